@@ -5,6 +5,7 @@
 #include "media/base/audio_buffer.h"
 
 #include <cmath>
+#include <iterator>
 
 #include "base/logging.h"
 #include "media/base/audio_bus.h"
@@ -19,6 +20,13 @@ static base::TimeDelta CalculateDuration(int frames, double sample_rate) {
       frames * base::Time::kMicrosecondsPerSecond / sample_rate);
 }
 
+AudioBufferMemoryPool::MemoryEntry::MemoryEntry(AudioMemory memory,
+                                                size_t size,
+                                                size_t returned_at)
+    : memory(std::move(memory)), size(size), returned_at(returned_at) {}
+AudioBufferMemoryPool::MemoryEntry::MemoryEntry(MemoryEntry&& other) = default;
+AudioBufferMemoryPool::MemoryEntry::~MemoryEntry() = default;
+
 AudioBufferMemoryPool::AudioBufferMemoryPool() = default;
 AudioBufferMemoryPool::~AudioBufferMemoryPool() = default;
 
@@ -27,15 +35,37 @@ size_t AudioBufferMemoryPool::GetPoolSizeForTesting() {
   return entries_.size();
 }
 
+size_t AudioBufferMemoryPool::hit_count() {
+  base::AutoLock al(entry_lock_);
+  return hit_count_;
+}
+
+size_t AudioBufferMemoryPool::miss_count() {
+  base::AutoLock al(entry_lock_);
+  return request_count_ - hit_count_;
+}
+
 AudioBufferMemoryPool::AudioMemory AudioBufferMemoryPool::CreateBuffer(
     size_t size) {
-  base::AutoLock al(entry_lock_);
-  while (!entries_.empty()) {
-    MemoryEntry& front = entries_.front();
-    MemoryEntry entry(std::move(front.first), front.second);
-    entries_.pop_front();
-    if (entry.second == size)
-      return std::move(entry.first);
+  {
+    base::AutoLock al(entry_lock_);
+    ++request_count_;
+
+    // Entries are ordered by age, so idle ones are always at the front.
+    while (!entries_.empty() &&
+           request_count_ - entries_.front().returned_at > kMaxIdleRequests) {
+      entries_.pop_front();
+    }
+
+    // Prefer the most recently returned buffer, it's most likely in cache.
+    for (auto it = entries_.rbegin(); it != entries_.rend(); ++it) {
+      if (it->size == size) {
+        AudioMemory memory = std::move(it->memory);
+        entries_.erase(std::next(it).base());
+        ++hit_count_;
+        return memory;
+      }
+    }
   }
 
   return AudioMemory(static_cast<uint8_t*>(
@@ -44,7 +74,7 @@ AudioBufferMemoryPool::AudioMemory AudioBufferMemoryPool::CreateBuffer(
 
 void AudioBufferMemoryPool::ReturnBuffer(AudioMemory memory, size_t size) {
   base::AutoLock al(entry_lock_);
-  entries_.emplace_back(std::move(memory), size);
+  entries_.emplace_back(std::move(memory), size, request_count_);
 }
 
 AudioBuffer::AudioBuffer(SampleFormat sample_format,
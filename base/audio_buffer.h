@@ -227,22 +227,33 @@ class MEDIA_EXPORT AudioBuffer
 
 // Basic memory pool for reusing AudioBuffer internal memory to avoid thrashing.
 //
-// The pool is managed in a last-in-first-out manner, returned buffers are put
-// at the back of the queue. When a new buffer is requested by AudioBuffer, we
-// will scan from the front to find a matching buffer. All non-matching buffers
-// are dropped. The assumption is that when we reach steady-state all buffers
-// will have the same sized allocation. At most the pool will be equal in size
-// to the maximum number of concurrent AudioBuffer instances.
+// Returned buffers are put at the back of the queue. When a new buffer is
+// requested by AudioBuffer, we scan from the back to find the most recently
+// returned buffer of a matching size. Buffers of other sizes are kept, since
+// decoders such as Opus and Vorbis legitimately alternate between a few packet
+// sizes, but any buffer which goes unused for kMaxIdleRequests requests is
+// dropped so memory from a previous configuration is eventually released. At
+// most the pool will be equal in size to the maximum number of concurrent
+// AudioBuffer instances.
 //
 // Each AudioBuffer instance created with an AudioBufferMemoryPool will take a
 // ref on the pool instance so that it may return buffers in the future.
 class MEDIA_EXPORT AudioBufferMemoryPool
     : public base::RefCountedThreadSafe<AudioBufferMemoryPool> {
  public:
+  // Number of buffer requests after which an unused pooled buffer is freed.
+  enum { kMaxIdleRequests = 64 };
+
   AudioBufferMemoryPool();
 
   size_t GetPoolSizeForTesting();
 
+  // Number of buffer requests which were satisfied by recycled memory, and
+  // which required a new allocation, respectively.  Together they give the
+  // pool hit rate.
+  size_t hit_count();
+  size_t miss_count();
+
  private:
   friend class AudioBuffer;
   friend class base::RefCountedThreadSafe<AudioBufferMemoryPool>;
@@ -254,9 +265,23 @@ class MEDIA_EXPORT AudioBufferMemoryPool
   void ReturnBuffer(AudioMemory memory, size_t size);
 
   base::Lock entry_lock_;
-  using MemoryEntry = std::pair<AudioMemory, size_t>;
+  struct MemoryEntry {
+    MemoryEntry(AudioMemory memory, size_t size, size_t returned_at);
+    MemoryEntry(MemoryEntry&& other);
+    ~MemoryEntry();
+
+    AudioMemory memory;
+    size_t size;
+
+    // Value of |request_count_| when the memory was returned to the pool.
+    size_t returned_at;
+  };
   std::list<MemoryEntry> entries_ GUARDED_BY(entry_lock_);
 
+  // Total number of CreateBuffer() calls, used to age |entries_|.
+  size_t request_count_ GUARDED_BY(entry_lock_) = 0;
+  size_t hit_count_ GUARDED_BY(entry_lock_) = 0;
+
   DISALLOW_COPY_AND_ASSIGN(AudioBufferMemoryPool);
 };
 
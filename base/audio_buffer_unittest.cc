@@ -7,6 +7,7 @@
 #include <limits>
 #include <memory>
 
+#include "base/macros.h"
 #include "media/base/audio_buffer.h"
 #include "media/base/audio_bus.h"
 #include "media/base/test_helpers.h"
@@ -561,11 +562,28 @@ TEST(AudioBufferTest, AudioBufferMemoryPool) {
   b1 = nullptr;
   EXPECT_EQ(2u, pool->GetPoolSizeForTesting());
 
-  // A buffer of a different size should not reuse the buffer and drain pool.
+  EXPECT_EQ(1u, pool->hit_count());
+  EXPECT_EQ(2u, pool->miss_count());
+
+  // A buffer of a different size should not reuse the buffer, but should not
+  // drain the pool either.
   b2 = AudioBuffer::CreateBuffer(kSampleFormatU8, buffer->channel_layout(),
                                  buffer->channel_count(), buffer->sample_rate(),
                                  buffer->frame_count() / 2, pool);
+  EXPECT_EQ(2u, pool->GetPoolSizeForTesting());
+  EXPECT_EQ(1u, pool->hit_count());
+  EXPECT_EQ(3u, pool->miss_count());
+
+  // Recycling buffers of the new size eventually drops the idle ones.
+  for (int i = 0; i <= AudioBufferMemoryPool::kMaxIdleRequests; ++i) {
+    b2 = nullptr;
+    b2 = AudioBuffer::CreateBuffer(
+        kSampleFormatU8, buffer->channel_layout(), buffer->channel_count(),
+        buffer->sample_rate(), buffer->frame_count() / 2, pool);
+  }
   EXPECT_EQ(0u, pool->GetPoolSizeForTesting());
+  EXPECT_EQ(2u + AudioBufferMemoryPool::kMaxIdleRequests, pool->hit_count());
+  EXPECT_EQ(3u, pool->miss_count());
 
   // Mark pool for destruction and ensure buffer is still valid.
   pool = nullptr;
@@ -575,6 +593,37 @@ TEST(AudioBufferTest, AudioBufferMemoryPool) {
   b2 = nullptr;
 }
 
+// Decoders such as Opus may alternate between packet sizes; make sure the pool
+// serves both sizes from recycled memory.
+TEST(AudioBufferTest, AudioBufferMemoryPoolMixedSizes) {
+  scoped_refptr<AudioBufferMemoryPool> pool(new AudioBufferMemoryPool());
+  const ChannelLayout kChannelLayout = CHANNEL_LAYOUT_STEREO;
+  const int kChannels = ChannelLayoutToChannelCount(kChannelLayout);
+  const int kFrameCounts[] = {960, 480};
+
+  const void* memory[arraysize(kFrameCounts)];
+  for (size_t i = 0; i < arraysize(kFrameCounts); ++i) {
+    scoped_refptr<AudioBuffer> b = AudioBuffer::CreateBuffer(
+        kSampleFormatPlanarF32, kChannelLayout, kChannels, kSampleRate,
+        kFrameCounts[i], pool);
+    memory[i] = b->channel_data()[0];
+  }
+  EXPECT_EQ(2u, pool->GetPoolSizeForTesting());
+  EXPECT_EQ(2u, pool->miss_count());
+
+  for (int round = 0; round < 10; ++round) {
+    for (size_t i = 0; i < arraysize(kFrameCounts); ++i) {
+      scoped_refptr<AudioBuffer> b = AudioBuffer::CreateBuffer(
+          kSampleFormatPlanarF32, kChannelLayout, kChannels, kSampleRate,
+          kFrameCounts[i], pool);
+      EXPECT_EQ(memory[i], b->channel_data()[0]);
+    }
+  }
+  EXPECT_EQ(2u, pool->GetPoolSizeForTesting());
+  EXPECT_EQ(20u, pool->hit_count());
+  EXPECT_EQ(2u, pool->miss_count());
+}
+
 // Planar allocations use a different path, so make sure pool is used.
 TEST(AudioBufferTest, AudioBufferMemoryPoolPlanar) {
   scoped_refptr<AudioBufferMemoryPool> pool(new AudioBufferMemoryPool());
@@ -596,10 +645,11 @@ TEST(AudioBufferTest, AudioBufferMemoryPoolPlanar) {
   EXPECT_EQ(1u, pool->GetPoolSizeForTesting());
 
   // Even (especially) when used with CreateBuffer.
-  b1 = AudioBuffer::CreateBuffer(kSampleFormatU8, buffer->channel_layout(),
-                                 buffer->channel_count(), buffer->sample_rate(),
-                                 buffer->frame_count(), pool);
+  b1 = AudioBuffer::CreateBuffer(
+      kSampleFormatPlanarF32, buffer->channel_layout(), buffer->channel_count(),
+      buffer->sample_rate(), buffer->frame_count(), pool);
   EXPECT_EQ(0u, pool->GetPoolSizeForTesting());
+  EXPECT_EQ(1u, pool->hit_count());
 
   // Mark pool for destruction and ensure buffer is still valid.
   pool = nullptr;
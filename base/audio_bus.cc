@@ -13,10 +13,20 @@
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/numerics/safe_conversions.h"
+#include "build/build_config.h"
 #include "media/base/audio_parameters.h"
 #include "media/base/limits.h"
 #include "media/base/vector_math.h"
 
+// NaCl does not allow intrinsics.
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include <emmintrin.h>
+#define VECTORIZED_INTERLEAVE
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+#include <arm_neon.h>
+#define VECTORIZED_INTERLEAVE
+#endif
+
 namespace media {
 
 static bool IsAligned(void* ptr) {
@@ -419,4 +429,345 @@ void AudioBus::SwapChannels(int a, int b) {
   std::swap(channel_data_[a], channel_data_[b]);
 }
 
+#if defined(VECTORIZED_INTERLEAVE)
+// Scaling factors matching SignedInt16SampleTypeTraits.  Negative and positive
+// samples are scaled differently since int16_t is not symmetric around zero.
+static constexpr float kInt16NegativeScale = 32768.0f;
+static constexpr float kInt16PositiveScale = 32767.0f;
+static constexpr float kInt16InverseNegativeScale = 1.0f / kInt16NegativeScale;
+static constexpr float kInt16InversePositiveScale = 1.0f / kInt16PositiveScale;
+
+// The helpers below operate on four samples at a time.  LoadSamples() reads
+// four consecutive samples and converts them to float; StoreSamples() clips
+// four floats and writes them as four consecutive samples.  Both mirror the
+// scalar conversions in audio_sample_types.h exactly, including the handling
+// of NaN for float output.
+#if defined(ARCH_CPU_X86_FAMILY)
+typedef __m128 FloatVector;
+
+static inline FloatVector LoadSamples(const int16_t* source) {
+  // Sign extend to 32 bits by unpacking each sample into the upper half of a
+  // 32-bit lane and shifting it back down.
+  const __m128i samples =
+      _mm_loadl_epi64(reinterpret_cast<const __m128i*>(source));
+  const __m128 values =
+      _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+  const __m128 negative = _mm_cmplt_ps(values, _mm_setzero_ps());
+  const __m128 scale = _mm_or_ps(
+      _mm_and_ps(negative, _mm_set1_ps(kInt16InverseNegativeScale)),
+      _mm_andnot_ps(negative, _mm_set1_ps(kInt16InversePositiveScale)));
+  return _mm_mul_ps(values, scale);
+}
+
+static inline FloatVector LoadSamples(const float* source) {
+  return _mm_loadu_ps(source);
+}
+
+static inline void StoreSamples(FloatVector values, int16_t* dest) {
+  // Clipping after scaling is equivalent to clipping to [-1, 1] first, since
+  // -1 and 1 scale exactly to the int16_t limits.
+  const __m128 negative = _mm_cmplt_ps(values, _mm_setzero_ps());
+  const __m128 scale =
+      _mm_or_ps(_mm_and_ps(negative, _mm_set1_ps(kInt16NegativeScale)),
+                _mm_andnot_ps(negative, _mm_set1_ps(kInt16PositiveScale)));
+  __m128 scaled = _mm_mul_ps(values, scale);
+  scaled = _mm_max_ps(_mm_min_ps(scaled, _mm_set1_ps(kInt16PositiveScale)),
+                      _mm_set1_ps(-kInt16NegativeScale));
+  const __m128i samples = _mm_cvttps_epi32(scaled);
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(dest),
+                   _mm_packs_epi32(samples, samples));
+}
+
+static inline void StoreSamples(FloatVector values, float* dest) {
+  // Zero NaN lanes first: MINPS and MAXPS return their second operand when
+  // either one is NaN, which would otherwise clip NaN to -1 instead of 0.
+  values = _mm_and_ps(values, _mm_cmpord_ps(values, values));
+  _mm_storeu_ps(dest, _mm_max_ps(_mm_min_ps(values, _mm_set1_ps(1.0f)),
+                                 _mm_set1_ps(-1.0f)));
+}
+
+static inline FloatVector LoadChannel(const float* source) {
+  return _mm_loadu_ps(source);
+}
+
+static inline void StoreChannel(FloatVector values, float* dest) {
+  _mm_storeu_ps(dest, values);
+}
+
+// Splits two vectors holding four interleaved stereo frames into one vector
+// per channel, and back.
+static inline void Deinterleave2(FloatVector a,
+                                 FloatVector b,
+                                 FloatVector* left,
+                                 FloatVector* right) {
+  *left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  *right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+static inline void Interleave2(FloatVector left,
+                               FloatVector right,
+                               FloatVector* a,
+                               FloatVector* b) {
+  *a = _mm_unpacklo_ps(left, right);
+  *b = _mm_unpackhi_ps(left, right);
+}
+
+static inline void Transpose4x4(FloatVector* rows) {
+  _MM_TRANSPOSE4_PS(rows[0], rows[1], rows[2], rows[3]);
+}
+#elif defined(ARCH_CPU_ARM_FAMILY)
+typedef float32x4_t FloatVector;
+
+static inline FloatVector LoadSamples(const int16_t* source) {
+  const float32x4_t values = vcvtq_f32_s32(vmovl_s16(vld1_s16(source)));
+  const float32x4_t scale =
+      vbslq_f32(vcltq_f32(values, vdupq_n_f32(0.0f)),
+                vdupq_n_f32(kInt16InverseNegativeScale),
+                vdupq_n_f32(kInt16InversePositiveScale));
+  return vmulq_f32(values, scale);
+}
+
+static inline FloatVector LoadSamples(const float* source) {
+  return vld1q_f32(source);
+}
+
+static inline void StoreSamples(FloatVector values, int16_t* dest) {
+  // Clipping after scaling is equivalent to clipping to [-1, 1] first, since
+  // -1 and 1 scale exactly to the int16_t limits.
+  const float32x4_t scale = vbslq_f32(vcltq_f32(values, vdupq_n_f32(0.0f)),
+                                      vdupq_n_f32(kInt16NegativeScale),
+                                      vdupq_n_f32(kInt16PositiveScale));
+  float32x4_t scaled = vmulq_f32(values, scale);
+  scaled = vmaxq_f32(vminq_f32(scaled, vdupq_n_f32(kInt16PositiveScale)),
+                     vdupq_n_f32(-kInt16NegativeScale));
+  vst1_s16(dest, vqmovn_s32(vcvtq_s32_f32(scaled)));
+}
+
+static inline void StoreSamples(FloatVector values, float* dest) {
+  // NaN compares unequal to itself; zero those lanes before clipping.
+  const uint32x4_t not_nan = vceqq_f32(values, values);
+  values = vreinterpretq_f32_u32(
+      vandq_u32(vreinterpretq_u32_f32(values), not_nan));
+  vst1q_f32(dest, vmaxq_f32(vminq_f32(values, vdupq_n_f32(1.0f)),
+                            vdupq_n_f32(-1.0f)));
+}
+
+static inline FloatVector LoadChannel(const float* source) {
+  return vld1q_f32(source);
+}
+
+static inline void StoreChannel(FloatVector values, float* dest) {
+  vst1q_f32(dest, values);
+}
+
+// Splits two vectors holding four interleaved stereo frames into one vector
+// per channel, and back.
+static inline void Deinterleave2(FloatVector a,
+                                 FloatVector b,
+                                 FloatVector* left,
+                                 FloatVector* right) {
+  const float32x4x2_t result = vuzpq_f32(a, b);
+  *left = result.val[0];
+  *right = result.val[1];
+}
+
+static inline void Interleave2(FloatVector left,
+                               FloatVector right,
+                               FloatVector* a,
+                               FloatVector* b) {
+  const float32x4x2_t result = vzipq_f32(left, right);
+  *a = result.val[0];
+  *b = result.val[1];
+}
+
+static inline void Transpose4x4(FloatVector* rows) {
+  const float32x4x2_t t01 = vtrnq_f32(rows[0], rows[1]);
+  const float32x4x2_t t23 = vtrnq_f32(rows[2], rows[3]);
+  rows[0] = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+  rows[1] = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+  rows[2] = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+  rows[3] = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+#endif
+
+// Deinterleaves and converts as many multiples of four frames as possible from
+// |source| into |dest| and returns the number of frames written.  Stereo is
+// split with shuffles; other layouts are transposed in blocks of four channels
+// by four frames, with any remaining channels gathered one at a time.
+template <typename SampleType>
+static int DeinterleaveFrames_SIMD(const SampleType* source,
+                                   int write_offset,
+                                   int frames,
+                                   AudioBus* dest) {
+  const int channels = dest->channels();
+  const int vector_frames = frames & ~3;
+
+  if (channels == 2) {
+    float* left = dest->channel(0) + write_offset;
+    float* right = dest->channel(1) + write_offset;
+    for (int i = 0; i < vector_frames; i += 4, source += 8) {
+      FloatVector left_values, right_values;
+      Deinterleave2(LoadSamples(source), LoadSamples(source + 4), &left_values,
+                    &right_values);
+      StoreChannel(left_values, left + i);
+      StoreChannel(right_values, right + i);
+    }
+    return vector_frames;
+  }
+
+  int ch = 0;
+  for (; ch + 4 <= channels; ch += 4) {
+    for (int i = 0; i < vector_frames; i += 4) {
+      FloatVector values[4];
+      for (int j = 0; j < 4; ++j)
+        values[j] = LoadSamples(source + (i + j) * channels + ch);
+      Transpose4x4(values);
+      for (int j = 0; j < 4; ++j)
+        StoreChannel(values[j], dest->channel(ch + j) + write_offset + i);
+    }
+  }
+  for (; ch < channels; ++ch) {
+    float* channel_data = dest->channel(ch) + write_offset;
+    for (int i = 0; i < vector_frames; i += 4) {
+      const SampleType* frame = source + i * channels + ch;
+      const SampleType samples[4] = {frame[0], frame[channels],
+                                     frame[2 * channels], frame[3 * channels]};
+      StoreChannel(LoadSamples(samples), channel_data + i);
+    }
+  }
+  return vector_frames;
+}
+
+// The inverse of DeinterleaveFrames_SIMD().
+template <typename SampleType>
+static int InterleaveFrames_SIMD(const AudioBus* source,
+                                 int read_offset,
+                                 int frames,
+                                 SampleType* dest) {
+  const int channels = source->channels();
+  const int vector_frames = frames & ~3;
+
+  if (channels == 2) {
+    const float* left = source->channel(0) + read_offset;
+    const float* right = source->channel(1) + read_offset;
+    for (int i = 0; i < vector_frames; i += 4, dest += 8) {
+      FloatVector a, b;
+      Interleave2(LoadChannel(left + i), LoadChannel(right + i), &a, &b);
+      StoreSamples(a, dest);
+      StoreSamples(b, dest + 4);
+    }
+    return vector_frames;
+  }
+
+  int ch = 0;
+  for (; ch + 4 <= channels; ch += 4) {
+    for (int i = 0; i < vector_frames; i += 4) {
+      FloatVector values[4];
+      for (int j = 0; j < 4; ++j)
+        values[j] = LoadChannel(source->channel(ch + j) + read_offset + i);
+      Transpose4x4(values);
+      for (int j = 0; j < 4; ++j)
+        StoreSamples(values[j], dest + (i + j) * channels + ch);
+    }
+  }
+  for (; ch < channels; ++ch) {
+    const float* channel_data = source->channel(ch) + read_offset;
+    for (int i = 0; i < vector_frames; i += 4) {
+      SampleType samples[4];
+      StoreSamples(LoadChannel(channel_data + i), samples);
+      SampleType* frame = dest + i * channels + ch;
+      frame[0] = samples[0];
+      frame[channels] = samples[1];
+      frame[2 * channels] = samples[2];
+      frame[3 * channels] = samples[3];
+    }
+  }
+  return vector_frames;
+}
+#endif  // defined(VECTORIZED_INTERLEAVE)
+
+// Shared implementation of the specializations below.  The SIMD helpers handle
+// whole blocks of four frames; the generic conversion handles the remainder.
+template <class SourceSampleTypeTraits>
+static void DeinterleaveFrames(
+    const typename SourceSampleTypeTraits::ValueType* source_buffer,
+    int write_offset_in_frames,
+    int num_frames_to_write,
+    AudioBus* dest) {
+  int frames_done = 0;
+#if defined(VECTORIZED_INTERLEAVE)
+  frames_done = DeinterleaveFrames_SIMD(source_buffer, write_offset_in_frames,
+                                        num_frames_to_write, dest);
+#endif
+  const int channels = dest->channels();
+  for (int ch = 0; ch < channels; ++ch) {
+    float* channel_data = dest->channel(ch) + write_offset_in_frames;
+    for (int i = frames_done; i < num_frames_to_write; ++i) {
+      channel_data[i] =
+          SourceSampleTypeTraits::ToFloat(source_buffer[i * channels + ch]);
+    }
+  }
+}
+
+template <class TargetSampleTypeTraits>
+static void InterleaveFrames(
+    const AudioBus* source,
+    int read_offset_in_frames,
+    int num_frames_to_read,
+    typename TargetSampleTypeTraits::ValueType* dest_buffer) {
+  int frames_done = 0;
+#if defined(VECTORIZED_INTERLEAVE)
+  frames_done = InterleaveFrames_SIMD(source, read_offset_in_frames,
+                                      num_frames_to_read, dest_buffer);
+#endif
+  const int channels = source->channels();
+  for (int ch = 0; ch < channels; ++ch) {
+    const float* channel_data = source->channel(ch) + read_offset_in_frames;
+    for (int i = frames_done; i < num_frames_to_read; ++i) {
+      dest_buffer[i * channels + ch] =
+          TargetSampleTypeTraits::FromFloat(channel_data[i]);
+    }
+  }
+}
+
+template <>
+void AudioBus::CopyConvertFromInterleavedSourceToAudioBus<
+    SignedInt16SampleTypeTraits>(const int16_t* source_buffer,
+                                 int write_offset_in_frames,
+                                 int num_frames_to_write,
+                                 AudioBus* dest) {
+  DeinterleaveFrames<SignedInt16SampleTypeTraits>(
+      source_buffer, write_offset_in_frames, num_frames_to_write, dest);
+}
+
+template <>
+void AudioBus::CopyConvertFromInterleavedSourceToAudioBus<
+    Float32SampleTypeTraits>(const float* source_buffer,
+                             int write_offset_in_frames,
+                             int num_frames_to_write,
+                             AudioBus* dest) {
+  DeinterleaveFrames<Float32SampleTypeTraits>(
+      source_buffer, write_offset_in_frames, num_frames_to_write, dest);
+}
+
+template <>
+void AudioBus::CopyConvertFromAudioBusToInterleavedTarget<
+    SignedInt16SampleTypeTraits>(const AudioBus* source,
+                                 int read_offset_in_frames,
+                                 int num_frames_to_read,
+                                 int16_t* dest_buffer) {
+  InterleaveFrames<SignedInt16SampleTypeTraits>(
+      source, read_offset_in_frames, num_frames_to_read, dest_buffer);
+}
+
+template <>
+void AudioBus::CopyConvertFromAudioBusToInterleavedTarget<
+    Float32SampleTypeTraits>(const AudioBus* source,
+                             int read_offset_in_frames,
+                             int num_frames_to_read,
+                             float* dest_buffer) {
+  InterleaveFrames<Float32SampleTypeTraits>(
+      source, read_offset_in_frames, num_frames_to_read, dest_buffer);
+}
+
 }  // namespace media
@@ -40,16 +40,34 @@ void RunInterleaveBench(AudioBus* bus, const std::string& trace_name) {
                          true);
 }
 
-// Benchmark the FromInterleaved() and ToInterleaved() methods.
-TEST(AudioBusPerfTest, Interleave) {
-  std::unique_ptr<AudioBus> bus = AudioBus::Create(2, kSampleRate * 120);
+static void RunInterleaveBenches(int channels,
+                                 int seconds,
+                                 const std::string& suffix) {
+  std::unique_ptr<AudioBus> bus =
+      AudioBus::Create(channels, kSampleRate * seconds);
   FakeAudioRenderCallback callback(0.2, kSampleRate);
   callback.Render(base::TimeDelta(), base::TimeTicks::Now(), 0, bus.get());
 
   // Only benchmark these two types since they're the only commonly used ones.
   RunInterleaveBench<int16_t, SignedInt16SampleTypeTraits>(bus.get(),
-                                                           "int16_t");
-  RunInterleaveBench<float, Float32SampleTypeTraits>(bus.get(), "float");
+                                                           "int16_t" + suffix);
+  RunInterleaveBench<float, Float32SampleTypeTraits>(bus.get(),
+                                                     "float" + suffix);
+}
+
+// Benchmark the FromInterleaved() and ToInterleaved() methods.
+TEST(AudioBusPerfTest, Interleave) {
+  RunInterleaveBenches(2, 120, "");
+}
+
+// Same as above for the common surround layouts, which take the transposing
+// rather than the stereo code path.  Shorter buses keep memory use similar.
+TEST(AudioBusPerfTest, Interleave_5_1) {
+  RunInterleaveBenches(6, 40, "_5_1");
+}
+
+TEST(AudioBusPerfTest, Interleave_7_1) {
+  RunInterleaveBenches(8, 30, "_7_1");
 }
 
 }  // namespace media
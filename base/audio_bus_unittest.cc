@@ -5,8 +5,10 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <cmath>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
@@ -584,6 +586,93 @@ TEST_F(AudioBusTest, ToInterleavedPartial) {
   }
 }
 
+// Verify the vectorized int16 and float32 conversions exactly match the
+// scalar sample type conversions for every channel count, including frame
+// counts and offsets which leave a partial block of frames.
+TEST_F(AudioBusTest, InterleaveMatchesScalarConversion) {
+  static const int kFrames = 37;
+  static const int kOffset = 3;
+  static const float kFloatValues[] = {
+      0.0f,   -0.0f,   0.5f,     -0.5f,   1.0f,         -1.0f,
+      1.5f,   -1.5f,   1e-30f,   -1e-30f, 0.99999994f,  -0.99999994f,
+      100.0f, -100.0f, 0.123f,   -0.777f};
+  static const int16_t kInt16Values[] = {
+      0, 1, -1, 32767, -32768, 16384, -16384, 12345, -23456, 2, -2, 32766};
+
+  for (int channels = 1; channels <= 8; ++channels) {
+    SCOPED_TRACE(base::StringPrintf("%d channels", channels));
+    const int samples = channels * kFrames;
+
+    std::vector<float> float_source(samples);
+    std::vector<int16_t> int16_source(samples);
+    for (int i = 0; i < samples; ++i) {
+      float_source[i] = kFloatValues[i % arraysize(kFloatValues)];
+      int16_source[i] = kInt16Values[i % arraysize(kInt16Values)];
+    }
+    float_source[samples / 2] = std::numeric_limits<float>::quiet_NaN();
+
+    std::unique_ptr<AudioBus> bus = AudioBus::Create(channels, kFrames);
+    for (int frames = 0; frames <= kFrames - kOffset; ++frames) {
+      bus->FromInterleavedPartial<SignedInt16SampleTypeTraits>(
+          &int16_source[0], kOffset, frames);
+      for (int ch = 0; ch < channels; ++ch) {
+        for (int i = 0; i < frames; ++i) {
+          ASSERT_EQ(SignedInt16SampleTypeTraits::ToFloat(
+                        int16_source[i * channels + ch]),
+                    bus->channel(ch)[kOffset + i]);
+        }
+      }
+
+      // Float input is not clipped, so only compare finite values here.
+      bus->FromInterleavedPartial<Float32SampleTypeTraits>(&float_source[0],
+                                                           kOffset, frames);
+      for (int ch = 0; ch < channels; ++ch) {
+        for (int i = 0; i < frames; ++i) {
+          const float expected = float_source[i * channels + ch];
+          if (!std::isnan(expected))
+            ASSERT_EQ(expected, bus->channel(ch)[kOffset + i]);
+        }
+      }
+    }
+
+    // Fill the bus with values that exercise clipping; NaN is only valid for
+    // float output.
+    for (int ch = 0; ch < channels; ++ch) {
+      for (int i = 0; i < kFrames; ++i) {
+        bus->channel(ch)[i] =
+            kFloatValues[(i * channels + ch) % arraysize(kFloatValues)];
+      }
+    }
+    for (int frames = 0; frames <= kFrames - kOffset; ++frames) {
+      std::vector<int16_t> int16_dest(samples);
+      bus->ToInterleavedPartial<SignedInt16SampleTypeTraits>(kOffset, frames,
+                                                             &int16_dest[0]);
+      for (int ch = 0; ch < channels; ++ch) {
+        for (int i = 0; i < frames; ++i) {
+          ASSERT_EQ(SignedInt16SampleTypeTraits::FromFloat(
+                        bus->channel(ch)[kOffset + i]),
+                    int16_dest[i * channels + ch]);
+        }
+      }
+    }
+
+    bus->channel(channels - 1)[kOffset + 1] =
+        std::numeric_limits<float>::quiet_NaN();
+    for (int frames = 0; frames <= kFrames - kOffset; ++frames) {
+      std::vector<float> float_dest(samples);
+      bus->ToInterleavedPartial<Float32SampleTypeTraits>(kOffset, frames,
+                                                         &float_dest[0]);
+      for (int ch = 0; ch < channels; ++ch) {
+        for (int i = 0; i < frames; ++i) {
+          ASSERT_EQ(Float32SampleTypeTraits::FromFloat(
+                        bus->channel(ch)[kOffset + i]),
+                    float_dest[i * channels + ch]);
+        }
+      }
+    }
+  }
+}
+
 struct ZeroingOutTestData {
   static constexpr int kChannelCount = 2;
   static constexpr int kFrameCount = 10;
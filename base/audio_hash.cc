@@ -2,18 +2,134 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 
 #include "media/base/audio_hash.h"
 
+#include "base/logging.h"
 #include "base/macros.h"
 #include "base/numerics/math_constants.h"
 #include "base/strings/stringprintf.h"
+#include "build/build_config.h"
 #include "media/base/audio_bus.h"
 
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include <xmmintrin.h>
+#define BUCKET_SUMS_FUNC AddToBucketSums_SSE
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+#include <arm_neon.h>
+#define BUCKET_SUMS_FUNC AddToBucketSums_NEON
+#else
+#define BUCKET_SUMS_FUNC AddToBucketSums_C
+#endif
+
+// The scalar and vectorized bucket sums must be bit identical, so multiplies
+// and adds in this file must not be contracted into fused multiply-adds, even
+// across statements.  Compilers which ignore this pragma, or builds using
+// -ffp-contract=fast, may still fuse them; the hashes then only match to
+// within rounding.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#endif
+
 namespace media {
 
+namespace {
+
+static_assert(WindowedAudioHash::kBuckets == 8,
+              "The vectorized bucket sums below assume eight buckets.");
+
+// Returns the weight of row |row| of a window, i.e. of the kBuckets frames
+// starting at |row| * kBuckets.  The weights are spread over [0.5, 1.5) by a
+// multiplicative hash of the row index, and are exact in float.
+float RowWeight(uint32_t row) {
+  return 0.5f + ((row * 0x9e3779b1u) >> 16) * (1.0f / 65536);
+}
+
+// Adds |frames| samples of |src|, weighted by their row, to |sums|; src[i] is
+// in row |row| + i / kBuckets and added to sums[i % kBuckets].  |frames| must
+// be a multiple of kBuckets.  Every implementation adds to each bucket in the
+// same order, so all of them return bit identical results.
+void AddToBucketSums_C(const float src[],
+                       int frames,
+                       uint32_t row,
+                       float sums[]) {
+  for (int i = 0; i < frames; i += WindowedAudioHash::kBuckets, ++row) {
+    const float weight = RowWeight(row);
+    for (int j = 0; j < WindowedAudioHash::kBuckets; ++j) {
+      // Not fused into a multiply-add, see FP_CONTRACT above, just like the
+      // vectorized versions.
+      sums[j] += weight * src[i + j];
+    }
+  }
+}
+
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+void AddToBucketSums_SSE(const float src[],
+                         int frames,
+                         uint32_t row,
+                         float sums[]) {
+  __m128 sums_low = _mm_loadu_ps(sums);
+  __m128 sums_high = _mm_loadu_ps(sums + 4);
+  for (int i = 0; i < frames; i += WindowedAudioHash::kBuckets, ++row) {
+    const __m128 weight = _mm_set1_ps(RowWeight(row));
+    sums_low = _mm_add_ps(sums_low, _mm_mul_ps(weight, _mm_loadu_ps(src + i)));
+    sums_high =
+        _mm_add_ps(sums_high, _mm_mul_ps(weight, _mm_loadu_ps(src + i + 4)));
+  }
+  _mm_storeu_ps(sums, sums_low);
+  _mm_storeu_ps(sums + 4, sums_high);
+}
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+void AddToBucketSums_NEON(const float src[],
+                          int frames,
+                          uint32_t row,
+                          float sums[]) {
+  float32x4_t sums_low = vld1q_f32(sums);
+  float32x4_t sums_high = vld1q_f32(sums + 4);
+  for (int i = 0; i < frames; i += WindowedAudioHash::kBuckets, ++row) {
+    const float weight = RowWeight(row);
+    sums_low = vaddq_f32(sums_low, vmulq_n_f32(vld1q_f32(src + i), weight));
+    sums_high =
+        vaddq_f32(sums_high, vmulq_n_f32(vld1q_f32(src + i + 4), weight));
+  }
+  vst1q_f32(sums, sums_low);
+  vst1q_f32(sums + 4, sums_high);
+}
+#endif
+
+// Adds the sample at frame |position| of a window to the bucket sums.
+void AddToBucketSum(float sample, int position, float sums[]) {
+  const float weighted_sample =
+      RowWeight(position / WindowedAudioHash::kBuckets) * sample;
+  sums[position % WindowedAudioHash::kBuckets] += weighted_sample;
+}
+
+// Folds per channel bucket sums into a single window hash, rotating the buckets
+// of each channel by its index so channel order matters.
+void FoldChannelSums(const std::vector<float>& channel_sums,
+                     int channels,
+                     float* hash) {
+  for (int i = 0; i < WindowedAudioHash::kBuckets; ++i)
+    hash[i] = 0;
+  for (int ch = 0; ch < channels; ++ch) {
+    const float* sums = &channel_sums[ch * WindowedAudioHash::kBuckets];
+    for (int i = 0; i < WindowedAudioHash::kBuckets; ++i)
+      hash[(i + ch) % WindowedAudioHash::kBuckets] += sums[i];
+  }
+}
+
+std::string HashToString(const float* hash, int size) {
+  std::string result;
+  for (int i = 0; i < size; ++i)
+    result += base::StringPrintf("%.2f,", hash[i]);
+  return result;
+}
+
+}  // namespace
+
 AudioHash::AudioHash()
     : audio_hash_(),
       sample_count_(0) {
@@ -47,10 +163,7 @@ void AudioHash::Update(const AudioBus* audio_bus, int frames) {
 }
 
 std::string AudioHash::ToString() const {
-  std::string result;
-  for (size_t i = 0; i < arraysize(audio_hash_); ++i)
-    result += base::StringPrintf("%.2f,", audio_hash_[i]);
-  return result;
+  return HashToString(audio_hash_, arraysize(audio_hash_));
 }
 
 bool AudioHash::IsEquivalent(const std::string& other, double tolerance) const {
@@ -66,4 +179,119 @@ bool AudioHash::IsEquivalent(const std::string& other, double tolerance) const {
   return true;
 }
 
+WindowedAudioHash::WindowedAudioHash(int channels,
+                                     int window_frames,
+                                     int max_windows)
+    : channels_(channels),
+      window_frames_(window_frames),
+      max_windows_(max_windows),
+      window_position_(0),
+      completed_windows_(0),
+      channel_sums_(channels * kBuckets),
+      window_hashes_(max_windows * kBuckets) {
+  DCHECK_GT(channels_, 0);
+  DCHECK_GT(window_frames_, 0);
+  DCHECK_GT(max_windows_, 0);
+}
+
+WindowedAudioHash::~WindowedAudioHash() = default;
+
+void WindowedAudioHash::Update(const AudioBus* audio_bus, int frames) {
+  DCHECK_LE(frames, audio_bus->frames());
+  DCHECK_EQ(channels_, audio_bus->channels());
+
+  int offset = 0;
+  while (offset < frames) {
+    const int chunk_frames =
+        std::min(frames - offset, window_frames_ - window_position_);
+
+    // Hash the samples up to the next multiple of kBuckets one at a time, then
+    // as many full rows of kBuckets as possible with the vectorized version.
+    const int head_frames =
+        std::min(chunk_frames,
+                 (kBuckets - window_position_ % kBuckets) % kBuckets);
+    const int body_frames = (chunk_frames - head_frames) / kBuckets * kBuckets;
+    const uint32_t body_row = (window_position_ + head_frames) / kBuckets;
+    for (int ch = 0; ch < channels_; ++ch) {
+      const float* src = audio_bus->channel(ch) + offset;
+      float* sums = &channel_sums_[ch * kBuckets];
+      for (int i = 0; i < head_frames; ++i)
+        AddToBucketSum(src[i], window_position_ + i, sums);
+      BUCKET_SUMS_FUNC(src + head_frames, body_frames, body_row, sums);
+      for (int i = head_frames + body_frames; i < chunk_frames; ++i)
+        AddToBucketSum(src[i], window_position_ + i, sums);
+    }
+
+    offset += chunk_frames;
+    window_position_ += chunk_frames;
+    if (window_position_ == window_frames_)
+      FinishWindow();
+  }
+}
+
+int WindowedAudioHash::window_count() const {
+  return completed_windows_ + (window_position_ > 0 ? 1 : 0);
+}
+
+int WindowedAudioHash::first_window() const {
+  return std::max(0, completed_windows_ - max_windows_);
+}
+
+std::string WindowedAudioHash::WindowToString(int index) const {
+  float hash[kBuckets];
+  GetWindowHash(index, hash);
+  return HashToString(hash, kBuckets);
+}
+
+std::string WindowedAudioHash::ToString() const {
+  std::string result;
+  for (int i = first_window(); i < window_count(); ++i)
+    result += WindowToString(i) + ";";
+  return result;
+}
+
+int WindowedAudioHash::FindFirstMismatch(const std::string& other,
+                                         double tolerance) const {
+  float other_hash;
+  char separator;
+
+  std::stringstream is(other);
+  const int windows = window_count();
+  for (int i = first_window(); i < windows; ++i) {
+    float hash[kBuckets];
+    GetWindowHash(i, hash);
+    for (int j = 0; j < kBuckets; ++j) {
+      if (!(is >> other_hash >> separator) ||
+          std::fabs(hash[j] - other_hash) > tolerance) {
+        return i;
+      }
+    }
+    if (!(is >> separator) || separator != ';')
+      return i;
+  }
+
+  // Any hashes left in |other| don't have a counterpart here.
+  return is >> other_hash ? windows : -1;
+}
+
+void WindowedAudioHash::GetWindowHash(int index, float* hash) const {
+  DCHECK_GE(index, first_window());
+  DCHECK_LT(index, window_count());
+  if (index < completed_windows_) {
+    const float* stored_hash = &window_hashes_[index % max_windows_ * kBuckets];
+    std::copy(stored_hash, stored_hash + kBuckets, hash);
+    return;
+  }
+
+  FoldChannelSums(channel_sums_, channels_, hash);
+}
+
+void WindowedAudioHash::FinishWindow() {
+  float* hash = &window_hashes_[completed_windows_ % max_windows_ * kBuckets];
+  FoldChannelSums(channel_sums_, channels_, hash);
+  std::fill(channel_sums_.begin(), channel_sums_.end(), 0);
+  window_position_ = 0;
+  ++completed_windows_;
+}
+
 }  // namespace media
@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/strings/string_piece.h"
@@ -61,6 +62,84 @@ class MEDIA_EXPORT AudioHash {
   DISALLOW_COPY_AND_ASSIGN(AudioHash);
 };
 
+// Computes a separate hash for every |window_frames| frames of a series of
+// AudioBus objects, so a divergence between two long streams can be localized
+// to a window instead of a single end-of-stream value.
+//
+// Unlike AudioHash, each window hash is a weighted sum of the samples bucketed
+// by frame index modulo kBuckets and rotated by channel number.  Every row of
+// kBuckets frames in a window gets its own pseudo-random weight, so reordered
+// audio or zero-mean signals don't sum to the same value.  This vectorizes
+// well, so hashing runs at close to memory bandwidth, while keeping the same
+// resilience to small errors when converted to string.  The additions in each
+// bucket happen in frame order on every platform, so results don't depend on
+// the CPU or on how the stream is split across Update() calls.
+//
+// Only the hashes of the last |max_windows| completed windows are kept, in
+// storage allocated upon construction; Update() never allocates.
+class MEDIA_EXPORT WindowedAudioHash {
+ public:
+  enum { kBuckets = 8 };
+
+  WindowedAudioHash(int channels, int window_frames, int max_windows);
+  ~WindowedAudioHash();
+
+  // Update the window hashes with the contents of the provided AudioBus, which
+  // must have |channels| channels.
+  void Update(const AudioBus* audio_bus, int frames);
+
+  // Number of windows hashed so far, including a trailing partial window.
+  int window_count() const;
+
+  // Index of the oldest window whose hash is still available.
+  int first_window() const;
+
+  int window_frames() const { return window_frames_; }
+
+  // Return a string representation of the hash of window |index|, in the same
+  // format as AudioHash::ToString().  |index| must be in the range
+  // [first_window(), window_count()).
+  std::string WindowToString(int index) const;
+
+  // Return a string representation of every available window hash, starting
+  // at first_window(), separated by ';'.
+  std::string ToString() const;
+
+  // Compare with another set of window hashes given as string representation,
+  // whose first hash is that of window first_window().  Returns the index of
+  // the first window for which any bucket differs by more than |tolerance|, or
+  // for which |other| has no hash or an extra one.  If all windows are
+  // equivalent returns -1.
+  int FindFirstMismatch(const std::string& other, double tolerance) const;
+
+ private:
+  // Writes the kBuckets values of the hash of window |index| to |hash|.
+  void GetWindowHash(int index, float* hash) const;
+
+  // Stores the hash of the current window and starts the next one.
+  void FinishWindow();
+
+  const int channels_;
+  const int window_frames_;
+  const int max_windows_;
+
+  // Number of frames hashed into the current window so far.
+  int window_position_;
+
+  // Number of completed windows so far.
+  int completed_windows_;
+
+  // Per channel running sums for the current window; kBuckets per channel,
+  // indexed by frame position within the window modulo kBuckets.
+  std::vector<float> channel_sums_;
+
+  // Ring of the hashes of the last |max_windows_| completed windows; kBuckets
+  // per window, window i is stored at slot i % |max_windows_|.
+  std::vector<float> window_hashes_;
+
+  DISALLOW_COPY_AND_ASSIGN(WindowedAudioHash);
+};
+
 }  // namespace media
 
 #endif  // MEDIA_BASE_AUDIO_HASH_H_
@@ -0,0 +1,54 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/audio_hash.h"
+#include "media/base/fake_audio_render_callback.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 20;
+static const int kSampleRate = 48000;
+static const int kChannels = 2;
+static const int kBufferFrames = 480;
+static const int kMaxWindows = 60;
+
+template <typename Hash>
+static void RunHashBenchmark(Hash* hash,
+                             const AudioBus* bus,
+                             int seconds,
+                             const std::string& trace_name) {
+  const int buffers = seconds * kSampleRate / kBufferFrames;
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kBenchmarkIterations; ++i) {
+    for (int j = 0; j < buffers; ++j)
+      hash->Update(bus, bus->frames());
+  }
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult("audio_hash", "", trace_name,
+                         total_time_milliseconds / kBenchmarkIterations, "ms",
+                         true);
+}
+
+// Benchmark hashing a stream of typical decoder sized buses.
+TEST(AudioHashPerfTest, Update) {
+  std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kBufferFrames);
+  FakeAudioRenderCallback callback(0.2, kSampleRate);
+  callback.Render(base::TimeDelta(), base::TimeTicks::Now(), 0, bus.get());
+
+  AudioHash hash;
+  RunHashBenchmark(&hash, bus.get(), 1, "audio_hash_1s");
+
+  WindowedAudioHash windowed_hash(kChannels, kSampleRate, kMaxWindows);
+  RunHashBenchmark(&windowed_hash, bus.get(), 1, "windowed_audio_hash_1s");
+  RunHashBenchmark(&windowed_hash, bus.get(), 60, "windowed_audio_hash_60s");
+}
+
+}  // namespace media
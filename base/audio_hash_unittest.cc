@@ -2,10 +2,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
+#include <string>
 
 #include "base/logging.h"
 #include "base/macros.h"
+#include "base/numerics/math_constants.h"
 #include "media/base/audio_bus.h"
 #include "media/base/audio_hash.h"
 #include "media/base/fake_audio_render_callback.h"
@@ -16,6 +20,7 @@ namespace media {
 static const int kChannelCount = 2;
 static const int kFrameCount = 1024;
 static const int kSampleRate = 48000;
+static const int kMaxWindows = 16;
 
 class AudioHashTest : public testing::Test {
  public:
@@ -168,4 +173,148 @@ TEST_F(AudioHashTest, VerifySimilarHash) {
   EXPECT_NE(hash_one.ToString(), hash_three.ToString());
 }
 
+// Ensure windowed hashes don't depend on how the stream is split into buses,
+// even when Update() calls don't line up with windows or buckets.
+TEST_F(AudioHashTest, WindowedHashIgnoresUpdateSizes) {
+  const int kWindowFrames = 100;
+  WindowedAudioHash full_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  full_hash.Update(bus_one_.get(), bus_one_->frames());
+  EXPECT_EQ((kFrameCount + kWindowFrames - 1) / kWindowFrames,
+            full_hash.window_count());
+
+  const int kUpdateSizes[] = {1, 7, 13, 100, 3, 256};
+  WindowedAudioHash split_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  // Copy each piece since wrapping unaligned channel data isn't allowed.
+  std::unique_ptr<AudioBus> piece_bus =
+      AudioBus::Create(kChannelCount, kFrameCount);
+  for (int offset = 0, i = 0; offset < kFrameCount; ++i) {
+    const int frames = std::min(kFrameCount - offset,
+                                kUpdateSizes[i % arraysize(kUpdateSizes)]);
+    bus_one_->CopyPartialFramesTo(offset, frames, 0, piece_bus.get());
+    split_hash.Update(piece_bus.get(), frames);
+    offset += frames;
+  }
+
+  EXPECT_EQ(full_hash.ToString(), split_hash.ToString());
+  EXPECT_EQ(-1, full_hash.FindFirstMismatch(split_hash.ToString(), 0.01));
+}
+
+// Ensure a difference is localized to the window containing it.
+TEST_F(AudioHashTest, WindowedHashFindsMismatchedWindow) {
+  const int kWindowFrames = 256;
+  WindowedAudioHash original_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  original_hash.Update(bus_one_.get(), bus_one_->frames());
+  EXPECT_EQ(kFrameCount / kWindowFrames, original_hash.window_count());
+
+  bus_one_->channel(1)[2 * kWindowFrames + 10] += 0.5f;
+  WindowedAudioHash modified_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  modified_hash.Update(bus_one_.get(), bus_one_->frames());
+
+  EXPECT_EQ(original_hash.WindowToString(1), modified_hash.WindowToString(1));
+  EXPECT_NE(original_hash.WindowToString(2), modified_hash.WindowToString(2));
+  EXPECT_EQ(2, original_hash.FindFirstMismatch(modified_hash.ToString(), 0.1));
+
+  // Differences within |tolerance| are ignored.
+  EXPECT_EQ(-1, original_hash.FindFirstMismatch(modified_hash.ToString(), 1));
+}
+
+// Ensure missing or extra windows are reported as mismatches.
+TEST_F(AudioHashTest, WindowedHashWindowCountMismatch) {
+  const int kWindowFrames = 1000;
+  WindowedAudioHash short_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  short_hash.Update(bus_one_.get(), kWindowFrames);
+  EXPECT_EQ(1, short_hash.window_count());
+
+  // The trailing partial window counts as a window.
+  WindowedAudioHash long_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  long_hash.Update(bus_one_.get(), bus_one_->frames());
+  EXPECT_EQ(2, long_hash.window_count());
+
+  EXPECT_EQ(1, long_hash.FindFirstMismatch(short_hash.ToString(), 0.01));
+  EXPECT_EQ(1, short_hash.FindFirstMismatch(long_hash.ToString(), 0.01));
+  EXPECT_EQ(-1, short_hash.FindFirstMismatch(
+                    long_hash.WindowToString(0) + ";", 0.01));
+}
+
+// Ensure channel order matters to the windowed hash.
+TEST_F(AudioHashTest, WindowedHashChannelOrder) {
+  WindowedAudioHash original_hash(kChannelCount, kFrameCount, kMaxWindows);
+  original_hash.Update(bus_one_.get(), bus_one_->frames());
+
+  std::unique_ptr<AudioBus> swapped_ch_bus =
+      AudioBus::CreateWrapper(kChannelCount);
+  swapped_ch_bus->set_frames(bus_one_->frames());
+  for (int ch = 0; ch < kChannelCount; ++ch) {
+    swapped_ch_bus->SetChannelData(kChannelCount - (ch + 1),
+                                   bus_one_->channel(ch));
+  }
+
+  WindowedAudioHash swapped_hash(kChannelCount, kFrameCount, kMaxWindows);
+  swapped_hash.Update(swapped_ch_bus.get(), swapped_ch_bus->frames());
+
+  EXPECT_NE(original_hash.ToString(), swapped_hash.ToString());
+}
+
+// Ensure the order of samples within a window matters to the windowed hash.
+TEST_F(AudioHashTest, WindowedHashSampleOrder) {
+  WindowedAudioHash original_hash(kChannelCount, kFrameCount, kMaxWindows);
+  original_hash.Update(bus_one_.get(), bus_one_->frames());
+
+  // Swap two blocks of a multiple of WindowedAudioHash::kBuckets frames, which
+  // doesn't change which bucket any sample is summed into.
+  const int kBlockFrames = 64;
+  float* channel = bus_one_->channel(0);
+  std::swap_ranges(channel, channel + kBlockFrames, channel + 4 * kBlockFrames);
+
+  WindowedAudioHash swapped_hash(kChannelCount, kFrameCount, kMaxWindows);
+  swapped_hash.Update(bus_one_.get(), bus_one_->frames());
+
+  EXPECT_EQ(0, original_hash.FindFirstMismatch(swapped_hash.ToString(), 0.01));
+}
+
+// Ensure zero-mean audio doesn't hash like silence, even when every bucket sums
+// to zero.
+TEST_F(AudioHashTest, WindowedHashZeroMean) {
+  WindowedAudioHash silence_hash(kChannelCount, kFrameCount, kMaxWindows);
+  bus_two_->Zero();
+  silence_hash.Update(bus_two_.get(), bus_two_->frames());
+
+  // A sine with a period of two rows of buckets, so each bucket alternately
+  // gets a sample and its negation.
+  const int kPeriod = 2 * WindowedAudioHash::kBuckets;
+  for (int ch = 0; ch < bus_one_->channels(); ++ch) {
+    for (int i = 0; i < bus_one_->frames(); ++i) {
+      bus_one_->channel(ch)[i] =
+          0.5 * std::sin(2.0 * base::kPiDouble * i / kPeriod);
+    }
+  }
+  WindowedAudioHash sine_hash(kChannelCount, kFrameCount, kMaxWindows);
+  sine_hash.Update(bus_one_.get(), bus_one_->frames());
+
+  EXPECT_EQ(0, silence_hash.FindFirstMismatch(sine_hash.ToString(), 0.01));
+}
+
+// Ensure only the last |max_windows| window hashes are kept, and that they
+// match those of a hash which keeps every window.
+TEST_F(AudioHashTest, WindowedHashKeepsLastWindows) {
+  const int kWindowFrames = 100;
+  const int kKeptWindows = 2;
+  WindowedAudioHash full_hash(kChannelCount, kWindowFrames, kMaxWindows);
+  full_hash.Update(bus_one_.get(), bus_one_->frames());
+  WindowedAudioHash ring_hash(kChannelCount, kWindowFrames, kKeptWindows);
+  ring_hash.Update(bus_one_.get(), bus_one_->frames());
+
+  // The trailing partial window is kept in addition to |kKeptWindows|.
+  EXPECT_EQ(full_hash.window_count(), ring_hash.window_count());
+  EXPECT_EQ(0, full_hash.first_window());
+  EXPECT_EQ(ring_hash.window_count() - kKeptWindows - 1,
+            ring_hash.first_window());
+
+  std::string expected;
+  for (int i = ring_hash.first_window(); i < ring_hash.window_count(); ++i)
+    expected += full_hash.WindowToString(i) + ";";
+  EXPECT_EQ(expected, ring_hash.ToString());
+  EXPECT_EQ(-1, ring_hash.FindFirstMismatch(expected, 0.01));
+}
+
 }  // namespace media
@@ -4,20 +4,42 @@
 
 #include "media/base/audio_renderer_mixer.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/field_trial_params.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
 #include "base/trace_event/trace_event.h"
 #include "media/base/audio_timestamp_helper.h"
+#include "media/base/media_switches.h"
+#include "media/base/vector_math.h"
 
 namespace media {
 
 enum { kPauseDelaySeconds = 10 };
 
+// Upper bound on the "threads" parameter of kParallelAudioMixing.
+constexpr int kMaxMixingThreads = 8;
+
+// Returns the number of pre-mixing threads kParallelAudioMixing asks for, or 0
+// to mix serially.
+static int GetMixingThreadsFromFeature() {
+  if (!base::FeatureList::IsEnabled(kParallelAudioMixing))
+    return 0;
+  const int threads = base::GetFieldTrialParamByFeatureAsInt(
+      kParallelAudioMixing, "threads", 2);
+  return std::max(0, std::min(threads, kMaxMixingThreads));
+}
+
 // Tracks the maximum value of a counter and logs it into a UMA histogram upon
 // each increase of the maximum. NOT thread-safe, make sure it is used under
 // lock.
@@ -50,18 +72,171 @@ class AudioRendererMixer::UMAMaxValueTracker {
   DISALLOW_COPY_AND_ASSIGN(UMAMaxValueTracker);
 };
 
+// Pre-mixes a subset of the mixer inputs on its own thread.  Each mix is
+// started by Render() for the following callback and written to the back half
+// of a pair of buses, so Render() can read the front half without waiting.
+class AudioRendererMixer::MixingThread
+    : public base::DelegateSimpleThread::Delegate {
+ public:
+  MixingThread(const AudioParameters& output_params, int index)
+      : converter_(output_params, output_params, true),
+        input_count_(0),
+        mix_pending_(false),
+        mix_bus_index_(0),
+        frames_delayed_(0),
+        stopping_(false),
+        start_event_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                     base::WaitableEvent::InitialState::NOT_SIGNALED),
+        done_event_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                    base::WaitableEvent::InitialState::NOT_SIGNALED),
+        thread_(this,
+                "AudioMixingThread" + base::IntToString(index),
+                base::SimpleThread::Options(
+                    base::ThreadPriority::REALTIME_AUDIO)) {
+    for (auto& bus : buses_) {
+      bus = AudioBus::Create(output_params);
+      bus->Zero();
+    }
+    thread_.Start();
+  }
+
+  ~MixingThread() override {
+    WaitForMix();
+    stopping_ = true;
+    start_event_.Signal();
+    thread_.Join();
+  }
+
+  // Adds or removes an input; blocks while a mix is in progress.
+  void AddInput(AudioConverter::InputCallback* input) {
+    base::AutoLock auto_lock(converter_lock_);
+    converter_.AddInput(input);
+    ++input_count_;
+  }
+  void RemoveInput(AudioConverter::InputCallback* input) {
+    base::AutoLock auto_lock(converter_lock_);
+    converter_.RemoveInput(input);
+    --input_count_;
+  }
+
+  // Adds or removes an input of |converter|, which must be an input of this
+  // thread; blocks while a mix is in progress.
+  void AddConverterInput(LoopbackAudioConverter* converter,
+                         AudioConverter::InputCallback* input) {
+    base::AutoLock auto_lock(converter_lock_);
+    converter->AddInput(input);
+  }
+  void RemoveConverterInput(LoopbackAudioConverter* converter,
+                            AudioConverter::InputCallback* input) {
+    base::AutoLock auto_lock(converter_lock_);
+    converter->RemoveInput(input);
+  }
+
+  int input_count() const { return input_count_; }
+
+  base::PlatformThreadId thread_id() { return thread_.tid(); }
+
+  // Returns true if no mix is outstanding, i.e. WaitForMix() won't block.
+  bool IsMixDone() {
+    if (mix_pending_ && done_event_.IsSignaled())
+      mix_pending_ = false;
+    return !mix_pending_;
+  }
+
+  // Waits for the outstanding mix, if any, to finish.
+  void WaitForMix() {
+    if (!mix_pending_)
+      return;
+    done_event_.Wait();
+    mix_pending_ = false;
+  }
+
+  // Flips the buses so the last completed mix becomes mixed_bus() and starts
+  // mixing the next buffer into the other bus.  WaitForMix() must have been
+  // called since the previous StartMix().
+  void StartMix(uint32_t frames_delayed) {
+    DCHECK(!mix_pending_);
+    mix_pending_ = true;
+    mix_bus_index_ ^= 1;
+    frames_delayed_ = frames_delayed;
+    start_event_.Signal();
+  }
+
+  // The most recent completed mix; valid until the next StartMix().
+  const AudioBus* mixed_bus() const { return buses_[mix_bus_index_ ^ 1].get(); }
+
+ private:
+  // base::DelegateSimpleThread::Delegate implementation.
+  void Run() override {
+    while (true) {
+      start_event_.Wait();
+      if (stopping_)
+        return;
+
+      {
+        TRACE_EVENT0("audio", "AudioRendererMixer::MixingThread::Run");
+        base::AutoLock auto_lock(converter_lock_);
+        converter_.ConvertWithDelay(frames_delayed_,
+                                    buses_[mix_bus_index_].get());
+      }
+      done_event_.Signal();
+    }
+  }
+
+  base::Lock converter_lock_;
+  AudioConverter converter_ GUARDED_BY(converter_lock_);
+
+  // Only modified under the mixer's |lock_|; used to balance the threads.
+  int input_count_;
+
+  // Whether a mix was started and not yet waited for.  Only used under the
+  // mixer's |lock_|.
+  bool mix_pending_;
+
+  // |buses_[mix_bus_index_]| is written by the mixing thread, the other one is
+  // read by Render().  |mix_bus_index_|, |frames_delayed_| and |stopping_| are
+  // only written while no mix is outstanding; the events order the accesses.
+  std::unique_ptr<AudioBus> buses_[2];
+  int mix_bus_index_;
+  uint32_t frames_delayed_;
+  bool stopping_;
+
+  base::WaitableEvent start_event_;
+  base::WaitableEvent done_event_;
+  base::DelegateSimpleThread thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(MixingThread);
+};
+
 AudioRendererMixer::AudioRendererMixer(const AudioParameters& output_params,
                                        scoped_refptr<AudioRendererSink> sink,
                                        const UmaLogCallback& log_callback)
+    : AudioRendererMixer(output_params,
+                         std::move(sink),
+                         log_callback,
+                         GetMixingThreadsFromFeature()) {}
+
+AudioRendererMixer::AudioRendererMixer(const AudioParameters& output_params,
+                                       scoped_refptr<AudioRendererSink> sink,
+                                       const UmaLogCallback& log_callback,
+                                       int mixing_threads)
     : output_params_(output_params),
       audio_sink_(std::move(sink)),
       master_converter_(output_params, output_params, true),
+      parallel_render_count_(0),
+      deadline_miss_count_(0),
       pause_delay_(base::TimeDelta::FromSeconds(kPauseDelaySeconds)),
       last_play_time_(base::TimeTicks::Now()),
       // Initialize |playing_| to true since Start() results in an auto-play.
       playing_(true),
       input_count_tracker_(new UMAMaxValueTracker(log_callback)) {
   DCHECK(audio_sink_);
+  DCHECK_GE(mixing_threads, 0);
+  for (int i = 0; i < mixing_threads; ++i) {
+    mixing_threads_.push_back(
+        std::make_unique<MixingThread>(output_params_, i));
+  }
+
   audio_sink_->Initialize(output_params, this);
   audio_sink_->Start();
 }
@@ -72,8 +247,16 @@ AudioRendererMixer::~AudioRendererMixer() {
 
   // Ensure that all mixer inputs have removed themselves prior to destruction.
   DCHECK(master_converter_.empty());
+  DCHECK(input_threads_.empty());
   DCHECK(converters_.empty());
   DCHECK_EQ(error_callbacks_.size(), 0U);
+
+  if (parallel_render_count_ > 0) {
+    UMA_HISTOGRAM_PERCENTAGE(
+        "Media.Audio.Render.AudioRendererMixer.DeadlineMissPercentage",
+        static_cast<int>(100 * static_cast<int64_t>(deadline_miss_count_) /
+                         parallel_render_count_));
+  }
 }
 
 void AudioRendererMixer::AddMixerInput(const AudioParameters& input_params,
@@ -87,7 +270,7 @@ void AudioRendererMixer::AddMixerInput(const AudioParameters& input_params,
 
   int input_sample_rate = input_params.sample_rate();
   if (is_master_sample_rate(input_sample_rate)) {
-    master_converter_.AddInput(input);
+    AddMasterInput(input);
   } else {
     auto converter = converters_.find(input_sample_rate);
     if (converter == converters_.end()) {
@@ -102,9 +285,9 @@ void AudioRendererMixer::AddMixerInput(const AudioParameters& input_params,
       converter = result.first;
 
       // Add newly-created resampler as an input to the master mixer.
-      master_converter_.AddInput(converter->second.get());
+      AddMasterInput(converter->second.get());
     }
-    converter->second->AddInput(input);
+    AddConverterInput(converter->second.get(), input);
   }
 
   input_count_tracker_->Increment();
@@ -117,14 +300,14 @@ void AudioRendererMixer::RemoveMixerInput(
 
   int input_sample_rate = input_params.sample_rate();
   if (is_master_sample_rate(input_sample_rate)) {
-    master_converter_.RemoveInput(input);
+    RemoveMasterInput(input);
   } else {
     auto converter = converters_.find(input_sample_rate);
     DCHECK(converter != converters_.end());
-    converter->second->RemoveInput(input);
+    RemoveConverterInput(converter->second.get(), input);
     if (converter->second->empty()) {
       // Remove converter when it's empty.
-      master_converter_.RemoveInput(converter->second.get());
+      RemoveMasterInput(converter->second.get());
       converters_.erase(converter);
     }
   }
@@ -160,8 +343,29 @@ OutputDeviceInfo AudioRendererMixer::GetOutputDeviceInfo() {
   return audio_sink_->GetOutputDeviceInfo();
 }
 
+int AudioRendererMixer::GetDeadlineMissesForTesting() {
+  base::AutoLock auto_lock(lock_);
+  return deadline_miss_count_;
+}
+
+void AudioRendererMixer::SetDeadlineMissCallbackForTesting(
+    const base::Closure& deadline_miss_cb) {
+  base::AutoLock auto_lock(lock_);
+  deadline_miss_cb_for_testing_ = deadline_miss_cb;
+}
+
 bool AudioRendererMixer::CurrentThreadIsRenderingThread() {
-  return audio_sink_->CurrentThreadIsRenderingThread();
+  if (audio_sink_->CurrentThreadIsRenderingThread())
+    return true;
+
+  // Inputs are rendered on the mixing threads when there are any.  Not taking
+  // |lock_| here, since Render() may hold it while waiting for those threads.
+  const base::PlatformThreadId thread_id = base::PlatformThread::CurrentId();
+  for (const auto& thread : mixing_threads_) {
+    if (thread->thread_id() == thread_id)
+      return true;
+  }
+  return false;
 }
 
 int AudioRendererMixer::Render(base::TimeDelta delay,
@@ -175,7 +379,7 @@ int AudioRendererMixer::Render(base::TimeDelta delay,
   // sink to avoid wasting resources when media elements are present but remain
   // in the pause state.
   const base::TimeTicks now = base::TimeTicks::Now();
-  if (!master_converter_.empty()) {
+  if (!master_converter_.empty() || !input_threads_.empty()) {
     last_play_time_ = now;
   } else if (now - last_play_time_ >= pause_delay_ && playing_) {
     audio_sink_->Pause();
@@ -184,10 +388,109 @@ int AudioRendererMixer::Render(base::TimeDelta delay,
 
   uint32_t frames_delayed =
       AudioTimestampHelper::TimeToFrames(delay, output_params_.sample_rate());
-  master_converter_.ConvertWithDelay(frames_delayed, audio_bus);
+  if (mixing_threads_.empty())
+    master_converter_.ConvertWithDelay(frames_delayed, audio_bus);
+  else
+    RenderParallel(frames_delayed, audio_bus);
   return audio_bus->frames();
 }
 
+void AudioRendererMixer::AddMasterInput(AudioConverter::InputCallback* input) {
+  if (mixing_threads_.empty()) {
+    master_converter_.AddInput(input);
+    return;
+  }
+
+  MixingThread* thread = mixing_threads_.front().get();
+  for (const auto& candidate : mixing_threads_) {
+    if (candidate->input_count() < thread->input_count())
+      thread = candidate.get();
+  }
+  thread->AddInput(input);
+  input_threads_[input] = thread;
+}
+
+void AudioRendererMixer::AddConverterInput(
+    LoopbackAudioConverter* converter,
+    AudioConverter::InputCallback* input) {
+  if (mixing_threads_.empty()) {
+    converter->AddInput(input);
+    return;
+  }
+
+  // |converter| is mixed on the thread it was assigned to, so its inputs may
+  // only change while that thread isn't mixing.
+  auto it = input_threads_.find(converter);
+  DCHECK(it != input_threads_.end());
+  it->second->AddConverterInput(converter, input);
+}
+
+void AudioRendererMixer::RemoveConverterInput(
+    LoopbackAudioConverter* converter,
+    AudioConverter::InputCallback* input) {
+  if (mixing_threads_.empty()) {
+    converter->RemoveInput(input);
+    return;
+  }
+
+  auto it = input_threads_.find(converter);
+  DCHECK(it != input_threads_.end());
+  it->second->RemoveConverterInput(converter, input);
+}
+
+void AudioRendererMixer::RemoveMasterInput(
+    AudioConverter::InputCallback* input) {
+  if (mixing_threads_.empty()) {
+    master_converter_.RemoveInput(input);
+    return;
+  }
+
+  auto it = input_threads_.find(input);
+  DCHECK(it != input_threads_.end());
+  it->second->RemoveInput(input);
+  input_threads_.erase(it);
+}
+
+void AudioRendererMixer::RenderParallel(uint32_t frames_delayed,
+                                        AudioBus* audio_bus) {
+  DCHECK_EQ(audio_bus->frames(), output_params_.frames_per_buffer());
+  ++parallel_render_count_;
+
+  // Collect the mixes started by the previous Render(); if a thread is still
+  // busy there's nothing better to do than wait for it, since its inputs can't
+  // be pulled from here while it runs.
+  bool missed_deadline = false;
+  for (const auto& thread : mixing_threads_) {
+    if (!thread->IsMixDone())
+      missed_deadline = true;
+  }
+  if (missed_deadline) {
+    ++deadline_miss_count_;
+    TRACE_EVENT_INSTANT0("audio", "AudioRendererMixer::DeadlineMiss",
+                         TRACE_EVENT_SCOPE_THREAD);
+    if (deadline_miss_cb_for_testing_)
+      deadline_miss_cb_for_testing_.Run();
+  }
+  for (const auto& thread : mixing_threads_)
+    thread->WaitForMix();
+
+  // The next mix is played one buffer after this one.
+  const uint32_t next_frames_delayed =
+      frames_delayed + output_params_.frames_per_buffer();
+  for (const auto& thread : mixing_threads_)
+    thread->StartMix(next_frames_delayed);
+
+  const int frames = audio_bus->frames();
+  mixing_threads_.front()->mixed_bus()->CopyTo(audio_bus);
+  for (size_t i = 1; i < mixing_threads_.size(); ++i) {
+    const AudioBus* mixed_bus = mixing_threads_[i]->mixed_bus();
+    for (int ch = 0; ch < audio_bus->channels(); ++ch) {
+      vector_math::FMAC(mixed_bus->channel(ch), 1.0f, frames,
+                        audio_bus->channel(ch));
+    }
+  }
+}
+
 void AudioRendererMixer::OnRenderError() {
   // Call each mixer input and signal an error.
   base::AutoLock auto_lock(lock_);
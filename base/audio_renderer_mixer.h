@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/macros.h"
 #include "base/synchronization/lock.h"
@@ -24,14 +25,28 @@ namespace media {
 // Mixes a set of AudioConverter::InputCallbacks into a single output stream
 // which is funneled into a single shared AudioRendererSink; saving a bundle
 // on renderer side resources.
+//
+// By default every input is mixed serially on the sink's rendering thread.
+// When constructed with |mixing_threads| > 0, or without it while
+// kParallelAudioMixing is enabled, the inputs are instead partitioned
+// across that many worker threads, each of which pre-mixes its share of inputs
+// one buffer ahead of the sink into a double-buffered partial bus; Render()
+// then only has to sum the partial buses.  This trades one buffer of extra
+// output latency for a much shorter realtime callback when many inputs share
+// one sink.  Input callbacks are then run on the worker threads.
 class MEDIA_EXPORT AudioRendererMixer
     : public AudioRendererSink::RenderCallback {
  public:
   typedef base::Callback<void(int)> UmaLogCallback;
 
+  // Mixes on the number of threads kParallelAudioMixing asks for, if enabled.
   AudioRendererMixer(const AudioParameters& output_params,
                      scoped_refptr<AudioRendererSink> sink,
                      const UmaLogCallback& log_callback);
+  AudioRendererMixer(const AudioParameters& output_params,
+                     scoped_refptr<AudioRendererSink> sink,
+                     const UmaLogCallback& log_callback,
+                     int mixing_threads);
   ~AudioRendererMixer() override;
 
   // Add or remove a mixer input from mixing; called by AudioRendererMixerInput.
@@ -50,12 +65,23 @@ class MEDIA_EXPORT AudioRendererMixer
 
   OutputDeviceInfo GetOutputDeviceInfo();
 
-  // Returns true if called on rendering thread, otherwise false.
+  // Returns true if called on rendering thread, or on one of the mixing threads
+  // which render the inputs, otherwise false.
   bool CurrentThreadIsRenderingThread();
 
   const AudioParameters& GetOutputParamsForTesting() { return output_params_; };
 
+  // Number of Render() calls which had to block because a mixing thread had
+  // not finished its partial mix in time.  Always zero without mixing threads.
+  int GetDeadlineMissesForTesting();
+
+  // Runs |deadline_miss_cb| on the rendering thread whenever Render() finds a
+  // mixing thread which has not finished its partial mix, before waiting for
+  // it.  |deadline_miss_cb| must not call into the mixer.
+  void SetDeadlineMissCallbackForTesting(const base::Closure& deadline_miss_cb);
+
  private:
+  class MixingThread;
   class UMAMaxValueTracker;
 
   // Maps input sample rate to the dedicated converter.
@@ -69,6 +95,22 @@ class MEDIA_EXPORT AudioRendererMixer
              AudioBus* audio_bus) override;
   void OnRenderError() override;
 
+  // Adds or removes an input of |master_converter_|, or of the least loaded
+  // |mixing_threads_| entry when mixing in parallel.  |lock_| must be held.
+  void AddMasterInput(AudioConverter::InputCallback* input);
+  void RemoveMasterInput(AudioConverter::InputCallback* input);
+
+  // Adds or removes an input of |converter|, an entry of |converters_|, while
+  // nothing is mixing it.  |lock_| must be held.
+  void AddConverterInput(LoopbackAudioConverter* converter,
+                         AudioConverter::InputCallback* input);
+  void RemoveConverterInput(LoopbackAudioConverter* converter,
+                            AudioConverter::InputCallback* input);
+
+  // Collects the partial mixes of |mixing_threads_| into |audio_bus| and kicks
+  // off the mix for the next callback.  |lock_| must be held.
+  void RenderParallel(uint32_t frames_delayed, AudioBus* audio_bus);
+
   bool is_master_sample_rate(int sample_rate) {
     return sample_rate == output_params_.sample_rate();
   }
@@ -79,6 +121,12 @@ class MEDIA_EXPORT AudioRendererMixer
   // Output sink for this mixer.
   const scoped_refptr<AudioRendererSink> audio_sink_;
 
+  // Worker threads used to pre-mix inputs when mixing in parallel, empty
+  // otherwise.  Not modified after construction, so that
+  // CurrentThreadIsRenderingThread() can check it without |lock_|; the
+  // threads' mixing state is protected by |lock_| nonetheless.
+  std::vector<std::unique_ptr<MixingThread>> mixing_threads_;
+
   // ---------------[ All variables below protected by |lock_| ]---------------
   base::Lock lock_;
 
@@ -95,6 +143,17 @@ class MEDIA_EXPORT AudioRendererMixer
   // mixer inputs that are in the output sample rate.
   AudioConverter master_converter_ GUARDED_BY(lock_);
 
+  // The entry of |mixing_threads_| each input of the master mix was assigned
+  // to when mixing in parallel.
+  std::map<AudioConverter::InputCallback*, MixingThread*> input_threads_
+      GUARDED_BY(lock_);
+
+  // Render() calls so far, and how many of those had to wait for a mixing
+  // thread.  Logged to UMA upon destruction.
+  int parallel_render_count_ GUARDED_BY(lock_);
+  int deadline_miss_count_ GUARDED_BY(lock_);
+  base::Closure deadline_miss_cb_for_testing_ GUARDED_BY(lock_);
+
   // Handles physical stream pause when no inputs are playing.  For latency
   // reasons we don't want to immediately pause the physical stream.
   base::TimeDelta pause_delay_ GUARDED_BY(lock_);
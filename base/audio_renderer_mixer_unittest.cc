@@ -16,10 +16,13 @@
 #include "base/bind_helpers.h"
 #include "base/macros.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/threading/platform_thread.h"
 #include "media/base/audio_renderer_mixer_input.h"
+#include "media/base/audio_timestamp_helper.h"
 #include "media/base/audio_renderer_mixer_pool.h"
 #include "media/base/fake_audio_render_callback.h"
+#include "media/base/media_switches.h"
 #include "media/base/mock_audio_renderer_sink.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -516,6 +519,179 @@ TEST_P(AudioRendererMixerBehavioralTest, MixerPausesStream) {
   mixer_inputs_[0]->Stop();
 }
 
+// Input which blocks on the mixing thread until released, and records whether
+// the mixer considers that thread a rendering thread.
+class BlockingInputCallback : public AudioConverter::InputCallback {
+ public:
+  explicit BlockingInputCallback(AudioRendererMixer* mixer)
+      : mixer_(mixer),
+        release_(base::WaitableEvent::ResetPolicy::MANUAL,
+                 base::WaitableEvent::InitialState::NOT_SIGNALED),
+        on_rendering_thread_(false) {}
+  ~BlockingInputCallback() override = default;
+
+  void Release() { release_.Signal(); }
+
+  // Only safe to call once the input has been removed from |mixer_|.
+  bool on_rendering_thread() const { return on_rendering_thread_; }
+
+  double ProvideInput(AudioBus* audio_bus, uint32_t frames_delayed) override {
+    on_rendering_thread_ = mixer_->CurrentThreadIsRenderingThread();
+    release_.Wait();
+    audio_bus->Zero();
+    return 1.0;
+  }
+
+ private:
+  AudioRendererMixer* const mixer_;
+  base::WaitableEvent release_;
+  bool on_rendering_thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockingInputCallback);
+};
+
+// Verify that mixing on several threads produces the same output as mixing on
+// the rendering thread, one buffer later.
+TEST(AudioRendererMixerParallelTest, MatchesSerialMix) {
+  const int kMixingThreads = 3;
+  const AudioParameters output_params(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                                      kChannelLayout, kTestInputHigher,
+                                      kLowLatencyBufferSize);
+
+  scoped_refptr<MockAudioRendererSink> serial_sink =
+      new MockAudioRendererSink();
+  scoped_refptr<MockAudioRendererSink> parallel_sink =
+      new MockAudioRendererSink();
+  EXPECT_CALL(*serial_sink.get(), Start());
+  EXPECT_CALL(*serial_sink.get(), Stop());
+  EXPECT_CALL(*parallel_sink.get(), Start());
+  EXPECT_CALL(*parallel_sink.get(), Stop());
+  AudioRendererMixer serial_mixer(output_params, serial_sink,
+                                  base::Bind(&LogUma));
+  AudioRendererMixer parallel_mixer(output_params, parallel_sink,
+                                    base::Bind(&LogUma), kMixingThreads);
+
+  // Use a few inputs at a different sample rate to exercise resampling too.
+  std::vector<AudioParameters> input_params;
+  std::vector<std::unique_ptr<FakeAudioRenderCallback>> serial_inputs;
+  std::vector<std::unique_ptr<FakeAudioRenderCallback>> parallel_inputs;
+  for (int i = 0; i < kMixerInputs; ++i) {
+    const int sample_rate = i % 4 ? kTestInputHigher : kTestInputLower;
+    input_params.push_back(AudioParameters(
+        AudioParameters::AUDIO_PCM_LINEAR, kChannelLayout, sample_rate,
+        kHighLatencyBufferSize));
+    const double step = (i + 1) / static_cast<double>(kLowLatencyBufferSize);
+    serial_inputs.push_back(
+        std::make_unique<FakeAudioRenderCallback>(step, sample_rate));
+    parallel_inputs.push_back(
+        std::make_unique<FakeAudioRenderCallback>(step, sample_rate));
+    serial_inputs[i]->set_volume(1.0 / kMixerInputs);
+    parallel_inputs[i]->set_volume(1.0 / kMixerInputs);
+    serial_mixer.AddMixerInput(input_params[i], serial_inputs[i].get());
+    parallel_mixer.AddMixerInput(input_params[i], parallel_inputs[i].get());
+  }
+
+  std::unique_ptr<AudioBus> expected_bus = AudioBus::Create(output_params);
+  std::unique_ptr<AudioBus> actual_bus = AudioBus::Create(output_params);
+
+  // The first buffer is silence while the mixing threads catch up.
+  parallel_sink->callback()->Render(base::TimeDelta(), base::TimeTicks::Now(),
+                                    0, actual_bus.get());
+  EXPECT_TRUE(actual_bus->AreFramesZero());
+
+  for (int cycle = 0; cycle < kMixerCycles; ++cycle) {
+    serial_sink->callback()->Render(base::TimeDelta(), base::TimeTicks::Now(),
+                                    0, expected_bus.get());
+    parallel_sink->callback()->Render(base::TimeDelta(),
+                                      base::TimeTicks::Now(), 0,
+                                      actual_bus.get());
+    for (int ch = 0; ch < actual_bus->channels(); ++ch) {
+      for (int i = 0; i < actual_bus->frames(); ++i) {
+        ASSERT_NEAR(expected_bus->channel(ch)[i], actual_bus->channel(ch)[i],
+                    0.00001)
+            << " cycle=" << cycle << ", ch=" << ch << ", i=" << i;
+      }
+    }
+  }
+
+  for (int i = 0; i < kMixerInputs; ++i) {
+    serial_mixer.RemoveMixerInput(input_params[i], serial_inputs[i].get());
+    parallel_mixer.RemoveMixerInput(input_params[i], parallel_inputs[i].get());
+  }
+
+  // Inputs are asked for data one buffer ahead of the sink.  Only safe to check
+  // once removed, since the mixing threads may still be running otherwise.
+  EXPECT_EQ(AudioTimestampHelper::FramesToTime(kLowLatencyBufferSize,
+                                               kTestInputHigher),
+            parallel_inputs[1]->last_delay());
+}
+
+// Verify that kParallelAudioMixing makes mixers mix in parallel by default,
+// which delays their output by one buffer.
+TEST(AudioRendererMixerParallelTest, EnabledByFeature) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kParallelAudioMixing);
+
+  const AudioParameters output_params(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                                      kChannelLayout, kTestInputHigher,
+                                      kLowLatencyBufferSize);
+  scoped_refptr<MockAudioRendererSink> sink = new MockAudioRendererSink();
+  EXPECT_CALL(*sink.get(), Start());
+  EXPECT_CALL(*sink.get(), Stop());
+  AudioRendererMixer mixer(output_params, sink, base::Bind(&LogUma));
+
+  FakeAudioRenderCallback input(1.0 / kLowLatencyBufferSize, kTestInputHigher);
+  mixer.AddMixerInput(output_params, &input);
+  std::unique_ptr<AudioBus> audio_bus = AudioBus::Create(output_params);
+
+  sink->callback()->Render(base::TimeDelta(), base::TimeTicks::Now(), 0,
+                           audio_bus.get());
+  EXPECT_TRUE(audio_bus->AreFramesZero());
+  sink->callback()->Render(base::TimeDelta(), base::TimeTicks::Now(), 0,
+                           audio_bus.get());
+  EXPECT_FALSE(audio_bus->AreFramesZero());
+
+  mixer.RemoveMixerInput(output_params, &input);
+}
+
+// Verify a mixing thread which can't keep up is counted as a deadline miss.
+TEST(AudioRendererMixerParallelTest, DeadlineMiss) {
+  const AudioParameters output_params(AudioParameters::AUDIO_PCM_LOW_LATENCY,
+                                      kChannelLayout, kTestInputHigher,
+                                      kLowLatencyBufferSize);
+  scoped_refptr<MockAudioRendererSink> sink = new MockAudioRendererSink();
+  EXPECT_CALL(*sink.get(), Start());
+  EXPECT_CALL(*sink.get(), Stop());
+  EXPECT_CALL(*sink.get(), CurrentThreadIsRenderingThread())
+      .WillRepeatedly(testing::Return(false));
+  AudioRendererMixer mixer(output_params, sink, base::Bind(&LogUma), 2);
+  EXPECT_EQ(0, mixer.GetDeadlineMissesForTesting());
+
+  BlockingInputCallback input(&mixer);
+  mixer.AddMixerInput(output_params, &input);
+  std::unique_ptr<AudioBus> audio_bus = AudioBus::Create(output_params);
+
+  // Only release the input once Render() has seen the unfinished mix.
+  mixer.SetDeadlineMissCallbackForTesting(base::Bind(
+      &BlockingInputCallback::Release, base::Unretained(&input)));
+
+  // The first Render() never waits since no mix has been started yet.
+  sink->callback()->Render(base::TimeDelta(), base::TimeTicks::Now(), 0,
+                           audio_bus.get());
+  EXPECT_EQ(0, mixer.GetDeadlineMissesForTesting());
+
+  // The mix started above is blocked until the deadline miss is reported.
+  sink->callback()->Render(base::TimeDelta(), base::TimeTicks::Now(), 0,
+                           audio_bus.get());
+  EXPECT_EQ(1, mixer.GetDeadlineMissesForTesting());
+
+  mixer.RemoveMixerInput(output_params, &input);
+
+  // Inputs are rendered on the mixing threads, which the mixer must report as
+  // rendering threads.
+  EXPECT_TRUE(input.on_rendering_thread());
+}
+
 INSTANTIATE_TEST_CASE_P(
     /* no prefix */,
     AudioRendererMixerTest,
@@ -8,12 +8,10 @@
 
 #include "base/sys_byteorder.h"
 
-namespace {
-const int kRegWidthInBits = sizeof(uint64_t) * 8;
-}
-
 namespace media {
 
+constexpr int BitReaderCore::kRegWidthInBits;
+
 BitReaderCore::ByteStreamProvider::ByteStreamProvider() = default;
 
 BitReaderCore::ByteStreamProvider::~ByteStreamProvider() = default;
@@ -29,17 +27,6 @@ BitReaderCore::BitReaderCore(ByteStreamProvider* byte_stream_provider)
 
 BitReaderCore::~BitReaderCore() = default;
 
-bool BitReaderCore::ReadFlag(bool* flag) {
-  if (nbits_ == 0 && !Refill(1))
-    return false;
-
-  *flag = (reg_ & (UINT64_C(1) << (kRegWidthInBits - 1))) != 0;
-  reg_ <<= 1;
-  nbits_--;
-  bits_read_++;
-  return true;
-}
-
 int BitReaderCore::PeekBitsMsbAligned(int num_bits, uint64_t* out) {
   // Try to have at least |num_bits| in the bit register.
   if (nbits_ < num_bits)
@@ -56,6 +56,14 @@ class MEDIA_EXPORT BitReaderCore {
   // integer type.
   template<typename T> bool ReadBits(int num_bits, T* out) {
     DCHECK_LE(num_bits, static_cast<int>(sizeof(T) * 8));
+    // Fast path for bits already in the current register.
+    if (num_bits > 0 && num_bits < kRegWidthInBits && num_bits <= nbits_) {
+      *out = static_cast<T>(reg_ >> (kRegWidthInBits - num_bits));
+      reg_ <<= num_bits;
+      nbits_ -= num_bits;
+      bits_read_ += num_bits;
+      return true;
+    }
     uint64_t temp;
     bool ret = ReadBitsInternal(num_bits, &temp);
     *out = static_cast<T>(temp);
@@ -63,7 +71,16 @@ class MEDIA_EXPORT BitReaderCore {
   }
 
   // Read one bit from the stream and return it as a boolean in |*flag|.
-  bool ReadFlag(bool* flag);
+  bool ReadFlag(bool* flag) {
+    if (nbits_ == 0 && !Refill(1))
+      return false;
+
+    *flag = (reg_ >> (kRegWidthInBits - 1)) != 0;
+    reg_ <<= 1;
+    nbits_--;
+    bits_read_++;
+    return true;
+  }
 
   // Retrieve some bits without actually consuming them.
   // Bits returned in |*out| are shifted so the most significant bit contains
@@ -87,6 +104,8 @@ class MEDIA_EXPORT BitReaderCore {
   int bits_read() const;
 
  private:
+  static constexpr int kRegWidthInBits = sizeof(uint64_t) * 8;
+
   // This function can skip any number of bits but is more efficient
   // for small numbers. Return false if the given number of bits cannot be
   // skipped (not enough bits in the stream), true otherwise.
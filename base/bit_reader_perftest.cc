@@ -0,0 +1,79 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "media/base/bit_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 20;
+
+static const size_t kBufferSize = 4 * 1024 * 1024;
+
+class BitReaderPerfTest : public testing::Test {
+ public:
+  BitReaderPerfTest() : buffer_(kBufferSize) {
+    uint32_t state = 1;
+    for (uint8_t& value : buffer_) {
+      state = state * 1103515245 + 12345;
+      value = state >> 24;
+    }
+  }
+
+  // Runs |read| on a fresh reader kBenchmarkIterations times and reports the
+  // time per buffer.
+  template <typename ReadFunction>
+  void RunBenchmark(const std::string& trace, ReadFunction read) {
+    uint64_t sum = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      BitReader reader(buffer_.data(), buffer_.size());
+      sum += read(&reader);
+    }
+    double total_time_milliseconds =
+        (base::TimeTicks::Now() - start).InMillisecondsF();
+    EXPECT_GT(sum, 0u);
+    perf_test::PrintResult("bit_reader", "", trace,
+                           total_time_milliseconds / kBenchmarkIterations,
+                           "ms", true);
+  }
+
+ protected:
+  std::vector<uint8_t> buffer_;
+};
+
+// Field widths typical of VP9 and AAC headers.
+TEST_F(BitReaderPerfTest, ReadBitsMixedWidths) {
+  RunBenchmark("read_bits_mixed_widths", [](BitReader* reader) {
+    static const int kWidths[] = {1, 2, 3, 4, 6, 8, 13, 16, 1, 1, 7, 32};
+    uint64_t sum = 0;
+    uint32_t value;
+    for (size_t i = 0;
+         reader->ReadBits(kWidths[i % arraysize(kWidths)], &value); ++i) {
+      sum += value;
+    }
+    return sum;
+  });
+}
+
+TEST_F(BitReaderPerfTest, ReadFlag) {
+  RunBenchmark("read_flag", [](BitReader* reader) {
+    uint64_t sum = 0;
+    bool flag;
+    while (reader->ReadFlag(&flag))
+      sum += flag;
+    return sum;
+  });
+}
+
+}  // namespace media
@@ -4,23 +4,39 @@
 
 #include "media/base/byte_queue.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "base/logging.h"
 
 namespace media {
 
-// Default starting size for the queue.
+// Default starting size for the queue, and minimum size of its blocks.
 enum { kDefaultQueueSize = 1024 };
 
-ByteQueue::ByteQueue()
-    : buffer_(new uint8_t[kDefaultQueueSize]),
-      size_(kDefaultQueueSize),
-      offset_(0),
-      used_(0) {}
+ByteQueue::Block::Block(scoped_refptr<SegmentBuffer> buffer,
+                        size_t begin,
+                        size_t end)
+    : buffer(std::move(buffer)), begin(begin), end(end) {}
+
+ByteQueue::Block::Block(Block&& other) = default;
+
+ByteQueue::Block& ByteQueue::Block::operator=(Block&& other) = default;
+
+ByteQueue::Block::~Block() = default;
+
+ByteQueue::ByteQueue() : overlap_(0), used_(0), bytes_copied_(0) {
+  blocks_.emplace_back(base::MakeRefCounted<SegmentBuffer>(kDefaultQueueSize),
+                       0, 0);
+}
 
 ByteQueue::~ByteQueue() = default;
 
 void ByteQueue::Reset() {
-  offset_ = 0;
+  while (blocks_.size() > 1)
+    blocks_.pop_front();
+  blocks_.back().begin = blocks_.back().end;
+  overlap_ = 0;
   used_ = 0;
 }
 
@@ -28,58 +44,108 @@ void ByteQueue::Push(const uint8_t* data, int size) {
   DCHECK(data);
   DCHECK_GT(size, 0);
 
-  size_t size_needed = used_ + size;
-
-  // Check to see if we need a bigger buffer.
-  if (size_needed > size_) {
-    size_t new_size = 2 * size_;
-    while (size_needed > new_size && new_size > size_)
-      new_size *= 2;
-
-    // Sanity check to make sure we didn't overflow.
-    CHECK_GT(new_size, size_);
-
-    std::unique_ptr<uint8_t[]> new_buffer(new uint8_t[new_size]);
-
-    // Copy the data from the old buffer to the start of the new one.
-    if (used_ > 0)
-      memcpy(new_buffer.get(), front(), used_);
-
-    buffer_ = std::move(new_buffer);
-    size_ = new_size;
-    offset_ = 0;
-  } else if ((offset_ + used_ + size) > size_) {
-    // The buffer is big enough, but we need to move the data in the queue.
-    memmove(buffer_.get(), front(), used_);
-    offset_ = 0;
+  Block& tail = blocks_.back();
+  if (tail.buffer->HasOneRef()) {
+    if (tail.size() == 0)
+      tail.begin = tail.end = 0;
+
+    // Append in place if nothing else refers to the last block.
+    if (tail.end + size <= tail.buffer->size()) {
+      tail.buffer->Write(tail.end, data, size);
+      tail.end += size;
+      used_ += size;
+      return;
+    }
   }
 
-  memcpy(front() + used_, data, size);
+  // Otherwise start a new block rather than move the data already queued.
+  scoped_refptr<SegmentBuffer> buffer = base::MakeRefCounted<SegmentBuffer>(
+      std::max<size_t>(size, kDefaultQueueSize));
+  buffer->Write(0, data, size);
+  if (tail.size() == 0)
+    blocks_.pop_back();
+  blocks_.emplace_back(std::move(buffer), 0, size);
   used_ += size;
 }
 
-void ByteQueue::Peek(const uint8_t** data, int* size) const {
+void ByteQueue::Peek(const uint8_t** data, int* size) {
   DCHECK(data);
   DCHECK(size);
-  *data = front();
+  Linearize(used_);
+  *data = blocks_.front().buffer->data() + blocks_.front().begin;
   *size = used_;
 }
 
+void ByteQueue::PeekAtLeast(int min_size, const uint8_t** data, int* size) {
+  DCHECK_GE(min_size, 0);
+  DCHECK(data);
+  DCHECK(size);
+  Linearize(std::min(min_size, used_));
+  *data = blocks_.front().buffer->data() + blocks_.front().begin;
+  *size = blocks_.front().size();
+}
+
 void ByteQueue::Pop(int count) {
   DCHECK_LE(count, used_);
 
-  offset_ += count;
   used_ -= count;
+  size_t bytes_to_pop = count;
+  while (bytes_to_pop > 0) {
+    Block& front = blocks_.front();
+    const size_t bytes_popped = std::min(front.size(), bytes_to_pop);
+    front.begin += bytes_popped;
+    bytes_to_pop -= bytes_popped;
+    if (overlap_ > 0 && front.size() <= overlap_) {
+      // The rest of the first block is in the second one too.
+      blocks_[1].begin += overlap_ - front.size();
+      front.begin = front.end;
+      overlap_ = 0;
+    }
+    if (front.size() == 0 && blocks_.size() > 1)
+      blocks_.pop_front();
+  }
+}
 
-  // Move the offset back to 0 if we have reached the end of the buffer.
-  if (offset_ == size_) {
-    DCHECK_EQ(used_, 0);
-    offset_ = 0;
+void ByteQueue::Linearize(size_t size) {
+  if (blocks_.front().size() >= size)
+    return;
+  RemoveOverlap();
+
+  // Callers which peek at the whole queue copy it every time a Push() starts
+  // a new block, so leave room for pushes to append in place for a while.
+  const size_t capacity =
+      size == static_cast<size_t>(used_)
+          ? std::max<size_t>(2 * size, kDefaultQueueSize)
+          : size;
+  scoped_refptr<SegmentBuffer> buffer =
+      base::MakeRefCounted<SegmentBuffer>(capacity);
+
+  // Blocks copied in full are dropped, but the last block copied from is only
+  // overlapped by the copy.
+  size_t bytes_copied = 0;
+  while (bytes_copied < size) {
+    Block& front = blocks_.front();
+    const size_t bytes_to_copy = std::min(front.size(), size - bytes_copied);
+    buffer->Write(bytes_copied, front.buffer->data() + front.begin,
+                  bytes_to_copy);
+    bytes_copied += bytes_to_copy;
+    if (bytes_to_copy == front.size())
+      blocks_.pop_front();
+    else
+      overlap_ = bytes_to_copy;
   }
+  bytes_copied_ += bytes_copied;
+
+  blocks_.emplace_front(std::move(buffer), 0, size);
 }
 
-uint8_t* ByteQueue::front() const {
-  return buffer_.get() + offset_;
+void ByteQueue::RemoveOverlap() {
+  if (overlap_ == 0)
+    return;
+
+  DCHECK_LT(overlap_, blocks_[1].size());
+  blocks_[1].begin += overlap_;
+  overlap_ = 0;
 }
 
 }  // namespace media
@@ -8,18 +8,27 @@
 #include <stddef.h>
 #include <stdint.h>
 
-#include <memory>
-
+#include "base/containers/circular_deque.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "media/base/media_export.h"
+#include "media/base/segment_buffer.h"
 
 namespace media {
 
 // Represents a queue of bytes.
 // Data is added to the end of the queue via an Push() call and removed via
 // Pop(). The contents of the queue can be observed via the Peek() method.
-// This class manages the underlying storage of the queue and tries to minimize
-// the number of buffer copies when data is appended and removed.
+//
+// The queue is a list of blocks, so Push() never moves data already queued.
+// Data is only copied when a peek spans several blocks, and then only as much
+// as the peek asks for; callers which can work on part of the queue should
+// use PeekAtLeast() rather than Peek().
+//
+// Blocks are SegmentBuffers, which callers may slice into, e.g. with
+// StreamParserBuffer::FromSegment(), to keep peeked data past the next Push()
+// or Pop() without copying it. A block is never changed once it is
+// referenced elsewhere.
 class MEDIA_EXPORT ByteQueue {
  public:
   ByteQueue();
@@ -34,26 +43,65 @@ class MEDIA_EXPORT ByteQueue {
   // Get a pointer to the front of the queue and the queue size.
   // These values are only valid until the next Push() or
   // Pop() call.
-  void Peek(const uint8_t** data, int* size) const;
+  void Peek(const uint8_t** data, int* size);
+
+  // Like Peek(), but may return as little as the first |min_size| bytes of the
+  // queue, or all of it if it is smaller.
+  void PeekAtLeast(int min_size, const uint8_t** data, int* size);
 
   // Remove |count| bytes from the front of the queue.
   void Pop(int count);
 
+  // Returns the number of bytes in the queue.
+  int size() const { return used_; }
+
+  // Returns the storage holding the data returned by the last peek, valid for
+  // as long as that data is.
+  const scoped_refptr<SegmentBuffer>& segment() const {
+    return blocks_.front().buffer;
+  }
+
+  // Returns the number of bytes copied so far to make peeked data contiguous,
+  // which doesn't include copying pushed data into the queue.
+  size_t bytes_copied() const { return bytes_copied_; }
+
  private:
-  // Returns a pointer to the front of the queue.
-  uint8_t* front() const;
+  // The part [begin, end) of |buffer| which is in the queue.
+  struct Block {
+    Block(scoped_refptr<SegmentBuffer> buffer, size_t begin, size_t end);
+    Block(Block&& other);
+    Block& operator=(Block&& other);
+    ~Block();
 
-  std::unique_ptr<uint8_t[]> buffer_;
+    size_t size() const { return end - begin; }
 
-  // Size of |buffer_|.
-  size_t size_;
+    scoped_refptr<SegmentBuffer> buffer;
+    size_t begin;
+    size_t end;
+  };
 
-  // Offset from the start of |buffer_| that marks the front of the queue.
-  size_t offset_;
+  // Makes the first |size| bytes of the queue contiguous. If those are all of
+  // the queue, leaves room for Push() to append in place.
+  void Linearize(size_t size);
+
+  // Removes the start of the second block which the first block holds a copy
+  // of from the second block.
+  void RemoveOverlap();
+
+  // Never empty. Only the last block can be empty, and only if the queue is.
+  base::circular_deque<Block> blocks_;
+
+  // Number of bytes at the end of the first block which are a copy of the
+  // start of the second one. Linearize() leaves the block it copied from last
+  // alone, so that parsing goes back to the pushed data once it is past the
+  // copied window rather than copying every following window too.
+  size_t overlap_;
 
   // Number of bytes stored in the queue.
   int used_;
 
+  size_t bytes_copied_;
+
   DISALLOW_COPY_AND_ASSIGN(ByteQueue);
 };
 
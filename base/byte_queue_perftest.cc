@@ -0,0 +1,115 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "media/base/byte_queue.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 10;
+
+// A high bitrate MSE session: 4 MB appends of frames between 1 KB and 256 KB.
+static const int kAppendSize = 4 * 1024 * 1024;
+static const int kNumAppends = 32;
+static const int kMinFrameSize = 1024;
+static const int kMaxFrameSize = 256 * 1024;
+
+class ByteQueuePerfTest : public testing::Test {
+ public:
+  ByteQueuePerfTest() : data_(kAppendSize * kNumAppends) {
+    // Frame sizes, each frame starting with its size like a container would.
+    uint32_t state = 1;
+    for (size_t offset = 0; offset + 4 <= data_.size();) {
+      state = state * 1103515245 + 12345;
+      uint32_t frame_size =
+          kMinFrameSize + (state >> 8) % (kMaxFrameSize - kMinFrameSize);
+      for (int i = 0; i < 4; ++i)
+        data_[offset + i] = frame_size >> (24 - 8 * i);
+      offset += frame_size;
+    }
+  }
+
+  // Appends all the data to a queue and parses it the way stream parsers do,
+  // popping whole frames as soon as they are available. Uses Peek() if
+  // |peek_all|, or PeekAtLeast() with a window widened as frames require.
+  // Reports the time per append and the bytes copied per byte appended.
+  void RunBenchmark(const std::string& trace, bool peek_all) {
+    size_t bytes_copied = 0;
+    size_t frames = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      ByteQueue queue;
+      for (int j = 0; j < kNumAppends; ++j) {
+        queue.Push(&data_[j * kAppendSize], kAppendSize);
+        frames += ParseFrames(&queue, peek_all);
+      }
+      bytes_copied += queue.bytes_copied();
+    }
+    double total_time_milliseconds =
+        (base::TimeTicks::Now() - start).InMillisecondsF();
+    EXPECT_GT(frames, 0u);
+    perf_test::PrintResult("byte_queue_append", "", trace,
+                           total_time_milliseconds /
+                               (kBenchmarkIterations * kNumAppends),
+                           "ms", true);
+    perf_test::PrintResult(
+        "byte_queue_copied", "", trace,
+        static_cast<double>(bytes_copied) /
+            (static_cast<double>(data_.size()) * kBenchmarkIterations),
+        "bytes_per_byte", true);
+  }
+
+ private:
+  static size_t ParseFrames(ByteQueue* queue, bool peek_all) {
+    size_t frames = 0;
+    int min_window_size = 0;
+    for (;;) {
+      const uint8_t* data;
+      int size;
+      if (peek_all)
+        queue->Peek(&data, &size);
+      else
+        queue->PeekAtLeast(min_window_size, &data, &size);
+
+      int bytes_parsed = 0;
+      while (size - bytes_parsed >= 4) {
+        const uint8_t* frame = data + bytes_parsed;
+        const int frame_size =
+            frame[0] << 24 | frame[1] << 16 | frame[2] << 8 | frame[3];
+        if (frame_size > size - bytes_parsed)
+          break;
+        bytes_parsed += frame_size;
+        ++frames;
+      }
+      queue->Pop(bytes_parsed);
+
+      if (size == queue->size() + bytes_parsed)
+        return frames;
+      min_window_size = 2 * (size - bytes_parsed);
+    }
+  }
+
+  std::vector<uint8_t> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(ByteQueuePerfTest);
+};
+
+TEST_F(ByteQueuePerfTest, Peek) {
+  RunBenchmark("peek", true);
+}
+
+TEST_F(ByteQueuePerfTest, PeekAtLeast) {
+  RunBenchmark("peek_at_least", false);
+}
+
+}  // namespace media
@@ -0,0 +1,161 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/byte_queue.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "media/base/stream_parser_buffer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+TEST(ByteQueueTest, PushPeekPop) {
+  ByteQueue queue;
+  std::vector<uint8_t> data(5000);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = i;
+
+  // Grow the queue past its initial size.
+  for (size_t i = 0; i < data.size(); i += 100)
+    queue.Push(&data[i], 100);
+
+  const uint8_t* peek_data;
+  int peek_size;
+  queue.Peek(&peek_data, &peek_size);
+  ASSERT_EQ(static_cast<int>(data.size()), peek_size);
+  EXPECT_EQ(0, memcmp(data.data(), peek_data, data.size()));
+
+  queue.Pop(4000);
+  queue.Peek(&peek_data, &peek_size);
+  ASSERT_EQ(1000, peek_size);
+  EXPECT_EQ(0, memcmp(&data[4000], peek_data, 1000));
+
+  queue.Reset();
+  queue.Peek(&peek_data, &peek_size);
+  EXPECT_EQ(0, peek_size);
+}
+
+TEST(ByteQueueTest, ReusesUnsharedSegment) {
+  ByteQueue queue;
+  const uint8_t kData[] = {1, 2, 3, 4};
+  queue.Push(kData, sizeof(kData));
+  const SegmentBuffer* segment = queue.segment().get();
+
+  queue.Pop(sizeof(kData));
+  queue.Push(kData, sizeof(kData));
+  EXPECT_EQ(segment, queue.segment().get());
+}
+
+TEST(ByteQueueTest, DoesNotModifySharedSegment) {
+  ByteQueue queue;
+  const uint8_t kFrame[] = {1, 2, 3, 4};
+  const uint8_t kPartialFrame[] = {5, 6};
+  queue.Push(kFrame, sizeof(kFrame));
+  queue.Push(kPartialFrame, sizeof(kPartialFrame));
+
+  const uint8_t* peek_data;
+  int peek_size;
+  queue.Peek(&peek_data, &peek_size);
+  scoped_refptr<StreamParserBuffer> buffer = StreamParserBuffer::FromSegment(
+      queue.segment(), peek_data, sizeof(kFrame), true, DemuxerStream::AUDIO,
+      0);
+  EXPECT_EQ(peek_data, buffer->data());
+  EXPECT_FALSE(buffer->is_padded());
+  queue.Pop(sizeof(kFrame));
+
+  // Pushing more data doesn't write to the segment holding the frame, even
+  // though it has room.
+  std::vector<uint8_t> data(1000, 7);
+  queue.Push(data.data(), data.size());
+  EXPECT_EQ(0, memcmp(kFrame, buffer->data(), sizeof(kFrame)));
+
+  queue.Peek(&peek_data, &peek_size);
+  ASSERT_EQ(static_cast<int>(sizeof(kPartialFrame) + data.size()), peek_size);
+  EXPECT_EQ(0, memcmp(kPartialFrame, peek_data, sizeof(kPartialFrame)));
+  EXPECT_FALSE(queue.segment()->Contains(buffer->data(), sizeof(kFrame)));
+}
+
+TEST(ByteQueueTest, PeekAtLeastCopiesOnlyTheWindow) {
+  ByteQueue queue;
+  std::vector<uint8_t> data(6000);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = i * 7;
+  for (size_t i = 0; i < data.size(); i += 2000)
+    queue.Push(&data[i], 2000);
+  ASSERT_EQ(6000, queue.size());
+
+  // The first pushed block holds enough data.
+  const uint8_t* peek_data;
+  int peek_size;
+  queue.PeekAtLeast(100, &peek_data, &peek_size);
+  EXPECT_EQ(2000, peek_size);
+  EXPECT_EQ(0u, queue.bytes_copied());
+
+  // Only the window spanning the first two blocks is copied.
+  queue.Pop(1990);
+  queue.PeekAtLeast(100, &peek_data, &peek_size);
+  ASSERT_EQ(100, peek_size);
+  EXPECT_EQ(0, memcmp(&data[1990], peek_data, 100));
+  EXPECT_EQ(100u, queue.bytes_copied());
+
+  queue.Pop(100);
+  queue.PeekAtLeast(100, &peek_data, &peek_size);
+  ASSERT_EQ(1910, peek_size);
+  EXPECT_EQ(0, memcmp(&data[2090], peek_data, 1910));
+  EXPECT_EQ(100u, queue.bytes_copied());
+
+  // Peek() makes all of the queue contiguous.
+  queue.Peek(&peek_data, &peek_size);
+  ASSERT_EQ(3910, peek_size);
+  EXPECT_EQ(0, memcmp(&data[2090], peek_data, 3910));
+  EXPECT_EQ(4010u, queue.bytes_copied());
+
+  // Which leaves room to push more without copying again. Only the data
+  // written to the segment counts, not that room.
+  EXPECT_EQ(3910u, queue.segment()->written_size());
+  EXPECT_GT(queue.segment()->size(), queue.segment()->written_size());
+  queue.Push(data.data(), 1000);
+  queue.Peek(&peek_data, &peek_size);
+  ASSERT_EQ(4910, peek_size);
+  EXPECT_EQ(0, memcmp(data.data(), peek_data + 3910, 1000));
+  EXPECT_EQ(4010u, queue.bytes_copied());
+  EXPECT_EQ(4910u, queue.segment()->written_size());
+}
+
+TEST(ByteQueueTest, PeekAtLeastReturnsToPushedDataAfterWindow) {
+  ByteQueue queue;
+  std::vector<uint8_t> data(4000);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = i * 7;
+  queue.Push(&data[0], 2000);
+  queue.Push(&data[2000], 2000);
+  queue.Pop(1990);
+
+  const uint8_t* peek_data;
+  int peek_size;
+  queue.PeekAtLeast(100, &peek_data, &peek_size);
+  ASSERT_EQ(100, peek_size);
+  EXPECT_EQ(100u, queue.bytes_copied());
+
+  // Widening a window which is still in the copy copies it again.
+  queue.Pop(5);
+  queue.PeekAtLeast(200, &peek_data, &peek_size);
+  ASSERT_EQ(200, peek_size);
+  EXPECT_EQ(0, memcmp(&data[1995], peek_data, 200));
+  EXPECT_EQ(300u, queue.bytes_copied());
+  EXPECT_EQ(2005, queue.size());
+
+  // Once past the copy, peeks use the pushed block again.
+  queue.Pop(150);
+  queue.PeekAtLeast(100, &peek_data, &peek_size);
+  ASSERT_EQ(1855, peek_size);
+  EXPECT_EQ(0, memcmp(&data[2145], peek_data, 1855));
+  EXPECT_EQ(300u, queue.bytes_copied());
+}
+
+}  // namespace media
@@ -5,6 +5,9 @@
 #include "media/base/channel_mixer.h"
 
 #include <stddef.h>
+#include <string.h>
+
+#include <algorithm>
 
 #include "base/logging.h"
 #include "media/base/audio_bus.h"
@@ -36,7 +39,21 @@ void ChannelMixer::Initialize(
   // Create the transformation matrix
   ChannelMixingMatrix matrix_builder(input_layout, input_channels,
                                      output_layout, output_channels);
-  remapping_ = matrix_builder.CreateTransformationMatrix(&matrix_);
+  matrix_builder.CreateTransformationMatrix(&matrix_);
+
+  // Compile the matrix down to just the taps which contribute to each output.
+  mix_taps_.resize(matrix_.size());
+  for (size_t output_ch = 0; output_ch < matrix_.size(); ++output_ch) {
+    for (size_t input_ch = 0; input_ch < matrix_[output_ch].size();
+         ++input_ch) {
+      const float scale = matrix_[output_ch][input_ch];
+      // Scale should always be positive.  Don't bother scaling by zero.
+      DCHECK_GE(scale, 0);
+      if (scale > 0) {
+        mix_taps_[output_ch].push_back({static_cast<int>(input_ch), scale});
+      }
+    }
+  }
 }
 
 ChannelMixer::~ChannelMixer() = default;
@@ -54,34 +71,26 @@ void ChannelMixer::TransformPartial(const AudioBus* input,
   CHECK_LE(frame_count, input->frames());
   CHECK_LE(frame_count, output->frames());
 
-  // Zero initialize |output| so we're accumulating from zero.
-  output->ZeroFrames(frame_count);
-
-  // If we're just remapping we can simply copy the correct input to output.
-  if (remapping_) {
-    for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
-      for (int input_ch = 0; input_ch < input->channels(); ++input_ch) {
-        float scale = matrix_[output_ch][input_ch];
-        if (scale > 0) {
-          DCHECK_EQ(scale, 1.0f);
-          memcpy(output->channel(output_ch), input->channel(input_ch),
-                 sizeof(*output->channel(output_ch)) * frame_count);
-          break;
-        }
-      }
+  for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
+    const std::vector<MixTap>& taps = mix_taps_[output_ch];
+    float* dest = output->channel(output_ch);
+    if (taps.empty()) {
+      std::fill(dest, dest + frame_count, 0.0f);
+      continue;
     }
-    return;
-  }
 
-  for (int output_ch = 0; output_ch < output->channels(); ++output_ch) {
-    for (int input_ch = 0; input_ch < input->channels(); ++input_ch) {
-      float scale = matrix_[output_ch][input_ch];
-      // Scale should always be positive.  Don't bother scaling by zero.
-      DCHECK_GE(scale, 0);
-      if (scale > 0) {
-        vector_math::FMAC(input->channel(input_ch), scale, frame_count,
-                          output->channel(output_ch));
-      }
+    // The first tap initializes the output, which avoids zeroing it first and
+    // turns pure remapping into a plain copy.
+    const float* first_src = input->channel(taps[0].input_channel);
+    if (taps[0].scale == 1.0f) {
+      memcpy(dest, first_src, sizeof(*dest) * frame_count);
+    } else {
+      vector_math::FMUL(first_src, taps[0].scale, frame_count, dest);
+    }
+
+    for (size_t i = 1; i < taps.size(); ++i) {
+      vector_math::FMAC(input->channel(taps[i].input_channel), taps[i].scale,
+                        frame_count, dest);
     }
   }
 }
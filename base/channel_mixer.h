@@ -22,6 +22,11 @@ class AudioParameters;
 // to list of input channels.  The transform renders all of the output channels,
 // with each output channel rendered according to a weighted sum of the relevant
 // input channels as defined in the matrix.
+//
+// Since most matrices are sparse (identity, pure remapping, or a handful of
+// -3 dB taps), the matrix is compiled into a per-output-channel list of the
+// non-zero taps at construction; each output channel is then rendered as a
+// copy, a scaled copy, or a scaled copy followed by a few FMACs.
 class MEDIA_EXPORT ChannelMixer {
  public:
   // To mix two channels into one and preserve loudness, we must apply
@@ -47,12 +52,18 @@ class MEDIA_EXPORT ChannelMixer {
   void Initialize(ChannelLayout input_layout, int input_channels,
                   ChannelLayout output_layout, int output_channels);
 
+  // A single input channel contributing to an output channel.
+  struct MixTap {
+    int input_channel;
+    float scale;
+  };
+
   // 2D matrix of output channels to input channels.
   std::vector< std::vector<float> > matrix_;
 
-  // Optimization case for when we can simply remap the input channels to output
-  // channels and don't need to do a multiply-accumulate loop over |matrix_|.
-  bool remapping_;
+  // For each output channel, the input channels with a non-zero weight in
+  // |matrix_|.  An empty list means the output channel is silent.
+  std::vector<std::vector<MixTap>> mix_taps_;
 
   DISALLOW_COPY_AND_ASSIGN(ChannelMixer);
 };
@@ -0,0 +1,57 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/base/channel_layout.h"
+#include "media/base/channel_mixer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 200000;
+static const int kFrames = 512;
+
+static void RunTransformBenchmark(ChannelLayout input_layout,
+                                  ChannelLayout output_layout,
+                                  const std::string& trace_name) {
+  ChannelMixer mixer(input_layout, output_layout);
+  std::unique_ptr<AudioBus> input_bus =
+      AudioBus::Create(ChannelLayoutToChannelCount(input_layout), kFrames);
+  std::unique_ptr<AudioBus> output_bus =
+      AudioBus::Create(ChannelLayoutToChannelCount(output_layout), kFrames);
+  for (int ch = 0; ch < input_bus->channels(); ++ch)
+    std::fill(input_bus->channel(ch), input_bus->channel(ch) + kFrames, 0.5f);
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kBenchmarkIterations; ++i)
+    mixer.Transform(input_bus.get(), output_bus.get());
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult("channel_mixer_transform", "", trace_name,
+                         kBenchmarkIterations / total_time_milliseconds,
+                         "runs/ms", true);
+}
+
+TEST(ChannelMixerPerfTest, StereoTo5_1) {
+  RunTransformBenchmark(CHANNEL_LAYOUT_STEREO, CHANNEL_LAYOUT_5_1,
+                        "stereo_to_5_1");
+}
+
+TEST(ChannelMixerPerfTest, Downmix5_1ToStereo) {
+  RunTransformBenchmark(CHANNEL_LAYOUT_5_1, CHANNEL_LAYOUT_STEREO,
+                        "5_1_to_stereo");
+}
+
+TEST(ChannelMixerPerfTest, Downmix7_1ToStereo) {
+  RunTransformBenchmark(CHANNEL_LAYOUT_7_1, CHANNEL_LAYOUT_STEREO,
+                        "7_1_to_stereo");
+}
+
+}  // namespace media
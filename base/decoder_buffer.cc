@@ -53,6 +53,17 @@ DecoderBuffer::DecoderBuffer(std::unique_ptr<UnalignedSharedMemory> shm,
       shm_(std::move(shm)),
       is_key_frame_(false) {}
 
+DecoderBuffer::DecoderBuffer(scoped_refptr<SegmentBuffer> segment,
+                             const uint8_t* data,
+                             size_t size)
+    : size_(size),
+      side_data_size_(0),
+      segment_(std::move(segment)),
+      segment_data_(data),
+      is_key_frame_(false) {
+  CHECK(segment_->Contains(data, size));
+}
+
 DecoderBuffer::~DecoderBuffer() {
   // TODO(crbug.com/794740). As a lot of the crashes have |side_data_size_|
   // == 0 yet |side_data| is not null, check that here hoping to get better
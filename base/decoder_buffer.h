@@ -21,6 +21,7 @@
 #include "build/build_config.h"
 #include "media/base/decrypt_config.h"
 #include "media/base/media_export.h"
+#include "media/base/segment_buffer.h"
 #include "media/base/timestamp_constants.h"
 #include "media/base/unaligned_shared_memory.h"
 
@@ -28,9 +29,11 @@ namespace media {
 
 // A specialized buffer for interfacing with audio / video decoders.
 //
-// Specifically ensures that data is aligned and padded as necessary by the
-// underlying decoding framework.  On desktop platforms this means memory is
-// allocated using FFmpeg with particular alignment and padding requirements.
+// Buffers which own their data ensure that it is aligned and padded as
+// necessary by the underlying decoding framework.  On desktop platforms this
+// means memory is allocated using FFmpeg with particular alignment and padding
+// requirements.  Buffers backed by shared memory or by a slice of a
+// SegmentBuffer are neither aligned nor padded; see is_padded().
 //
 // Also includes decoder specific functionality for decryption.
 //
@@ -111,6 +114,8 @@ class MEDIA_EXPORT DecoderBuffer
     DCHECK(!end_of_stream());
     if (shm_)
       return static_cast<uint8_t*>(shm_->memory());
+    if (segment_)
+      return segment_data_;
     return data_.get();
   }
 
@@ -118,6 +123,7 @@ class MEDIA_EXPORT DecoderBuffer
   uint8_t* writable_data() const {
     DCHECK(!end_of_stream());
     DCHECK(!shm_);
+    DCHECK(!segment_);
     return data_.get();
   }
 
@@ -126,6 +132,21 @@ class MEDIA_EXPORT DecoderBuffer
     return size_;
   }
 
+  // Returns true if data() is aligned to kAlignmentSize and followed by
+  // kPaddingSize zeroed bytes. Consumers which read past data_size(), such as
+  // FFmpeg, must copy buffers for which this is false.
+  bool is_padded() const {
+    DCHECK(!end_of_stream());
+    return !shm_ && !segment_;
+  }
+
+  // Returns the block data() is a slice of, or null if this buffer doesn't
+  // share its data. The whole block stays alive as long as any slice does.
+  const SegmentBuffer* segment() const {
+    DCHECK(!end_of_stream());
+    return segment_.get();
+  }
+
   const uint8_t* side_data() const {
     DCHECK(!end_of_stream());
     return side_data_.get();
@@ -158,7 +179,7 @@ class MEDIA_EXPORT DecoderBuffer
   }
 
   // If there's no data in this buffer, it represents end of stream.
-  bool end_of_stream() const { return !shm_ && !data_; }
+  bool end_of_stream() const { return !shm_ && !segment_ && !data_; }
 
   bool is_key_frame() const {
     DCHECK(!end_of_stream());
@@ -194,6 +215,13 @@ class MEDIA_EXPORT DecoderBuffer
 
   DecoderBuffer(std::unique_ptr<UnalignedSharedMemory> shm, size_t size);
 
+  // Refers to the |size| bytes at |data| within |segment| instead of copying
+  // them. |data| need not be aligned, and the bytes following the slice may be
+  // another buffer's data or uninitialized.
+  DecoderBuffer(scoped_refptr<SegmentBuffer> segment,
+                const uint8_t* data,
+                size_t size);
+
   virtual ~DecoderBuffer();
 
  private:
@@ -218,6 +246,11 @@ class MEDIA_EXPORT DecoderBuffer
   // Encoded data, if it is stored in SHM.
   std::unique_ptr<UnalignedSharedMemory> shm_;
 
+  // Encoded data, if it is a slice of a larger block shared with other
+  // buffers.
+  scoped_refptr<SegmentBuffer> segment_;
+  const uint8_t* segment_data_ = nullptr;
+
   // Encryption parameters for the encoded data.
   std::unique_ptr<DecryptConfig> decrypt_config_;
 
@@ -77,6 +77,7 @@ TEST(DecoderBufferTest, FromSharedMemoryHandle) {
   EXPECT_EQ(0, memcmp(buffer->data(), kData, kDataSize));
   EXPECT_FALSE(buffer->end_of_stream());
   EXPECT_FALSE(buffer->is_key_frame());
+  EXPECT_FALSE(buffer->is_padded());
 }
 
 TEST(DecoderBufferTest, FromSharedMemoryHandle_Unaligned) {
@@ -118,6 +119,7 @@ TEST(DecoderBufferTest, PaddingAlignment) {
   scoped_refptr<DecoderBuffer> buffer2(DecoderBuffer::CopyFrom(
       reinterpret_cast<const uint8_t*>(&kData), kDataSize));
   ASSERT_TRUE(buffer2.get());
+  EXPECT_TRUE(buffer2->is_padded());
 
   // Padding data should always be zeroed.
   for(int i = 0; i < DecoderBuffer::kPaddingSize; i++)
@@ -0,0 +1,110 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/lock_free_audio_fifo.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/logging.h"
+
+namespace media {
+
+LockFreeAudioFifo::LockFreeAudioFifo(int channels, int frames)
+    : audio_bus_(AudioBus::Create(channels, frames)),
+      max_frames_(frames),
+      read_index_(0),
+      write_index_(0) {}
+
+LockFreeAudioFifo::~LockFreeAudioFifo() = default;
+
+int LockFreeAudioFifo::FramesBetween(int read_index, int write_index) const {
+  const int delta = write_index - read_index;
+  return delta < 0 ? delta + 2 * max_frames_ : delta;
+}
+
+int LockFreeAudioFifo::Advance(int index, int frames) const {
+  index += frames;
+  return index >= 2 * max_frames_ ? index - 2 * max_frames_ : index;
+}
+
+int LockFreeAudioFifo::frames() const {
+  return FramesBetween(read_index_.value.load(std::memory_order_acquire),
+                       write_index_.value.load(std::memory_order_acquire));
+}
+
+bool LockFreeAudioFifo::Push(const AudioBus* source) {
+  DCHECK(source);
+  DCHECK_EQ(source->channels(), audio_bus_->channels());
+
+  // Only this thread writes |write_index_|.  Acquiring |read_index_| makes
+  // sure the consumer is done reading any frames we are about to overwrite.
+  const int write_index = write_index_.value.load(std::memory_order_relaxed);
+  const int read_index = read_index_.value.load(std::memory_order_acquire);
+  const int source_size = source->frames();
+  if (source_size > max_frames_ - FramesBetween(read_index, write_index))
+    return false;
+
+  // Copy all channels from the source to the FIFO, wrapping around if needed.
+  const int write_pos =
+      write_index >= max_frames_ ? write_index - max_frames_ : write_index;
+  const int append_size = std::min(source_size, max_frames_ - write_pos);
+  const int wrap_size = source_size - append_size;
+  for (int ch = 0; ch < source->channels(); ++ch) {
+    float* dest = audio_bus_->channel(ch);
+    const float* src = source->channel(ch);
+    memcpy(&dest[write_pos], &src[0], append_size * sizeof(src[0]));
+    if (wrap_size > 0)
+      memcpy(&dest[0], &src[append_size], wrap_size * sizeof(src[0]));
+  }
+
+  write_index_.value.store(Advance(write_index, source_size),
+                           std::memory_order_release);
+  return true;
+}
+
+bool LockFreeAudioFifo::Consume(AudioBus* destination,
+                                int start_frame,
+                                int frames_to_consume) {
+  DCHECK(destination);
+  DCHECK_EQ(destination->channels(), audio_bus_->channels());
+  CHECK_LE(frames_to_consume + start_frame, destination->frames());
+
+  // Only this thread writes |read_index_|.  Acquiring |write_index_| makes
+  // sure the producer's copies of the frames we are about to read are visible.
+  const int read_index = read_index_.value.load(std::memory_order_relaxed);
+  const int write_index = write_index_.value.load(std::memory_order_acquire);
+  if (frames_to_consume > FramesBetween(read_index, write_index))
+    return false;
+
+  // Copy all channels from the FIFO to |destination|, wrapping around if
+  // needed.
+  const int read_pos =
+      read_index >= max_frames_ ? read_index - max_frames_ : read_index;
+  const int consume_size = std::min(frames_to_consume, max_frames_ - read_pos);
+  const int wrap_size = frames_to_consume - consume_size;
+  for (int ch = 0; ch < destination->channels(); ++ch) {
+    float* dest = destination->channel(ch);
+    const float* src = audio_bus_->channel(ch);
+    memcpy(&dest[start_frame], &src[read_pos], consume_size * sizeof(src[0]));
+    if (wrap_size > 0) {
+      memcpy(&dest[start_frame + consume_size], &src[0],
+             wrap_size * sizeof(src[0]));
+    }
+  }
+
+  read_index_.value.store(Advance(read_index, frames_to_consume),
+                          std::memory_order_release);
+  return true;
+}
+
+void LockFreeAudioFifo::Clear() {
+  // Catching up with the producer drops everything it has published so far;
+  // anything pushed concurrently simply remains in the FIFO.
+  read_index_.value.store(write_index_.value.load(std::memory_order_acquire),
+                          std::memory_order_release);
+}
+
+}  // namespace media
@@ -0,0 +1,100 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_LOCK_FREE_AUDIO_FIFO_H_
+#define MEDIA_BASE_LOCK_FREE_AUDIO_FIFO_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <memory>
+
+#include "base/macros.h"
+#include "media/base/audio_bus.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// First-in first-out container for AudioBus elements which may be pushed to
+// by one thread and consumed from by another without locking, e.g. across the
+// boundary between a realtime audio device thread and a renderer thread.
+//
+// Like AudioFifo, the maximum number of audio frames is set at construction
+// and the memory is used as a ring buffer.  Unlike AudioFifo, running out of
+// data or space is not fatal: Push() and Consume() are all-or-nothing and
+// report failure instead, since neither side can know exactly what the other
+// is doing.  Neither method allocates, locks or blocks.
+//
+// Push() must only be called from a single producer thread, and Consume() and
+// Clear() only from a single consumer thread; frames() may be called from
+// either, but is only a snapshot.
+class MEDIA_EXPORT LockFreeAudioFifo {
+ public:
+  // Creates a new LockFreeAudioFifo and allocates |channels| of length
+  // |frames|.
+  LockFreeAudioFifo(int channels, int frames);
+  ~LockFreeAudioFifo();
+
+  // Pushes all audio channel data from |source| to the FIFO.  Returns false,
+  // without pushing anything, if there is not enough free space.  Producer
+  // thread only.
+  bool Push(const AudioBus* source);
+
+  // Consumes |frames_to_consume| audio frames from the FIFO and copies them to
+  // |destination| starting at position |start_frame|.  Returns false, without
+  // consuming anything, if the FIFO does not contain |frames_to_consume|
+  // frames.  There must be sufficient space in |destination|.  Consumer thread
+  // only.
+  bool Consume(AudioBus* destination, int start_frame, int frames_to_consume);
+
+  // Drops all frames currently in the FIFO.  Consumer thread only.
+  void Clear();
+
+  // Number of audio frames in the FIFO.
+  int frames() const;
+
+  int max_frames() const { return max_frames_; }
+
+ private:
+  // Size of a cache line on the CPUs we care about.
+  static constexpr size_t kCacheLineSize = 64;
+
+  // Number of frames between |read_index| and |write_index|, which are in
+  // [0, 2 * |max_frames_|) so that a full FIFO can be told from an empty one.
+  int FramesBetween(int read_index, int write_index) const;
+
+  // Returns |index| advanced by |frames|, wrapped to [0, 2 * |max_frames_|).
+  int Advance(int index, int frames) const;
+
+  // The actual FIFO is an audio bus implemented as a ring buffer.
+  const std::unique_ptr<AudioBus> audio_bus_;
+
+  // Maximum number of elements the FIFO can contain.
+  const int max_frames_;
+
+  // An index padded on both sides by a whole cache line, so that it never
+  // shares one with the other index or the members above.  This holds for any
+  // alignment of the FIFO; alignas() would not, since before C++17 operator
+  // new doesn't honor alignments beyond alignof(std::max_align_t).
+  struct PaddedIndex {
+    explicit PaddedIndex(int index) : value(index) {}
+
+    char padding_before[kCacheLineSize];
+    std::atomic<int> value;
+    char padding_after[kCacheLineSize - sizeof(std::atomic<int>)];
+  };
+
+  // Written only by the consumer and producer respectively; the ring buffer
+  // position is the index modulo |max_frames_|.  Each is published with
+  // release semantics after the corresponding copy has completed, and kept on
+  // its own cache line so the two threads don't contend for it.
+  PaddedIndex read_index_;
+  PaddedIndex write_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockFreeAudioFifo);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_LOCK_FREE_AUDIO_FIFO_H_
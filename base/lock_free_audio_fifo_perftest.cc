@@ -0,0 +1,117 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "media/base/audio_fifo.h"
+#include "media/base/lock_free_audio_fifo.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kChannels = 2;
+static const int kFifoFrames = 4096;
+static const int kTotalFrames = 48000 * 600;
+
+// The locked path audio code uses today: an AudioFifo guarded by a lock, with
+// the same non-fatal Push() and Consume() semantics as LockFreeAudioFifo.
+class LockedAudioFifo {
+ public:
+  LockedAudioFifo(int channels, int frames) : fifo_(channels, frames) {}
+
+  bool Push(const AudioBus* source) {
+    base::AutoLock auto_lock(lock_);
+    if (source->frames() > fifo_.max_frames() - fifo_.frames())
+      return false;
+    fifo_.Push(source);
+    return true;
+  }
+
+  bool Consume(AudioBus* destination, int start_frame, int frames_to_consume) {
+    base::AutoLock auto_lock(lock_);
+    if (frames_to_consume > fifo_.frames())
+      return false;
+    fifo_.Consume(destination, start_frame, frames_to_consume);
+    return true;
+  }
+
+ private:
+  base::Lock lock_;
+  AudioFifo fifo_;
+
+  DISALLOW_COPY_AND_ASSIGN(LockedAudioFifo);
+};
+
+template <class Fifo>
+class Producer : public base::DelegateSimpleThread::Delegate {
+ public:
+  Producer(Fifo* fifo, int chunk_frames)
+      : fifo_(fifo), chunk_(AudioBus::Create(kChannels, chunk_frames)) {
+    chunk_->Zero();
+  }
+
+  void Run() override {
+    for (int frames = 0; frames < kTotalFrames; frames += chunk_->frames()) {
+      while (!fifo_->Push(chunk_.get()))
+        base::PlatformThread::YieldCurrentThread();
+    }
+  }
+
+ private:
+  Fifo* const fifo_;
+  const std::unique_ptr<AudioBus> chunk_;
+
+  DISALLOW_COPY_AND_ASSIGN(Producer);
+};
+
+// Streams kTotalFrames through |Fifo| from a producer thread pushing chunks of
+// |push_frames| to this thread consuming chunks of |consume_frames|, with
+// both sides spinning whenever the FIFO is full or empty so they contend as
+// much as possible.
+template <class Fifo>
+void RunContentionBenchmark(int push_frames,
+                            int consume_frames,
+                            const std::string& trace_name) {
+  Fifo fifo(kChannels, kFifoFrames);
+  Producer<Fifo> producer(&fifo, push_frames);
+  base::DelegateSimpleThread producer_thread(&producer, "FifoProducer");
+  std::unique_ptr<AudioBus> output =
+      AudioBus::Create(kChannels, consume_frames);
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  producer_thread.Start();
+  for (int frames = 0; frames + consume_frames <= kTotalFrames;
+       frames += consume_frames) {
+    while (!fifo.Consume(output.get(), 0, consume_frames))
+      base::PlatformThread::YieldCurrentThread();
+  }
+  producer_thread.Join();
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+
+  perf_test::PrintResult("audio_fifo_contention", "", trace_name,
+                         kTotalFrames / total_time_milliseconds / 1000,
+                         "mega_frames/s", true);
+}
+
+// 10 ms buffers in, typical 128 frame Web Audio render quanta out.
+TEST(LockFreeAudioFifoPerfTest, Contention) {
+  RunContentionBenchmark<LockedAudioFifo>(480, 128, "locked");
+  RunContentionBenchmark<LockFreeAudioFifo>(480, 128, "lock_free");
+}
+
+// Tiny chunks maximize the number of index updates per frame.
+TEST(LockFreeAudioFifoPerfTest, ContentionSmallChunks) {
+  RunContentionBenchmark<LockedAudioFifo>(16, 16, "locked_16_frames");
+  RunContentionBenchmark<LockFreeAudioFifo>(16, 16, "lock_free_16_frames");
+}
+
+}  // namespace media
@@ -0,0 +1,166 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/lock_free_audio_fifo.h"
+
+#include <memory>
+
+#include "base/macros.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+static const int kChannels = 2;
+static const int kMaxFrameCount = 128;
+
+// Fills every channel of |bus| with consecutive values starting at |value| and
+// returns the value following the last one written.
+static int FillRamp(AudioBus* bus, int value) {
+  for (int ch = 0; ch < bus->channels(); ++ch) {
+    for (int i = 0; i < bus->frames(); ++i)
+      bus->channel(ch)[i] = value + i;
+  }
+  return value + bus->frames();
+}
+
+// Returns true if every channel of |bus| holds consecutive values starting at
+// |value|.
+static bool HasRamp(const AudioBus* bus, int value) {
+  for (int ch = 0; ch < bus->channels(); ++ch) {
+    for (int i = 0; i < bus->frames(); ++i) {
+      if (bus->channel(ch)[i] != value + i)
+        return false;
+    }
+  }
+  return true;
+}
+
+TEST(LockFreeAudioFifoTest, Construct) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  EXPECT_EQ(0, fifo.frames());
+  EXPECT_EQ(kMaxFrameCount, fifo.max_frames());
+}
+
+// Pushing beyond capacity or consuming more than is buffered must fail without
+// changing the FIFO.
+TEST(LockFreeAudioFifoTest, FullAndEmpty) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> bus = AudioBus::Create(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> one_frame = AudioBus::Create(kChannels, 1);
+
+  EXPECT_FALSE(fifo.Consume(bus.get(), 0, 1));
+  EXPECT_TRUE(fifo.Push(bus.get()));
+  EXPECT_EQ(kMaxFrameCount, fifo.frames());
+  EXPECT_FALSE(fifo.Push(one_frame.get()));
+  EXPECT_EQ(kMaxFrameCount, fifo.frames());
+
+  std::unique_ptr<AudioBus> big_bus =
+      AudioBus::Create(kChannels, kMaxFrameCount + 1);
+  EXPECT_FALSE(fifo.Consume(big_bus.get(), 0, kMaxFrameCount + 1));
+  EXPECT_TRUE(fifo.Consume(bus.get(), 0, kMaxFrameCount));
+  EXPECT_EQ(0, fifo.frames());
+
+  EXPECT_TRUE(fifo.Push(one_frame.get()));
+  fifo.Clear();
+  EXPECT_EQ(0, fifo.frames());
+  EXPECT_FALSE(fifo.Consume(one_frame.get(), 0, 1));
+}
+
+// Push and consume odd sized chunks so the ring buffer wraps at every possible
+// position, and verify the data survives intact.
+TEST(LockFreeAudioFifoTest, PushAndConsumeWithWrap) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> input = AudioBus::Create(kChannels, 37);
+  std::unique_ptr<AudioBus> output = AudioBus::Create(kChannels, 23);
+
+  int next_input = 0;
+  int next_output = 0;
+  for (int i = 0; i < 1000; ++i) {
+    while (fifo.max_frames() - fifo.frames() >= input->frames()) {
+      next_input = FillRamp(input.get(), next_input);
+      ASSERT_TRUE(fifo.Push(input.get()));
+    }
+    while (fifo.frames() >= output->frames()) {
+      ASSERT_TRUE(fifo.Consume(output.get(), 0, output->frames()));
+      ASSERT_TRUE(HasRamp(output.get(), next_output));
+      next_output += output->frames();
+    }
+  }
+  EXPECT_EQ(next_input - next_output, fifo.frames());
+}
+
+// Verify |start_frame| offsets the copy into the destination.
+TEST(LockFreeAudioFifoTest, ConsumeWithStartFrame) {
+  LockFreeAudioFifo fifo(kChannels, kMaxFrameCount);
+  std::unique_ptr<AudioBus> input = AudioBus::Create(kChannels, 16);
+  FillRamp(input.get(), 100);
+  ASSERT_TRUE(fifo.Push(input.get()));
+
+  std::unique_ptr<AudioBus> output = AudioBus::Create(kChannels, 24);
+  output->Zero();
+  ASSERT_TRUE(fifo.Consume(output.get(), 8, 16));
+  for (int ch = 0; ch < kChannels; ++ch) {
+    EXPECT_EQ(0.0f, output->channel(ch)[7]);
+    EXPECT_EQ(100.0f, output->channel(ch)[8]);
+    EXPECT_EQ(115.0f, output->channel(ch)[23]);
+  }
+}
+
+// Pushes a continuous ramp in fixed size chunks as fast as the FIFO allows.
+class RampProducer : public base::DelegateSimpleThread::Delegate {
+ public:
+  RampProducer(LockFreeAudioFifo* fifo, int chunk_frames, int total_frames)
+      : fifo_(fifo),
+        chunk_(AudioBus::Create(kChannels, chunk_frames)),
+        total_frames_(total_frames) {}
+
+  void Run() override {
+    int next_value = 0;
+    while (next_value < total_frames_) {
+      FillRamp(chunk_.get(), next_value);
+      while (!fifo_->Push(chunk_.get()))
+        base::PlatformThread::YieldCurrentThread();
+      next_value += chunk_->frames();
+    }
+  }
+
+ private:
+  LockFreeAudioFifo* const fifo_;
+  const std::unique_ptr<AudioBus> chunk_;
+  const int total_frames_;
+
+  DISALLOW_COPY_AND_ASSIGN(RampProducer);
+};
+
+// Consume on this thread while another thread pushes, with chunk sizes which
+// don't divide the FIFO size, and verify every frame arrives in order.
+TEST(LockFreeAudioFifoTest, ConcurrentPushAndConsume) {
+  static const int kTotalFrames = 480 * 1000;
+  LockFreeAudioFifo fifo(kChannels, 1000);
+  RampProducer producer(&fifo, 480, kTotalFrames);
+  base::DelegateSimpleThread producer_thread(&producer, "RampProducer");
+  producer_thread.Start();
+
+  // Keep consuming after a mismatch so the producer can always finish.
+  std::unique_ptr<AudioBus> output = AudioBus::Create(kChannels, 441);
+  int next_value = 0;
+  int mismatches = 0;
+  while (next_value + output->frames() <= kTotalFrames) {
+    if (!fifo.Consume(output.get(), 0, output->frames())) {
+      base::PlatformThread::YieldCurrentThread();
+      continue;
+    }
+    if (!HasRamp(output.get(), next_value))
+      ++mismatches;
+    next_value += output->frames();
+  }
+
+  producer_thread.Join();
+  EXPECT_EQ(0, mismatches);
+  EXPECT_EQ(kTotalFrames - next_value, fifo.frames());
+}
+
+}  // namespace media
@@ -41,6 +41,8 @@ const char kReportVp9AsAnUnsupportedMimeType[] =
 const char kAlsaInputDevice[] = "alsa-input-device";
 // The Alsa device to use when opening an audio stream.
 const char kAlsaOutputDevice[] = "alsa-output-device";
+// Number of buffers to request from V4L2 video capture drivers.
+const char kV4L2CaptureBuffers[] = "v4l2-capture-buffers";
 #endif
 
 #if defined(OS_WIN)
@@ -92,7 +94,9 @@ const char kDisableMojoRenderer[] = "disable-mojo-renderer";
 const char kUseFakeDeviceForMediaStream[] = "use-fake-device-for-media-stream";
 
 // Use an .y4m file to play as the webcam. See the comments in
-// media/capture/video/file_video_capture_device.h for more details.
+// media/capture/video/file_video_capture_device.h for more details. The path
+// may be followed by ";start-frame=N,playback-rate=R", see
+// media/capture/video/file_video_capture_device_factory.h.
 const char kUseFileForFakeVideoCapture[] = "use-file-for-fake-video-capture";
 
 // Play a .wav file as the microphone. Note that for WebRTC calls we'll treat
@@ -203,6 +207,11 @@ const base::Feature kNewAudioRenderingMixingStrategy{
 const base::Feature kOverlayFullscreenVideo{"overlay-fullscreen-video",
                                             base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Pre-mix the inputs of each AudioRendererMixer on worker threads, one buffer
+// ahead of its sink. The "threads" parameter sets the number of workers.
+const base::Feature kParallelAudioMixing{"ParallelAudioMixing",
+                                         base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Enable Picture-in-Picture.
 const base::Feature kPictureInPicture {
   "PictureInPicture",
@@ -253,6 +262,13 @@ const base::Feature kBackgroundSrcVideoTrackOptimization{
 const base::Feature kBackgroundVideoPauseOptimization{
     "BackgroundVideoPauseOptimization", base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Start MSE garbage collection before the memory limit is reached, freeing
+// played data a GOP at a time within a time budget per append, and release
+// the freed buffers on a background task. The budget is set in milliseconds by
+// the "budget_ms" parameter and defaults to 1.
+const base::Feature kIncrementalSourceBufferGC{
+    "IncrementalSourceBufferGC", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Make MSE garbage collection algorithm more aggressive when we are under
 // moderate or critical memory pressure. This will relieve memory pressure by
 // releasing stale data from MSE buffers.
@@ -347,6 +363,11 @@ const base::Feature kVaapiVP8Encoder{"VaapiVP8Encoder",
 const base::Feature kVideoBlitColorAccuracy{"video-blit-color-accuracy",
                                             base::FEATURE_ENABLED_BY_DEFAULT};
 
+// Decode MJPEG captured frames on several threads when no hardware JPEG
+// decoder is available.
+const base::Feature kVideoCaptureParallelJpegDecoding{
+    "VideoCaptureParallelJpegDecoding", base::FEATURE_ENABLED_BY_DEFAULT};
+
 // Enables support for External Clear Key (ECK) key system for testing on
 // supported platforms. On platforms that do not support ECK, this feature has
 // no effect.
@@ -365,6 +386,12 @@ const base::Feature kHardwareSecureDecryption{
 const base::Feature kLimitParallelMediaPreloading{
     "LimitParallelMediaPreloading", base::FEATURE_DISABLED_BY_DEFAULT};
 
+// Lets media resource loaders continue through short runs of cached data
+// rather than issuing a new range request after each one, and sizes the
+// preload buffer from the measured download throughput.
+const base::Feature kMultiBufferReadAheadScheduling{
+    "MultiBufferReadAheadScheduling", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Enables low-delay video rendering in media pipeline on "live" stream.
 const base::Feature kLowDelayVideoRenderingOnLiveStream{
     "low-delay-video-rendering-on-live-stream",
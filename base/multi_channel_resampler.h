@@ -18,7 +18,9 @@ namespace media {
 class AudioBus;
 
 // MultiChannelResampler is a multi channel wrapper for SincResampler; allowing
-// high quality sample rate conversion of multiple channels at once.
+// high quality sample rate conversion of multiple channels at once.  All
+// channels are resampled by a single planar SincResampler, so kernel lookups
+// and input requests are shared between them.
 class MEDIA_EXPORT MultiChannelResampler {
  public:
   // Callback type for providing more data into the resampler.  Expects AudioBus
@@ -44,8 +46,8 @@ class MEDIA_EXPORT MultiChannelResampler {
   // not call while Resample() is in progress.
   void Flush();
 
-  // Update ratio for all SincResamplers.  SetRatio() will cause reconstruction
-  // of the kernels used for resampling.  Not thread safe, do not call while
+  // Update the resampling ratio.  SetRatio() will cause reconstruction of the
+  // kernels used for resampling.  Not thread safe, do not call while
   // Resample() is in progress.
   void SetRatio(double io_sample_rate_ratio);
 
@@ -60,22 +62,18 @@ class MEDIA_EXPORT MultiChannelResampler {
   void PrimeWithSilence();
 
  private:
-  // SincResampler::ReadCB implementation.  ProvideInput() will be called for
-  // each channel (in channel order) as SincResampler needs more data.
-  void ProvideInput(int channel, int frames, float* destination);
+  // SincResampler::MultiChannelReadCB implementation.  Forwards the request to
+  // |read_cb_| along with the current frame delay.
+  void ProvideInput(int frames, AudioBus* audio_bus);
 
   // Source of data for resampling.
   ReadCB read_cb_;
 
-  // Each channel has its own high quality resampler.
-  std::vector<std::unique_ptr<SincResampler>> resamplers_;
+  // Resamples all channels in lock step.
+  std::unique_ptr<SincResampler> resampler_;
 
-  // Buffers for audio data going into SincResampler from ReadCB.
-  std::unique_ptr<AudioBus> resampler_audio_bus_;
-
-  // To avoid a memcpy() on the first channel we create a wrapped AudioBus where
-  // the first channel points to the |destination| provided to ProvideInput().
-  std::unique_ptr<AudioBus> wrapped_resampler_audio_bus_;
+  // Per-channel output pointers handed to |resampler_| for each chunk.
+  std::vector<float*> channel_destinations_;
 
   // The number of output frames that have successfully been processed during
   // the current Resample() call.
@@ -0,0 +1,33 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/base/segment_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "media/base/decoder_buffer.h"
+
+namespace media {
+
+SegmentBuffer::SegmentBuffer(size_t size)
+    : size_(size),
+      data_(static_cast<uint8_t*>(
+          base::AlignedAlloc(size + DecoderBuffer::kPaddingSize,
+                             DecoderBuffer::kAlignmentSize))) {
+  memset(data_.get() + size_, 0, DecoderBuffer::kPaddingSize);
+}
+
+SegmentBuffer::~SegmentBuffer() = default;
+
+void SegmentBuffer::Write(size_t offset, const uint8_t* data, size_t size) {
+  DCHECK(HasOneRef());
+  DCHECK_LE(offset, size_);
+  DCHECK_LE(size, size_ - offset);
+  memcpy(data_.get() + offset, data, size);
+  written_size_ = std::max(written_size_, offset + size);
+}
+
+}  // namespace media
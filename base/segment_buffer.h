@@ -0,0 +1,67 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_BASE_SEGMENT_BUFFER_H_
+#define MEDIA_BASE_SEGMENT_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/aligned_memory.h"
+#include "base/memory/ref_counted.h"
+#include "media/base/media_export.h"
+
+namespace media {
+
+// A block of appended media data which DecoderBuffers can refer to, see
+// StreamParserBuffer::FromSegment(), instead of each holding a copy of their
+// part of it. Only the start of the block is aligned, and only its end is
+// followed by DecoderBuffer::kPaddingSize zeroed bytes; a slice may start
+// anywhere and be followed by other data or by bytes never written, so slice
+// buffers report DecoderBuffer::is_padded() as false.
+//
+// The creator may write to the block for as long as it holds the only
+// reference. Once shared, the block must not change, which makes it safe to
+// read slices of it on any thread.
+class MEDIA_EXPORT SegmentBuffer
+    : public base::RefCountedThreadSafe<SegmentBuffer> {
+ public:
+  // Allocates an uninitialized block of |size| bytes.
+  explicit SegmentBuffer(size_t size);
+
+  const uint8_t* data() const { return data_.get(); }
+
+  // Copies |size| bytes from |data| to |offset| in the block.
+  void Write(size_t offset, const uint8_t* data, size_t size);
+
+  size_t size() const { return size_; }
+
+  // Returns the end of the data written to the block so far. Capacity past it
+  // is never read through slices, so only this much counts as media data.
+  size_t written_size() const { return written_size_; }
+
+  // Returns true if [|data|, |data| + |size|) lies within the block.
+  bool Contains(const uint8_t* data, size_t size) const {
+    return data >= data_.get() && data <= data_.get() + size_ &&
+           size <= static_cast<size_t>(data_.get() + size_ - data);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<SegmentBuffer>;
+  ~SegmentBuffer();
+
+  const size_t size_;
+  const std::unique_ptr<uint8_t, base::AlignedFreeDeleter> data_;
+  size_t written_size_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(SegmentBuffer);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_BASE_SEGMENT_BUFFER_H_
@@ -72,24 +72,36 @@
 //
 // Note: we're glossing over how the sub-sample handling works with
 // |virtual_source_idx_|, etc.
+//
+// Multi-channel resamplers lay out one such buffer per channel, back-to-back
+// and |channel_stride_| samples apart, and move the regions of every channel
+// together.  Only the region pointers for the first channel are stored.
 
 #include "media/base/sinc_resampler.h"
 
 #include <limits>
+#include <utility>
+#include <vector>
 
 #include "base/logging.h"
+#include "base/no_destructor.h"
 #include "base/numerics/math_constants.h"
+#include "base/synchronization/lock.h"
 #include "build/build_config.h"
 #include "cc/base/math_util.h"
+#include "media/base/audio_bus.h"
 
 #if defined(ARCH_CPU_X86_FAMILY)
 #include <xmmintrin.h>
 #define CONVOLVE_FUNC Convolve_SSE
+#define CONVOLVE2_FUNC Convolve2_SSE
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #include <arm_neon.h>
 #define CONVOLVE_FUNC Convolve_NEON
+#define CONVOLVE2_FUNC Convolve2_NEON
 #else
 #define CONVOLVE_FUNC Convolve_C
+#define CONVOLVE2_FUNC Convolve2_C
 #endif
 
 namespace media {
@@ -114,37 +126,220 @@ static int CalculateChunkSize(int block_size_, double io_ratio) {
   return block_size_ / io_ratio;
 }
 
+namespace {
+
+// The parts of the windowed sinc() kernels which do not depend on the sample
+// rate ratio.  Computed once per process.
+struct KernelTables {
+  KernelTables() {
+    // Blackman window parameters.
+    static const double kAlpha = 0.16;
+    static const double kA0 = 0.5 * (1.0 - kAlpha);
+    static const double kA1 = 0.5;
+    static const double kA2 = 0.5 * kAlpha;
+
+    // We generate a range of sub-sample offsets from 0.0 to 1.0.
+    for (int offset_idx = 0; offset_idx <= SincResampler::kKernelOffsetCount;
+         ++offset_idx) {
+      const float subsample_offset =
+          static_cast<float>(offset_idx) / SincResampler::kKernelOffsetCount;
+
+      for (int i = 0; i < SincResampler::kKernelSize; ++i) {
+        const int idx = i + offset_idx * SincResampler::kKernelSize;
+        pre_sinc[idx] = base::kPiFloat *
+                        (i - SincResampler::kKernelSize / 2 - subsample_offset);
+
+        // Compute Blackman window, matching the offset of the sinc().
+        const float x = (i - subsample_offset) / SincResampler::kKernelSize;
+        window[idx] =
+            static_cast<float>(kA0 - kA1 * cos(2.0 * base::kPiDouble * x) +
+                               kA2 * cos(4.0 * base::kPiDouble * x));
+      }
+    }
+  }
+
+  float pre_sinc[SincResampler::kKernelStorageSize];
+  float window[SincResampler::kKernelStorageSize];
+};
+
+const KernelTables& GetKernelTables() {
+  static const base::NoDestructor<KernelTables> tables;
+  return *tables;
+}
+
+// Generates the set of windowed sinc() kernels for |sinc_scale_factor| into
+// |kernel|, which must hold kKernelStorageSize floats.
+void ComputeKernel(double sinc_scale_factor, float* kernel) {
+  const KernelTables& tables = GetKernelTables();
+  for (int idx = 0; idx < SincResampler::kKernelStorageSize; ++idx) {
+    const float window = tables.window[idx];
+    const float pre_sinc = tables.pre_sinc[idx];
+
+    // Window the sinc() function and store at the correct offset.
+    kernel[idx] = static_cast<float>(
+        window * (pre_sinc ? sin(sinc_scale_factor * pre_sinc) / pre_sinc
+                           : sinc_scale_factor));
+  }
+}
+
+}  // namespace
+
+// Immutable kernel storage for one |sinc_scale_factor|, shared by every
+// SincResampler using it.
+class SincResampler::SharedKernel
+    : public base::RefCountedThreadSafe<SharedKernel> {
+ public:
+  explicit SharedKernel(double sinc_scale_factor)
+      : sinc_scale_factor_(sinc_scale_factor),
+        // Create kernel storage with a 16-byte alignment for SSE optimizations.
+        storage_(static_cast<float*>(
+            base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))) {
+    ComputeKernel(sinc_scale_factor_, storage_.get());
+  }
+
+  double sinc_scale_factor() const { return sinc_scale_factor_; }
+  const float* data() const { return storage_.get(); }
+
+ private:
+  friend class base::RefCountedThreadSafe<SharedKernel>;
+  ~SharedKernel() = default;
+
+  const double sinc_scale_factor_;
+  const std::unique_ptr<float[], base::AlignedFreeDeleter> storage_;
+
+  DISALLOW_COPY_AND_ASSIGN(SharedKernel);
+};
+
+namespace {
+
+// Process-wide, most-recently-used cache of kernels keyed by sinc scale
+// factor.  Streams are opened and closed with a handful of common sample rate
+// pairs (44.1k <-> 48k, 16k <-> 48k, ...), and every upsampling ratio maps to
+// the same scale factor, so a small cache covers nearly all resamplers.
+class KernelCache {
+ public:
+  // Evicted kernels stay alive for as long as any resampler references them.
+  static const size_t kMaxEntries = 8;
+
+  KernelCache() = default;
+
+  // Returns the cached kernel for |sinc_scale_factor| or nullptr.
+  scoped_refptr<SincResampler::SharedKernel> Lookup(double sinc_scale_factor) {
+    base::AutoLock auto_lock(lock_);
+    return LookupLocked(sinc_scale_factor);
+  }
+
+  // Returns the cached kernel for |sinc_scale_factor|, creating it if needed.
+  scoped_refptr<SincResampler::SharedKernel> GetOrCreate(
+      double sinc_scale_factor) {
+    scoped_refptr<SincResampler::SharedKernel> kernel =
+        Lookup(sinc_scale_factor);
+    if (kernel)
+      return kernel;
+
+    // Build the kernel without holding |lock_|; if another thread raced us the
+    // first inserted kernel wins and ours is discarded.
+    kernel = base::MakeRefCounted<SincResampler::SharedKernel>(
+        sinc_scale_factor);
+
+    base::AutoLock auto_lock(lock_);
+    scoped_refptr<SincResampler::SharedKernel> existing =
+        LookupLocked(sinc_scale_factor);
+    if (existing)
+      return existing;
+
+    if (entries_.size() == kMaxEntries)
+      entries_.erase(entries_.begin());
+    entries_.push_back(kernel);
+    return kernel;
+  }
+
+ private:
+  scoped_refptr<SincResampler::SharedKernel> LookupLocked(
+      double sinc_scale_factor) {
+    lock_.AssertAcquired();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if ((*it)->sinc_scale_factor() != sinc_scale_factor)
+        continue;
+
+      // Move the hit to the back, which holds the most recently used entry.
+      scoped_refptr<SincResampler::SharedKernel> kernel = std::move(*it);
+      entries_.erase(it);
+      entries_.push_back(kernel);
+      return kernel;
+    }
+    return nullptr;
+  }
+
+  base::Lock lock_;
+  std::vector<scoped_refptr<SincResampler::SharedKernel>> entries_;
+
+  DISALLOW_COPY_AND_ASSIGN(KernelCache);
+};
+
+KernelCache& GetKernelCache() {
+  static base::NoDestructor<KernelCache> cache;
+  return *cache;
+}
+
+}  // namespace
+
+// Rounds |frames| up so that consecutive channels in the input buffer keep the
+// 16-byte alignment of the first channel.
+static int CalculateChannelStride(int frames) {
+  static const int kFloatsPerAlignment = 16 / sizeof(float);
+  return (frames + kFloatsPerAlignment - 1) & ~(kFloatsPerAlignment - 1);
+}
+
 SincResampler::SincResampler(double io_sample_rate_ratio,
                              int request_frames,
                              const ReadCB& read_cb)
-    : io_sample_rate_ratio_(io_sample_rate_ratio),
+    : SincResampler(1,
+                    io_sample_rate_ratio,
+                    request_frames,
+                    read_cb,
+                    MultiChannelReadCB()) {}
+
+SincResampler::SincResampler(int channels,
+                             double io_sample_rate_ratio,
+                             int request_frames,
+                             const MultiChannelReadCB& read_cb)
+    : SincResampler(channels,
+                    io_sample_rate_ratio,
+                    request_frames,
+                    ReadCB(),
+                    read_cb) {}
+
+SincResampler::SincResampler(int channels,
+                             double io_sample_rate_ratio,
+                             int request_frames,
+                             const ReadCB& read_cb,
+                             const MultiChannelReadCB& multi_channel_read_cb)
+    : channels_(channels),
+      io_sample_rate_ratio_(io_sample_rate_ratio),
       read_cb_(read_cb),
+      multi_channel_read_cb_(multi_channel_read_cb),
       request_frames_(request_frames),
       input_buffer_size_(request_frames_ + kKernelSize),
+      channel_stride_(CalculateChannelStride(input_buffer_size_)),
+      shared_kernel_(GetKernelCache().GetOrCreate(
+          SincScaleFactor(io_sample_rate_ratio_))),
+      kernel_(shared_kernel_->data()),
       // Create input buffers with a 16-byte alignment for SSE optimizations.
-      kernel_storage_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
-      kernel_pre_sinc_storage_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
-      kernel_window_storage_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16))),
-      input_buffer_(static_cast<float*>(
-          base::AlignedAlloc(sizeof(float) * input_buffer_size_, 16))),
+      input_buffer_(static_cast<float*>(base::AlignedAlloc(
+          sizeof(float) * channel_stride_ * channels_, 16))),
       r1_(input_buffer_.get()),
       r2_(input_buffer_.get() + kKernelSize / 2) {
+  CHECK_GT(channels_, 0);
   CHECK_GT(request_frames_, 0);
+  DCHECK_NE(read_cb_.is_null(), multi_channel_read_cb_.is_null());
+  if (!multi_channel_read_cb_.is_null()) {
+    input_bus_ = AudioBus::CreateWrapper(channels_);
+    input_bus_->set_frames(request_frames_);
+  }
   Flush();
   CHECK_GT(block_size_, kKernelSize)
       << "block_size must be greater than kKernelSize!";
-
-  memset(kernel_storage_.get(), 0,
-         sizeof(*kernel_storage_.get()) * kKernelStorageSize);
-  memset(kernel_pre_sinc_storage_.get(), 0,
-         sizeof(*kernel_pre_sinc_storage_.get()) * kKernelStorageSize);
-  memset(kernel_window_storage_.get(), 0,
-         sizeof(*kernel_window_storage_.get()) * kKernelStorageSize);
-
-  InitializeKernel();
 }
 
 SincResampler::~SincResampler() = default;
@@ -166,40 +361,15 @@ void SincResampler::UpdateRegions(bool second_load) {
   CHECK_LT(r2_, r3_);
 }
 
-void SincResampler::InitializeKernel() {
-  // Blackman window parameters.
-  static const double kAlpha = 0.16;
-  static const double kA0 = 0.5 * (1.0 - kAlpha);
-  static const double kA1 = 0.5;
-  static const double kA2 = 0.5 * kAlpha;
-
-  // Generates a set of windowed sinc() kernels.
-  // We generate a range of sub-sample offsets from 0.0 to 1.0.
-  const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
-  for (int offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
-    const float subsample_offset =
-        static_cast<float>(offset_idx) / kKernelOffsetCount;
-
-    for (int i = 0; i < kKernelSize; ++i) {
-      const int idx = i + offset_idx * kKernelSize;
-      const float pre_sinc =
-          base::kPiFloat * (i - kKernelSize / 2 - subsample_offset);
-      kernel_pre_sinc_storage_[idx] = pre_sinc;
-
-      // Compute Blackman window, matching the offset of the sinc().
-      const float x = (i - subsample_offset) / kKernelSize;
-      const float window =
-          static_cast<float>(kA0 - kA1 * cos(2.0 * base::kPiDouble * x) +
-                             kA2 * cos(4.0 * base::kPiDouble * x));
-      kernel_window_storage_[idx] = window;
-
-      // Compute the sinc with offset, then window the sinc() function and store
-      // at the correct offset.
-      kernel_storage_[idx] = static_cast<float>(
-          window * (pre_sinc ? sin(sinc_scale_factor * pre_sinc) / pre_sinc
-                             : sinc_scale_factor));
-    }
+void SincResampler::ReadInput() {
+  if (!read_cb_.is_null()) {
+    read_cb_.Run(request_frames_, r0_);
+    return;
   }
+
+  for (int ch = 0; ch < channels_; ++ch)
+    input_bus_->SetChannelData(ch, r0_ + ch * channel_stride_);
+  multi_channel_read_cb_.Run(request_frames_, input_bus_.get());
 }
 
 void SincResampler::SetRatio(double io_sample_rate_ratio) {
@@ -211,28 +381,43 @@ void SincResampler::SetRatio(double io_sample_rate_ratio) {
   io_sample_rate_ratio_ = io_sample_rate_ratio;
   chunk_size_ = CalculateChunkSize(block_size_, io_sample_rate_ratio_);
 
-  // Optimize reinitialization by reusing values which are independent of
-  // |sinc_scale_factor|.  Provides a 3x speedup.
+  // Every upsampling ratio uses the same kernels.
   const double sinc_scale_factor = SincScaleFactor(io_sample_rate_ratio_);
-  for (int offset_idx = 0; offset_idx <= kKernelOffsetCount; ++offset_idx) {
-    for (int i = 0; i < kKernelSize; ++i) {
-      const int idx = i + offset_idx * kKernelSize;
-      const float window = kernel_window_storage_[idx];
-      const float pre_sinc = kernel_pre_sinc_storage_[idx];
-
-      kernel_storage_[idx] = static_cast<float>(
-          window * (pre_sinc ? sin(sinc_scale_factor * pre_sinc) / pre_sinc
-                             : sinc_scale_factor));
-    }
+  if (shared_kernel_ &&
+      shared_kernel_->sinc_scale_factor() == sinc_scale_factor) {
+    return;
   }
+
+  // Prefer a kernel some other stream already built.  Otherwise compute it
+  // into private storage rather than inserting it into the cache: ratios set
+  // here are typically continuously adjusted for clock drift and would only
+  // evict the common entries.
+  shared_kernel_ = GetKernelCache().Lookup(sinc_scale_factor);
+  if (shared_kernel_) {
+    kernel_ = shared_kernel_->data();
+    return;
+  }
+
+  if (!kernel_storage_) {
+    kernel_storage_.reset(static_cast<float*>(
+        base::AlignedAlloc(sizeof(float) * kKernelStorageSize, 16)));
+  }
+  ComputeKernel(sinc_scale_factor, kernel_storage_.get());
+  kernel_ = kernel_storage_.get();
 }
 
 void SincResampler::Resample(int frames, float* destination) {
+  DCHECK_EQ(channels_, 1);
+  ResampleChannels(frames, &destination);
+}
+
+void SincResampler::ResampleChannels(int frames, float* const* destinations) {
   int remaining_frames = frames;
+  int output_idx = 0;
 
   // Step (1) -- Prime the input buffer at the start of the input stream.
   if (!buffer_primed_ && remaining_frames) {
-    read_cb_.Run(request_frames_, r0_);
+    ReadInput();
     buffer_primed_ = true;
   }
 
@@ -253,7 +438,7 @@ void SincResampler::Resample(int frames, float* destination) {
 
         // We'll compute "convolutions" for the two kernels which straddle
         // |virtual_source_idx_|.
-        const float* k1 = kernel_storage_.get() + offset_idx * kKernelSize;
+        const float* k1 = kernel_ + offset_idx * kKernelSize;
         const float* k2 = k1 + kKernelSize;
 
         // Ensure |k1|, |k2| are 16-byte aligned for SIMD usage.  Should always
@@ -267,8 +452,23 @@ void SincResampler::Resample(int frames, float* destination) {
         // Figure out how much to weight each kernel's "convolution".
         const double kernel_interpolation_factor =
             virtual_offset_idx - offset_idx;
-        *destination++ =
-            CONVOLVE_FUNC(input_ptr, k1, k2, kernel_interpolation_factor);
+
+        // All channels share the kernels and interpolation factor computed
+        // above; convolve them two at a time so each kernel load is reused.
+        int ch = 0;
+        for (; ch + 1 < channels_; ch += 2) {
+          CONVOLVE2_FUNC(input_ptr + ch * channel_stride_,
+                         input_ptr + (ch + 1) * channel_stride_, k1, k2,
+                         kernel_interpolation_factor,
+                         &destinations[ch][output_idx],
+                         &destinations[ch + 1][output_idx]);
+        }
+        if (ch < channels_) {
+          destinations[ch][output_idx] =
+              CONVOLVE_FUNC(input_ptr + ch * channel_stride_, k1, k2,
+                            kernel_interpolation_factor);
+        }
+        ++output_idx;
 
         // Advance the virtual index.
         virtual_source_idx_ += io_sample_rate_ratio_;
@@ -283,14 +483,17 @@ void SincResampler::Resample(int frames, float* destination) {
 
     // Step (3) -- Copy r3_, r4_ to r1_, r2_.
     // This wraps the last input frames back to the start of the buffer.
-    memcpy(r1_, r3_, sizeof(*input_buffer_.get()) * kKernelSize);
+    for (int ch = 0; ch < channels_; ++ch) {
+      memcpy(r1_ + ch * channel_stride_, r3_ + ch * channel_stride_,
+             sizeof(*input_buffer_.get()) * kKernelSize);
+    }
 
     // Step (4) -- Reinitialize regions if necessary.
     if (r0_ == r2_)
       UpdateRegions(true);
 
     // Step (5) -- Refresh the buffer with more input.
-    read_cb_.Run(request_frames_, r0_);
+    ReadInput();
   }
 }
 
@@ -306,7 +509,7 @@ void SincResampler::Flush() {
   virtual_source_idx_ = 0;
   buffer_primed_ = false;
   memset(input_buffer_.get(), 0,
-         sizeof(*input_buffer_.get()) * input_buffer_size_);
+         sizeof(*input_buffer_.get()) * channel_stride_ * channels_);
   UpdateRegions(false);
 }
 
@@ -333,6 +536,35 @@ float SincResampler::Convolve_C(const float* input_ptr, const float* k1,
       kernel_interpolation_factor * sum2);
 }
 
+void SincResampler::Convolve2_C(const float* input_ptr0,
+                                const float* input_ptr1,
+                                const float* k1,
+                                const float* k2,
+                                double kernel_interpolation_factor,
+                                float* result0,
+                                float* result1) {
+  float sum1_0 = 0;
+  float sum2_0 = 0;
+  float sum1_1 = 0;
+  float sum2_1 = 0;
+
+  int n = kKernelSize;
+  while (n--) {
+    const float k1_value = *k1++;
+    const float k2_value = *k2++;
+    sum1_0 += *input_ptr0 * k1_value;
+    sum2_0 += *input_ptr0++ * k2_value;
+    sum1_1 += *input_ptr1 * k1_value;
+    sum2_1 += *input_ptr1++ * k2_value;
+  }
+
+  // Linearly interpolate the two "convolutions" of each channel.
+  *result0 = static_cast<float>((1.0 - kernel_interpolation_factor) * sum1_0 +
+                                kernel_interpolation_factor * sum2_0);
+  *result1 = static_cast<float>((1.0 - kernel_interpolation_factor) * sum1_1 +
+                                kernel_interpolation_factor * sum2_1);
+}
+
 #if defined(ARCH_CPU_X86_FAMILY)
 float SincResampler::Convolve_SSE(const float* input_ptr, const float* k1,
                                   const float* k2,
@@ -372,6 +604,70 @@ float SincResampler::Convolve_SSE(const float* input_ptr, const float* k1,
 
   return result;
 }
+
+void SincResampler::Convolve2_SSE(const float* input_ptr0,
+                                  const float* input_ptr1,
+                                  const float* k1,
+                                  const float* k2,
+                                  double kernel_interpolation_factor,
+                                  float* result0,
+                                  float* result1) {
+  DCHECK_EQ(reinterpret_cast<uintptr_t>(input_ptr0) & 0x0F,
+            reinterpret_cast<uintptr_t>(input_ptr1) & 0x0F);
+
+  __m128 m_k1;
+  __m128 m_k2;
+  __m128 m_input0;
+  __m128 m_input1;
+  __m128 m_sums1_0 = _mm_setzero_ps();
+  __m128 m_sums2_0 = _mm_setzero_ps();
+  __m128 m_sums1_1 = _mm_setzero_ps();
+  __m128 m_sums2_1 = _mm_setzero_ps();
+
+  // Based on |input_ptr0| alignment, we need to use loadu or load.  Both
+  // channels share the alignment of the first.
+  if (reinterpret_cast<uintptr_t>(input_ptr0) & 0x0F) {
+    for (int i = 0; i < kKernelSize; i += 4) {
+      m_k1 = _mm_load_ps(k1 + i);
+      m_k2 = _mm_load_ps(k2 + i);
+      m_input0 = _mm_loadu_ps(input_ptr0 + i);
+      m_input1 = _mm_loadu_ps(input_ptr1 + i);
+      m_sums1_0 = _mm_add_ps(m_sums1_0, _mm_mul_ps(m_input0, m_k1));
+      m_sums2_0 = _mm_add_ps(m_sums2_0, _mm_mul_ps(m_input0, m_k2));
+      m_sums1_1 = _mm_add_ps(m_sums1_1, _mm_mul_ps(m_input1, m_k1));
+      m_sums2_1 = _mm_add_ps(m_sums2_1, _mm_mul_ps(m_input1, m_k2));
+    }
+  } else {
+    for (int i = 0; i < kKernelSize; i += 4) {
+      m_k1 = _mm_load_ps(k1 + i);
+      m_k2 = _mm_load_ps(k2 + i);
+      m_input0 = _mm_load_ps(input_ptr0 + i);
+      m_input1 = _mm_load_ps(input_ptr1 + i);
+      m_sums1_0 = _mm_add_ps(m_sums1_0, _mm_mul_ps(m_input0, m_k1));
+      m_sums2_0 = _mm_add_ps(m_sums2_0, _mm_mul_ps(m_input0, m_k2));
+      m_sums1_1 = _mm_add_ps(m_sums1_1, _mm_mul_ps(m_input1, m_k1));
+      m_sums2_1 = _mm_add_ps(m_sums2_1, _mm_mul_ps(m_input1, m_k2));
+    }
+  }
+
+  // Linearly interpolate the two "convolutions" of each channel.
+  const __m128 m_weight1 =
+      _mm_set_ps1(static_cast<float>(1.0 - kernel_interpolation_factor));
+  const __m128 m_weight2 =
+      _mm_set_ps1(static_cast<float>(kernel_interpolation_factor));
+  m_sums1_0 = _mm_add_ps(_mm_mul_ps(m_sums1_0, m_weight1),
+                         _mm_mul_ps(m_sums2_0, m_weight2));
+  m_sums1_1 = _mm_add_ps(_mm_mul_ps(m_sums1_1, m_weight1),
+                         _mm_mul_ps(m_sums2_1, m_weight2));
+
+  // Sum components together.
+  m_sums2_0 = _mm_add_ps(_mm_movehl_ps(m_sums1_0, m_sums1_0), m_sums1_0);
+  _mm_store_ss(result0, _mm_add_ss(m_sums2_0, _mm_shuffle_ps(
+      m_sums2_0, m_sums2_0, 1)));
+  m_sums2_1 = _mm_add_ps(_mm_movehl_ps(m_sums1_1, m_sums1_1), m_sums1_1);
+  _mm_store_ss(result1, _mm_add_ss(m_sums2_1, _mm_shuffle_ps(
+      m_sums2_1, m_sums2_1, 1)));
+}
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 float SincResampler::Convolve_NEON(const float* input_ptr, const float* k1,
                                    const float* k2,
@@ -399,6 +695,49 @@ float SincResampler::Convolve_NEON(const float* input_ptr, const float* k1,
   float32x2_t m_half = vadd_f32(vget_high_f32(m_sums1), vget_low_f32(m_sums1));
   return vget_lane_f32(vpadd_f32(m_half, m_half), 0);
 }
+
+void SincResampler::Convolve2_NEON(const float* input_ptr0,
+                                   const float* input_ptr1,
+                                   const float* k1,
+                                   const float* k2,
+                                   double kernel_interpolation_factor,
+                                   float* result0,
+                                   float* result1) {
+  float32x4_t m_k1;
+  float32x4_t m_k2;
+  float32x4_t m_input0;
+  float32x4_t m_input1;
+  float32x4_t m_sums1_0 = vmovq_n_f32(0);
+  float32x4_t m_sums2_0 = vmovq_n_f32(0);
+  float32x4_t m_sums1_1 = vmovq_n_f32(0);
+  float32x4_t m_sums2_1 = vmovq_n_f32(0);
+
+  for (int i = 0; i < kKernelSize; i += 4) {
+    m_k1 = vld1q_f32(k1 + i);
+    m_k2 = vld1q_f32(k2 + i);
+    m_input0 = vld1q_f32(input_ptr0 + i);
+    m_input1 = vld1q_f32(input_ptr1 + i);
+    m_sums1_0 = vmlaq_f32(m_sums1_0, m_input0, m_k1);
+    m_sums2_0 = vmlaq_f32(m_sums2_0, m_input0, m_k2);
+    m_sums1_1 = vmlaq_f32(m_sums1_1, m_input1, m_k1);
+    m_sums2_1 = vmlaq_f32(m_sums2_1, m_input1, m_k2);
+  }
+
+  // Linearly interpolate the two "convolutions" of each channel.
+  const float32x4_t m_weight1 = vmovq_n_f32(1.0 - kernel_interpolation_factor);
+  const float32x4_t m_weight2 = vmovq_n_f32(kernel_interpolation_factor);
+  m_sums1_0 =
+      vmlaq_f32(vmulq_f32(m_sums1_0, m_weight1), m_sums2_0, m_weight2);
+  m_sums1_1 =
+      vmlaq_f32(vmulq_f32(m_sums1_1, m_weight1), m_sums2_1, m_weight2);
+
+  // Sum components together.
+  float32x2_t m_half =
+      vadd_f32(vget_high_f32(m_sums1_0), vget_low_f32(m_sums1_0));
+  *result0 = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+  m_half = vadd_f32(vget_high_f32(m_sums1_1), vget_low_f32(m_sums1_1));
+  *result1 = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+}
 #endif
 
 }  // namespace media
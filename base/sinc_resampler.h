@@ -11,12 +11,17 @@
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
+#include "base/memory/ref_counted.h"
 #include "build/build_config.h"
 #include "media/base/media_export.h"
 
 namespace media {
+class AudioBus;
 
-// SincResampler is a high-quality single-channel sample-rate converter.
+// SincResampler is a high-quality sample-rate converter.  It resamples either a
+// single channel or several planar channels in lock step; in the latter case
+// every channel shares the kernel lookups, interpolation factors and input
+// requests, which is considerably cheaper than one resampler per channel.
 class MEDIA_EXPORT SincResampler {
  public:
   enum {
@@ -41,6 +46,13 @@ class MEDIA_EXPORT SincResampler {
   // are available to satisfy the request.
   typedef base::Callback<void(int frames, float* destination)> ReadCB;
 
+  // Callback type for providing more data into a multi-channel resampler.
+  // Expects |frames| of data to be rendered into every channel of
+  // |destination|; zero padded if not enough frames are available to satisfy
+  // the request.
+  typedef base::Callback<void(int frames, AudioBus* destination)>
+      MultiChannelReadCB;
+
   // Constructs a SincResampler with the specified |read_cb|, which is used to
   // acquire audio data for resampling.  |io_sample_rate_ratio| is the ratio
   // of input / output sample rates.  |request_frames| controls the size in
@@ -50,11 +62,26 @@ class MEDIA_EXPORT SincResampler {
   SincResampler(double io_sample_rate_ratio,
                 int request_frames,
                 const ReadCB& read_cb);
+
+  // Constructs a SincResampler which resamples |channels| planar channels at
+  // once.  |read_cb| is run once per request to fill all channels.  Otherwise
+  // identical to the single channel constructor above.
+  SincResampler(int channels,
+                double io_sample_rate_ratio,
+                int request_frames,
+                const MultiChannelReadCB& read_cb);
   ~SincResampler();
 
-  // Resample |frames| of data from |read_cb_| into |destination|.
+  // Resample |frames| of data from |read_cb_| into |destination|.  Only valid
+  // for single channel resamplers.
   void Resample(int frames, float* destination);
 
+  // Resample |frames| of data for every channel into |destinations|, which
+  // must contain channels() pointers to at least |frames| floats each.
+  void ResampleChannels(int frames, float* const* destinations);
+
+  int channels() const { return channels_; }
+
   // The maximum size in frames that guarantees Resample() will only make a
   // single call to |read_cb_| for more data.  Note: If PrimeWithSilence() is
   // not called, chunk size will grow after the first two Resample() calls by
@@ -72,11 +99,16 @@ class MEDIA_EXPORT SincResampler {
   void Flush();
 
   // Update |io_sample_rate_ratio_|.  SetRatio() will cause a reconstruction of
-  // the kernels used for resampling.  Not thread safe, do not call while
-  // Resample() is in progress.
+  // the kernels used for resampling unless another resampler already uses
+  // kernels for the new ratio.  Not thread safe, do not call while Resample()
+  // is in progress.
   void SetRatio(double io_sample_rate_ratio);
 
-  float* get_kernel_for_testing() { return kernel_storage_.get(); }
+  const float* get_kernel_for_testing() const { return kernel_; }
+
+  // Kernels are immutable once built and shared between every SincResampler
+  // using the same ratio through a small process-wide cache.
+  class SharedKernel;
 
   // Return number of input frames consumed by a callback but not yet processed.
   // Since input/output ratio can be fractional, so can this value.
@@ -85,13 +117,22 @@ class MEDIA_EXPORT SincResampler {
 
  private:
   FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve);
+  FRIEND_TEST_ALL_PREFIXES(SincResamplerTest, Convolve2);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerPerfTest, Convolve_unoptimized_aligned);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerPerfTest, Convolve_optimized_aligned);
   FRIEND_TEST_ALL_PREFIXES(SincResamplerPerfTest, Convolve_optimized_unaligned);
 
-  void InitializeKernel();
+  SincResampler(int channels,
+                double io_sample_rate_ratio,
+                int request_frames,
+                const ReadCB& read_cb,
+                const MultiChannelReadCB& multi_channel_read_cb);
+
   void UpdateRegions(bool second_load);
 
+  // Fills region r0_ of every channel with |request_frames_| of new input.
+  void ReadInput();
+
   // Compute convolution of |k1| and |k2| over |input_ptr|, resultant sums are
   // linearly interpolated using |kernel_interpolation_factor|.  On x86, the
   // underlying implementation is chosen at run time based on SSE support.  On
@@ -108,6 +149,38 @@ class MEDIA_EXPORT SincResampler {
                              double kernel_interpolation_factor);
 #endif
 
+  // Same as Convolve_*() above, but convolves two channels against the same
+  // pair of kernels so each kernel element is only loaded once.  Results are
+  // bit identical to two Convolve_*() calls.  |input_ptr0| and |input_ptr1|
+  // must share the same alignment.
+  static void Convolve2_C(const float* input_ptr0,
+                          const float* input_ptr1,
+                          const float* k1,
+                          const float* k2,
+                          double kernel_interpolation_factor,
+                          float* result0,
+                          float* result1);
+#if defined(ARCH_CPU_X86_FAMILY)
+  static void Convolve2_SSE(const float* input_ptr0,
+                            const float* input_ptr1,
+                            const float* k1,
+                            const float* k2,
+                            double kernel_interpolation_factor,
+                            float* result0,
+                            float* result1);
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  static void Convolve2_NEON(const float* input_ptr0,
+                             const float* input_ptr1,
+                             const float* k1,
+                             const float* k2,
+                             double kernel_interpolation_factor,
+                             float* result0,
+                             float* result1);
+#endif
+
+  // The number of planar channels resampled together.
+  const int channels_;
+
   // The ratio of input / output sample rates.
   double io_sample_rate_ratio_;
 
@@ -118,8 +191,10 @@ class MEDIA_EXPORT SincResampler {
   // The buffer is primed once at the very beginning of processing.
   bool buffer_primed_;
 
-  // Source of data for resampling.
+  // Source of data for resampling.  Exactly one of these is set, depending on
+  // which constructor was used.
   const ReadCB read_cb_;
+  const MultiChannelReadCB multi_channel_read_cb_;
 
   // The size (in samples) to request from each |read_cb_| execution.
   const int request_frames_;
@@ -134,18 +209,34 @@ class MEDIA_EXPORT SincResampler {
   // The size (in samples) of the internal buffer used by the resampler.
   const int input_buffer_size_;
 
+  // Distance (in samples) between the start of consecutive channels within
+  // |input_buffer_|.  Rounded up from |input_buffer_size_| so every channel
+  // has the same alignment as the first.
+  const int channel_stride_;
+
+  // The shared kernels for |io_sample_rate_ratio_|, or nullptr if SetRatio()
+  // had to build them into |kernel_storage_|.
+  scoped_refptr<SharedKernel> shared_kernel_;
+
+  // Private kernel storage, only allocated once SetRatio() selects a ratio no
+  // other resampler has built kernels for.
+  std::unique_ptr<float[], base::AlignedFreeDeleter> kernel_storage_;
+
   // Contains kKernelOffsetCount kernels back-to-back, each of size kKernelSize.
   // The kernel offsets are sub-sample shifts of a windowed sinc shifted from
-  // 0.0 to 1.0 sample.
-  std::unique_ptr<float[], base::AlignedFreeDeleter> kernel_storage_;
-  std::unique_ptr<float[], base::AlignedFreeDeleter> kernel_pre_sinc_storage_;
-  std::unique_ptr<float[], base::AlignedFreeDeleter> kernel_window_storage_;
+  // 0.0 to 1.0 sample.  Points into |shared_kernel_| or |kernel_storage_|.
+  const float* kernel_;
 
   // Data from the source is copied into this buffer for each processing pass.
+  // Channels are stored back-to-back, |channel_stride_| samples apart.
   std::unique_ptr<float[], base::AlignedFreeDeleter> input_buffer_;
 
-  // Pointers to the various regions inside |input_buffer_|.  See the diagram at
-  // the top of the .cc file for more information.
+  // Wraps region r0_ of every channel for |multi_channel_read_cb_|.
+  std::unique_ptr<AudioBus> input_bus_;
+
+  // Pointers to the various regions inside the first channel of
+  // |input_buffer_|; channel N's regions are |channel_stride_| * N further on.
+  // See the diagram at the top of the .cc file for more information.
   float* r0_;
   float* const r1_;
   float* const r2_;
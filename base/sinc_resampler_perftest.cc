@@ -2,10 +2,15 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <memory>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/bind_helpers.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
+#include "media/base/audio_bus.h"
 #include "media/base/sinc_resampler.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -67,4 +72,65 @@ TEST(SincResamplerPerfTest, Convolve_optimized_unaligned) {
 
 #undef CONVOLVE_FUNC
 
+static const int kMultiChannelBenchmarkIterations = 20000;
+static const int kMultiChannelBenchmarkFrames = 512;
+
+// Compares one SincResampler per channel, which is how MultiChannelResampler
+// used to work, against a single multi-channel SincResampler.
+static void RunMultiChannelBenchmark(int channels) {
+  std::unique_ptr<AudioBus> output =
+      AudioBus::Create(channels, kMultiChannelBenchmarkFrames);
+
+  std::vector<std::unique_ptr<SincResampler>> resamplers;
+  for (int ch = 0; ch < channels; ++ch) {
+    resamplers.push_back(std::make_unique<SincResampler>(
+        kSampleRateRatio, SincResampler::kDefaultRequestSize,
+        base::DoNothing()));
+  }
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kMultiChannelBenchmarkIterations; ++i) {
+    for (int ch = 0; ch < channels; ++ch)
+      resamplers[ch]->Resample(output->frames(), output->channel(ch));
+  }
+  double total_time_milliseconds =
+      (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult(
+      "sinc_resampler_multichannel", "",
+      "per_channel_" + base::IntToString(channels),
+      kMultiChannelBenchmarkIterations / total_time_milliseconds, "runs/ms",
+      true);
+
+  SincResampler multi_channel_resampler(channels, kSampleRateRatio,
+                                        SincResampler::kDefaultRequestSize,
+                                        base::DoNothing());
+  std::vector<float*> destinations(channels);
+  for (int ch = 0; ch < channels; ++ch)
+    destinations[ch] = output->channel(ch);
+
+  start = base::TimeTicks::Now();
+  for (int i = 0; i < kMultiChannelBenchmarkIterations; ++i) {
+    multi_channel_resampler.ResampleChannels(output->frames(),
+                                             destinations.data());
+  }
+  total_time_milliseconds = (base::TimeTicks::Now() - start).InMillisecondsF();
+  perf_test::PrintResult(
+      "sinc_resampler_multichannel", "",
+      "batched_" + base::IntToString(channels),
+      kMultiChannelBenchmarkIterations / total_time_milliseconds, "runs/ms",
+      true);
+}
+
+TEST(SincResamplerPerfTest, MultiChannel_Stereo) {
+  RunMultiChannelBenchmark(2);
+}
+
+TEST(SincResamplerPerfTest, MultiChannel_5_1) {
+  RunMultiChannelBenchmark(6);
+}
+
+TEST(SincResamplerPerfTest, MultiChannel_7_1) {
+  RunMultiChannelBenchmark(8);
+}
+
 } // namespace media
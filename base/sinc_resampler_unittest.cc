@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/bind_helpers.h"
@@ -11,6 +12,7 @@
 #include "base/strings/string_number_conversions.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
+#include "media/base/audio_bus.h"
 #include "media/base/sinc_resampler.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -176,24 +178,179 @@ TEST(SincResamplerTest, Convolve) {
   // Use a kernel from SincResampler as input and kernel data, this has the
   // benefit of already being properly sized and aligned for Convolve_SSE().
   double result = resampler.Convolve_C(
-      resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.get_kernel_for_testing(), resampler.get_kernel_for_testing(),
+      resampler.get_kernel_for_testing(), kKernelInterpolationFactor);
   double result2 = resampler.CONVOLVE_FUNC(
-      resampler.kernel_storage_.get(), resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.get_kernel_for_testing(), resampler.get_kernel_for_testing(),
+      resampler.get_kernel_for_testing(), kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
 
   // Test Convolve() w/ unaligned input pointer.
   result = resampler.Convolve_C(
-      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.get_kernel_for_testing() + 1, resampler.get_kernel_for_testing(),
+      resampler.get_kernel_for_testing(), kKernelInterpolationFactor);
   result2 = resampler.CONVOLVE_FUNC(
-      resampler.kernel_storage_.get() + 1, resampler.kernel_storage_.get(),
-      resampler.kernel_storage_.get(), kKernelInterpolationFactor);
+      resampler.get_kernel_for_testing() + 1, resampler.get_kernel_for_testing(),
+      resampler.get_kernel_for_testing(), kKernelInterpolationFactor);
   EXPECT_NEAR(result2, result, kEpsilon);
 }
 #endif
 
+// Ensure Convolve2_*() matches two single channel Convolve_*() calls exactly,
+// for both aligned and unaligned input.
+TEST(SincResamplerTest, Convolve2) {
+  MockSource mock_source;
+  SincResampler resampler(
+      kSampleRateRatio, SincResampler::kDefaultRequestSize,
+      base::Bind(&MockSource::ProvideInput, base::Unretained(&mock_source)));
+
+  const float* k1 = resampler.get_kernel_for_testing();
+  const float* k2 = k1 + SincResampler::kKernelSize;
+  for (int offset = 0; offset < 2; ++offset) {
+    SCOPED_TRACE(offset ? "unaligned" : "aligned");
+    const float* input0 = k1 + offset;
+    const float* input1 = k1 + 4 * SincResampler::kKernelSize + offset;
+
+    float result0;
+    float result1;
+    resampler.Convolve2_C(input0, input1, k1, k2, 0.25, &result0, &result1);
+    EXPECT_EQ(resampler.Convolve_C(input0, k1, k2, 0.25), result0);
+    EXPECT_EQ(resampler.Convolve_C(input1, k1, k2, 0.25), result1);
+
+#if defined(ARCH_CPU_X86_FAMILY)
+    resampler.Convolve2_SSE(input0, input1, k1, k2, 0.25, &result0, &result1);
+    EXPECT_EQ(resampler.Convolve_SSE(input0, k1, k2, 0.25), result0);
+    EXPECT_EQ(resampler.Convolve_SSE(input1, k1, k2, 0.25), result1);
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+    resampler.Convolve2_NEON(input0, input1, k1, k2, 0.25, &result0, &result1);
+    EXPECT_EQ(resampler.Convolve_NEON(input0, k1, k2, 0.25), result0);
+    EXPECT_EQ(resampler.Convolve_NEON(input1, k1, k2, 0.25), result1);
+#endif
+  }
+}
+
+// Verify resamplers with the same effective ratio share kernel storage, and
+// that sharing does not change the kernels themselves.
+TEST(SincResamplerTest, SharedKernels) {
+  SincResampler resampler_a(48000.0 / 44100.0,
+                            SincResampler::kDefaultRequestSize,
+                            base::DoNothing());
+  SincResampler resampler_b(48000.0 / 44100.0, 128, base::DoNothing());
+  EXPECT_EQ(resampler_a.get_kernel_for_testing(),
+            resampler_b.get_kernel_for_testing());
+
+  // All upsampling ratios use the same kernels.
+  SincResampler upsampler_a(44100.0 / 48000.0,
+                            SincResampler::kDefaultRequestSize,
+                            base::DoNothing());
+  SincResampler upsampler_b(16000.0 / 48000.0,
+                            SincResampler::kDefaultRequestSize,
+                            base::DoNothing());
+  EXPECT_EQ(upsampler_a.get_kernel_for_testing(),
+            upsampler_b.get_kernel_for_testing());
+  EXPECT_NE(resampler_a.get_kernel_for_testing(),
+            upsampler_a.get_kernel_for_testing());
+
+  // SetRatio() to a ratio nobody has built kernels for must produce the same
+  // kernels as constructing a resampler with that ratio, and must not affect
+  // other resamplers sharing the original kernels.
+  std::unique_ptr<float[]> kernel(new float[SincResampler::kKernelStorageSize]);
+  memcpy(kernel.get(), resampler_b.get_kernel_for_testing(),
+         sizeof(float) * SincResampler::kKernelStorageSize);
+  const double kUncommonRatio = 48000.0 / 44099.0;
+  resampler_a.SetRatio(kUncommonRatio);
+  EXPECT_NE(resampler_a.get_kernel_for_testing(),
+            resampler_b.get_kernel_for_testing());
+  EXPECT_EQ(0, memcmp(kernel.get(), resampler_b.get_kernel_for_testing(),
+                      sizeof(float) * SincResampler::kKernelStorageSize));
+
+  SincResampler uncommon_resampler(
+      kUncommonRatio, SincResampler::kDefaultRequestSize, base::DoNothing());
+  EXPECT_EQ(0, memcmp(uncommon_resampler.get_kernel_for_testing(),
+                      resampler_a.get_kernel_for_testing(),
+                      sizeof(float) * SincResampler::kKernelStorageSize));
+
+  // Switching back picks the shared kernels up again.
+  resampler_a.SetRatio(48000.0 / 44100.0);
+  EXPECT_EQ(resampler_a.get_kernel_for_testing(),
+            resampler_b.get_kernel_for_testing());
+}
+
+// Provides a distinct ramp per channel so channel mixups are detectable.
+class MultiChannelRampSource {
+ public:
+  explicit MultiChannelRampSource(int channels)
+      : channels_(channels), frames_provided_(0) {}
+
+  void ProvideChannel(int channel, int frames, float* destination) {
+    for (int i = 0; i < frames; ++i)
+      destination[i] = Value(channel, channel_frames_[channel] + i);
+    channel_frames_[channel] += frames;
+  }
+
+  void ProvideInput(int frames, AudioBus* destination) {
+    ASSERT_EQ(channels_, destination->channels());
+    ASSERT_EQ(frames, destination->frames());
+    for (int ch = 0; ch < channels_; ++ch) {
+      for (int i = 0; i < frames; ++i)
+        destination->channel(ch)[i] = Value(ch, frames_provided_ + i);
+    }
+    frames_provided_ += frames;
+  }
+
+ private:
+  static float Value(int channel, int frame) {
+    return sin((channel + 1) * 0.01 * frame);
+  }
+
+  const int channels_;
+  int frames_provided_;
+  int channel_frames_[8] = {};
+
+  DISALLOW_COPY_AND_ASSIGN(MultiChannelRampSource);
+};
+
+// Verify a multi-channel SincResampler matches independent single channel
+// resamplers exactly, for both even and odd channel counts.
+TEST(SincResamplerTest, MultiChannelMatchesSingleChannel) {
+  static const int kFrames = 1000;
+  static const int kIterations = 8;
+  for (int channels = 1; channels <= 8; ++channels) {
+    SCOPED_TRACE(channels);
+    MultiChannelRampSource single_source(channels);
+    MultiChannelRampSource multi_source(channels);
+
+    std::vector<std::unique_ptr<SincResampler>> single_resamplers;
+    for (int ch = 0; ch < channels; ++ch) {
+      single_resamplers.push_back(std::make_unique<SincResampler>(
+          kSampleRateRatio, 441,
+          base::Bind(&MultiChannelRampSource::ProvideChannel,
+                     base::Unretained(&single_source), ch)));
+    }
+    SincResampler multi_resampler(
+        channels, kSampleRateRatio, 441,
+        base::Bind(&MultiChannelRampSource::ProvideInput,
+                   base::Unretained(&multi_source)));
+
+    std::unique_ptr<AudioBus> single_bus = AudioBus::Create(channels, kFrames);
+    std::unique_ptr<AudioBus> multi_bus = AudioBus::Create(channels, kFrames);
+    std::vector<float*> destinations(channels);
+    for (int ch = 0; ch < channels; ++ch)
+      destinations[ch] = multi_bus->channel(ch);
+
+    for (int i = 0; i < kIterations; ++i) {
+      for (int ch = 0; ch < channels; ++ch)
+        single_resamplers[ch]->Resample(kFrames, single_bus->channel(ch));
+      multi_resampler.ResampleChannels(kFrames, destinations.data());
+
+      for (int ch = 0; ch < channels; ++ch) {
+        ASSERT_EQ(0, memcmp(single_bus->channel(ch), multi_bus->channel(ch),
+                            sizeof(float) * kFrames));
+      }
+    }
+  }
+}
+
 // Fake audio source for testing the resampler.  Generates a sinusoidal linear
 // chirp (http://en.wikipedia.org/wiki/Chirp) which can be tuned to stress the
 // resampler for the specific sample rate conversion being used.
@@ -5,6 +5,7 @@
 #include "media/base/stream_parser_buffer.h"
 
 #include <algorithm>
+#include <utility>
 
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
@@ -40,6 +41,17 @@ scoped_refptr<StreamParserBuffer> StreamParserBuffer::CopyFrom(
                              is_key_frame, type, track_id));
 }
 
+scoped_refptr<StreamParserBuffer> StreamParserBuffer::FromSegment(
+    scoped_refptr<SegmentBuffer> segment,
+    const uint8_t* data,
+    int data_size,
+    bool is_key_frame,
+    Type type,
+    TrackId track_id) {
+  return base::WrapRefCounted(new StreamParserBuffer(
+      std::move(segment), data, data_size, is_key_frame, type, track_id));
+}
+
 DecodeTimestamp StreamParserBuffer::GetDecodeTimestamp() const {
   if (decode_timestamp_ == kNoDecodeTimestamp())
     return DecodeTimestamp::FromPresentationTime(timestamp());
@@ -76,6 +88,23 @@ StreamParserBuffer::StreamParserBuffer(const uint8_t* data,
     set_is_key_frame(true);
 }
 
+StreamParserBuffer::StreamParserBuffer(scoped_refptr<SegmentBuffer> segment,
+                                       const uint8_t* data,
+                                       int data_size,
+                                       bool is_key_frame,
+                                       Type type,
+                                       TrackId track_id)
+    : DecoderBuffer(std::move(segment), data, data_size),
+      decode_timestamp_(kNoDecodeTimestamp()),
+      config_id_(kInvalidConfigId),
+      type_(type),
+      track_id_(track_id),
+      is_duration_estimated_(false) {
+  set_duration(kNoTimestamp);
+  if (is_key_frame)
+    set_is_key_frame(true);
+}
+
 StreamParserBuffer::~StreamParserBuffer() = default;
 
 int StreamParserBuffer::GetConfigId() const {
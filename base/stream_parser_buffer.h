@@ -123,6 +123,19 @@ class MEDIA_EXPORT StreamParserBuffer : public DecoderBuffer {
                                                     Type type,
                                                     TrackId track_id);
 
+  // Creates a buffer whose data is the |data_size| bytes at |data| within
+  // |segment|, which it keeps alive instead of copying them. SourceBufferStream
+  // counts all of |segment| towards its memory limit for as long as any of its
+  // slices remain buffered, so parsers should slice segments which hold little
+  // else.
+  static scoped_refptr<StreamParserBuffer> FromSegment(
+      scoped_refptr<SegmentBuffer> segment,
+      const uint8_t* data,
+      int data_size,
+      bool is_key_frame,
+      Type type,
+      TrackId track_id);
+
   // Decode timestamp. If not explicitly set, or set to kNoTimestamp, the
   // value will be taken from the normal timestamp.
   DecodeTimestamp GetDecodeTimestamp() const;
@@ -170,6 +183,12 @@ class MEDIA_EXPORT StreamParserBuffer : public DecoderBuffer {
                      bool is_key_frame,
                      Type type,
                      TrackId track_id);
+  StreamParserBuffer(scoped_refptr<SegmentBuffer> segment,
+                     const uint8_t* data,
+                     int data_size,
+                     bool is_key_frame,
+                     Type type,
+                     TrackId track_id);
   ~StreamParserBuffer() override;
 
   DecodeTimestamp decode_timestamp_;
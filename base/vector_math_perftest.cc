@@ -56,6 +56,23 @@ class VectorMathPerfTest : public testing::Test {
                            true);
   }
 
+  void RunBenchmark(void (*fn)(const float[], int, float[]),
+                    int len,
+                    const std::string& test_name,
+                    const std::string& trace_name) {
+    TimeTicks start = TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i)
+      fn(input_vector_.get(), len, output_vector_.get());
+    double total_time_milliseconds =
+        (TimeTicks::Now() - start).InMillisecondsF();
+    perf_test::PrintResult(test_name,
+                           "",
+                           trace_name,
+                           kBenchmarkIterations / total_time_milliseconds,
+                           "runs/ms",
+                           true);
+  }
+
   void RunBenchmark(
       std::pair<float, float> (*fn)(float, const float[], int, float),
       int len,
@@ -174,4 +191,69 @@ TEST_F(VectorMathPerfTest, EWMAAndMaxPower_optimized_aligned) {
 }
 #endif
 
+#if defined(ARCH_CPU_X86_FAMILY)
+// Benchmarks for the runtime-dispatched AVX2/FMA tier.  These are skipped on
+// hosts without AVX2 support.
+TEST_F(VectorMathPerfTest, FMAC_avx2_unaligned) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(
+      vector_math::FMAC_AVX2, false, "vector_math_fmac", "avx2_unaligned");
+}
+
+TEST_F(VectorMathPerfTest, FMAC_avx2_aligned) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(
+      vector_math::FMAC_AVX2, true, "vector_math_fmac", "avx2_aligned");
+}
+
+TEST_F(VectorMathPerfTest, FMUL_avx2_unaligned) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(
+      vector_math::FMUL_AVX2, false, "vector_math_fmul", "avx2_unaligned");
+}
+
+TEST_F(VectorMathPerfTest, FMUL_avx2_aligned) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(
+      vector_math::FMUL_AVX2, true, "vector_math_fmul", "avx2_aligned");
+}
+
+TEST_F(VectorMathPerfTest, EWMAAndMaxPower_avx2_unaligned) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(vector_math::EWMAAndMaxPower_AVX2,
+               kVectorSize - 1,
+               "vector_math_ewma_and_max_power",
+               "avx2_unaligned");
+}
+
+TEST_F(VectorMathPerfTest, EWMAAndMaxPower_avx2_aligned) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(vector_math::EWMAAndMaxPower_AVX2,
+               kVectorSize,
+               "vector_math_ewma_and_max_power",
+               "avx2_aligned");
+}
+#endif
+
+// Benchmarks for each vector_math::Crossfade() method.
+TEST_F(VectorMathPerfTest, Crossfade_unoptimized) {
+  RunBenchmark(vector_math::Crossfade_C, kVectorSize, "vector_math_crossfade",
+               "unoptimized");
+}
+
+#if defined(ARCH_CPU_X86_FAMILY)
+TEST_F(VectorMathPerfTest, Crossfade_avx2) {
+  if (!vector_math::CpuSupportsAVX2())
+    return;
+  RunBenchmark(vector_math::Crossfade_AVX2, kVectorSize,
+               "vector_math_crossfade", "avx2");
+}
+#endif
+
 } // namespace media
@@ -27,6 +27,7 @@ MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_C(
     const float src[],
     int len,
     float smoothing_factor);
+MEDIA_SHMEM_EXPORT void Crossfade_C(const float src[], int len, float dest[]);
 
 #if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
 MEDIA_SHMEM_EXPORT void FMAC_SSE(const float src[],
@@ -42,6 +43,27 @@ MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_SSE(
     const float src[],
     int len,
     float smoothing_factor);
+
+// Returns true if the AVX2/FMA versions below may be called on this CPU, i.e.
+// it supports both AVX2 and FMA3.  The public entry points in vector_math.h
+// use them automatically when it does.
+MEDIA_SHMEM_EXPORT bool CpuSupportsAVX2();
+MEDIA_SHMEM_EXPORT void FMAC_AVX2(const float src[],
+                                  float scale,
+                                  int len,
+                                  float dest[]);
+MEDIA_SHMEM_EXPORT void FMUL_AVX2(const float src[],
+                                  float scale,
+                                  int len,
+                                  float dest[]);
+MEDIA_SHMEM_EXPORT std::pair<float, float> EWMAAndMaxPower_AVX2(
+    float initial_value,
+    const float src[],
+    int len,
+    float smoothing_factor);
+MEDIA_SHMEM_EXPORT void Crossfade_AVX2(const float src[],
+                                       int len,
+                                       float dest[]);
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
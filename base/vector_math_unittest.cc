@@ -46,6 +46,13 @@ class VectorMathTest : public testing::Test {
       ASSERT_FLOAT_EQ(output_vector_[i], value);
   }
 
+  void VerifyCrossfadeOutput() {
+    for (int i = 0; i < kVectorSize; ++i) {
+      ASSERT_FLOAT_EQ(i / static_cast<float>(kVectorSize), output_vector_[i])
+          << "i=" << i;
+    }
+  }
+
  protected:
   std::unique_ptr<float[], base::AlignedFreeDeleter> input_vector_;
   std::unique_ptr<float[], base::AlignedFreeDeleter> output_vector_;
@@ -81,6 +88,14 @@ TEST_F(VectorMathTest, FMAC) {
         input_vector_.get(), kScale, kVectorSize, output_vector_.get());
     VerifyOutput(kResult);
   }
+
+  if (vector_math::CpuSupportsAVX2()) {
+    SCOPED_TRACE("FMAC_AVX2");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMAC_AVX2(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -122,6 +137,14 @@ TEST_F(VectorMathTest, FMUL) {
         input_vector_.get(), kScale, kVectorSize, output_vector_.get());
     VerifyOutput(kResult);
   }
+
+  if (vector_math::CpuSupportsAVX2()) {
+    SCOPED_TRACE("FMUL_AVX2");
+    FillTestVectors(kInputFillValue, kOutputFillValue);
+    vector_math::FMUL_AVX2(
+        input_vector_.get(), kScale, kVectorSize, output_vector_.get());
+    VerifyOutput(kResult);
+  }
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -136,13 +159,31 @@ TEST_F(VectorMathTest, FMUL) {
 }
 
 TEST_F(VectorMathTest, Crossfade) {
-  FillTestVectors(0, 1);
-  vector_math::Crossfade(
-      input_vector_.get(), kVectorSize, output_vector_.get());
-  for (int i = 0; i < kVectorSize; ++i) {
-    ASSERT_FLOAT_EQ(i / static_cast<float>(kVectorSize), output_vector_[i])
-        << "i=" << i;
+  {
+    SCOPED_TRACE("Crossfade");
+    FillTestVectors(0, 1);
+    vector_math::Crossfade(
+        input_vector_.get(), kVectorSize, output_vector_.get());
+    VerifyCrossfadeOutput();
+  }
+
+  {
+    SCOPED_TRACE("Crossfade_C");
+    FillTestVectors(0, 1);
+    vector_math::Crossfade_C(
+        input_vector_.get(), kVectorSize, output_vector_.get());
+    VerifyCrossfadeOutput();
+  }
+
+#if defined(ARCH_CPU_X86_FAMILY)
+  if (vector_math::CpuSupportsAVX2()) {
+    SCOPED_TRACE("Crossfade_AVX2");
+    FillTestVectors(0, 1);
+    vector_math::Crossfade_AVX2(
+        input_vector_.get(), kVectorSize, output_vector_.get());
+    VerifyCrossfadeOutput();
   }
+#endif
 }
 
 class EWMATestScenario {
@@ -230,6 +271,14 @@ class EWMATestScenario {
       EXPECT_NEAR(expected_final_avg_, result.first, 0.0000001f);
       EXPECT_NEAR(expected_max_, result.second, 0.0000001f);
     }
+
+    if (vector_math::CpuSupportsAVX2()) {
+      SCOPED_TRACE("EWMAAndMaxPower_AVX2");
+      const std::pair<float, float>& result = vector_math::EWMAAndMaxPower_AVX2(
+          initial_value_, data_.get(), data_len_, smoothing_factor_);
+      EXPECT_NEAR(expected_final_avg_, result.first, 0.0000001f);
+      EXPECT_NEAR(expected_max_, result.second, 0.0000001f);
+    }
 #endif
 
 #if defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
@@ -4,6 +4,11 @@
 
 #include "media/base/video_frame_pool.h"
 
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <tuple>
+
 #include "base/bind.h"
 #include "base/containers/circular_deque.h"
 #include "base/macros.h"
@@ -14,27 +19,54 @@
 
 namespace media {
 
+// static
+const size_t VideoFramePool::kDefaultMaxPooledBytes = 256 * 1024 * 1024;
+
+namespace {
+
+// Frames unused for longer than this are released from the pool.
+constexpr base::TimeDelta kStaleFrameLimit = base::TimeDelta::FromSeconds(10);
+
+// Bytes held by frames waiting in all pools of the process, and the limit.
+std::atomic<size_t> g_pooled_bytes(0);
+std::atomic<size_t> g_max_pooled_bytes(VideoFramePool::kDefaultMaxPooledBytes);
+
+}  // namespace
+
 class VideoFramePool::PoolImpl
     : public base::RefCountedThreadSafe<VideoFramePool::PoolImpl> {
  public:
   PoolImpl();
 
-  // See VideoFramePool::CreateFrame() for usage. Attempts to keep |frames_| in
-  // LRU order by always pulling from the back of |frames_|.
+  // See VideoFramePool::CreateFrame() for usage. Attempts to keep each bucket
+  // in LRU order by always pulling from the back of it.
   scoped_refptr<VideoFrame> CreateFrame(VideoPixelFormat format,
                                         const gfx::Size& coded_size,
                                         const gfx::Rect& visible_rect,
                                         const gfx::Size& natural_size,
                                         base::TimeDelta timestamp);
 
-  // Shuts down the frame pool and releases all frames in |frames_|.
+  // Shuts down the frame pool and releases all frames in |buckets_|.
   // Once this is called frames will no longer be inserted back into
-  // |frames_|.
+  // |buckets_|.
   void Shutdown();
 
+  void SetZeroInitializeFrames(bool zero_initialize) {
+    base::AutoLock auto_lock(lock_);
+    zero_initialize_frames_ = zero_initialize;
+  }
+
+  Stats GetStats() {
+    base::AutoLock auto_lock(lock_);
+    return stats_;
+  }
+
   size_t get_pool_size_for_testing() {
     base::AutoLock auto_lock(lock_);
-    return frames_.size();
+    size_t size = 0;
+    for (const auto& bucket : buckets_)
+      size += bucket.second.size();
+    return size;
   }
 
   void set_tick_clock_for_testing(const base::TickClock* tick_clock) {
@@ -45,22 +77,43 @@ class VideoFramePool::PoolImpl
   friend class base::RefCountedThreadSafe<VideoFramePool::PoolImpl>;
   ~PoolImpl();
 
-  // Called when the frame wrapper gets destroyed. |frame| is the actual frame
-  // that was wrapped and is placed in |frames_| by this function so it can be
-  // reused. This will attempt to expire frames that haven't been used in some
-  // time. It relies on |frames_| being in LRU order with the front being the
-  // least recently used entry.
-  void FrameReleased(scoped_refptr<VideoFrame> frame);
+  struct FrameKey {
+    bool operator<(const FrameKey& other) const {
+      return std::make_tuple(format, coded_size.width(), coded_size.height()) <
+             std::make_tuple(other.format, other.coded_size.width(),
+                             other.coded_size.height());
+    }
 
-  base::Lock lock_;
-  bool is_shutdown_ GUARDED_BY(lock_) = false;
+    VideoPixelFormat format;
+    gfx::Size coded_size;
+  };
 
   struct FrameEntry {
     base::TimeTicks last_use_time;
     scoped_refptr<VideoFrame> frame;
   };
 
-  base::circular_deque<FrameEntry> frames_ GUARDED_BY(lock_);
+  using Bucket = base::circular_deque<FrameEntry>;
+  using BucketMap = std::map<FrameKey, Bucket>;
+
+  // Called when the frame wrapper gets destroyed. |frame| is the actual frame
+  // that was wrapped and is placed in the bucket for |key| by this function so
+  // it can be reused. This will expire frames that haven't been used in some
+  // time and then evict the least recently used frames while over the byte
+  // budget. It relies on each bucket being in LRU order with the front being
+  // the least recently used entry.
+  void FrameReleased(const FrameKey& key, scoped_refptr<VideoFrame> frame);
+
+  // Releases the least recently used frame of |bucket|, which holds frames for
+  // |key|.  |lock_| must be held.
+  void EvictOldestFrame(const FrameKey& key, Bucket* bucket);
+
+  base::Lock lock_;
+  bool is_shutdown_ GUARDED_BY(lock_) = false;
+  bool zero_initialize_frames_ GUARDED_BY(lock_) = true;
+
+  BucketMap buckets_ GUARDED_BY(lock_);
+  Stats stats_ GUARDED_BY(lock_);
 
   // |tick_clock_| is always a DefaultTickClock outside of testing.
   const base::TickClock* tick_clock_;
@@ -81,28 +134,44 @@ scoped_refptr<VideoFrame> VideoFramePool::PoolImpl::CreateFrame(
     const gfx::Rect& visible_rect,
     const gfx::Size& natural_size,
     base::TimeDelta timestamp) {
-  base::AutoLock auto_lock(lock_);
-  DCHECK(!is_shutdown_);
-
+  const FrameKey key = {format, coded_size};
   scoped_refptr<VideoFrame> frame;
-  while (!frame && !frames_.empty()) {
-    scoped_refptr<VideoFrame> pool_frame = std::move(frames_.back().frame);
-    frames_.pop_back();
-
-    if (pool_frame->format() == format &&
-        pool_frame->coded_size() == coded_size &&
-        pool_frame->visible_rect() == visible_rect &&
-        pool_frame->natural_size() == natural_size) {
-      frame = pool_frame;
-      frame->set_timestamp(timestamp);
-      frame->metadata()->Clear();
-      break;
+  bool zero_initialize;
+  {
+    base::AutoLock auto_lock(lock_);
+    DCHECK(!is_shutdown_);
+
+    auto it = buckets_.find(key);
+    if (it != buckets_.end()) {
+      frame = std::move(it->second.back().frame);
+      it->second.pop_back();
+      if (it->second.empty())
+        buckets_.erase(it);
+
+      const size_t frame_bytes = VideoFrame::AllocationSize(format, coded_size);
+      stats_.pooled_bytes -= frame_bytes;
+      g_pooled_bytes -= frame_bytes;
+      ++stats_.hits;
+    } else {
+      ++stats_.misses;
     }
+    zero_initialize = zero_initialize_frames_;
   }
 
-  if (!frame) {
-    frame = VideoFrame::CreateZeroInitializedFrame(
-        format, coded_size, visible_rect, natural_size, timestamp);
+  // Frames are only ever accessed by one owner outside of |buckets_|, so the
+  // rest doesn't need |lock_|; in particular the allocation.
+  if (frame) {
+    frame->set_timestamp(timestamp);
+    frame->metadata()->Clear();
+  } else {
+    // Pooled frames cover their whole coded size; the wrapper below applies
+    // |visible_rect| and |natural_size| so they don't need to match on reuse.
+    const gfx::Rect coded_rect(coded_size);
+    frame = zero_initialize
+                ? VideoFrame::CreateZeroInitializedFrame(
+                      format, coded_size, coded_rect, coded_size, timestamp)
+                : VideoFrame::CreateFrame(format, coded_size, coded_rect,
+                                          coded_size, timestamp);
     // This can happen if the arguments are not valid.
     if (!frame) {
       LOG(ERROR) << "Failed to create a video frame";
@@ -111,37 +180,75 @@ scoped_refptr<VideoFrame> VideoFramePool::PoolImpl::CreateFrame(
   }
 
   scoped_refptr<VideoFrame> wrapped_frame = VideoFrame::WrapVideoFrame(
-      frame, frame->format(), frame->visible_rect(), frame->natural_size());
+      frame, frame->format(), visible_rect, natural_size);
+  if (!wrapped_frame) {
+    LOG(ERROR) << "Failed to wrap a video frame";
+    return nullptr;
+  }
   wrapped_frame->AddDestructionObserver(base::Bind(
-      &VideoFramePool::PoolImpl::FrameReleased, this, std::move(frame)));
+      &VideoFramePool::PoolImpl::FrameReleased, this, key, std::move(frame)));
   return wrapped_frame;
 }
 
 void VideoFramePool::PoolImpl::Shutdown() {
   base::AutoLock auto_lock(lock_);
   is_shutdown_ = true;
-  frames_.clear();
+  g_pooled_bytes -= stats_.pooled_bytes;
+  stats_.pooled_bytes = 0;
+  buckets_.clear();
 }
 
-void VideoFramePool::PoolImpl::FrameReleased(scoped_refptr<VideoFrame> frame) {
+void VideoFramePool::PoolImpl::FrameReleased(const FrameKey& key,
+                                             scoped_refptr<VideoFrame> frame) {
   base::AutoLock auto_lock(lock_);
   if (is_shutdown_)
     return;
 
+  // Keyed by the requested rather than the actual coded size, which may have
+  // been rounded up, so the next request for the same size finds it.
+  const size_t frame_bytes =
+      VideoFrame::AllocationSize(key.format, key.coded_size);
+  stats_.pooled_bytes += frame_bytes;
+  g_pooled_bytes += frame_bytes;
+
   const base::TimeTicks now = tick_clock_->NowTicks();
-  frames_.push_back({now, std::move(frame)});
-
-  // After this loop, |stale_index| is the index of the oldest non-stale frame.
-  // Such an index must exist because |frame| is never stale.
-  int stale_index = -1;
-  constexpr base::TimeDelta kStaleFrameLimit = base::TimeDelta::FromSeconds(10);
-  while (now - frames_[++stale_index].last_use_time > kStaleFrameLimit) {
-    // Last frame should never be included since we just added it.
-    DCHECK_LE(static_cast<size_t>(stale_index), frames_.size());
+  buckets_[key].push_back({now, std::move(frame)});
+
+  // Expire the frames of every bucket which haven't been used for a while.
+  // |frame| is never stale, so its bucket always survives this loop.
+  for (auto it = buckets_.begin(); it != buckets_.end();) {
+    Bucket& bucket = it->second;
+    while (!bucket.empty() &&
+           now - bucket.front().last_use_time > kStaleFrameLimit) {
+      EvictOldestFrame(it->first, &bucket);
+    }
+    it = bucket.empty() ? buckets_.erase(it) : std::next(it);
   }
 
-  if (stale_index)
-    frames_.erase(frames_.begin(), frames_.begin() + stale_index);
+  // Then evict the least recently used frames of this pool, possibly including
+  // |frame|, until all pools together are back within budget.
+  while (!buckets_.empty() && g_pooled_bytes > g_max_pooled_bytes) {
+    auto oldest = buckets_.begin();
+    for (auto it = buckets_.begin(); it != buckets_.end(); ++it) {
+      if (it->second.front().last_use_time <
+          oldest->second.front().last_use_time) {
+        oldest = it;
+      }
+    }
+    EvictOldestFrame(oldest->first, &oldest->second);
+    if (oldest->second.empty())
+      buckets_.erase(oldest);
+  }
+}
+
+void VideoFramePool::PoolImpl::EvictOldestFrame(const FrameKey& key,
+                                                Bucket* bucket) {
+  const size_t frame_bytes =
+      VideoFrame::AllocationSize(key.format, key.coded_size);
+  stats_.pooled_bytes -= frame_bytes;
+  g_pooled_bytes -= frame_bytes;
+  ++stats_.evictions;
+  bucket->pop_front();
 }
 
 VideoFramePool::VideoFramePool() : pool_(new PoolImpl()) {}
@@ -160,6 +267,19 @@ scoped_refptr<VideoFrame> VideoFramePool::CreateFrame(
                             timestamp);
 }
 
+void VideoFramePool::SetZeroInitializeFrames(bool zero_initialize) {
+  pool_->SetZeroInitializeFrames(zero_initialize);
+}
+
+VideoFramePool::Stats VideoFramePool::GetStats() const {
+  return pool_->GetStats();
+}
+
+// static
+void VideoFramePool::SetMaxPooledBytesForTesting(size_t max_pooled_bytes) {
+  g_max_pooled_bytes = max_pooled_bytes;
+}
+
 size_t VideoFramePool::GetPoolSizeForTesting() const {
   return pool_->get_pool_size_for_testing();
 }
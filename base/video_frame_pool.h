@@ -21,26 +21,52 @@ namespace media {
 // VideoFrame objects. The pool manages the memory for the VideoFrame
 // returned by CreateFrame(). When one of these VideoFrames is destroyed,
 // the memory is returned to the pool for use by a subsequent CreateFrame()
-// call. The memory in the pool is retained for the life of the
-// VideoFramePool object. If the parameters passed to CreateFrame() change
-// during the life of this object, then the memory used by frames with the old
-// parameter values will be purged from the pool.
+// call. Released frames are kept in buckets keyed by format and coded size, so
+// switching between resolutions doesn't discard the frames of the others.
+// Frames are released from the pool once unused for a while, or when the
+// frames held by all pools in the process exceed a byte budget.
 class MEDIA_EXPORT VideoFramePool {
  public:
+  // Counters for monitoring how well the pool works.
+  struct Stats {
+    // Number of CreateFrame() calls which did and didn't reuse a frame.
+    size_t hits = 0;
+    size_t misses = 0;
+
+    // Number of frames released from the pool for staleness or budget.
+    size_t evictions = 0;
+
+    // Bytes currently held by frames waiting in the pool.
+    size_t pooled_bytes = 0;
+  };
+
+  // Default byte budget for the frames waiting in all pools of the process.
+  static const size_t kDefaultMaxPooledBytes;
+
   VideoFramePool();
   ~VideoFramePool();
 
-  // Returns a frame from the pool that matches the specified
-  // parameters or creates a new frame if no suitable frame exists in
-  // the pool. The pool is drained if no matching frame is found.
-  // The buffer for the new frame will be zero initialized.  Reused frames will
-  // not be zero initialized.
+  // Returns a frame from the pool that matches the specified format and coded
+  // size or creates a new frame if no suitable frame exists in the pool.  The
+  // buffer for a new frame will be zero initialized unless disabled through
+  // SetZeroInitializeFrames().  Reused frames will not be zero initialized.
   scoped_refptr<VideoFrame> CreateFrame(VideoPixelFormat format,
                                         const gfx::Size& coded_size,
                                         const gfx::Rect& visible_rect,
                                         const gfx::Size& natural_size,
                                         base::TimeDelta timestamp);
 
+  // Controls whether new frames are zero initialized; true by default.  Only
+  // disable this if every frame is fully overwritten, i.e. rows() x row_bytes()
+  // of every plane, before anything reads from it.
+  void SetZeroInitializeFrames(bool zero_initialize);
+
+  Stats GetStats() const;
+
+  // Changes the byte budget shared by all pools in the process; frames are
+  // evicted as they're returned to a pool while the budget is exceeded.
+  static void SetMaxPooledBytesForTesting(size_t max_pooled_bytes);
+
  protected:
   friend class VideoFramePoolTest;
 
@@ -87,10 +87,97 @@ TEST_F(VideoFramePoolTest, SimpleFormatChange) {
   // Verify that both frames are in the pool.
   CheckPoolSize(2u);
 
-  // Verify that requesting a frame with a different format causes the pool
-  // to get drained.
+  // Verify that requesting a frame with a different format leaves the frames
+  // of the old format in the pool.
   scoped_refptr<VideoFrame> new_frame = CreateFrame(PIXEL_FORMAT_I420A, 10);
+  CheckPoolSize(2u);
+
+  // Switching back reuses them.
+  scoped_refptr<VideoFrame> old_format_frame =
+      CreateFrame(PIXEL_FORMAT_I420, 10);
+  CheckPoolSize(1u);
+
+  VideoFramePool::Stats stats = pool_->GetStats();
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(3u, stats.misses);
+  EXPECT_EQ(0u, stats.evictions);
+  EXPECT_EQ(VideoFrame::AllocationSize(PIXEL_FORMAT_I420, gfx::Size(320, 240)),
+            stats.pooled_bytes);
+}
+
+TEST_F(VideoFramePoolTest, ResolutionChange) {
+  const gfx::Size kSmallSize(160, 120);
+  const gfx::Size kLargeSize(320, 240);
+  scoped_refptr<VideoFrame> small_frame =
+      pool_->CreateFrame(PIXEL_FORMAT_I420, kSmallSize, gfx::Rect(kSmallSize),
+                         kSmallSize, base::TimeDelta());
+  scoped_refptr<VideoFrame> large_frame =
+      pool_->CreateFrame(PIXEL_FORMAT_I420, kLargeSize, gfx::Rect(kLargeSize),
+                         kLargeSize, base::TimeDelta());
+  const uint8_t* small_y_data = small_frame->data(VideoFrame::kYPlane);
+  const uint8_t* large_y_data = large_frame->data(VideoFrame::kYPlane);
+  small_frame = nullptr;
+  large_frame = nullptr;
+  CheckPoolSize(2u);
+
+  // Each size gets its own frame back, even with a different visible rect.
+  const gfx::Rect kCroppedRect(8, 8, 144, 104);
+  small_frame =
+      pool_->CreateFrame(PIXEL_FORMAT_I420, kSmallSize, kCroppedRect,
+                         kCroppedRect.size(), base::TimeDelta());
+  EXPECT_EQ(kCroppedRect, small_frame->visible_rect());
+  EXPECT_EQ(kCroppedRect.size(), small_frame->natural_size());
+  EXPECT_EQ(small_y_data, small_frame->data(VideoFrame::kYPlane));
+  large_frame =
+      pool_->CreateFrame(PIXEL_FORMAT_I420, kLargeSize, gfx::Rect(kLargeSize),
+                         kLargeSize, base::TimeDelta());
+  EXPECT_EQ(large_y_data, large_frame->data(VideoFrame::kYPlane));
   CheckPoolSize(0u);
+  EXPECT_EQ(2u, pool_->GetStats().hits);
+}
+
+TEST_F(VideoFramePoolTest, ByteBudget) {
+  const size_t kFrameBytes =
+      VideoFrame::AllocationSize(PIXEL_FORMAT_I420, gfx::Size(320, 240));
+  VideoFramePool::SetMaxPooledBytesForTesting(2 * kFrameBytes);
+
+  // Frames are only held by the pool while within budget; the least recently
+  // used ones are evicted first, which is |frame_a| here.
+  scoped_refptr<VideoFrame> frame_a = CreateFrame(PIXEL_FORMAT_I420, 10);
+  scoped_refptr<VideoFrame> frame_b = CreateFrame(PIXEL_FORMAT_I420, 10);
+  scoped_refptr<VideoFrame> frame_c = CreateFrame(PIXEL_FORMAT_I420, 10);
+  const uint8_t* c_y_data = frame_c->data(VideoFrame::kYPlane);
+  frame_a = nullptr;
+  test_clock_.Advance(base::TimeDelta::FromMilliseconds(1));
+  frame_b = nullptr;
+  test_clock_.Advance(base::TimeDelta::FromMilliseconds(1));
+  frame_c = nullptr;
+  CheckPoolSize(2u);
+  EXPECT_EQ(1u, pool_->GetStats().evictions);
+  EXPECT_EQ(2 * kFrameBytes, pool_->GetStats().pooled_bytes);
+
+  // The budget is shared with other pools.
+  VideoFramePool other_pool;
+  scoped_refptr<VideoFrame> other_frame = other_pool.CreateFrame(
+      PIXEL_FORMAT_I420, gfx::Size(320, 240), gfx::Rect(320, 240),
+      gfx::Size(320, 240), base::TimeDelta());
+  other_frame = nullptr;
+  EXPECT_EQ(0u, other_pool.GetStats().pooled_bytes);
+  EXPECT_EQ(1u, other_pool.GetStats().evictions);
+
+  // The most recently used frame is the first one reused.
+  scoped_refptr<VideoFrame> frame = CreateFrame(PIXEL_FORMAT_I420, 10);
+  EXPECT_EQ(c_y_data, frame->data(VideoFrame::kYPlane));
+
+  VideoFramePool::SetMaxPooledBytesForTesting(
+      VideoFramePool::kDefaultMaxPooledBytes);
+}
+
+TEST_F(VideoFramePoolTest, NoZeroInitialization) {
+  pool_->SetZeroInitializeFrames(false);
+  scoped_refptr<VideoFrame> frame = CreateFrame(PIXEL_FORMAT_I420, 10);
+  ASSERT_TRUE(frame);
+  EXPECT_EQ(1u, pool_->GetStats().misses);
 }
 
 TEST_F(VideoFramePoolTest, FrameValidAfterPoolDestruction) {
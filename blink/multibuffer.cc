@@ -7,7 +7,9 @@
 #include "media/blink/multibuffer.h"
 
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/location.h"
+#include "media/base/media_switches.h"
 
 namespace media {
 
@@ -164,7 +166,11 @@ int64_t MultiBuffer::GlobalLRU::Size() const {
 //
 MultiBuffer::MultiBuffer(int32_t block_size_shift,
                          const scoped_refptr<GlobalLRU>& global_lru)
-    : max_size_(0), block_size_shift_(block_size_shift), lru_(global_lru) {}
+    : max_size_(0),
+      block_size_shift_(block_size_shift),
+      read_ahead_scheduling_(
+          base::FeatureList::IsEnabled(kMultiBufferReadAheadScheduling)),
+      lru_(global_lru) {}
 
 MultiBuffer::~MultiBuffer() {
   CHECK(pinned_.empty());
@@ -205,8 +211,9 @@ void MultiBuffer::AddReader(const BlockId& pos, Reader* reader) {
     }
 
     // Make sure that there are no present blocks between the writer and
-    // the requested position, as that will cause the writer to quit.
-    if (closest_writer > closest_block) {
+    // the requested position, as that will cause the writer to quit, unless
+    // the writer is going to read through them.
+    if (closest_writer > closest_block || read_ahead_scheduling_) {
       provider = writer_index_[closest_writer].get();
       DCHECK(provider);
     }
@@ -371,12 +378,32 @@ bool MultiBuffer::ProviderCollision(const BlockId& id) const {
 
   // Data already exists at providers current position,
   // if the URL supports ranges, we can kill the data provider.
-  if (RangeSupported() && Contains(id))
+  if (RangeSupported() && Contains(id) && !ShouldCoalesceAt(id))
     return true;
 
   return false;
 }
 
+bool MultiBuffer::ShouldCoalesceAt(const BlockId& pos) const {
+  if (!read_ahead_scheduling_)
+    return false;
+
+  // Reading through a long run of present blocks costs more than a new
+  // request would.
+  const BlockId next_missing = FindNextUnavailable(pos);
+  if (next_missing - pos > kMaxWaitForWriterOffset)
+    return false;
+
+  // Another writer is going to provide the missing blocks.
+  if (ClosestNextEntry(writer_index_, pos + 1) <= next_missing)
+    return false;
+
+  // Some reader would keep a writer at |next_missing| alive.
+  auto i = readers_.lower_bound(pos - kMaxWaitForReaderOffset);
+  return i != readers_.end() &&
+         i->first <= next_missing + kMaxWaitForWriterOffset;
+}
+
 void MultiBuffer::Prune(size_t max_to_free) {
   lru_->Prune(max_to_free);
 }
@@ -397,10 +424,14 @@ void MultiBuffer::OnDataProviderEvent(DataProvider* provider_tmp) {
       }
       DCHECK_GE(pos, 0);
       scoped_refptr<DataBuffer> data = provider->Read();
-      data_[pos] = data;
       eof = data->end_of_stream();
-      if (!pinned_[pos])
-        lru_->Use(this, pos);
+      // Keep the blocks which ShouldCoalesceAt() lets the provider read
+      // through, since readers may be using them.
+      if (!RangeSupported() || !Contains(pos)) {
+        data_[pos] = data;
+        if (!pinned_[pos])
+          lru_->Use(this, pos);
+      }
       ++pos;
     }
   }
@@ -336,6 +336,14 @@ class MEDIA_BLINK_EXPORT MultiBuffer {
   // output of another writer.
   bool ProviderCollision(const BlockId& pos) const;
 
+  // Returns true if a writer at the present block |pos| should read through
+  // to the missing blocks which follow. With kMultiBufferReadAheadScheduling,
+  // a writer which runs into at most kMaxWaitForWriterOffset present blocks
+  // reads through them, rather than having a new writer created after them,
+  // if a reader in its look-ahead or look-behind region is going to want the
+  // missing blocks which follow.
+  bool ShouldCoalesceAt(const BlockId& pos) const;
+
   // Call NotifyAvailableRange(new_range) on all readers waiting
   // for a block in |observer_range|
   void NotifyAvailableRange(const Interval<MultiBufferBlockId>& observer_range,
@@ -350,6 +358,10 @@ class MEDIA_BLINK_EXPORT MultiBuffer {
   // Is the client an audio element?
   bool is_client_audio_element_ = false;
 
+  // Whether kMultiBufferReadAheadScheduling was enabled at construction.
+  // Checked for every block a writer receives, so it isn't looked up anew.
+  const bool read_ahead_scheduling_;
+
   // Stores the actual data.
   DataMap data_;
 
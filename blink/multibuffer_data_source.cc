@@ -8,11 +8,13 @@
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/macros.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/single_thread_task_runner.h"
 #include "media/base/media_log.h"
+#include "media/base/media_switches.h"
 #include "media/blink/buffered_data_source_host_impl.h"
 #include "media/blink/multibuffer_reader.h"
 #include "net/base/net_errors.h"
@@ -58,6 +60,19 @@ const int64_t kTargetSecondsBufferedBehind = 2;
 // Extra buffer accumulation speed, in terms of download buffer.
 const int kSlowPreloadPercentage = 10;
 
+// With kMultiBufferReadAheadScheduling, preload further ahead when downloading
+// is less than this many times faster than playback, up to
+// kMaxSlowDownloadPreloadScale times as far, so that dips in throughput don't
+// drain the buffer.
+const double kSlowDownloadRatio = 4.0;
+const double kMaxSlowDownloadPreloadScale = 3.0;
+
+// With kMultiBufferReadAheadScheduling, resume preloading once this many
+// seconds of downloading have been read, so that fast connections load in
+// fewer, longer bursts.
+const double kPreloadHighExtraSeconds = 1.0;
+const int64_t kMaxPreloadHighExtra = 8 << 20;  // 8 Mb
+
 // Update buffer sizes every 32 progress updates.
 const int kUpdateBufferSizeFrequency = 32;
 
@@ -713,6 +728,21 @@ void MultibufferDataSource::UpdateBufferSizes() {
   // Preload 10 seconds of data, clamped to some min/max value.
   int64_t preload = clamp(kTargetSecondsBufferedAhead * bytes_per_second,
                           kMinBufferPreload, kMaxBufferPreload);
+  int64_t preload_high_extra = kPreloadHighExtra;
+
+  // Buffer further ahead when the download barely keeps up with playback.
+  const int64_t throughput = url_data()->DownloadThroughput();
+  if (throughput > 0 &&
+      base::FeatureList::IsEnabled(kMultiBufferReadAheadScheduling)) {
+    const double scale =
+        clamp(kSlowDownloadRatio * bytes_per_second / throughput, 1.0,
+              kMaxSlowDownloadPreloadScale);
+    preload = clamp(static_cast<int64_t>(preload * scale), kMinBufferPreload,
+                    kMaxBufferPreload);
+    preload_high_extra =
+        clamp(static_cast<int64_t>(throughput * kPreloadHighExtraSeconds),
+              kPreloadHighExtra, kMaxPreloadHighExtra);
+  }
 
   // Increase buffering slowly at a rate of 10% of data downloaded so
   // far, maxing out at the preload size.
@@ -723,7 +753,7 @@ void MultibufferDataSource::UpdateBufferSizes() {
   preload += extra_buffer;
 
   // We preload this much, then we stop unil we read |preload| before resuming.
-  int64_t preload_high = preload + kPreloadHighExtra;
+  int64_t preload_high = preload + preload_high_extra;
 
   // We pin a few seconds of data behind the current reading position.
   int64_t pin_backward = clamp(kTargetSecondsBufferedBehind * bytes_per_second,
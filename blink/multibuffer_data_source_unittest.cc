@@ -1705,6 +1705,27 @@ TEST_F(MultibufferDataSourceTest, CheckBufferSizeAfterReadingALot) {
   EXPECT_EQ(5013504 /* file size rounded up to blocks size */, buffer_size());
 }
 
+TEST_F(MultibufferDataSourceTest, CheckBufferSizesAdaptToThroughput) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kMultiBufferReadAheadScheduling);
+  InitializeWith206Response(1 << 30);  // 1 gb
+
+  // Downloading at twice the playback rate buffers further ahead.
+  url_data()->AddDownloadSample(2 << 20, base::TimeDelta::FromSeconds(1));
+  data_source_->SetBitrate(8 << 20);  // 8 mbit / s
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(20 << 20, preload_low());
+  EXPECT_EQ(22 << 20, preload_high());
+
+  // Fast downloads resume preloading in larger bursts.
+  url_data()->AddDownloadSample(64 * (16 << 20),
+                                base::TimeDelta::FromSeconds(64));
+  data_source_->SetBitrate(8 << 20);  // 8 mbit / s
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(10 << 20, preload_low());
+  EXPECT_EQ(18 << 20, preload_high());
+}
+
 // Provoke an edge case where the loading state may not end up transitioning
 // back to "idle" when we're done loading.
 TEST_F(MultibufferDataSourceTest, Http_CheckLoadingTransition) {
@@ -0,0 +1,263 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/test/scoped_feature_list.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/time/time.h"
+#include "media/base/data_buffer.h"
+#include "media/base/fake_single_thread_task_runner.h"
+#include "media/base/media_switches.h"
+#include "media/blink/multibuffer.h"
+#include "media/blink/multibuffer_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+// 32 KB blocks, like UrlData uses.
+static const int kBlockSizeShift = 15;
+static const int64_t kBlockSize = 1 << kBlockSizeShift;
+static const int64_t kFileSize = 256 << 20;
+
+// The simulated network: every request waits for kRequestLatency before its
+// first byte, then the loading requests share kThroughput bytes per second.
+static const int64_t kThroughput = 4 << 20;
+static const int kRequestLatencyMs = 100;
+
+// Playback reads this many bytes per second.
+static const int64_t kPlaybackBytesPerSecond = 1 << 20;
+
+// The default buffer sizes of MultibufferDataSource at low bitrates.
+static const int64_t kPreloadLow = 2 << 20;
+static const int64_t kPreloadHigh = 3 << 20;
+static const int64_t kPinBackward = 2 << 20;
+static const int64_t kPinForward = 25 << 20;
+
+class FakeLoader;
+
+// Creates a FakeLoader for every range request.
+class FakeLoaderMultiBuffer : public MultiBuffer {
+ public:
+  FakeLoaderMultiBuffer(const scoped_refptr<GlobalLRU>& lru,
+                        const base::SimpleTestTickClock* clock,
+                        std::vector<FakeLoader*>* loaders)
+      : MultiBuffer(kBlockSizeShift, lru), clock_(clock), loaders_(loaders) {}
+
+  int requests() const { return requests_; }
+
+ protected:
+  std::unique_ptr<DataProvider> CreateWriter(const BlockId& pos,
+                                             bool) override;
+  bool RangeSupported() const override { return true; }
+
+ private:
+  const base::SimpleTestTickClock* const clock_;
+  std::vector<FakeLoader*>* const loaders_;
+  int requests_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeLoaderMultiBuffer);
+};
+
+// Loads blocks from |pos| on, one block at a time, once |start_time| has
+// passed. Registers itself in |loaders| while it exists.
+class FakeLoader : public MultiBuffer::DataProvider {
+ public:
+  FakeLoader(MultiBufferBlockId pos,
+             base::TimeTicks start_time,
+             MultiBuffer* multibuffer,
+             std::vector<FakeLoader*>* loaders)
+      : pos_(pos),
+        start_time_(start_time),
+        multibuffer_(multibuffer),
+        loaders_(loaders) {
+    loaders_->push_back(this);
+  }
+
+  ~FakeLoader() override {
+    loaders_->erase(std::find(loaders_->begin(), loaders_->end(), this));
+  }
+
+  bool Loading(base::TimeTicks now) const {
+    return !deferred_ && !eof_ && now >= start_time_;
+  }
+
+  // Receives the next block. May destroy |this|.
+  void Deliver() {
+    const int64_t byte_pos =
+        static_cast<int64_t>(pos_ + fifo_.size()) << kBlockSizeShift;
+    scoped_refptr<DataBuffer> block = new DataBuffer(kBlockSize);
+    block->set_data_size(std::min(kBlockSize, kFileSize - byte_pos));
+    fifo_.push_back(block);
+    if (byte_pos + kBlockSize >= kFileSize) {
+      fifo_.push_back(DataBuffer::CreateEOSBuffer());
+      eof_ = true;
+    }
+    multibuffer_->OnDataProviderEvent(this);
+  }
+
+  // MultiBuffer::DataProvider implementation.
+  MultiBufferBlockId Tell() const override { return pos_; }
+  bool Available() const override { return !fifo_.empty(); }
+  int64_t AvailableBytes() const override { return 0; }
+  scoped_refptr<DataBuffer> Read() override {
+    scoped_refptr<DataBuffer> block = fifo_.front();
+    fifo_.pop_front();
+    ++pos_;
+    return block;
+  }
+  void SetDeferred(bool deferred) override { deferred_ = deferred; }
+
+ private:
+  MultiBufferBlockId pos_;
+  const base::TimeTicks start_time_;
+  MultiBuffer* const multibuffer_;
+  std::vector<FakeLoader*>* const loaders_;
+  base::circular_deque<scoped_refptr<DataBuffer>> fifo_;
+  bool deferred_ = false;
+  bool eof_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeLoader);
+};
+
+std::unique_ptr<MultiBuffer::DataProvider> FakeLoaderMultiBuffer::CreateWriter(
+    const BlockId& pos,
+    bool) {
+  ++requests_;
+  return std::make_unique<FakeLoader>(
+      pos,
+      clock_->NowTicks() +
+          base::TimeDelta::FromMilliseconds(kRequestLatencyMs),
+      this, loaders_);
+}
+
+// Reads |size| bytes at |position|, at the playback rate if |playback| or as
+// fast as they arrive otherwise, like a demuxer parsing metadata does.
+struct TraceRead {
+  int64_t position;
+  int64_t size;
+  bool playback;
+};
+
+// These benchmarks are part of media_blink_unittests but disabled by default.
+// Run them with --gtest_also_run_disabled_tests.
+class MultiBufferPerfTest : public testing::Test {
+ public:
+  MultiBufferPerfTest()
+      : task_runner_(new FakeSingleThreadTaskRunner(&clock_)),
+        tick_(base::TimeDelta::FromMicroseconds(
+            base::Time::kMicrosecondsPerSecond * kBlockSize / kThroughput)) {}
+
+  // Replays |trace| with one reader, and reports the number of requests made
+  // and the time spent waiting for data.
+  void RunTrace(const std::string& trace_name,
+                const std::vector<TraceRead>& trace) {
+    std::vector<FakeLoader*> loaders;
+    scoped_refptr<MultiBuffer::GlobalLRU> lru(
+        new MultiBuffer::GlobalLRU(task_runner_));
+    FakeLoaderMultiBuffer multibuffer(lru, &clock_, &loaders);
+
+    base::TimeDelta stall_time;
+    {
+      MultiBufferReader reader(&multibuffer, 0, kFileSize,
+                               base::Callback<void(int64_t, int64_t)>());
+      reader.SetMaxBuffer(kPinBackward + kPinForward);
+      reader.SetPinRange(kPinBackward, kPinForward);
+      reader.SetPreload(kPreloadHigh, kPreloadLow);
+
+      const int64_t playback_bytes_per_tick =
+          kPlaybackBytesPerSecond * tick_.InMicroseconds() /
+          base::Time::kMicrosecondsPerSecond;
+      std::vector<uint8_t> buffer(kPreloadHigh);
+      size_t next_loader = 0;
+      for (const TraceRead& read : trace) {
+        reader.Seek(read.position);
+        int64_t remaining = read.size;
+        int64_t allowance = 0;
+        while (remaining > 0) {
+          clock_.Advance(tick_);
+
+          // Loading requests take turns receiving a block.
+          for (size_t i = 0; i < loaders.size(); ++i) {
+            next_loader = (next_loader + 1) % loaders.size();
+            if (loaders[next_loader]->Loading(clock_.NowTicks())) {
+              loaders[next_loader]->Deliver();
+              break;
+            }
+          }
+
+          allowance = read.playback ? allowance + playback_bytes_per_tick
+                                    : static_cast<int64_t>(buffer.size());
+          const int64_t bytes_read = reader.TryRead(
+              buffer.data(), std::min(remaining, allowance));
+          remaining -= bytes_read;
+          allowance -= bytes_read;
+          if (bytes_read == 0) {
+            // Playback pauses until data arrives.
+            stall_time += tick_;
+            allowance = std::min(allowance, playback_bytes_per_tick);
+          }
+        }
+      }
+    }
+
+    perf_test::PrintResult("multibuffer_requests", "", trace_name,
+                           static_cast<size_t>(multibuffer.requests()),
+                           "requests", true);
+    perf_test::PrintResult("multibuffer_stall", "", trace_name,
+                           stall_time.InMillisecondsF(), "ms", true);
+  }
+
+  // Runs |trace| with and without kMultiBufferReadAheadScheduling.
+  void RunBenchmark(const std::string& trace_name,
+                    const std::vector<TraceRead>& trace) {
+    RunTrace(trace_name, trace);
+
+    base::test::ScopedFeatureList scoped_feature_list;
+    scoped_feature_list.InitAndEnableFeature(kMultiBufferReadAheadScheduling);
+    RunTrace(trace_name + "_read_ahead", trace);
+  }
+
+ protected:
+  base::SimpleTestTickClock clock_;
+  scoped_refptr<FakeSingleThreadTaskRunner> task_runner_;
+
+  // The time it takes to load a block at kThroughput.
+  const base::TimeDelta tick_;
+
+  DISALLOW_COPY_AND_ASSIGN(MultiBufferPerfTest);
+};
+
+// Scrubs through the first 30 seconds, looking at a frame every second, then
+// plays them.
+TEST_F(MultiBufferPerfTest, DISABLED_ScrubThenPlay) {
+  std::vector<TraceRead> trace;
+  for (int i = 0; i < 30; ++i) {
+    trace.push_back(
+        {i * kPlaybackBytesPerSecond + (i % 3) * kBlockSize, 64 << 10, false});
+  }
+  trace.push_back({0, 30 * kPlaybackBytesPerSecond, true});
+  RunBenchmark("scrub_then_play", trace);
+}
+
+// Opens an MP4 file with the moov box at the end, then plays it.
+TEST_F(MultiBufferPerfTest, DISABLED_MoovAtEnd) {
+  std::vector<TraceRead> trace = {
+      {0, 64 << 10, false},
+      {kFileSize - (1 << 20), 1 << 20, false},
+      {64 << 10, 30 * kPlaybackBytesPerSecond, true}};
+  RunBenchmark("moov_at_end", trace);
+}
+
+}  // namespace media
@@ -11,8 +11,10 @@
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/containers/circular_deque.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/simple_test_tick_clock.h"
 #include "media/base/fake_single_thread_task_runner.h"
+#include "media/base/media_switches.h"
 #include "media/base/test_random.h"
 #include "media/blink/multibuffer.h"
 #include "media/blink/multibuffer_reader.h"
@@ -255,6 +257,21 @@ class MultiBufferTest : public testing::Test {
   TestMultiBuffer multibuffer_;
 };
 
+// Enables kMultiBufferReadAheadScheduling before MultiBufferTest constructs
+// |multibuffer_|, which reads the feature state once.
+class ReadAheadSchedulingEnabler {
+ public:
+  ReadAheadSchedulingEnabler() {
+    scoped_feature_list_.InitAndEnableFeature(kMultiBufferReadAheadScheduling);
+  }
+
+ private:
+  base::test::ScopedFeatureList scoped_feature_list_;
+};
+
+class MultiBufferReadAheadSchedulingTest : private ReadAheadSchedulingEnabler,
+                                           public MultiBufferTest {};
+
 TEST_F(MultiBufferTest, ReadAll) {
   multibuffer_.SetMaxWriters(1);
   size_t pos = 0;
@@ -371,6 +388,43 @@ TEST_F(MultiBufferTest, ReadAllAdvanceFirst_NeverDefer2) {
   }
 }
 
+TEST_F(MultiBufferReadAheadSchedulingTest, ReadThroughShortPresentRuns) {
+  multibuffer_.SetFileSize(100 * kBlockSize);
+  multibuffer_.SetRangeSupported(true);
+
+  // Load blocks 10 and 11 only.
+  MultiBufferReader reader1(&multibuffer_, 10 * kBlockSize, 12 * kBlockSize,
+                            base::Callback<void(int64_t, int64_t)>());
+  reader1.SetPinRange(0, 2 * kBlockSize);
+  reader1.SetPreload(2 * kBlockSize, 2 * kBlockSize);
+  while (AdvanceAll()) {
+  }
+  EXPECT_EQ(1, multibuffer_.writers_created());
+  EXPECT_EQ(12, multibuffer_.FindNextUnavailable(10));
+
+  // A reader from the start gets blocks 0 to 19 from a single writer, which
+  // doesn't stop at the blocks already present.
+  MultiBufferReader reader2(&multibuffer_, 0, 100 * kBlockSize,
+                            base::Callback<void(int64_t, int64_t)>());
+  reader2.SetPinRange(0, 20 * kBlockSize);
+  reader2.SetPreload(20 * kBlockSize, 20 * kBlockSize);
+  while (AdvanceAll()) {
+  }
+  EXPECT_EQ(2, multibuffer_.writers_created());
+  EXPECT_EQ(20, multibuffer_.FindNextUnavailable(0));
+  multibuffer_.CheckPresentState();
+
+  uint8_t buffer[kBlockSize];
+  for (size_t pos = 0; pos < 20 * kBlockSize; pos += kBlockSize) {
+    ASSERT_EQ(static_cast<int64_t>(kBlockSize),
+              reader2.TryReadAt(pos, buffer, kBlockSize));
+    for (size_t i = 0; i < kBlockSize; i++) {
+      EXPECT_EQ(static_cast<uint8_t>(((pos + i) * 15485863) >> 16), buffer[i])
+          << " pos = " << pos + i;
+    }
+  }
+}
+
 TEST_F(MultiBufferTest, LRUTest) {
   int64_t max_size = 17;
   int64_t current_size = 0;
@@ -599,4 +653,35 @@ TEST_F(MultiBufferTest, RandomTest_RangeSupported) {
   }
 }
 
+TEST_F(MultiBufferReadAheadSchedulingTest, RandomTest_ReadAheadScheduling) {
+  size_t file_size = 1000000;
+  multibuffer_.SetFileSize(file_size);
+  multibuffer_.SetMaxBlocksAfterDefer(10);
+  std::vector<ReadHelper*> read_helpers;
+  multibuffer_.SetRangeSupported(true);
+  for (size_t i = 0; i < 20; i++) {
+    read_helpers.push_back(
+        new ReadHelper(file_size, 1000, &multibuffer_, &rnd_));
+  }
+  for (int i = 0; i < 100; i++) {
+    for (int j = 0; j < 100; j++) {
+      if (rnd_.Rand() & 1) {
+        if (!writers.empty())
+          Advance();
+      } else {
+        size_t j = rnd_.Rand() % read_helpers.size();
+        if (rnd_.Rand() % 100 < 3)
+          read_helpers[j]->Seek();
+        read_helpers[j]->StartRead();
+      }
+    }
+    multibuffer_.CheckLRUState();
+  }
+  multibuffer_.CheckPresentState();
+  while (!read_helpers.empty()) {
+    delete read_helpers.back();
+    read_helpers.pop_back();
+  }
+}
+
 }  // namespace media
@@ -172,6 +172,10 @@ scoped_refptr<DataBuffer> ResourceMultiBufferDataProvider::Read() {
 }
 
 void ResourceMultiBufferDataProvider::SetDeferred(bool deferred) {
+  if (deferred != deferred_) {
+    deferred_ = deferred;
+    last_data_time_ = base::TimeTicks();
+  }
   if (active_loader_)
     active_loader_->SetDefersLoading(deferred);
 }
@@ -390,6 +394,13 @@ void ResourceMultiBufferDataProvider::DidReceiveData(const char* data,
 
   url_data_->AddBytesReadFromNetwork(data_length);
 
+  // Data which arrives while deferred was already on its way, so it doesn't
+  // tell how fast we can download.
+  const base::TimeTicks now = base::TimeTicks::Now();
+  if (!deferred_ && !last_data_time_.is_null())
+    url_data_->AddDownloadSample(data_length, now - last_data_time_);
+  last_data_time_ = deferred_ ? base::TimeTicks() : now;
+
   if (bytes_to_discard_) {
     uint64_t tmp = std::min<uint64_t>(bytes_to_discard_, data_length);
     data_length -= tmp;
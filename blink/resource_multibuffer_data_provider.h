@@ -12,6 +12,7 @@
 
 #include "base/callback.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "media/blink/media_blink_export.h"
 #include "media/blink/multibuffer.h"
 #include "media/blink/url_index.h"
@@ -131,6 +132,13 @@ class MEDIA_BLINK_EXPORT ResourceMultiBufferDataProvider
   // Is the client an audio element?
   bool is_client_audio_element_ = false;
 
+  // Whether SetDeferred() last deferred loading.
+  bool deferred_ = false;
+
+  // When data was last received while loading, or null if loading started or
+  // resumed since. Used to measure the download throughput.
+  base::TimeTicks last_data_time_;
+
   base::WeakPtrFactory<ResourceMultiBufferDataProvider> weak_factory_;
 };
 
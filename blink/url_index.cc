@@ -4,6 +4,8 @@
 
 #include "media/blink/url_index.h"
 
+#include <algorithm>
+#include <cmath>
 #include <set>
 #include <utility>
 
@@ -25,6 +27,13 @@ const int kUrlMappingTimeoutSeconds = 300;
 // Max number of resource preloading in parallel.
 const size_t kMaxParallelPreload = 6;
 
+// Download samples lose half their weight in DownloadThroughput() for every
+// this many seconds of downloading after them.
+const double kDownloadThroughputHalfLifeSeconds = 2.0;
+
+// Don't estimate the download throughput from less downloading than this.
+const double kMinDownloadSeconds = 0.2;
+
 namespace {
 // Helper function, return max parallel preloads.
 size_t GetMaxParallelPreload() {
@@ -237,6 +246,22 @@ void UrlData::AddBytesReadFromNetwork(int64_t b) {
   }
 }
 
+void UrlData::AddDownloadSample(int64_t bytes, base::TimeDelta duration) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK_GE(bytes, 0);
+  const double seconds = std::max(duration.InSecondsF(), 0.0);
+  const double decay =
+      std::pow(0.5, seconds / kDownloadThroughputHalfLifeSeconds);
+  download_bytes_ = download_bytes_ * decay + bytes;
+  download_seconds_ = download_seconds_ * decay + seconds;
+}
+
+int64_t UrlData::DownloadThroughput() const {
+  if (download_seconds_ < kMinDownloadSeconds)
+    return 0;
+  return static_cast<int64_t>(download_bytes_ / download_seconds_);
+}
+
 size_t UrlData::CachedSize() {
   DCHECK(thread_checker_.CalledOnValidThread());
   return multibuffer()->map().size();
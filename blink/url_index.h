@@ -16,6 +16,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/threading/thread_checker.h"
+#include "base/time/time.h"
 #include "media/blink/lru.h"
 #include "media/blink/media_blink_export.h"
 #include "media/blink/multibuffer.h"
@@ -183,6 +184,14 @@ class MEDIA_BLINK_EXPORT UrlData : public base::RefCounted<UrlData> {
   void AddBytesReadFromNetwork(int64_t b);
   int64_t BytesReadFromNetwork() const { return bytes_read_from_network_; }
 
+  // Records that |bytes| were received from the network in |duration|, not
+  // counting time spent waiting for a response or deferred.
+  void AddDownloadSample(int64_t bytes, base::TimeDelta duration);
+
+  // Returns the recent download throughput in bytes per second, or 0 if too
+  // little has been downloaded to tell.
+  int64_t DownloadThroughput() const;
+
   // Call |cb| when it's ok to start preloading an URL.
   // Note that |cb| may be called directly from inside this function.
   void WaitToLoad(base::OnceClosure cb);
@@ -239,6 +248,11 @@ class MEDIA_BLINK_EXPORT UrlData : public base::RefCounted<UrlData> {
   // Number of bytes read from network into the cache for this resource.
   int64_t bytes_read_from_network_ = 0;
 
+  // Bytes and seconds of download samples, decayed so that recent samples
+  // weigh the most in DownloadThroughput().
+  double download_bytes_ = 0;
+  double download_seconds_ = 0;
+
   // Does the server support ranges?
   bool range_supported_;
 
@@ -1245,6 +1245,10 @@ EnumTraits<media::mojom::VideoCaptureFrameDropReason,
     case media::VideoCaptureFrameDropReason::kBufferPoolBufferAllocationFailed:
       return media::mojom::VideoCaptureFrameDropReason::
           kBufferPoolBufferAllocationFailed;
+    case media::VideoCaptureFrameDropReason::
+        kDeviceClientDroppedStaleMjpegFrame:
+      return media::mojom::VideoCaptureFrameDropReason::
+          kDeviceClientDroppedStaleMjpegFrame;
   }
   NOTREACHED();
   return media::mojom::VideoCaptureFrameDropReason::kNone;
@@ -1330,6 +1334,11 @@ bool EnumTraits<media::mojom::VideoCaptureFrameDropReason,
       *output =
           media::VideoCaptureFrameDropReason::kBufferPoolBufferAllocationFailed;
       return true;
+    case media::mojom::VideoCaptureFrameDropReason::
+        kDeviceClientDroppedStaleMjpegFrame:
+      *output = media::VideoCaptureFrameDropReason::
+          kDeviceClientDroppedStaleMjpegFrame;
+      return true;
   }
   NOTREACHED();
   return false;
@@ -20,6 +20,7 @@
 #include "media/base/media_switches.h"
 #include "media/capture/video/fake_video_capture_device_factory.h"
 #include "media/capture/video/mock_video_capture_device_client.h"
+#include "media/capture/video/stub_buffer_handle_provider.h"
 #include "media/capture/video/video_capture_device.h"
 #include "media/capture/video_capture_types.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -36,70 +37,6 @@ namespace media {
 
 namespace {
 
-class StubBufferHandle : public VideoCaptureBufferHandle {
- public:
-  StubBufferHandle(size_t mapped_size, uint8_t* data)
-      : mapped_size_(mapped_size), data_(data) {}
-
-  size_t mapped_size() const override { return mapped_size_; }
-  uint8_t* data() const override { return data_; }
-  const uint8_t* const_data() const override { return data_; }
-
- private:
-  const size_t mapped_size_;
-  uint8_t* const data_;
-};
-
-class StubBufferHandleProvider
-    : public VideoCaptureDevice::Client::Buffer::HandleProvider {
- public:
-  StubBufferHandleProvider(size_t mapped_size, uint8_t* data)
-      : mapped_size_(mapped_size), data_(data) {}
-
-  ~StubBufferHandleProvider() override = default;
-
-  mojo::ScopedSharedBufferHandle GetHandleForInterProcessTransit(
-      bool read_only) override {
-    NOTREACHED();
-    return mojo::ScopedSharedBufferHandle();
-  }
-
-  base::SharedMemoryHandle GetNonOwnedSharedMemoryHandleForLegacyIPC()
-      override {
-    NOTREACHED();
-    return base::SharedMemoryHandle();
-  }
-
-  std::unique_ptr<VideoCaptureBufferHandle> GetHandleForInProcessAccess()
-      override {
-    return std::make_unique<StubBufferHandle>(mapped_size_, data_);
-  }
-
- private:
-  const size_t mapped_size_;
-  uint8_t* const data_;
-};
-
-class StubReadWritePermission
-    : public VideoCaptureDevice::Client::Buffer::ScopedAccessPermission {
- public:
-  StubReadWritePermission(uint8_t* data) : data_(data) {}
-  ~StubReadWritePermission() override { delete[] data_; }
-
- private:
-  uint8_t* const data_;
-};
-
-VideoCaptureDevice::Client::Buffer CreateStubBuffer(int buffer_id,
-                                                    size_t mapped_size) {
-  auto* buffer = new uint8_t[mapped_size];
-  const int arbitrary_frame_feedback_id = 0;
-  return VideoCaptureDevice::Client::Buffer(
-      buffer_id, arbitrary_frame_feedback_id,
-      std::make_unique<StubBufferHandleProvider>(mapped_size, buffer),
-      std::make_unique<StubReadWritePermission>(buffer));
-};
-
 class ImageCaptureClient : public base::RefCounted<ImageCaptureClient> {
  public:
   // GMock doesn't support move-only arguments, so we use this forward method.
@@ -154,7 +91,8 @@ class FakeVideoCaptureDeviceTestBase : public ::testing::Test {
                       VideoCaptureDevice::Client::Buffer* buffer) {
               EXPECT_GT(dimensions.GetArea(), 0);
               const VideoCaptureFormat frame_format(dimensions, 0.0, format);
-              *buffer = CreateStubBuffer(0, frame_format.ImageAllocationSize());
+              *buffer = CreateStubBuffer(0, 0,
+                                         frame_format.ImageAllocationSize());
               return VideoCaptureDevice::Client::ReserveResult::kSucceeded;
             }));
     ON_CALL(*result, OnIncomingCapturedData(_, _, _, _, _, _, _))
@@ -6,6 +6,7 @@
 
 #include <stddef.h>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/location.h"
@@ -24,7 +25,6 @@ namespace media {
 
 static const int kY4MHeaderMaxSize = 200;
 static const char kY4MSimpleFrameDelimiter[] = "FRAME";
-static const int kY4MSimpleFrameDelimiterSize = 6;
 static const float kMJpegFrameRate = 30.0f;
 
 int ParseY4MInt(const base::StringPiece& token) {
@@ -82,7 +82,8 @@ void ParseY4MTags(const std::string& file_header,
           break;
         int fps_numerator, fps_denominator;
         ParseY4MRational(token, &fps_numerator, &fps_denominator);
-        format.frame_rate = fps_numerator / fps_denominator;
+        format.frame_rate =
+            static_cast<float>(fps_numerator) / fps_denominator;
         break;
       }
       case 'I':
@@ -110,37 +111,63 @@ void ParseY4MTags(const std::string& file_header,
   *video_format = format;
 }
 
+// Maps a video file into memory and indexes the location of every frame in
+// it, so that frames can be handed out in any order without copying them.
 class VideoFileParser {
  public:
   explicit VideoFileParser(const base::FilePath& file_path);
   virtual ~VideoFileParser();
 
-  // Parses file header and collects format information in |capture_format|.
-  virtual bool Initialize(VideoCaptureFormat* capture_format) = 0;
+  // Maps the file, parses its header and indexes its frames. Collects format
+  // information in |capture_format|. Returns false if the file can't be read
+  // or holds no complete frame.
+  bool Initialize(VideoCaptureFormat* capture_format);
 
-  // Gets the start pointer of next frame and stores current frame size in
-  // |frame_size|.
-  virtual const uint8_t* GetNextFrame(int* frame_size) = 0;
+  size_t num_frames() const { return frames_.size(); }
+
+  // Makes |frame_index|, which must be less than num_frames(), the frame
+  // returned by the next GetNextFrame() call.
+  void SeekToFrame(size_t frame_index);
+
+  // Returns a pointer into the mapped file to the next frame, and stores the
+  // frame's size in |frame_size|. Loops back to the first frame after the
+  // last one.
+  const uint8_t* GetNextFrame(int* frame_size);
 
  protected:
+  struct FrameLocation {
+    size_t offset;
+    size_t size;
+  };
+
+  // Parses the file header in |data| and collects format information in
+  // |capture_format|, then appends the location of every complete frame in
+  // |data| to |frames|. Returns false if the header is invalid.
+  virtual bool IndexFrames(const uint8_t* data,
+                           size_t length,
+                           VideoCaptureFormat* capture_format,
+                           std::vector<FrameLocation>* frames) = 0;
+
+ private:
   const base::FilePath file_path_;
-  int frame_size_;
-  size_t current_byte_index_;
-  size_t first_frame_byte_index_;
+  base::MemoryMappedFile mapped_file_;
+  std::vector<FrameLocation> frames_;
+  size_t next_frame_index_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoFileParser);
 };
 
 class Y4mFileParser final : public VideoFileParser {
  public:
   explicit Y4mFileParser(const base::FilePath& file_path);
-
-  // VideoFileParser implementation, class methods.
   ~Y4mFileParser() override;
-  bool Initialize(VideoCaptureFormat* capture_format) override;
-  const uint8_t* GetNextFrame(int* frame_size) override;
 
  private:
-  std::unique_ptr<base::File> file_;
-  std::unique_ptr<uint8_t[]> video_frame_;
+  // VideoFileParser implementation.
+  bool IndexFrames(const uint8_t* data,
+                   size_t length,
+                   VideoCaptureFormat* capture_format,
+                   std::vector<FrameLocation>* frames) override;
 
   DISALLOW_COPY_AND_ASSIGN(Y4mFileParser);
 };
@@ -148,73 +175,83 @@ class Y4mFileParser final : public VideoFileParser {
 class MjpegFileParser final : public VideoFileParser {
  public:
   explicit MjpegFileParser(const base::FilePath& file_path);
-
-  // VideoFileParser implementation, class methods.
   ~MjpegFileParser() override;
-  bool Initialize(VideoCaptureFormat* capture_format) override;
-  const uint8_t* GetNextFrame(int* frame_size) override;
 
  private:
-  std::unique_ptr<base::MemoryMappedFile> mapped_file_;
+  // VideoFileParser implementation.
+  bool IndexFrames(const uint8_t* data,
+                   size_t length,
+                   VideoCaptureFormat* capture_format,
+                   std::vector<FrameLocation>* frames) override;
 
   DISALLOW_COPY_AND_ASSIGN(MjpegFileParser);
 };
 
 VideoFileParser::VideoFileParser(const base::FilePath& file_path)
-    : file_path_(file_path),
-      frame_size_(0),
-      current_byte_index_(0),
-      first_frame_byte_index_(0) {}
+    : file_path_(file_path), next_frame_index_(0) {}
 
 VideoFileParser::~VideoFileParser() = default;
 
-Y4mFileParser::Y4mFileParser(const base::FilePath& file_path)
-    : VideoFileParser(file_path) {}
-
-Y4mFileParser::~Y4mFileParser() = default;
+bool VideoFileParser::Initialize(VideoCaptureFormat* capture_format) {
+  if (!mapped_file_.Initialize(file_path_) || !mapped_file_.IsValid()) {
+    LOG(ERROR) << "File memory map error: " << file_path_.value();
+    return false;
+  }
 
-bool Y4mFileParser::Initialize(VideoCaptureFormat* capture_format) {
-  file_.reset(new base::File(file_path_,
-                             base::File::FLAG_OPEN | base::File::FLAG_READ));
-  if (!file_->IsValid()) {
-    DLOG(ERROR) << file_path_.value() << ", error: "
-                << base::File::ErrorToString(file_->error_details());
+  if (!IndexFrames(mapped_file_.data(), mapped_file_.length(), capture_format,
+                   &frames_)) {
+    return false;
+  }
+  if (frames_.empty()) {
+    LOG(ERROR) << "File is incomplete";
     return false;
   }
+  DVLOG(1) << "Indexed " << frames_.size() << " frames";
+  return true;
+}
 
-  std::string header(kY4MHeaderMaxSize, '\0');
-  file_->Read(0, &header[0], header.size());
-  const size_t header_end = header.find(kY4MSimpleFrameDelimiter);
-  CHECK_NE(header_end, header.npos);
+void VideoFileParser::SeekToFrame(size_t frame_index) {
+  DCHECK_LT(frame_index, frames_.size());
+  next_frame_index_ = frame_index;
+}
 
-  ParseY4MTags(header, capture_format);
-  first_frame_byte_index_ = header_end + kY4MSimpleFrameDelimiterSize;
-  current_byte_index_ = first_frame_byte_index_;
-  frame_size_ = capture_format->ImageAllocationSize();
-  return true;
+const uint8_t* VideoFileParser::GetNextFrame(int* frame_size) {
+  const FrameLocation& frame = frames_[next_frame_index_];
+  next_frame_index_ = (next_frame_index_ + 1) % frames_.size();
+  *frame_size = static_cast<int>(frame.size);
+  return mapped_file_.data() + frame.offset;
 }
 
-const uint8_t* Y4mFileParser::GetNextFrame(int* frame_size) {
-  if (!video_frame_)
-    video_frame_.reset(new uint8_t[frame_size_]);
-  int result =
-      file_->Read(current_byte_index_,
-                  reinterpret_cast<char*>(video_frame_.get()), frame_size_);
-
-  // If we passed EOF to base::File, it will return 0 read characters. In that
-  // case, reset the pointer and read again.
-  if (result != frame_size_) {
-    CHECK_EQ(result, 0);
-    current_byte_index_ = first_frame_byte_index_;
-    CHECK_EQ(
-        file_->Read(current_byte_index_,
-                    reinterpret_cast<char*>(video_frame_.get()), frame_size_),
-        frame_size_);
-  } else {
-    current_byte_index_ += frame_size_ + kY4MSimpleFrameDelimiterSize;
+Y4mFileParser::Y4mFileParser(const base::FilePath& file_path)
+    : VideoFileParser(file_path) {}
+
+Y4mFileParser::~Y4mFileParser() = default;
+
+bool Y4mFileParser::IndexFrames(const uint8_t* data,
+                                size_t length,
+                                VideoCaptureFormat* capture_format,
+                                std::vector<FrameLocation>* frames) {
+  const base::StringPiece file(reinterpret_cast<const char*>(data), length);
+  const base::StringPiece header = file.substr(0, kY4MHeaderMaxSize);
+  const size_t header_end = header.find(kY4MSimpleFrameDelimiter);
+  if (header_end == header.npos) {
+    LOG(ERROR) << "Invalid Y4M header";
+    return false;
+  }
+  ParseY4MTags(header.as_string(), capture_format);
+
+  // Every frame starts with a "FRAME" delimiter, optionally followed by frame
+  // parameters, which are ignored, up to a newline.
+  const size_t frame_size = capture_format->ImageAllocationSize();
+  size_t offset = header_end;
+  while (file.substr(offset).starts_with(kY4MSimpleFrameDelimiter)) {
+    const size_t frame_start = file.find('\n', offset);
+    if (frame_start == file.npos || length - frame_start - 1 < frame_size)
+      break;
+    frames->push_back({frame_start + 1, frame_size});
+    offset = frame_start + 1 + frame_size;
   }
-  *frame_size = frame_size_;
-  return video_frame_.get();
+  return true;
 }
 
 MjpegFileParser::MjpegFileParser(const base::FilePath& file_path)
@@ -222,24 +259,14 @@ MjpegFileParser::MjpegFileParser(const base::FilePath& file_path)
 
 MjpegFileParser::~MjpegFileParser() = default;
 
-bool MjpegFileParser::Initialize(VideoCaptureFormat* capture_format) {
-  mapped_file_.reset(new base::MemoryMappedFile());
-
-  if (!mapped_file_->Initialize(file_path_) || !mapped_file_->IsValid()) {
-    LOG(ERROR) << "File memory map error: " << file_path_.value();
-    return false;
-  }
-
+bool MjpegFileParser::IndexFrames(const uint8_t* data,
+                                  size_t length,
+                                  VideoCaptureFormat* capture_format,
+                                  std::vector<FrameLocation>* frames) {
   JpegParseResult result;
-  if (!ParseJpegStream(mapped_file_->data(), mapped_file_->length(), &result))
+  if (!ParseJpegStream(data, length, &result))
     return false;
 
-  frame_size_ = result.image_size;
-  if (frame_size_ > static_cast<int>(mapped_file_->length())) {
-    LOG(ERROR) << "File is incomplete";
-    return false;
-  }
-
   VideoCaptureFormat format;
   format.pixel_format = PIXEL_FORMAT_MJPEG;
   format.frame_size.set_width(result.frame_header.visible_width);
@@ -248,23 +275,16 @@ bool MjpegFileParser::Initialize(VideoCaptureFormat* capture_format) {
   if (!format.IsValid())
     return false;
   *capture_format = format;
-  return true;
-}
 
-const uint8_t* MjpegFileParser::GetNextFrame(int* frame_size) {
-  const uint8_t* buf_ptr = mapped_file_->data() + current_byte_index_;
-
-  JpegParseResult result;
-  if (!ParseJpegStream(buf_ptr, mapped_file_->length() - current_byte_index_,
-                       &result)) {
-    return nullptr;
+  // The file is a plain concatenation of JPEG pictures.
+  size_t offset = 0;
+  while (offset < length &&
+         ParseJpegStream(data + offset, length - offset, &result) &&
+         result.image_size > 0 && result.image_size <= length - offset) {
+    frames->push_back({offset, result.image_size});
+    offset += result.image_size;
   }
-  *frame_size = frame_size_ = result.image_size;
-  current_byte_index_ += frame_size_;
-  // Reset the pointer to play repeatedly.
-  if (current_byte_index_ >= mapped_file_->length())
-    current_byte_index_ = first_frame_byte_index_;
-  return buf_ptr;
+  return true;
 }
 
 // static
@@ -301,7 +321,18 @@ std::unique_ptr<VideoFileParser> FileVideoCaptureDevice::GetVideoFileParser(
 }
 
 FileVideoCaptureDevice::FileVideoCaptureDevice(const base::FilePath& file_path)
-    : capture_thread_("CaptureThread"), file_path_(file_path) {}
+    : FileVideoCaptureDevice(file_path, 0, 1.0) {}
+
+FileVideoCaptureDevice::FileVideoCaptureDevice(const base::FilePath& file_path,
+                                               size_t start_frame,
+                                               double playback_rate)
+    : capture_thread_("CaptureThread"),
+      file_path_(file_path),
+      start_frame_(start_frame),
+      playback_rate_(playback_rate),
+      frames_since_schedule_start_(0) {
+  DCHECK_GT(playback_rate_, 0.0);
+}
 
 FileVideoCaptureDevice::~FileVideoCaptureDevice() {
   DCHECK(thread_checker_.CalledOnValidThread());
@@ -401,6 +432,10 @@ void FileVideoCaptureDevice::OnAllocateAndStart(
     return;
   }
 
+  file_parser_->SeekToFrame(start_frame_ % file_parser_->num_frames());
+  // Consumers see the rate frames are actually delivered at.
+  capture_format_.frame_rate *= playback_rate_;
+
   DVLOG(1) << "Opened video file " << capture_format_.frame_size.ToString()
            << ", fps: " << capture_format_.frame_rate;
   client_->OnStarted();
@@ -414,7 +449,8 @@ void FileVideoCaptureDevice::OnStopAndDeAllocate() {
   DCHECK(capture_thread_.task_runner()->BelongsToCurrentThread());
   file_parser_.reset();
   client_.reset();
-  next_frame_time_ = base::TimeTicks();
+  schedule_start_time_ = base::TimeTicks();
+  frames_since_schedule_start_ = 0;
 }
 
 void FileVideoCaptureDevice::OnCaptureTask() {
@@ -447,23 +483,27 @@ void FileVideoCaptureDevice::OnCaptureTask() {
     std::move(cb).Run(std::move(blob));
   }
 
-  // Reschedule next CaptureTask.
-  const base::TimeDelta frame_interval =
-      base::TimeDelta::FromMicroseconds(1E6 / capture_format_.frame_rate);
-  if (next_frame_time_.is_null()) {
-    next_frame_time_ = current_time + frame_interval;
-  } else {
-    next_frame_time_ += frame_interval;
-    // Don't accumulate any debt if we are lagging behind - just post next frame
-    // immediately and continue as normal.
-    if (next_frame_time_ < current_time)
-      next_frame_time_ = current_time;
+  // Reschedule next CaptureTask. Frame times are computed from the start of
+  // the schedule rather than accumulated, so that rounding errors don't make
+  // the frame rate drift.
+  if (schedule_start_time_.is_null())
+    schedule_start_time_ = current_time;
+  ++frames_since_schedule_start_;
+  base::TimeTicks next_frame_time =
+      schedule_start_time_ +
+      base::TimeDelta::FromSecondsD(frames_since_schedule_start_ /
+                                    capture_format_.frame_rate);
+  // Don't accumulate any debt if we are lagging behind - just post next frame
+  // immediately and continue as normal.
+  if (next_frame_time < current_time) {
+    schedule_start_time_ = next_frame_time = current_time;
+    frames_since_schedule_start_ = 0;
   }
   base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
       FROM_HERE,
       base::BindOnce(&FileVideoCaptureDevice::OnCaptureTask,
                      base::Unretained(this)),
-      next_frame_time_ - current_time);
+      next_frame_time - current_time);
 }
 
 }  // namespace media
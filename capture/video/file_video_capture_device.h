@@ -5,6 +5,7 @@
 #ifndef MEDIA_CAPTURE_VIDEO_FILE_VIDEO_CAPTURE_DEVICE_H_
 #define MEDIA_CAPTURE_VIDEO_FILE_VIDEO_CAPTURE_DEVICE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <memory>
@@ -32,6 +33,8 @@ class VideoFileParser;
 // Example MJPEG videos can be found in media/data/test/bear.mjpeg.
 // Restrictions: Y4M videos should have .y4m file extension and MJPEG videos
 // should have .mjpeg file extension.
+// Files are memory mapped and their frames indexed when capture starts, so
+// frames are handed to the client straight from the mapping.
 class CAPTURE_EXPORT FileVideoCaptureDevice : public VideoCaptureDevice {
  public:
   // Reads and parses the header of a |file_path|, returning the collected
@@ -45,6 +48,14 @@ class CAPTURE_EXPORT FileVideoCaptureDevice : public VideoCaptureDevice {
   // represents the Y4M or MJPEG file to stream repeatedly.
   explicit FileVideoCaptureDevice(const base::FilePath& file_path);
 
+  // Same as above, but starts streaming at frame |start_frame|, modulo the
+  // number of frames in the file, and delivers frames |playback_rate| times as
+  // fast as the file's frame rate, e.g. 4.0 to simulate a camera at 4x the
+  // recorded rate.
+  FileVideoCaptureDevice(const base::FilePath& file_path,
+                         size_t start_frame,
+                         double playback_rate);
+
   // VideoCaptureDevice implementation, class methods.
   ~FileVideoCaptureDevice() override;
   void AllocateAndStart(
@@ -81,10 +92,14 @@ class CAPTURE_EXPORT FileVideoCaptureDevice : public VideoCaptureDevice {
   // The following members belong to |capture_thread_|.
   std::unique_ptr<VideoCaptureDevice::Client> client_;
   const base::FilePath file_path_;
+  const size_t start_frame_;
+  const double playback_rate_;
   std::unique_ptr<VideoFileParser> file_parser_;
   VideoCaptureFormat capture_format_;
-  // Target time for the next frame.
-  base::TimeTicks next_frame_time_;
+  // Frames are due |frames_since_schedule_start_| frame intervals after
+  // |schedule_start_time_|, which is reset whenever capture falls behind.
+  base::TimeTicks schedule_start_time_;
+  int64_t frames_since_schedule_start_;
   // The system time when we receive the first frame.
   base::TimeTicks first_ref_time_;
 
@@ -4,8 +4,14 @@
 
 #include "media/capture/video/file_video_capture_device_factory.h"
 
+#include <vector>
+
 #include "base/command_line.h"
 #include "base/files/file_path.h"
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
@@ -17,25 +23,41 @@ namespace media {
 const char kFileVideoCaptureDeviceName[] =
     "/dev/placeholder-for-file-backed-fake-capture-device";
 
-// Inspects the command line and retrieves the file path parameter.
-base::FilePath GetFilePathFromCommandLine() {
+// Inspects the command line and retrieves the file path parameter, and the
+// playback options into |start_frame| and |playback_rate|.
+base::FilePath GetFilePathFromCommandLine(size_t* start_frame,
+                                          double* playback_rate) {
   base::FilePath command_line_file_path =
-      base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(
-          switches::kUseFileForFakeVideoCapture);
+      FileVideoCaptureDeviceFactory::ParseSwitchValue(
+          base::CommandLine::ForCurrentProcess()
+              ->GetSwitchValuePath(switches::kUseFileForFakeVideoCapture)
+              .value(),
+          start_frame, playback_rate);
   CHECK(!command_line_file_path.empty());
   return command_line_file_path;
 }
 
+base::FilePath GetFilePathFromCommandLine() {
+  size_t start_frame;
+  double playback_rate;
+  return GetFilePathFromCommandLine(&start_frame, &playback_rate);
+}
+
 std::unique_ptr<VideoCaptureDevice> FileVideoCaptureDeviceFactory::CreateDevice(
     const VideoCaptureDeviceDescriptor& device_descriptor) {
   DCHECK(thread_checker_.CalledOnValidThread());
   base::AssertBlockingAllowedDeprecated();
+  size_t start_frame;
+  double playback_rate;
+  GetFilePathFromCommandLine(&start_frame, &playback_rate);
 #if defined(OS_WIN)
   return std::unique_ptr<VideoCaptureDevice>(new FileVideoCaptureDevice(
-      base::FilePath(base::SysUTF8ToWide(device_descriptor.display_name()))));
+      base::FilePath(base::SysUTF8ToWide(device_descriptor.display_name())),
+      start_frame, playback_rate));
 #else
   return std::unique_ptr<VideoCaptureDevice>(new FileVideoCaptureDevice(
-      base::FilePath(device_descriptor.display_name())));
+      base::FilePath(device_descriptor.display_name()), start_frame,
+      playback_rate));
 #endif
 }
 
@@ -78,6 +100,49 @@ void FileVideoCaptureDeviceFactory::GetSupportedFormats(
   supported_formats->push_back(capture_format);
 }
 
+// static
+base::FilePath FileVideoCaptureDeviceFactory::ParseSwitchValue(
+    const base::FilePath::StringType& switch_value,
+    size_t* start_frame,
+    double* playback_rate) {
+  *start_frame = 0;
+  *playback_rate = 1.0;
+  const size_t separator = switch_value.find(FILE_PATH_LITERAL(';'));
+  if (separator == base::FilePath::StringType::npos)
+    return base::FilePath(switch_value);
+
+  const std::string options =
+      base::FilePath(switch_value.substr(separator + 1)).AsUTF8Unsafe();
+  for (const auto& option :
+       base::SplitString(options, ",", base::TRIM_WHITESPACE,
+                         base::SPLIT_WANT_NONEMPTY)) {
+    std::vector<std::string> param = base::SplitString(
+        option, "=", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    if (param.size() != 2u) {
+      LOG(WARNING) << "Forget a value '" << option << "'? Use name=value for "
+                   << switches::kUseFileForFakeVideoCapture << " options.";
+      continue;
+    }
+
+    if (base::EqualsCaseInsensitiveASCII(param.front(), "start-frame")) {
+      size_t parsed_start_frame = 0;
+      if (base::StringToSizeT(param.back(), &parsed_start_frame))
+        *start_frame = parsed_start_frame;
+    } else if (base::EqualsCaseInsensitiveASCII(param.front(),
+                                                "playback-rate")) {
+      double parsed_playback_rate = 0;
+      if (base::StringToDouble(param.back(), &parsed_playback_rate) &&
+          parsed_playback_rate > 0) {
+        *playback_rate = parsed_playback_rate;
+      }
+    } else {
+      LOG(WARNING) << "Unknown option " << param.front() << " for "
+                   << switches::kUseFileForFakeVideoCapture << ".";
+    }
+  }
+  return base::FilePath(switch_value.substr(0, separator));
+}
+
 void FileVideoCaptureDeviceFactory::GetCameraLocationsAsync(
     std::unique_ptr<VideoCaptureDeviceDescriptors> device_descriptors,
     DeviceDescriptorsCallback result_callback) {
@@ -5,6 +5,9 @@
 #ifndef MEDIA_CAPTURE_VIDEO_FILE_VIDEO_CAPTURE_DEVICE_FACTORY_H_
 #define MEDIA_CAPTURE_VIDEO_FILE_VIDEO_CAPTURE_DEVICE_FACTORY_H_
 
+#include <stddef.h>
+
+#include "base/files/file_path.h"
 #include "media/capture/video/video_capture_device_factory.h"
 
 namespace media {
@@ -14,7 +17,7 @@ namespace media {
 // input.
 // The |device_descriptor.display_name| passed into the Create() method is
 // interpreted as a (platform-specific) file path to a video file to be used as
-// a source.
+// a source. Playback options given on the command line apply to every device.
 class CAPTURE_EXPORT FileVideoCaptureDeviceFactory
     : public VideoCaptureDeviceFactory {
  public:
@@ -31,6 +34,16 @@ class CAPTURE_EXPORT FileVideoCaptureDeviceFactory
   void GetCameraLocationsAsync(
       std::unique_ptr<VideoCaptureDeviceDescriptors> device_descriptors,
       DeviceDescriptorsCallback result_callback) override;
+
+  // Parses |switch_value|, the value of --use-file-for-fake-video-capture.
+  // It is a file path, optionally followed by ";" and comma-separated options:
+  // "start-frame=N" starts streaming at frame N, and "playback-rate=R" delivers
+  // frames R times as fast as the file's frame rate. Returns the file path.
+  // Missing or malformed options are left at 0 and 1.0.
+  static base::FilePath ParseSwitchValue(
+      const base::FilePath::StringType& switch_value,
+      size_t* start_frame,
+      double* playback_rate);
 };
 
 }  // namespace media
@@ -6,17 +6,24 @@
 #include <stdint.h>
 
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/test/scoped_task_environment.h"
 #include "media/base/bind_to_current_loop.h"
 #include "media/base/test_data_util.h"
 #include "media/capture/video/file_video_capture_device.h"
+#include "media/capture/video/file_video_capture_device_factory.h"
 #include "media/capture/video/mock_video_capture_device_client.h"
+#include "media/filters/jpeg_parser.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 using ::testing::_;
+using ::testing::Invoke;
 using ::testing::InvokeWithoutArgs;
 
 namespace media {
@@ -45,6 +52,36 @@ class MockImageCaptureClient {
   mojom::PhotoStatePtr state_;
 };
 
+// Runs |device| until it delivers its first frame, and returns that frame and
+// its format.
+std::vector<uint8_t> CaptureFirstFrame(VideoCaptureDevice* device,
+                                       VideoCaptureFormat* format) {
+  auto client = std::make_unique<MockVideoCaptureDeviceClient>();
+  EXPECT_CALL(*client, OnError(_, _, _)).Times(0);
+  EXPECT_CALL(*client, OnStarted());
+
+  std::vector<uint8_t> frame;
+  base::RunLoop run_loop;
+  base::Closure quit_closure = BindToCurrentLoop(run_loop.QuitClosure());
+  EXPECT_CALL(*client, OnIncomingCapturedData(_, _, _, _, _, _, _))
+      .WillOnce(Invoke([&frame, format, quit_closure](
+                           const uint8_t* data, int length,
+                           const VideoCaptureFormat& frame_format, int,
+                           base::TimeTicks, base::TimeDelta, int) {
+        frame.assign(data, data + length);
+        *format = frame_format;
+        quit_closure.Run();
+      }))
+      .WillRepeatedly(Invoke([](const uint8_t*, int, const VideoCaptureFormat&,
+                                int, base::TimeTicks, base::TimeDelta, int) {
+      }));
+
+  device->AllocateAndStart(VideoCaptureParams(), std::move(client));
+  run_loop.Run();
+  device->StopAndDeAllocate();
+  return frame;
+}
+
 }  // namespace
 
 class FileVideoCaptureDeviceTest : public ::testing::Test {
@@ -103,4 +140,86 @@ TEST_F(FileVideoCaptureDeviceTest, TakePhoto) {
   run_loop.Run();
 }
 
+TEST(FileVideoCaptureDeviceSeekTest, Y4mStartFrameAndPlaybackRate) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const base::FilePath file_path = temp_dir.GetPath().AppendASCII("test.y4m");
+
+  // Three 4x2 I420 frames, each filled with its index plus one. The second
+  // frame carries frame parameters, which must be skipped.
+  const size_t kFrameSize = 4 * 2 * 3 / 2;
+  std::string contents = "YUV4MPEG2 W4 H2 F30000:1001 Ip A0:0 C420jpeg\n";
+  for (int i = 0; i < 3; ++i) {
+    contents += i == 1 ? "FRAME Ip\n" : "FRAME\n";
+    contents += std::string(kFrameSize, static_cast<char>(i + 1));
+  }
+  ASSERT_EQ(static_cast<int>(contents.size()),
+            base::WriteFile(file_path, contents.data(), contents.size()));
+
+  VideoCaptureFormat format;
+  EXPECT_TRUE(
+      FileVideoCaptureDevice::GetVideoCaptureFormat(file_path, &format));
+  EXPECT_FLOAT_EQ(30000.0f / 1001, format.frame_rate);
+
+  // Frame 4 wraps around to the second frame in the file.
+  FileVideoCaptureDevice device(file_path, 4, 2.0);
+  EXPECT_EQ(std::vector<uint8_t>(kFrameSize, 2),
+            CaptureFirstFrame(&device, &format));
+  EXPECT_EQ(PIXEL_FORMAT_I420, format.pixel_format);
+  EXPECT_FLOAT_EQ(2 * 30000.0f / 1001, format.frame_rate);
+}
+
+TEST(FileVideoCaptureDeviceSeekTest, MjpegStartFrame) {
+  base::test::ScopedTaskEnvironment scoped_task_environment;
+  const base::FilePath file_path = GetTestDataFilePath("bear.mjpeg");
+  std::string contents;
+  ASSERT_TRUE(base::ReadFileToString(file_path, &contents));
+
+  // Find the third picture in the file.
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(contents.data());
+  size_t offset = 0;
+  JpegParseResult result;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(ParseJpegStream(data + offset, contents.size() - offset,
+                                &result));
+    offset += result.image_size;
+  }
+  ASSERT_TRUE(
+      ParseJpegStream(data + offset, contents.size() - offset, &result));
+
+  FileVideoCaptureDevice device(file_path, 2, 1.0);
+  VideoCaptureFormat format;
+  EXPECT_EQ(std::vector<uint8_t>(data + offset,
+                                 data + offset + result.image_size),
+            CaptureFirstFrame(&device, &format));
+  EXPECT_EQ(PIXEL_FORMAT_MJPEG, format.pixel_format);
+}
+
+TEST(FileVideoCaptureDeviceFactoryTest, ParseSwitchValue) {
+  size_t start_frame;
+  double playback_rate;
+  EXPECT_EQ(base::FilePath(FILE_PATH_LITERAL("video.y4m")),
+            FileVideoCaptureDeviceFactory::ParseSwitchValue(
+                FILE_PATH_LITERAL("video.y4m"), &start_frame, &playback_rate));
+  EXPECT_EQ(0u, start_frame);
+  EXPECT_EQ(1.0, playback_rate);
+
+  EXPECT_EQ(base::FilePath(FILE_PATH_LITERAL("video.y4m")),
+            FileVideoCaptureDeviceFactory::ParseSwitchValue(
+                FILE_PATH_LITERAL("video.y4m;start-frame=30,playback-rate=4"),
+                &start_frame, &playback_rate));
+  EXPECT_EQ(30u, start_frame);
+  EXPECT_EQ(4.0, playback_rate);
+
+  // Malformed and unknown options are ignored.
+  EXPECT_EQ(base::FilePath(FILE_PATH_LITERAL("video.mjpeg")),
+            FileVideoCaptureDeviceFactory::ParseSwitchValue(
+                FILE_PATH_LITERAL("video.mjpeg;start-frame,playback-rate=-1,"
+                                  "fps=60"),
+                &start_frame, &playback_rate));
+  EXPECT_EQ(0u, start_frame);
+  EXPECT_EQ(1.0, playback_rate);
+}
+
 }  // namespace media
@@ -4,6 +4,7 @@
 
 #include "media/capture/video/linux/fake_v4l2_impl.h"
 
+#include <errno.h>
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/time.h>
@@ -37,7 +38,9 @@ struct FakeV4L2Buffer {
         offset(offset),
         length(length),
         flags(V4L2_BUF_FLAG_MAPPED),
-        sequence(0) {}
+        sequence(0),
+        user_ptr(0),
+        user_ptr_length(0) {}
 
   const __u32 index;
   const __u32 offset;
@@ -46,6 +49,9 @@ struct FakeV4L2Buffer {
   timeval timestamp;
   __u32 sequence;
   std::unique_ptr<uint8_t[]> data;
+  // Client memory queued with V4L2_MEMORY_USERPTR.
+  unsigned long user_ptr;
+  __u32 user_ptr_length;
 };
 
 class FakeV4L2Impl::OpenedDevice {
@@ -53,6 +59,7 @@ class FakeV4L2Impl::OpenedDevice {
   explicit OpenedDevice(const FakeV4L2DeviceConfig& config, int open_flags)
       : config_(config),
         open_flags_(open_flags),
+        memory_type_(V4L2_MEMORY_MMAP),
         wait_for_outgoing_queue_event_(
             base::WaitableEvent::ResetPolicy::AUTOMATIC),
         frame_production_thread_("FakeV4L2Impl FakeProductionThread") {
@@ -181,10 +188,12 @@ class FakeV4L2Impl::OpenedDevice {
   int reqbufs(v4l2_requestbuffers* bufs) {
     if (bufs->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
       return EINVAL;
-    if (bufs->memory != V4L2_MEMORY_MMAP) {
-      // We only support device-owned buffers
-      return EINVAL;
+    if (bufs->memory != V4L2_MEMORY_MMAP &&
+        (bufs->memory != V4L2_MEMORY_USERPTR || !config_.supports_user_ptr)) {
+      errno = EINVAL;
+      return kErrorReturnValue;
     }
+    memory_type_ = static_cast<v4l2_memory>(bufs->memory);
     incoming_queue_ = std::queue<FakeV4L2Buffer*>();
     outgoing_queue_ = std::queue<FakeV4L2Buffer*>();
     device_buffers_.clear();
@@ -206,7 +215,7 @@ class FakeV4L2Impl::OpenedDevice {
     if (buf->index >= device_buffers_.size())
       return EINVAL;
     auto& buffer = device_buffers_[buf->index];
-    buf->memory = V4L2_MEMORY_MMAP;
+    buf->memory = memory_type_;
     buf->flags = buffer.flags;
     buf->m.offset = buffer.offset;
     buf->length = buffer.length;
@@ -216,11 +225,17 @@ class FakeV4L2Impl::OpenedDevice {
   int qbuf(v4l2_buffer* buf) {
     if (buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
       return EINVAL;
-    if (buf->memory != V4L2_MEMORY_MMAP)
+    if (buf->memory != memory_type_)
       return EINVAL;
     if (buf->index >= device_buffers_.size())
       return EINVAL;
     auto& buffer = device_buffers_[buf->index];
+    if (memory_type_ == V4L2_MEMORY_USERPTR) {
+      if (!buf->m.userptr || buf->length < selected_format_.sizeimage)
+        return EINVAL;
+      buffer.user_ptr = buf->m.userptr;
+      buffer.user_ptr_length = buf->length;
+    }
     buffer.flags = V4L2_BUF_FLAG_MAPPED & V4L2_BUF_FLAG_QUEUED;
     buf->flags = buffer.flags;
 
@@ -232,7 +247,7 @@ class FakeV4L2Impl::OpenedDevice {
   int dqbuf(v4l2_buffer* buf) {
     if (buf->type != V4L2_BUF_TYPE_VIDEO_CAPTURE)
       return EINVAL;
-    if (buf->memory != V4L2_MEMORY_MMAP)
+    if (buf->memory != memory_type_)
       return EINVAL;
     bool outgoing_queue_is_empty = true;
     {
@@ -256,8 +271,13 @@ class FakeV4L2Impl::OpenedDevice {
     buf->field = V4L2_FIELD_NONE;
     buf->timestamp = buffer->timestamp;
     buf->sequence = buffer->sequence;
-    buf->m.offset = buffer->offset;
-    buf->length = buffer->length;
+    if (memory_type_ == V4L2_MEMORY_USERPTR) {
+      buf->m.userptr = buffer->user_ptr;
+      buf->length = buffer->user_ptr_length;
+    } else {
+      buf->m.offset = buffer->offset;
+      buf->length = buffer->length;
+    }
 
     return kSuccessReturnValue;
   }
@@ -297,7 +317,8 @@ class FakeV4L2Impl::OpenedDevice {
 
   void MaybeProduceOneFrame() {
     // We do not actually produce any frame data. Just move a buffer from
-    // incoming queue to outgoing queue.
+    // incoming queue to outgoing queue. Client buffers are stamped with the
+    // frame counter so tests can tell that the device wrote into them.
     base::AutoLock lock(incoming_queue_lock_);
     base::AutoLock lock2(outgoing_queue_lock_);
     if (incoming_queue_.empty()) {
@@ -308,6 +329,10 @@ class FakeV4L2Impl::OpenedDevice {
     gettimeofday(&buffer->timestamp, NULL);
     static __u32 frame_counter = 0;
     buffer->sequence = frame_counter++;
+    if (memory_type_ == V4L2_MEMORY_USERPTR) {
+      memset(reinterpret_cast<void*>(buffer->user_ptr), buffer->sequence & 0xff,
+             selected_format_.sizeimage);
+    }
     incoming_queue_.pop();
     outgoing_queue_.push(buffer);
     wait_for_outgoing_queue_event_.Signal();
@@ -315,6 +340,7 @@ class FakeV4L2Impl::OpenedDevice {
 
   const FakeV4L2DeviceConfig config_;
   const int open_flags_;
+  v4l2_memory memory_type_;
   v4l2_pix_format selected_format_;
   v4l2_fract timeperframe_;
   std::vector<FakeV4L2Buffer> device_buffers_;
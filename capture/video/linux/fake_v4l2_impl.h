@@ -21,6 +21,9 @@ struct FakeV4L2DeviceConfig {
       : descriptor(descriptor) {}
 
   const VideoCaptureDeviceDescriptor descriptor;
+  // Whether the device accepts V4L2_MEMORY_USERPTR buffers in addition to
+  // device-owned V4L2_MEMORY_MMAP ones.
+  bool supports_user_ptr = false;
 };
 
 // Implementation of V4L2CaptureDevice interface that allows configuring fake
@@ -21,6 +21,7 @@
 #include "media/capture/mojom/image_capture_types.h"
 #include "media/capture/video/blob_utils.h"
 #include "media/capture/video/linux/video_capture_device_linux.h"
+#include "media/capture/video/video_capture_buffer_handle.h"
 
 using media::mojom::MeteringMode;
 
@@ -41,11 +42,6 @@ namespace media {
 
 namespace {
 
-// Desired number of video buffers to allocate. The actual number of allocated
-// buffers by v4l2 driver can be higher or lower than this number.
-// kNumVideoBuffers should not be too small, or Chrome may not return enough
-// buffers back to driver in time.
-constexpr uint32_t kNumVideoBuffers = 4;
 // Timeout in milliseconds v4l2_thread_ blocks waiting for a frame from the hw.
 // This value has been fine tuned. Before changing or modifying it see
 // https://crbug.com/470717
@@ -57,6 +53,10 @@ constexpr int kMjpegWidth = 640;
 constexpr int kMjpegHeight = 480;
 // Typical framerate, in fps
 constexpr int kTypicalFramerate = 30;
+// How long to wait before trying to reserve client buffers again when every
+// V4L2_MEMORY_USERPTR buffer is out with consumers.
+constexpr base::TimeDelta kUserPtrBufferRetryDelay =
+    base::TimeDelta::FromMilliseconds(5);
 
 // V4L2 color formats supported by V4L2CaptureDelegate derived classes.
 // This list is ordered by precedence of use -- but see caveats for MJPEG.
@@ -106,17 +106,19 @@ void FillV4L2Format(v4l2_format* format,
 }
 
 // Fills all parts of |buffer|.
-void FillV4L2Buffer(v4l2_buffer* buffer, int index) {
+void FillV4L2Buffer(v4l2_buffer* buffer, int index, v4l2_memory memory) {
   memset(buffer, 0, sizeof(*buffer));
-  buffer->memory = V4L2_MEMORY_MMAP;
+  buffer->memory = memory;
   buffer->index = index;
   buffer->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
 }
 
-void FillV4L2RequestBuffer(v4l2_requestbuffers* request_buffer, int count) {
+void FillV4L2RequestBuffer(v4l2_requestbuffers* request_buffer,
+                           int count,
+                           v4l2_memory memory) {
   memset(request_buffer, 0, sizeof(*request_buffer));
   request_buffer->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-  request_buffer->memory = V4L2_MEMORY_MMAP;
+  request_buffer->memory = memory;
   request_buffer->count = count;
 }
 
@@ -190,6 +192,16 @@ class V4L2CaptureDelegate::BufferTracker
   size_t payload_size_;
 };
 
+// A |client_| buffer lent to the driver as V4L2_MEMORY_USERPTR memory.
+// |handle| maps the buffer for the driver to write into.
+struct V4L2CaptureDelegate::UserPtrBuffer {
+  VideoCaptureDevice::Client::Buffer buffer;
+  std::unique_ptr<VideoCaptureBufferHandle> handle;
+};
+
+// static
+constexpr uint32_t V4L2CaptureDelegate::kDefaultNumVideoBuffers;
+
 // static
 size_t V4L2CaptureDelegate::GetNumPlanesForFourCc(uint32_t fourcc) {
   for (const auto& fourcc_and_pixel_format : kSupportedFormatsAndPlanarity) {
@@ -234,12 +246,16 @@ V4L2CaptureDelegate::V4L2CaptureDelegate(
     V4L2CaptureDevice* v4l2,
     const VideoCaptureDeviceDescriptor& device_descriptor,
     const scoped_refptr<base::SingleThreadTaskRunner>& v4l2_task_runner,
-    int power_line_frequency)
+    int power_line_frequency,
+    uint32_t num_video_buffers)
     : v4l2_(v4l2),
       v4l2_task_runner_(v4l2_task_runner),
       device_descriptor_(device_descriptor),
       power_line_frequency_(power_line_frequency),
+      num_video_buffers_(num_video_buffers),
       device_fd_(v4l2),
+      memory_type_(V4L2_MEMORY_MMAP),
+      next_frame_feedback_id_(0),
       is_capturing_(false),
       timeout_count_(0),
       rotation_(0),
@@ -352,19 +368,24 @@ void V4L2CaptureDelegate::AllocateAndStart(
   capture_format_.frame_rate = frame_rate;
   capture_format_.pixel_format = pixel_format;
 
-  v4l2_requestbuffers r_buffer;
-  FillV4L2RequestBuffer(&r_buffer, kNumVideoBuffers);
-  if (DoIoctl(VIDIOC_REQBUFS, &r_buffer) < 0) {
-    SetErrorState(VideoCaptureError::kV4L2ErrorRequestingMmapBuffers, FROM_HERE,
-                  "Error requesting MMAP buffers from V4L2");
-    return;
-  }
-  for (unsigned int i = 0; i < r_buffer.count; ++i) {
-    if (!MapAndQueueBuffer(i)) {
-      SetErrorState(VideoCaptureError::kV4L2AllocateBufferFailed, FROM_HERE,
-                    "Allocate buffer failed");
+  // Frames which |client_| can take as they are get captured straight into
+  // its buffers; everything else goes through mmap()ed driver buffers and is
+  // copied or converted by |client_|.
+  if (!CanCaptureIntoClientBuffers() || !StartZeroCopyCapture()) {
+    v4l2_requestbuffers r_buffer;
+    FillV4L2RequestBuffer(&r_buffer, num_video_buffers_, V4L2_MEMORY_MMAP);
+    if (DoIoctl(VIDIOC_REQBUFS, &r_buffer) < 0) {
+      SetErrorState(VideoCaptureError::kV4L2ErrorRequestingMmapBuffers,
+                    FROM_HERE, "Error requesting MMAP buffers from V4L2");
       return;
     }
+    for (unsigned int i = 0; i < r_buffer.count; ++i) {
+      if (!MapAndQueueBuffer(i)) {
+        SetErrorState(VideoCaptureError::kV4L2AllocateBufferFailed, FROM_HERE,
+                      "Allocate buffer failed");
+        return;
+      }
+    }
   }
 
   v4l2_buf_type capture_type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -394,13 +415,15 @@ void V4L2CaptureDelegate::StopAndDeAllocate() {
   }
 
   buffer_tracker_pool_.clear();
+  user_ptr_buffers_.clear();
 
   v4l2_requestbuffers r_buffer;
-  FillV4L2RequestBuffer(&r_buffer, 0);
+  FillV4L2RequestBuffer(&r_buffer, 0, memory_type_);
   if (DoIoctl(VIDIOC_REQBUFS, &r_buffer) < 0) {
     SetErrorState(VideoCaptureError::kV4L2FailedToVidiocReqbufsWithCount0,
                   FROM_HERE, "Failed to VIDIOC_REQBUFS with count = 0");
   }
+  memory_type_ = V4L2_MEMORY_MMAP;
 
   // At this point we can close the device.
   // This is also needed for correctly changing settings later via VIDIOC_S_FMT.
@@ -767,7 +790,7 @@ void V4L2CaptureDelegate::ResetUserAndCameraControlsToDefault() {
 
 bool V4L2CaptureDelegate::MapAndQueueBuffer(int index) {
   v4l2_buffer buffer;
-  FillV4L2Buffer(&buffer, index);
+  FillV4L2Buffer(&buffer, index, V4L2_MEMORY_MMAP);
 
   if (DoIoctl(VIDIOC_QUERYBUF, &buffer) < 0) {
     DLOG(ERROR) << "Error querying status of a MMAP V4L2 buffer";
@@ -789,11 +812,110 @@ bool V4L2CaptureDelegate::MapAndQueueBuffer(int index) {
   return true;
 }
 
+bool V4L2CaptureDelegate::CanCaptureIntoClientBuffers() const {
+  const v4l2_pix_format& pix = video_fmt_.fmt.pix;
+  return capture_format_.pixel_format == PIXEL_FORMAT_I420 &&
+         pix.bytesperline == pix.width && pix.width % 2 == 0 &&
+         pix.height % 2 == 0 &&
+         pix.sizeimage == capture_format_.ImageAllocationSize();
+}
+
+bool V4L2CaptureDelegate::StartZeroCopyCapture() {
+  v4l2_requestbuffers r_buffer;
+  FillV4L2RequestBuffer(&r_buffer, num_video_buffers_, V4L2_MEMORY_USERPTR);
+  if (DoIoctl(VIDIOC_REQBUFS, &r_buffer) < 0 || r_buffer.count == 0) {
+    DVLOG(1) << "V4L2_MEMORY_USERPTR buffers are not supported";
+    return false;
+  }
+
+  memory_type_ = V4L2_MEMORY_USERPTR;
+  user_ptr_buffers_.resize(r_buffer.count);
+  if (QueueUserPtrBuffers() && HasQueuedUserPtrBuffers())
+    return true;
+
+  DVLOG(1) << "Failed to queue client buffers, falling back to MMAP";
+  user_ptr_buffers_.clear();
+  FillV4L2RequestBuffer(&r_buffer, 0, V4L2_MEMORY_USERPTR);
+  DoIoctl(VIDIOC_REQBUFS, &r_buffer);
+  memory_type_ = V4L2_MEMORY_MMAP;
+  return false;
+}
+
+bool V4L2CaptureDelegate::QueueUserPtrBuffers() {
+  DCHECK_EQ(V4L2_MEMORY_USERPTR, memory_type_);
+  // There is one slot per buffer the driver granted for |num_video_buffers_|.
+  // The client's pool may be smaller than that, in which case reserving stops
+  // once the pool is exhausted.
+  for (size_t index = 0; index < user_ptr_buffers_.size(); ++index) {
+    if (user_ptr_buffers_[index])
+      continue;
+
+    // The driver fills buffers in the order they are queued, so the frame
+    // captured into this buffer is the one with the next feedback id.
+    auto user_ptr_buffer = std::make_unique<UserPtrBuffer>();
+    const auto result = client_->ReserveOutputBuffer(
+        capture_format_.frame_size, PIXEL_FORMAT_I420, next_frame_feedback_id_,
+        &user_ptr_buffer->buffer);
+    if (result != VideoCaptureDevice::Client::ReserveResult::kSucceeded) {
+      // Every buffer of the pool is queued or held by consumers; try again on
+      // the next capture.
+      return true;
+    }
+    ++next_frame_feedback_id_;
+    user_ptr_buffer->handle =
+        user_ptr_buffer->buffer.handle_provider->GetHandleForInProcessAccess();
+    if (!QueueUserPtrBuffer(index, std::move(user_ptr_buffer)))
+      return false;
+  }
+  return true;
+}
+
+bool V4L2CaptureDelegate::QueueUserPtrBuffer(
+    int index,
+    std::unique_ptr<UserPtrBuffer> user_ptr_buffer) {
+  v4l2_buffer buffer;
+  FillV4L2Buffer(&buffer, index, V4L2_MEMORY_USERPTR);
+  buffer.m.userptr =
+      reinterpret_cast<unsigned long>(user_ptr_buffer->handle->data());
+  buffer.length = user_ptr_buffer->handle->mapped_size();
+  if (DoIoctl(VIDIOC_QBUF, &buffer) < 0) {
+    DLOG(ERROR) << "Error enqueuing a V4L2 USERPTR buffer into the driver";
+    return false;
+  }
+  user_ptr_buffers_[index] = std::move(user_ptr_buffer);
+  return true;
+}
+
+bool V4L2CaptureDelegate::HasQueuedUserPtrBuffers() const {
+  for (const auto& user_ptr_buffer : user_ptr_buffers_) {
+    if (user_ptr_buffer)
+      return true;
+  }
+  return false;
+}
+
 void V4L2CaptureDelegate::DoCapture() {
   DCHECK(v4l2_task_runner_->BelongsToCurrentThread());
   if (!is_capturing_)
     return;
 
+  if (memory_type_ == V4L2_MEMORY_USERPTR) {
+    if (!QueueUserPtrBuffers()) {
+      SetErrorState(VideoCaptureError::kV4L2FailedToEnqueueCaptureBuffer,
+                    FROM_HERE, "Failed to enqueue capture buffer");
+      return;
+    }
+    // Polling without any queued buffer fails right away, so wait for
+    // consumers to return some buffers instead.
+    if (!HasQueuedUserPtrBuffers()) {
+      v4l2_task_runner_->PostDelayedTask(
+          FROM_HERE,
+          base::BindOnce(&V4L2CaptureDelegate::DoCapture, GetWeakPtr()),
+          kUserPtrBufferRetryDelay);
+      return;
+    }
+  }
+
   pollfd device_pfd = {};
   device_pfd.fd = device_fd_.get();
   device_pfd.events = POLLIN;
@@ -823,7 +945,7 @@ void V4L2CaptureDelegate::DoCapture() {
   // Deenqueue, send and reenqueue a buffer if the driver has filled one in.
   if (device_pfd.revents & POLLIN) {
     v4l2_buffer buffer;
-    FillV4L2Buffer(&buffer, 0);
+    FillV4L2Buffer(&buffer, 0, memory_type_);
 
     if (DoIoctl(VIDIOC_DQBUF, &buffer) < 0) {
       SetErrorState(VideoCaptureError::kV4L2FailedToDequeueCaptureBuffer,
@@ -831,9 +953,18 @@ void V4L2CaptureDelegate::DoCapture() {
       return;
     }
 
-    buffer_tracker_pool_[buffer.index]->set_payload_size(buffer.bytesused);
-    const scoped_refptr<BufferTracker>& buffer_tracker =
-        buffer_tracker_pool_[buffer.index];
+    // In V4L2_MEMORY_USERPTR mode the frame was captured straight into a
+    // |client_| buffer, which is handed over below if possible.
+    std::unique_ptr<UserPtrBuffer> user_ptr_buffer;
+    const uint8_t* data;
+    if (memory_type_ == V4L2_MEMORY_USERPTR) {
+      user_ptr_buffer = std::move(user_ptr_buffers_[buffer.index]);
+      DCHECK(user_ptr_buffer);
+      data = user_ptr_buffer->handle->const_data();
+    } else {
+      buffer_tracker_pool_[buffer.index]->set_payload_size(buffer.bytesused);
+      data = buffer_tracker_pool_[buffer.index]->start();
+    }
 
     // There's a wide-spread issue where the kernel does not report accurate,
     // monotonically-increasing timestamps in the v4l2_buffer::timestamp
@@ -850,6 +981,7 @@ void V4L2CaptureDelegate::DoCapture() {
 #else
     bool buf_error_flag_set = false;
 #endif
+    bool frame_is_valid = false;
     if (buf_error_flag_set) {
 #ifdef V4L2_BUF_FLAG_ERROR
       LOG(ERROR) << "Dequeued v4l2 buffer contains corrupted data ("
@@ -865,24 +997,41 @@ void V4L2CaptureDelegate::DoCapture() {
       client_->OnFrameDropped(
           VideoCaptureFrameDropReason::kV4L2InvalidNumberOfBytesInBuffer);
     } else {
-      client_->OnIncomingCapturedData(
-          buffer_tracker->start(), buffer_tracker->payload_size(),
-          capture_format_, rotation_, now, timestamp);
+      frame_is_valid = true;
     }
 
+    // Photos are taken before the frame is delivered, since delivering may
+    // hand |data| over to consumers.
     while (!take_photo_callbacks_.empty()) {
       VideoCaptureDevice::TakePhotoCallback cb =
           std::move(take_photo_callbacks_.front());
       take_photo_callbacks_.pop();
 
       mojom::BlobPtr blob =
-          RotateAndBlobify(buffer_tracker->start(), buffer.bytesused,
-                           capture_format_, rotation_);
+          RotateAndBlobify(data, buffer.bytesused, capture_format_, rotation_);
       if (blob)
         std::move(cb).Run(std::move(blob));
     }
 
-    if (DoIoctl(VIDIOC_QBUF, &buffer) < 0) {
+    if (frame_is_valid) {
+      if (user_ptr_buffer && rotation_ == 0) {
+        user_ptr_buffer->handle.reset();
+        client_->OnIncomingCapturedBuffer(std::move(user_ptr_buffer->buffer),
+                                          capture_format_, now, timestamp);
+        user_ptr_buffer.reset();
+      } else {
+        // Rotated frames still need to be copied by |client_|.
+        client_->OnIncomingCapturedData(
+            data, buffer.bytesused, capture_format_, rotation_, now, timestamp,
+            user_ptr_buffer ? user_ptr_buffer->buffer.frame_feedback_id : 0);
+      }
+    }
+
+    // Client buffers which weren't handed over are released rather than queued
+    // again, since their feedback id belongs to this frame; all free slots are
+    // refilled by QueueUserPtrBuffers() on the next capture.
+    user_ptr_buffer.reset();
+    if (memory_type_ == V4L2_MEMORY_MMAP && DoIoctl(VIDIOC_QBUF, &buffer) < 0) {
       SetErrorState(VideoCaptureError::kV4L2FailedToEnqueueCaptureBuffer,
                     FROM_HERE, "Failed to enqueue capture buffer");
       return;
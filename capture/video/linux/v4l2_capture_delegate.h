@@ -47,11 +47,19 @@ class CAPTURE_EXPORT V4L2CaptureDelegate final {
   // preference, with MJPEG prioritised depending on |prefer_mjpeg|.
   static std::vector<uint32_t> GetListOfUsableFourCcs(bool prefer_mjpeg);
 
+  // Desired number of video buffers to allocate when the embedder doesn't ask
+  // for a particular number. The actual number of allocated buffers by the
+  // v4l2 driver can be higher or lower than the requested one.
+  static constexpr uint32_t kDefaultNumVideoBuffers = 4;
+
+  // |num_video_buffers| should not be too small, or Chrome may not return
+  // enough buffers back to driver in time.
   V4L2CaptureDelegate(
       V4L2CaptureDevice* v4l2,
       const VideoCaptureDeviceDescriptor& device_descriptor,
       const scoped_refptr<base::SingleThreadTaskRunner>& v4l2_task_runner,
-      int power_line_frequency);
+      int power_line_frequency,
+      uint32_t num_video_buffers);
   ~V4L2CaptureDelegate();
 
   // Forward-to versions of VideoCaptureDevice virtual methods.
@@ -99,6 +107,29 @@ class CAPTURE_EXPORT V4L2CaptureDelegate final {
   // enqueues it (VIDIOC_QBUF) back into V4L2.
   bool MapAndQueueBuffer(int index);
 
+  // Returns true if frames in |video_fmt_| can be handed to |client_| exactly
+  // as the driver produces them, i.e. they are tightly packed I420.
+  bool CanCaptureIntoClientBuffers() const;
+
+  // Requests V4L2_MEMORY_USERPTR buffers from the driver and queues buffers
+  // reserved from |client_| into them, so that the driver captures straight
+  // into memory which is then passed on to consumers without a copy. Returns
+  // false, leaving no buffers requested, if the driver doesn't support user
+  // pointers or |client_| has no buffer to spare.
+  bool StartZeroCopyCapture();
+
+  // Reserves |client_| buffers for free V4L2_MEMORY_USERPTR slots and queues
+  // them, until every slot is filled. Each buffer is reserved with the feedback
+  // id of the frame the driver will capture into it. Stops without error when
+  // |client_| runs out of buffers. Returns false if the driver refuses a
+  // buffer.
+  bool QueueUserPtrBuffers();
+
+  struct UserPtrBuffer;
+  bool QueueUserPtrBuffer(int index,
+                          std::unique_ptr<UserPtrBuffer> user_ptr_buffer);
+  bool HasQueuedUserPtrBuffers() const;
+
   void DoCapture();
 
   void SetErrorState(VideoCaptureError error,
@@ -109,6 +140,7 @@ class CAPTURE_EXPORT V4L2CaptureDelegate final {
   const scoped_refptr<base::SingleThreadTaskRunner> v4l2_task_runner_;
   const VideoCaptureDeviceDescriptor device_descriptor_;
   const int power_line_frequency_;
+  const uint32_t num_video_buffers_;
 
   // The following members are only known on AllocateAndStart().
   VideoCaptureFormat capture_format_;
@@ -118,9 +150,20 @@ class CAPTURE_EXPORT V4L2CaptureDelegate final {
 
   base::queue<VideoCaptureDevice::TakePhotoCallback> take_photo_callbacks_;
 
+  // Either V4L2_MEMORY_MMAP or, when capturing straight into |client_|'s
+  // buffers, V4L2_MEMORY_USERPTR.
+  v4l2_memory memory_type_;
+
   // Vector of BufferTracker to keep track of mmap()ed pointers and their use.
   std::vector<scoped_refptr<BufferTracker>> buffer_tracker_pool_;
 
+  // |client_| buffers queued into the driver, indexed by v4l2_buffer::index.
+  // Entries are null while their slot is free.
+  std::vector<std::unique_ptr<UserPtrBuffer>> user_ptr_buffers_;
+
+  // Feedback id for the next |client_| buffer queued into the driver.
+  int next_frame_feedback_id_;
+
   bool is_capturing_;
   int timeout_count_;
 
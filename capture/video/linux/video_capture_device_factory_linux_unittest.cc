@@ -5,12 +5,15 @@
 #include "media/capture/video/linux/video_capture_device_factory_linux.h"
 #include "base/run_loop.h"
 #include "base/test/scoped_task_environment.h"
+#include "media/base/video_frame.h"
 #include "media/capture/video/linux/fake_v4l2_impl.h"
 #include "media/capture/video/mock_video_capture_device_client.h"
+#include "media/capture/video/stub_buffer_handle_provider.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 using ::testing::_;
+using ::testing::Invoke;
 using ::testing::InvokeWithoutArgs;
 
 namespace media {
@@ -82,10 +85,21 @@ class VideoCaptureDeviceFactoryLinuxTest : public ::testing::Test {
                                            std::move(fake_device_provider));
   }
 
+  VideoCaptureDevice::Client::ReserveResult ReserveStubBuffer(
+      const gfx::Size& dimensions,
+      VideoPixelFormat format,
+      int frame_feedback_id,
+      VideoCaptureDevice::Client::Buffer* buffer) {
+    *buffer = CreateStubBuffer(next_buffer_id_++, frame_feedback_id,
+                               VideoFrame::AllocationSize(format, dimensions));
+    return VideoCaptureDevice::Client::ReserveResult::kSucceeded;
+  }
+
   base::test::ScopedTaskEnvironment scoped_task_environment_;
   FakeV4L2Impl* fake_v4l2_;
   DescriptorDeviceProvider* fake_device_provider_;
   std::unique_ptr<VideoCaptureDeviceFactoryLinux> factory_;
+  int next_buffer_id_ = 0;
 };
 
 TEST_F(VideoCaptureDeviceFactoryLinuxTest, EnumerateSingleFakeV4L2Device) {
@@ -143,4 +157,57 @@ TEST_F(VideoCaptureDeviceFactoryLinuxTest,
   device->StopAndDeAllocate();
 }
 
+TEST_F(VideoCaptureDeviceFactoryLinuxTest,
+       ReceiveFramesInClientBuffersFromUserPtrFakeDevice) {
+  // Setup
+  const std::string stub_display_name = "Fake Device 0";
+  const std::string stub_device_id = "/dev/video0";
+  VideoCaptureDeviceDescriptor descriptor(
+      stub_display_name, stub_device_id,
+      VideoCaptureApi::LINUX_V4L2_SINGLE_PLANE);
+  fake_device_provider_->AddDevice(descriptor);
+  FakeV4L2DeviceConfig config(descriptor);
+  config.supports_user_ptr = true;
+  fake_v4l2_->AddDevice(stub_device_id, config);
+
+  // Exercise
+  auto device = factory_->CreateDevice(descriptor);
+  VideoCaptureParams arbitrary_params;
+  arbitrary_params.requested_format.frame_size = gfx::Size(1280, 720);
+  arbitrary_params.requested_format.frame_rate = 30.0f;
+  arbitrary_params.requested_format.pixel_format = PIXEL_FORMAT_I420;
+  auto client = std::make_unique<MockVideoCaptureDeviceClient>();
+  MockVideoCaptureDeviceClient* client_ptr = client.get();
+  EXPECT_CALL(*client_ptr, ReserveOutputBuffer(_, PIXEL_FORMAT_I420, _, _))
+      .WillRepeatedly(
+          Invoke(this, &VideoCaptureDeviceFactoryLinuxTest::ReserveStubBuffer));
+
+  // Frames are written straight into the reserved buffers and handed over
+  // without a copy, each with its own feedback id.
+  base::RunLoop wait_loop;
+  static const int kFrameToReceive = 3;
+  int received_frame_count = 0;
+  EXPECT_CALL(*client_ptr, OnIncomingCapturedData(_, _, _, _, _, _, _))
+      .Times(0);
+  EXPECT_CALL(*client_ptr, DoOnIncomingCapturedBuffer(_, _, _, _))
+      .WillRepeatedly(Invoke([&wait_loop, &received_frame_count](
+                                 VideoCaptureDevice::Client::Buffer& buffer,
+                                 const VideoCaptureFormat& format,
+                                 base::TimeTicks, base::TimeDelta) {
+        EXPECT_EQ(gfx::Size(1280, 720), format.frame_size);
+        EXPECT_EQ(received_frame_count, buffer.frame_feedback_id);
+        auto handle = buffer.handle_provider->GetHandleForInProcessAccess();
+        const uint8_t* data = handle->const_data();
+        EXPECT_EQ(data[0], data[handle->mapped_size() - 1]);
+        received_frame_count++;
+        if (received_frame_count == kFrameToReceive)
+          wait_loop.Quit();
+      }));
+
+  device->AllocateAndStart(arbitrary_params, std::move(client));
+  wait_loop.Run();
+
+  device->StopAndDeAllocate();
+}
+
 };  // namespace media
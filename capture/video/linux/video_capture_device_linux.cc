@@ -9,8 +9,11 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/command_line.h"
 #include "base/single_thread_task_runner.h"
+#include "base/strings/string_number_conversions.h"
 #include "build/build_config.h"
+#include "media/base/media_switches.h"
 #include "media/capture/video/linux/v4l2_capture_delegate.h"
 
 #if defined(OS_OPENBSD)
@@ -35,6 +38,21 @@ int TranslatePowerLineFrequencyToV4L2(PowerLineFrequency frequency) {
   }
 }
 
+// Returns the number of buffers to request from the driver; more buffers
+// absorb longer consumer stalls at the cost of memory and latency.
+uint32_t GetNumberOfV4L2Buffers() {
+  const base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  int num_buffers = 0;
+  if (cmd_line->HasSwitch(switches::kV4L2CaptureBuffers) &&
+      base::StringToInt(
+          cmd_line->GetSwitchValueASCII(switches::kV4L2CaptureBuffers),
+          &num_buffers) &&
+      num_buffers > 0) {
+    return num_buffers;
+  }
+  return V4L2CaptureDelegate::kDefaultNumVideoBuffers;
+}
+
 }  // namespace
 
 // Translates Video4Linux pixel formats to Chromium pixel formats.
@@ -77,7 +95,7 @@ void VideoCaptureDeviceLinux::AllocateAndStart(
       TranslatePowerLineFrequencyToV4L2(GetPowerLineFrequency(params));
   capture_impl_ = std::make_unique<V4L2CaptureDelegate>(
       v4l2_.get(), device_descriptor_, v4l2_thread_.task_runner(),
-      line_frequency);
+      line_frequency, GetNumberOfV4L2Buffers());
   if (!capture_impl_) {
     client->OnError(VideoCaptureError::
                         kDeviceCaptureLinuxFailedToCreateVideoCaptureDelegate,
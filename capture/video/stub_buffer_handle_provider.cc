@@ -0,0 +1,70 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/capture/video/stub_buffer_handle_provider.h"
+
+#include <utility>
+
+#include "base/logging.h"
+
+namespace media {
+
+StubBufferHandle::StubBufferHandle(size_t mapped_size, uint8_t* data)
+    : mapped_size_(mapped_size), data_(data) {}
+
+StubBufferHandle::~StubBufferHandle() = default;
+
+size_t StubBufferHandle::mapped_size() const {
+  return mapped_size_;
+}
+
+uint8_t* StubBufferHandle::data() const {
+  return data_;
+}
+
+const uint8_t* StubBufferHandle::const_data() const {
+  return data_;
+}
+
+StubBufferHandleProvider::StubBufferHandleProvider(size_t mapped_size,
+                                                   uint8_t* data)
+    : mapped_size_(mapped_size), data_(data) {}
+
+StubBufferHandleProvider::~StubBufferHandleProvider() = default;
+
+mojo::ScopedSharedBufferHandle
+StubBufferHandleProvider::GetHandleForInterProcessTransit(bool read_only) {
+  NOTREACHED();
+  return mojo::ScopedSharedBufferHandle();
+}
+
+base::SharedMemoryHandle
+StubBufferHandleProvider::GetNonOwnedSharedMemoryHandleForLegacyIPC() {
+  NOTREACHED();
+  return base::SharedMemoryHandle();
+}
+
+std::unique_ptr<VideoCaptureBufferHandle>
+StubBufferHandleProvider::GetHandleForInProcessAccess() {
+  return std::make_unique<StubBufferHandle>(mapped_size_, data_);
+}
+
+StubReadWritePermission::StubReadWritePermission(
+    std::unique_ptr<uint8_t[]> data)
+    : data_(std::move(data)) {}
+
+StubReadWritePermission::~StubReadWritePermission() = default;
+
+VideoCaptureDevice::Client::Buffer CreateStubBuffer(int buffer_id,
+                                                    int frame_feedback_id,
+                                                    size_t mapped_size) {
+  auto data = std::make_unique<uint8_t[]>(mapped_size);
+  uint8_t* const data_ptr = data.get();
+  return VideoCaptureDevice::Client::Buffer(
+      buffer_id, frame_feedback_id,
+      std::make_unique<StubBufferHandleProvider>(mapped_size, data_ptr),
+      std::make_unique<StubReadWritePermission>(std::move(data)));
+}
+
+}  // namespace media
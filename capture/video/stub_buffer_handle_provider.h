@@ -0,0 +1,82 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_CAPTURE_VIDEO_STUB_BUFFER_HANDLE_PROVIDER_H_
+#define MEDIA_CAPTURE_VIDEO_STUB_BUFFER_HANDLE_PROVIDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/macros.h"
+#include "media/capture/video/video_capture_buffer_handle.h"
+#include "media/capture/video/video_capture_device.h"
+
+namespace media {
+
+// In-process handle to |mapped_size| bytes at |data|.
+class StubBufferHandle : public VideoCaptureBufferHandle {
+ public:
+  StubBufferHandle(size_t mapped_size, uint8_t* data);
+  ~StubBufferHandle() override;
+
+  size_t mapped_size() const override;
+  uint8_t* data() const override;
+  const uint8_t* const_data() const override;
+
+ private:
+  const size_t mapped_size_;
+  uint8_t* const data_;
+
+  DISALLOW_COPY_AND_ASSIGN(StubBufferHandle);
+};
+
+// Hands out StubBufferHandles to |mapped_size| bytes at |data|. Only
+// in-process access is supported.
+class StubBufferHandleProvider
+    : public VideoCaptureDevice::Client::Buffer::HandleProvider {
+ public:
+  StubBufferHandleProvider(size_t mapped_size, uint8_t* data);
+  ~StubBufferHandleProvider() override;
+
+  mojo::ScopedSharedBufferHandle GetHandleForInterProcessTransit(
+      bool read_only) override;
+  base::SharedMemoryHandle GetNonOwnedSharedMemoryHandleForLegacyIPC()
+      override;
+  std::unique_ptr<VideoCaptureBufferHandle> GetHandleForInProcessAccess()
+      override;
+
+ private:
+  const size_t mapped_size_;
+  uint8_t* const data_;
+
+  DISALLOW_COPY_AND_ASSIGN(StubBufferHandleProvider);
+};
+
+// Owns the memory of a stub buffer, so that it stays readable for as long as
+// the permission is held.
+class StubReadWritePermission
+    : public VideoCaptureDevice::Client::Buffer::ScopedAccessPermission {
+ public:
+  explicit StubReadWritePermission(std::unique_ptr<uint8_t[]> data);
+  ~StubReadWritePermission() override;
+
+  const uint8_t* data() const { return data_.get(); }
+
+ private:
+  const std::unique_ptr<uint8_t[]> data_;
+
+  DISALLOW_COPY_AND_ASSIGN(StubReadWritePermission);
+};
+
+// Returns a buffer of |mapped_size| bytes of heap memory, owned by its
+// StubReadWritePermission.
+VideoCaptureDevice::Client::Buffer CreateStubBuffer(int buffer_id,
+                                                    int frame_feedback_id,
+                                                    size_t mapped_size);
+
+}  // namespace media
+
+#endif  // MEDIA_CAPTURE_VIDEO_STUB_BUFFER_HANDLE_PROVIDER_H_
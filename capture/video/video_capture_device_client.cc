@@ -10,16 +10,21 @@
 
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/strings/stringprintf.h"
+#include "base/sys_info.h"
+#include "base/task_scheduler/task_scheduler.h"
 #include "base/trace_event/trace_event.h"
 #include "build/build_config.h"
 #include "media/base/bind_to_current_loop.h"
+#include "media/base/media_switches.h"
 #include "media/base/video_frame.h"
 #include "media/capture/video/scoped_buffer_pool_reservation.h"
 #include "media/capture/video/video_capture_buffer_handle.h"
 #include "media/capture/video/video_capture_buffer_pool.h"
 #include "media/capture/video/video_capture_jpeg_decoder.h"
+#include "media/capture/video/video_capture_parallel_jpeg_decoder.h"
 #include "media/capture/video/video_frame_receiver.h"
 #include "media/capture/video_capture_types.h"
 #include "third_party/libyuv/include/libyuv.h"
@@ -117,6 +122,9 @@ VideoCaptureDeviceClient::~VideoCaptureDeviceClient() {
   // |external_jpeg_decoder_| need to be destructed on the same thread as
   // OnIncomingCapturedData.
 
+  // Stop decoded frames from arriving for buffers retired below.
+  parallel_jpeg_decoder_.reset();
+
   for (int buffer_id : buffer_ids_known_by_receiver_)
     receiver_->OnBufferRetired(buffer_id);
 }
@@ -291,6 +299,31 @@ void VideoCaptureDeviceClient::OnIncomingCapturedData(
     }
   }
 
+  if (format.pixel_format == PIXEL_FORMAT_MJPEG && rotation == 0 && !flip &&
+      !external_jpeg_decoder_) {
+    if (!parallel_jpeg_decoder_ &&
+        base::FeatureList::IsEnabled(kVideoCaptureParallelJpegDecoding) &&
+        base::TaskScheduler::GetInstance() &&
+        base::SysInfo::NumberOfProcessors() > 1) {
+      // base::Unretained is safe because |parallel_jpeg_decoder_| is destroyed
+      // before |receiver_| and runs no callbacks afterwards.
+      parallel_jpeg_decoder_ =
+          std::make_unique<VideoCaptureParallelJpegDecoder>(
+              base::BindRepeating(&VideoFrameReceiver::OnFrameReadyInBuffer,
+                                  base::Unretained(receiver_.get())),
+              base::BindRepeating(&VideoFrameReceiver::OnFrameDropped,
+                                  base::Unretained(receiver_.get())),
+              base::BindRepeating(&VideoFrameReceiver::OnLog,
+                                  base::Unretained(receiver_.get())),
+              VideoCaptureParallelJpegDecoder::GetDefaultMaxFramesInFlight());
+    }
+    if (parallel_jpeg_decoder_) {
+      parallel_jpeg_decoder_->DecodeCapturedData(
+          data, length, format, reference_time, timestamp, std::move(buffer));
+      return;
+    }
+  }
+
   if (libyuv::ConvertToI420(
           data, length, y_plane_data, yplane_stride, u_plane_data,
           uv_plane_stride, v_plane_data, uv_plane_stride, crop_x, crop_y,
@@ -22,6 +22,7 @@ namespace media {
 class VideoCaptureBufferPool;
 class VideoFrameReceiver;
 class VideoCaptureJpegDecoder;
+class VideoCaptureParallelJpegDecoder;
 
 using VideoCaptureJpegDecoderFactoryCB =
     base::OnceCallback<std::unique_ptr<VideoCaptureJpegDecoder>()>;
@@ -32,7 +33,7 @@ using VideoCaptureJpegDecoderFactoryCB =
 // |optional_jpeg_decoder_factory_callback| is provided, the
 // VideoCaptureDeviceClient will attempt to use it for decoding of MJPEG frames.
 // Otherwise, it will use libyuv to perform MJPEG to I420 conversion in
-// software.
+// software, on several threads if possible.
 //
 // Methods of this class may be called from any thread, and in practice will
 // often be called on some auxiliary thread depending on the platform and the
@@ -111,6 +112,10 @@ class CAPTURE_EXPORT VideoCaptureDeviceClient
   std::unique_ptr<VideoCaptureJpegDecoder> external_jpeg_decoder_;
   base::OnceClosure on_started_using_gpu_cb_;
 
+  // Decodes MJPEG frames on TaskScheduler workers when there is no working
+  // |external_jpeg_decoder_|. Created on the first such frame.
+  std::unique_ptr<VideoCaptureParallelJpegDecoder> parallel_jpeg_decoder_;
+
   // The pool of shared-memory buffers used for capturing.
   const scoped_refptr<VideoCaptureBufferPool> buffer_pool_;
 
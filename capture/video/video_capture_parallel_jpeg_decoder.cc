@@ -0,0 +1,284 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/capture/video/video_capture_parallel_jpeg_decoder.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/containers/circular_deque.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/sys_info.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/trace_event/trace_event.h"
+#include "media/base/video_frame.h"
+#include "media/base/video_frame_metadata.h"
+#include "media/capture/video/video_capture_buffer_handle.h"
+#include "third_party/libyuv/include/libyuv.h"
+
+namespace media {
+
+namespace {
+
+// Every frame in flight holds on to a buffer from the capture buffer pool, so
+// keep enough of them free for consumers.
+constexpr size_t kMaxDefaultFramesInFlight = 3;
+
+// Decodes the MJPEG frame in |data| into the I420 |out_buffer|, whose size is
+// |frame_format|'s frame size rounded down to even dimensions.
+bool DecodeToI420(const std::vector<uint8_t>& data,
+                  const VideoCaptureFormat& frame_format,
+                  const VideoCaptureDevice::Client::Buffer& out_buffer) {
+  const gfx::Size dimensions(frame_format.frame_size.width() & ~1,
+                             frame_format.frame_size.height() & ~1);
+  std::unique_ptr<VideoCaptureBufferHandle> out_buffer_access =
+      out_buffer.handle_provider->GetHandleForInProcessAccess();
+  uint8_t* const y_plane_data = out_buffer_access->data();
+  uint8_t* const u_plane_data =
+      y_plane_data +
+      VideoFrame::PlaneSize(PIXEL_FORMAT_I420, VideoFrame::kYPlane, dimensions)
+          .GetArea();
+  uint8_t* const v_plane_data =
+      u_plane_data +
+      VideoFrame::PlaneSize(PIXEL_FORMAT_I420, VideoFrame::kUPlane, dimensions)
+          .GetArea();
+  const int y_plane_stride = dimensions.width();
+  const int uv_plane_stride = y_plane_stride / 2;
+  return libyuv::ConvertToI420(
+             data.data(), data.size(), y_plane_data, y_plane_stride,
+             u_plane_data, uv_plane_stride, v_plane_data, uv_plane_stride,
+             0 /* crop_x */, 0 /* crop_y */, frame_format.frame_size.width(),
+             frame_format.frame_size.height(), dimensions.width(),
+             dimensions.height(), libyuv::kRotate0, libyuv::FOURCC_MJPG) == 0;
+}
+
+}  // namespace
+
+class VideoCaptureParallelJpegDecoder::Core
+    : public base::RefCountedThreadSafe<Core> {
+ public:
+  // A captured frame waiting for, or going through, decoding.
+  struct Frame {
+    uint64_t sequence_number = 0;
+    std::vector<uint8_t> data;
+    VideoCaptureFormat frame_format;
+    base::TimeTicks reference_time;
+    base::TimeDelta timestamp;
+    VideoCaptureDevice::Client::Buffer out_buffer;
+    base::TimeTicks submit_time;
+  };
+
+  Core(DecodeDoneCB decode_done_cb,
+       FrameDroppedCB frame_dropped_cb,
+       size_t max_frames_in_flight)
+      : decode_done_cb_(std::move(decode_done_cb)),
+        frame_dropped_cb_(std::move(frame_dropped_cb)),
+        max_frames_in_flight_(max_frames_in_flight) {
+    DCHECK_GT(max_frames_in_flight_, 0u);
+  }
+
+  // Queues |frame| for decoding, making room for it if necessary.
+  void Submit(std::unique_ptr<Frame> frame) {
+    {
+      base::AutoLock lock(lock_);
+      if (pending_frames_.size() + frames_decoding_ >= max_frames_in_flight_) {
+        frame_dropped_cb_.Run(
+            VideoCaptureFrameDropReason::kDeviceClientDroppedStaleMjpegFrame);
+        if (pending_frames_.empty()) {
+          // Every frame in flight is being decoded already; |frame| is
+          // released along with its output buffer.
+          return;
+        }
+        // The dropped frame's slot is skipped by DeliverFinishedFrames().
+        finished_frames_[pending_frames_.front()->sequence_number] = nullptr;
+        pending_frames_.pop_front();
+      }
+      frame->sequence_number = next_sequence_number_++;
+      TRACE_EVENT_ASYNC_BEGIN0("jpeg",
+                               "VideoCaptureParallelJpegDecoder decoding",
+                               frame->sequence_number);
+      pending_frames_.push_back(std::move(frame));
+    }
+
+    // Tasks finding no pending frame, because it was dropped, do nothing.
+    base::PostTaskWithTraits(FROM_HERE, {base::TaskPriority::USER_BLOCKING},
+                             base::BindOnce(&Core::DecodeNextFrame, this));
+  }
+
+  // Stops all callbacks. Frames in flight are released as soon as possible.
+  void Shutdown() {
+    base::AutoLock lock(lock_);
+    shut_down_ = true;
+    pending_frames_.clear();
+    finished_frames_.clear();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<Core>;
+  ~Core() = default;
+
+  void DecodeNextFrame() {
+    std::unique_ptr<Frame> frame;
+    {
+      base::AutoLock lock(lock_);
+      if (pending_frames_.empty())
+        return;
+      frame = std::move(pending_frames_.front());
+      pending_frames_.pop_front();
+      ++frames_decoding_;
+    }
+
+    TRACE_EVENT0("jpeg", "VideoCaptureParallelJpegDecoder::DecodeNextFrame");
+    const base::TimeTicks decode_start_time = base::TimeTicks::Now();
+    const bool success =
+        DecodeToI420(frame->data, frame->frame_format, frame->out_buffer);
+    UMA_HISTOGRAM_CUSTOM_TIMES(
+        "Media.VideoCapture.ParallelJpegDecoder.DecodeTime",
+        base::TimeTicks::Now() - decode_start_time,
+        base::TimeDelta::FromMilliseconds(1), base::TimeDelta::FromSeconds(1),
+        50);
+
+    base::AutoLock lock(lock_);
+    --frames_decoding_;
+    if (shut_down_)
+      return;
+
+    const uint64_t sequence_number = frame->sequence_number;
+    if (!success) {
+      DLOG(WARNING) << "Failed to decode MJPEG frame";
+      frame_dropped_cb_.Run(
+          VideoCaptureFrameDropReason::kDeviceClientLibyuvConvertToI420Failed);
+      frame.reset();
+    }
+    finished_frames_[sequence_number] = std::move(frame);
+    DeliverFinishedFrames_Locked();
+  }
+
+  // Hands decoded frames to |decode_done_cb_| for as long as the next frame in
+  // capture order has finished.
+  void DeliverFinishedFrames_Locked() {
+    lock_.AssertAcquired();
+    for (auto it = finished_frames_.begin();
+         it != finished_frames_.end() &&
+         it->first == next_sequence_number_to_deliver_;
+         it = finished_frames_.erase(it), ++next_sequence_number_to_deliver_) {
+      TRACE_EVENT_ASYNC_END0("jpeg", "VideoCaptureParallelJpegDecoder decoding",
+                             it->first);
+      std::unique_ptr<Frame> frame = std::move(it->second);
+      if (!frame)
+        continue;
+
+      const gfx::Size dimensions(frame->frame_format.frame_size.width() & ~1,
+                                 frame->frame_format.frame_size.height() & ~1);
+      VideoFrameMetadata metadata;
+      metadata.SetDouble(VideoFrameMetadata::FRAME_RATE,
+                         frame->frame_format.frame_rate);
+      metadata.SetTimeTicks(VideoFrameMetadata::REFERENCE_TIME,
+                            frame->reference_time);
+
+      mojom::VideoFrameInfoPtr frame_info = mojom::VideoFrameInfo::New();
+      frame_info->timestamp = frame->timestamp;
+      frame_info->pixel_format = PIXEL_FORMAT_I420;
+      frame_info->coded_size = dimensions;
+      frame_info->visible_rect = gfx::Rect(dimensions);
+      frame_info->metadata = metadata.GetInternalValues().Clone();
+
+      // Time from capture to delivery, including time spent queued and
+      // waiting for earlier frames.
+      UMA_HISTOGRAM_CUSTOM_TIMES(
+          "Media.VideoCapture.ParallelJpegDecoder.Latency",
+          base::TimeTicks::Now() - frame->submit_time,
+          base::TimeDelta::FromMilliseconds(1),
+          base::TimeDelta::FromSeconds(1), 50);
+
+      decode_done_cb_.Run(frame->out_buffer.id,
+                          frame->out_buffer.frame_feedback_id,
+                          std::move(frame->out_buffer.access_permission),
+                          std::move(frame_info));
+    }
+  }
+
+  const DecodeDoneCB decode_done_cb_;
+  const FrameDroppedCB frame_dropped_cb_;
+  const size_t max_frames_in_flight_;
+
+  // Guards all members below, and serializes calls to the callbacks above.
+  base::Lock lock_;
+
+  // Frames waiting for a worker, oldest first.
+  base::circular_deque<std::unique_ptr<Frame>> pending_frames_;
+  size_t frames_decoding_ = 0;
+
+  // Frames which finished out of order, keyed by sequence number. Dropped
+  // and undecodable frames are null.
+  std::map<uint64_t, std::unique_ptr<Frame>> finished_frames_;
+
+  uint64_t next_sequence_number_ = 0;
+  uint64_t next_sequence_number_to_deliver_ = 0;
+  bool shut_down_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(Core);
+};
+
+VideoCaptureParallelJpegDecoder::VideoCaptureParallelJpegDecoder(
+    DecodeDoneCB decode_done_cb,
+    FrameDroppedCB frame_dropped_cb,
+    base::RepeatingCallback<void(const std::string&)> send_log_message_cb,
+    size_t max_frames_in_flight)
+    : core_(base::MakeRefCounted<Core>(std::move(decode_done_cb),
+                                       std::move(frame_dropped_cb),
+                                       max_frames_in_flight)) {
+  send_log_message_cb.Run(base::StringPrintf(
+      "Decoding MJPEG in software with up to %zu frames in flight",
+      max_frames_in_flight));
+}
+
+VideoCaptureParallelJpegDecoder::~VideoCaptureParallelJpegDecoder() {
+  core_->Shutdown();
+}
+
+// static
+size_t VideoCaptureParallelJpegDecoder::GetDefaultMaxFramesInFlight() {
+  // Enough frames to keep a worker per processor busy, within what the buffer
+  // pool can spare.
+  const int processors = base::SysInfo::NumberOfProcessors();
+  return std::min(static_cast<size_t>(std::max(processors, 2)),
+                  kMaxDefaultFramesInFlight);
+}
+
+void VideoCaptureParallelJpegDecoder::Initialize() {}
+
+VideoCaptureJpegDecoder::STATUS VideoCaptureParallelJpegDecoder::GetStatus()
+    const {
+  return INIT_PASSED;
+}
+
+void VideoCaptureParallelJpegDecoder::DecodeCapturedData(
+    const uint8_t* data,
+    size_t in_buffer_size,
+    const VideoCaptureFormat& frame_format,
+    base::TimeTicks reference_time,
+    base::TimeDelta timestamp,
+    VideoCaptureDevice::Client::Buffer out_buffer) {
+  TRACE_EVENT0("jpeg", "VideoCaptureParallelJpegDecoder::DecodeCapturedData");
+  DCHECK_EQ(PIXEL_FORMAT_MJPEG, frame_format.pixel_format);
+
+  // |data| is only valid during this call.
+  auto frame = std::make_unique<Core::Frame>();
+  frame->data.assign(data, data + in_buffer_size);
+  frame->frame_format = frame_format;
+  frame->reference_time = reference_time;
+  frame->timestamp = timestamp;
+  frame->out_buffer = std::move(out_buffer);
+  frame->submit_time = base::TimeTicks::Now();
+  core_->Submit(std::move(frame));
+}
+
+}  // namespace media
@@ -0,0 +1,76 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef MEDIA_CAPTURE_VIDEO_VIDEO_CAPTURE_PARALLEL_JPEG_DECODER_H_
+#define MEDIA_CAPTURE_VIDEO_VIDEO_CAPTURE_PARALLEL_JPEG_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "media/capture/capture_export.h"
+#include "media/capture/video/video_capture_jpeg_decoder.h"
+#include "media/capture/video_capture_types.h"
+
+namespace media {
+
+// Software implementation of VideoCaptureJpegDecoder which decodes MJPEG
+// frames with libyuv on TaskScheduler worker threads, so that several frames
+// can be decoded at once. Decoded frames are handed to |decode_done_cb| in the
+// order they were captured.
+//
+// At most |max_frames_in_flight| frames are queued or being decoded. When a
+// new frame arrives at a full queue, the oldest frame which hasn't started
+// decoding yet is dropped, since it would be stale by the time it is shown;
+// if every queued frame is already being decoded, the new frame is dropped
+// instead. Drops are reported through |frame_dropped_cb|.
+//
+// |decode_done_cb| is run on worker threads. |frame_dropped_cb| is run on the
+// thread calling DecodeCapturedData() for frames dropped to make room, and on
+// worker threads for frames which fail to decode. Callbacks are run one at a
+// time, and never after the decoder is destroyed. A TaskScheduler must be
+// available.
+class CAPTURE_EXPORT VideoCaptureParallelJpegDecoder
+    : public VideoCaptureJpegDecoder {
+ public:
+  using FrameDroppedCB =
+      base::RepeatingCallback<void(VideoCaptureFrameDropReason reason)>;
+
+  VideoCaptureParallelJpegDecoder(
+      DecodeDoneCB decode_done_cb,
+      FrameDroppedCB frame_dropped_cb,
+      base::RepeatingCallback<void(const std::string&)> send_log_message_cb,
+      size_t max_frames_in_flight);
+  ~VideoCaptureParallelJpegDecoder() override;
+
+  // Returns a |max_frames_in_flight| suited to the number of processors.
+  static size_t GetDefaultMaxFramesInFlight();
+
+  // Implementation of VideoCaptureJpegDecoder:
+  void Initialize() override;
+  STATUS GetStatus() const override;
+  void DecodeCapturedData(
+      const uint8_t* data,
+      size_t in_buffer_size,
+      const VideoCaptureFormat& frame_format,
+      base::TimeTicks reference_time,
+      base::TimeDelta timestamp,
+      VideoCaptureDevice::Client::Buffer out_buffer) override;
+
+ private:
+  // Holds the frame queue; shared with worker tasks, which may outlive |this|.
+  class Core;
+
+  const scoped_refptr<Core> core_;
+
+  DISALLOW_COPY_AND_ASSIGN(VideoCaptureParallelJpegDecoder);
+};
+
+}  // namespace media
+
+#endif  // MEDIA_CAPTURE_VIDEO_VIDEO_CAPTURE_PARALLEL_JPEG_DECODER_H_
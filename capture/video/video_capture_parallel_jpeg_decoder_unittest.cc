@@ -0,0 +1,172 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "media/capture/video/video_capture_parallel_jpeg_decoder.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/scoped_task_environment.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/test_data_util.h"
+#include "media/base/video_frame.h"
+#include "media/capture/video/stub_buffer_handle_provider.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace media {
+
+namespace {
+
+const int kWidth = 1280;
+const int kHeight = 720;
+
+using AccessPermission =
+    VideoCaptureDevice::Client::Buffer::ScopedAccessPermission;
+
+VideoCaptureDevice::Client::Buffer CreateI420StubBuffer(int buffer_id) {
+  const size_t mapped_size =
+      VideoFrame::AllocationSize(PIXEL_FORMAT_I420, gfx::Size(kWidth, kHeight));
+  return CreateStubBuffer(buffer_id, 0 /* frame_feedback_id */, mapped_size);
+}
+
+}  // namespace
+
+class VideoCaptureParallelJpegDecoderTest : public ::testing::Test {
+ public:
+  // Worker tasks only run during RunUntilIdle(), so tests control which frames
+  // are in flight when others arrive.
+  VideoCaptureParallelJpegDecoderTest()
+      : scoped_task_environment_(
+            base::test::ScopedTaskEnvironment::MainThreadType::DEFAULT,
+            base::test::ScopedTaskEnvironment::ExecutionMode::QUEUED),
+        jpeg_data_(ReadTestDataFile("peach_pi-1280x720.jpg")) {}
+
+  void CreateDecoder(size_t max_frames_in_flight) {
+    decoder_ = std::make_unique<VideoCaptureParallelJpegDecoder>(
+        base::BindRepeating(&VideoCaptureParallelJpegDecoderTest::OnDecodeDone,
+                            base::Unretained(this)),
+        base::BindRepeating(&VideoCaptureParallelJpegDecoderTest::OnDropped,
+                            base::Unretained(this)),
+        base::BindRepeating([](const std::string&) {}), max_frames_in_flight);
+    decoder_->Initialize();
+    EXPECT_EQ(VideoCaptureJpegDecoder::INIT_PASSED, decoder_->GetStatus());
+  }
+
+  void Decode(int buffer_id, const uint8_t* data, size_t size) {
+    const VideoCaptureFormat format(gfx::Size(kWidth, kHeight), 30.0f,
+                                    PIXEL_FORMAT_MJPEG);
+    decoder_->DecodeCapturedData(data, size, format, base::TimeTicks::Now(),
+                                 base::TimeDelta::FromMilliseconds(buffer_id),
+                                 CreateI420StubBuffer(buffer_id));
+  }
+
+  void DecodeJpeg(int buffer_id) {
+    Decode(buffer_id, jpeg_data_->data(), jpeg_data_->data_size());
+  }
+
+ protected:
+  void OnDecodeDone(
+      int buffer_id,
+      int frame_feedback_id,
+      std::unique_ptr<AccessPermission> buffer_read_permission,
+      mojom::VideoFrameInfoPtr frame_info) {
+    EXPECT_EQ(PIXEL_FORMAT_I420, frame_info->pixel_format);
+    EXPECT_EQ(gfx::Size(kWidth, kHeight), frame_info->coded_size);
+    EXPECT_EQ(base::TimeDelta::FromMilliseconds(buffer_id),
+              frame_info->timestamp);
+    decoded_buffer_ids_.push_back(buffer_id);
+    decoded_frames_.push_back(std::move(buffer_read_permission));
+  }
+
+  void OnDropped(VideoCaptureFrameDropReason reason) {
+    drop_reasons_.push_back(reason);
+  }
+
+  base::test::ScopedTaskEnvironment scoped_task_environment_;
+  const scoped_refptr<DecoderBuffer> jpeg_data_;
+  std::unique_ptr<VideoCaptureParallelJpegDecoder> decoder_;
+
+  std::vector<int> decoded_buffer_ids_;
+  std::vector<std::unique_ptr<AccessPermission>> decoded_frames_;
+  std::vector<VideoCaptureFrameDropReason> drop_reasons_;
+};
+
+TEST_F(VideoCaptureParallelJpegDecoderTest, DeliversFramesInCaptureOrder) {
+  const int kFrames = 8;
+  CreateDecoder(kFrames);
+  for (int i = 0; i < kFrames; ++i)
+    DecodeJpeg(i);
+  scoped_task_environment_.RunUntilIdle();
+
+  ASSERT_EQ(static_cast<size_t>(kFrames), decoded_buffer_ids_.size());
+  for (int i = 0; i < kFrames; ++i)
+    EXPECT_EQ(i, decoded_buffer_ids_[i]);
+  EXPECT_TRUE(drop_reasons_.empty());
+
+  // Every frame decodes to the same picture.
+  const size_t frame_size =
+      VideoFrame::AllocationSize(PIXEL_FORMAT_I420, gfx::Size(kWidth, kHeight));
+  const uint8_t* first_frame =
+      static_cast<StubReadWritePermission*>(decoded_frames_[0].get())->data();
+  EXPECT_NE(first_frame + frame_size,
+            std::find_if(first_frame, first_frame + frame_size,
+                         [](uint8_t value) { return value != 0; }));
+  for (int i = 1; i < kFrames; ++i) {
+    const uint8_t* frame =
+        static_cast<StubReadWritePermission*>(decoded_frames_[i].get())->data();
+    EXPECT_EQ(0, memcmp(first_frame, frame, frame_size));
+  }
+}
+
+TEST_F(VideoCaptureParallelJpegDecoderTest, DropsFramesBeyondQueueLimit) {
+  CreateDecoder(1);
+  DecodeJpeg(0);
+  DecodeJpeg(1);
+  DecodeJpeg(2);
+
+  // No worker has started yet, so each frame after the first evicts the
+  // queued one. Drops are reported right away, on this thread.
+  EXPECT_EQ(2u, drop_reasons_.size());
+  scoped_task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(std::vector<int>({2}), decoded_buffer_ids_);
+  ASSERT_EQ(2u, drop_reasons_.size());
+  for (const auto reason : drop_reasons_) {
+    EXPECT_EQ(VideoCaptureFrameDropReason::kDeviceClientDroppedStaleMjpegFrame,
+              reason);
+  }
+}
+
+TEST_F(VideoCaptureParallelJpegDecoderTest, SkipsUndecodableFrames) {
+  CreateDecoder(4);
+  const std::vector<uint8_t> garbage(1024, 0xab);
+  DecodeJpeg(0);
+  Decode(1, garbage.data(), garbage.size());
+  DecodeJpeg(2);
+  scoped_task_environment_.RunUntilIdle();
+
+  EXPECT_EQ(std::vector<int>({0, 2}), decoded_buffer_ids_);
+  ASSERT_EQ(1u, drop_reasons_.size());
+  EXPECT_EQ(VideoCaptureFrameDropReason::kDeviceClientLibyuvConvertToI420Failed,
+            drop_reasons_[0]);
+}
+
+TEST_F(VideoCaptureParallelJpegDecoderTest, NoCallbacksAfterDestruction) {
+  CreateDecoder(4);
+  for (int i = 0; i < 4; ++i)
+    DecodeJpeg(i);
+  decoder_.reset();
+  scoped_task_environment_.RunUntilIdle();
+
+  EXPECT_TRUE(decoded_buffer_ids_.empty());
+  EXPECT_TRUE(drop_reasons_.empty());
+}
+
+}  // namespace media
@@ -201,7 +201,8 @@ enum class VideoCaptureFrameDropReason {
   kWinMediaFoundationGetBufferByIndexReturnedNull = 14,
   kBufferPoolMaxBufferCountExceeded = 15,
   kBufferPoolBufferAllocationFailed = 16,
-  kMaxValue = 16
+  kDeviceClientDroppedStaleMjpegFrame = 17,
+  kMaxValue = 17
 };
 
 // Assert that the int:frequency mapping is correct.
@@ -635,6 +635,107 @@ TEST_F(AudioRendererAlgorithmTest, FullAndDecimatedSearch) {
                                       exclude_interval));
 }
 
+TEST_F(AudioRendererAlgorithmTest, CrossCorrelation) {
+  const int kChannels = 2;
+  const int kTargetFrames = 100;
+  const int kSearchFrames = 250;
+  const int kNumCandidBlocks = kSearchFrames - (kTargetFrames - 1);
+
+  std::unique_ptr<AudioBus> target = AudioBus::Create(kChannels, kTargetFrames);
+  std::unique_ptr<AudioBus> search = AudioBus::Create(kChannels, kSearchFrames);
+  for (int k = 0; k < kChannels; ++k) {
+    for (int n = 0; n < kTargetFrames; ++n)
+      target->channel(k)[n] = std::sin(0.1f * n + k);
+    for (int n = 0; n < kSearchFrames; ++n)
+      search->channel(k)[n] = std::cos(0.07f * n * (k + 1));
+  }
+
+  std::unique_ptr<float[]> correlation(
+      new float[kChannels * kNumCandidBlocks]);
+  internal::MultiChannelCrossCorrelation(target.get(), search.get(),
+                                         correlation.get());
+
+  float dot_prod[kChannels];
+  for (int n = 0; n < kNumCandidBlocks; ++n) {
+    internal::MultiChannelDotProduct(target.get(), 0, search.get(), n,
+                                     kTargetFrames, dot_prod);
+    for (int k = 0; k < kChannels; ++k)
+      EXPECT_NEAR(dot_prod[k], correlation[n * kChannels + k], 1e-3f);
+  }
+}
+
+// The FFT-based exhaustive search should pick the block a full search over
+// every candidate would.
+TEST_F(AudioRendererAlgorithmTest, CorrelationSearch) {
+  const int kChannels = 2;
+  const int kTargetFrames = 960;
+  const int kSearchFrames = kTargetFrames * 5 / 2;
+  const int kNumCandidBlocks = kSearchFrames - (kTargetFrames - 1);
+  const int kExpectedIndex = 321;
+
+  // A chirp has a single sharp autocorrelation peak.
+  std::unique_ptr<AudioBus> search = AudioBus::Create(kChannels, kSearchFrames);
+  for (int k = 0; k < kChannels; ++k) {
+    for (int n = 0; n < kSearchFrames; ++n)
+      search->channel(k)[n] = std::sin(5e-5f * n * n + k);
+  }
+  std::unique_ptr<AudioBus> target = AudioBus::Create(kChannels, kTargetFrames);
+  search->CopyPartialFramesTo(kExpectedIndex, kTargetFrames, 0, target.get());
+
+  std::unique_ptr<float[]> energy_target(new float[kChannels]);
+  internal::MultiChannelDotProduct(target.get(), 0, target.get(), 0,
+                                   kTargetFrames, energy_target.get());
+  std::unique_ptr<float[]> energy_candid_blocks(
+      new float[kNumCandidBlocks * kChannels]);
+  internal::MultiChannelMovingBlockEnergies(search.get(), kTargetFrames,
+                                            energy_candid_blocks.get());
+  std::unique_ptr<float[]> correlation(
+      new float[kNumCandidBlocks * kChannels]);
+  internal::MultiChannelCrossCorrelation(target.get(), search.get(),
+                                         correlation.get());
+
+  internal::Interval exclude_interval = std::make_pair(-100, -10);
+  EXPECT_EQ(kExpectedIndex,
+            internal::CorrelationSearch(
+                exclude_interval, kChannels, kNumCandidBlocks,
+                correlation.get(), energy_target.get(),
+                energy_candid_blocks.get()));
+
+  // The exclusion interval must be honored as well.
+  exclude_interval = std::make_pair(kExpectedIndex - 5, kExpectedIndex + 5);
+  EXPECT_EQ(internal::FullSearch(0, kNumCandidBlocks - 1, exclude_interval,
+                                 target.get(), search.get(),
+                                 energy_target.get(),
+                                 energy_candid_blocks.get()),
+            internal::CorrelationSearch(
+                exclude_interval, kChannels, kNumCandidBlocks,
+                correlation.get(), energy_target.get(),
+                energy_candid_blocks.get()));
+}
+
+// At high sample rates OptimalIndex() switches to the FFT-based search, which
+// should find the exact match.
+TEST_F(AudioRendererAlgorithmTest, OptimalIndexWithLargeBlocks) {
+  const int kChannels = 2;
+  // 20 ms blocks and a 30 ms search interval at 192 kHz, as used by
+  // AudioRendererAlgorithm.
+  const int kTargetFrames = 3840;
+  const int kSearchFrames = kTargetFrames + 5760 - 1;
+  const int kExpectedIndex = 4321;
+
+  std::unique_ptr<AudioBus> search = AudioBus::Create(kChannels, kSearchFrames);
+  for (int k = 0; k < kChannels; ++k) {
+    for (int n = 0; n < kSearchFrames; ++n)
+      search->channel(k)[n] = std::sin(5e-6f * n * n + k);
+  }
+  std::unique_ptr<AudioBus> target = AudioBus::Create(kChannels, kTargetFrames);
+  search->CopyPartialFramesTo(kExpectedIndex, kTargetFrames, 0, target.get());
+
+  internal::Interval exclude_interval = std::make_pair(-100, -10);
+  EXPECT_EQ(kExpectedIndex, internal::OptimalIndex(search.get(), target.get(),
+                                                   exclude_interval));
+}
+
 TEST_F(AudioRendererAlgorithmTest, QuadraticInterpolation) {
   // Arbitrary coefficients.
   const float kA = 0.7f;
@@ -153,12 +153,21 @@ void FFmpegAudioDecoder::DecodeBuffer(const DecoderBuffer& buffer,
 bool FFmpegAudioDecoder::FFmpegDecode(const DecoderBuffer& buffer) {
   AVPacket packet;
   av_init_packet(&packet);
+  scoped_refptr<DecoderBuffer> padded_buffer;
   if (buffer.end_of_stream()) {
     packet.data = NULL;
     packet.size = 0;
   } else {
-    packet.data = const_cast<uint8_t*>(buffer.data());
-    packet.size = buffer.data_size();
+    // FFmpeg may read past the end of the packet, e.g. MP3 frames sliced from
+    // the appended data are followed by the next frame, not zeroed padding.
+    const DecoderBuffer* input = &buffer;
+    if (!buffer.is_padded()) {
+      padded_buffer =
+          DecoderBuffer::CopyFrom(buffer.data(), buffer.data_size());
+      input = padded_buffer.get();
+    }
+    packet.data = const_cast<uint8_t*>(input->data());
+    packet.size = input->data_size();
 
     DCHECK(packet.data);
     DCHECK_GT(packet.size, 0);
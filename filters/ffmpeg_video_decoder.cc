@@ -312,12 +312,21 @@ bool FFmpegVideoDecoder::FFmpegDecode(const DecoderBuffer& buffer) {
   // Due to FFmpeg API changes we no longer have const read-only pointers.
   AVPacket packet;
   av_init_packet(&packet);
+  scoped_refptr<DecoderBuffer> padded_buffer;
   if (buffer.end_of_stream()) {
     packet.data = NULL;
     packet.size = 0;
   } else {
-    packet.data = const_cast<uint8_t*>(buffer.data());
-    packet.size = buffer.data_size();
+    // FFmpeg requires aligned input followed by zeroed padding, which buffers
+    // backed by shared memory or appended segments don't provide.
+    const DecoderBuffer* input = &buffer;
+    if (!buffer.is_padded()) {
+      padded_buffer =
+          DecoderBuffer::CopyFrom(buffer.data(), buffer.data_size());
+      input = padded_buffer.get();
+    }
+    packet.data = const_cast<uint8_t*>(input->data());
+    packet.size = input->data_size();
 
     DCHECK(packet.data);
     DCHECK_GT(packet.size, 0);
@@ -106,14 +106,55 @@ void SourceBufferRange::AdjustEstimatedDurationForNewAppend(
   }
 }
 
+size_t SourceBufferRange::ChargeBuffer(const StreamParserBuffer& buffer) {
+  const SegmentBuffer* segment = buffer.segment();
+  size_t bytes_charged = buffer.data_size();
+  if (segment) {
+    // Only the first slice of a segment in this range pays for it.
+    bytes_charged =
+        ++segment_slice_counts_[segment] == 1 ? segment->written_size() : 0;
+  }
+  size_in_bytes_ += bytes_charged;
+  return bytes_charged;
+}
+
+size_t SourceBufferRange::ReleaseBuffer(const StreamParserBuffer& buffer) {
+  const SegmentBuffer* segment = buffer.segment();
+  size_t bytes_released = buffer.data_size();
+  if (segment) {
+    auto itr = segment_slice_counts_.find(segment);
+    DCHECK(itr != segment_slice_counts_.end());
+    bytes_released = 0;
+    if (--itr->second == 0) {
+      bytes_released = segment->written_size();
+      segment_slice_counts_.erase(itr);
+    }
+  }
+  DCHECK_GE(size_in_bytes_, bytes_released);
+  size_in_bytes_ -= bytes_released;
+  return bytes_released;
+}
+
+size_t SourceBufferRange::GetReleasableSize(
+    const StreamParserBuffer& buffer,
+    std::map<const SegmentBuffer*, int>* released_slice_counts) const {
+  const SegmentBuffer* segment = buffer.segment();
+  if (!segment)
+    return buffer.data_size();
+
+  auto itr = segment_slice_counts_.find(segment);
+  DCHECK(itr != segment_slice_counts_.end());
+  int released_slices = ++(*released_slice_counts)[segment];
+  DCHECK_LE(released_slices, itr->second);
+  return released_slices == itr->second ? segment->written_size() : 0;
+}
+
 void SourceBufferRange::FreeBufferRange(
     const BufferQueue::const_iterator& starting_point,
     const BufferQueue::const_iterator& ending_point) {
   for (BufferQueue::const_iterator itr = starting_point; itr != ending_point;
        ++itr) {
-    size_t itr_data_size = static_cast<size_t>((*itr)->data_size());
-    DCHECK_GE(size_in_bytes_, itr_data_size);
-    size_in_bytes_ -= itr_data_size;
+    ReleaseBuffer(**itr);
   }
   buffers_.erase(starting_point, ending_point);
 }
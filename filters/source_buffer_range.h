@@ -5,6 +5,10 @@
 #ifndef MEDIA_FILTERS_SOURCE_BUFFER_RANGE_H_
 #define MEDIA_FILTERS_SOURCE_BUFFER_RANGE_H_
 
+#include <stddef.h>
+
+#include <map>
+
 #include "base/callback.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
@@ -105,6 +109,23 @@ class MEDIA_EXPORT SourceBufferRange {
   // care of updating |highest_frame_|.
   void AdjustEstimatedDurationForNewAppend(const BufferQueue& new_buffers);
 
+  // Accounts for |buffer| being added to or removed from |buffers_| in
+  // |size_in_bytes_|, and returns the number of bytes charged or released.
+  // A buffer which owns its data is charged its data_size(). Buffers slicing a
+  // SegmentBuffer instead charge the data written to the segment, once per
+  // range: any one of them keeps all of it alive, so the bytes are released
+  // only when the last of them is removed.
+  size_t ChargeBuffer(const StreamParserBuffer& buffer);
+  size_t ReleaseBuffer(const StreamParserBuffer& buffer);
+
+  // Returns the number of bytes ReleaseBuffer() would release for |buffer|,
+  // given that the buffers counted in |released_slice_counts| are removed
+  // too, and counts |buffer| there. Used to estimate the effect of a removal
+  // without performing it.
+  size_t GetReleasableSize(
+      const StreamParserBuffer& buffer,
+      std::map<const SegmentBuffer*, int>* released_slice_counts) const;
+
   // Frees the buffers in |buffers_| from [|start_point|,|ending_point|) and
   // updates the |size_in_bytes_| accordingly. Note, this does not update
   // |keyframe_map_|.
@@ -170,10 +191,14 @@ class MEDIA_EXPORT SourceBufferRange {
   // Called to get the largest interbuffer distance seen so far in the stream.
   InterbufferDistanceCB interbuffer_distance_cb_;
 
-  // Stores the amount of memory taken up by the data in |buffers_|.
+  // Stores the amount of memory retained by the data in |buffers_|, see
+  // ChargeBuffer().
   size_t size_in_bytes_;
 
  private:
+  // Number of buffers in |buffers_| slicing each SegmentBuffer.
+  std::map<const SegmentBuffer*, int> segment_slice_counts_;
+
   DISALLOW_COPY_AND_ASSIGN(SourceBufferRange);
 };
 
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <utility>
 
 #include "media/base/timestamp_constants.h"
 
@@ -22,6 +23,16 @@ static bool CompareStreamParserBufferToDecodeTimestamp(
     const DecodeTimestamp& decode_timestamp) {
   return buffer->GetDecodeTimestamp() < decode_timestamp;
 }
+static bool CompareDecodeTimestampToKeyframe(
+    const DecodeTimestamp& decode_timestamp,
+    const std::pair<DecodeTimestamp, int>& keyframe) {
+  return decode_timestamp < keyframe.first;
+}
+static bool CompareKeyframeToDecodeTimestamp(
+    const std::pair<DecodeTimestamp, int>& keyframe,
+    const DecodeTimestamp& decode_timestamp) {
+  return keyframe.first < decode_timestamp;
+}
 
 SourceBufferRangeByDts::SourceBufferRangeByDts(
     GapPolicy gap_policy,
@@ -98,12 +109,11 @@ void SourceBufferRangeByDts::AppendBuffersToEnd(
 
     buffers_.push_back(*itr);
     UpdateEndTime(*itr);
-    size_in_bytes_ += (*itr)->data_size();
+    ChargeBuffer(**itr);
 
     if ((*itr)->is_key_frame()) {
-      keyframe_map_.insert(
-          std::make_pair((*itr)->GetDecodeTimestamp(),
-                         buffers_.size() - 1 + keyframe_map_index_base_));
+      AddKeyframe((*itr)->GetDecodeTimestamp(),
+                  buffers_.size() - 1 + keyframe_map_index_base_);
     }
   }
 }
@@ -262,11 +272,10 @@ size_t SourceBufferRangeByDts::DeleteGOPFromFront(
   int buffers_deleted = 0;
   size_t total_bytes_deleted = 0;
 
-  KeyframeMap::const_iterator front = keyframe_map_.begin();
-  DCHECK(front != keyframe_map_.end());
+  DCHECK(!keyframe_map_.empty());
 
   // Delete the keyframe at the start of |keyframe_map_|.
-  keyframe_map_.erase(front);
+  keyframe_map_.pop_front();
 
   // Now we need to delete all the buffers that depend on the keyframe we've
   // just deleted.
@@ -277,10 +286,7 @@ size_t SourceBufferRangeByDts::DeleteGOPFromFront(
   // Delete buffers from the beginning of the buffered range up until (but not
   // including) the next keyframe.
   for (int i = 0; i < end_index; i++) {
-    size_t bytes_deleted = buffers_.front()->data_size();
-    DCHECK_GE(size_in_bytes_, bytes_deleted);
-    size_in_bytes_ -= bytes_deleted;
-    total_bytes_deleted += bytes_deleted;
+    total_bytes_deleted += ReleaseBuffer(*buffers_.front());
     deleted_buffers->push_back(buffers_.front());
     buffers_.pop_front();
     ++buffers_deleted;
@@ -324,10 +330,7 @@ size_t SourceBufferRangeByDts::DeleteGOPFromBack(BufferQueue* deleted_buffers) {
 
   size_t total_bytes_deleted = 0;
   while (buffers_.size() != goal_size) {
-    size_t bytes_deleted = buffers_.back()->data_size();
-    DCHECK_GE(size_in_bytes_, bytes_deleted);
-    size_in_bytes_ -= bytes_deleted;
-    total_bytes_deleted += bytes_deleted;
+    total_bytes_deleted += ReleaseBuffer(*buffers_.back());
     // We're removing buffers from the back, so push each removed buffer to the
     // front of |deleted_buffers| so that |deleted_buffers| are in nondecreasing
     // order.
@@ -346,6 +349,7 @@ size_t SourceBufferRangeByDts::GetRemovalGOP(
     size_t total_bytes_to_free,
     DecodeTimestamp* removal_end_timestamp) const {
   size_t bytes_removed = 0;
+  std::map<const SegmentBuffer*, int> released_slice_counts;
 
   auto gop_itr = GetFirstKeyframeAt(start_timestamp, false);
   if (gop_itr == keyframe_map_.end())
@@ -372,7 +376,7 @@ size_t SourceBufferRangeByDts::GetRemovalGOP(
     BufferQueue::const_iterator next_gop_start =
         buffers_.begin() + next_gop_index;
     for (; buffer_itr != next_gop_start; ++buffer_itr) {
-      gop_size += (*buffer_itr)->data_size();
+      gop_size += GetReleasableSize(**buffer_itr, &released_slice_counts);
     }
 
     bytes_removed += gop_size;
@@ -591,17 +595,35 @@ SourceBufferRangeByDts::GetBufferItrAt(DecodeTimestamp timestamp,
                                 CompareStreamParserBufferToDecodeTimestamp);
 }
 
+void SourceBufferRangeByDts::AddKeyframe(DecodeTimestamp timestamp, int index) {
+  // Keyframes usually arrive in order, so this is usually an append.
+  if (keyframe_map_.empty() || keyframe_map_.back().first < timestamp) {
+    keyframe_map_.emplace_back(timestamp, index);
+    return;
+  }
+
+  KeyframeMap::const_iterator itr =
+      std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(), timestamp,
+                       CompareKeyframeToDecodeTimestamp);
+  if (itr->first != timestamp)
+    keyframe_map_.insert(itr, std::make_pair(timestamp, index));
+}
+
 SourceBufferRangeByDts::KeyframeMap::const_iterator
 SourceBufferRangeByDts::GetFirstKeyframeAt(DecodeTimestamp timestamp,
                                            bool skip_given_timestamp) const {
-  return skip_given_timestamp ? keyframe_map_.upper_bound(timestamp)
-                              : keyframe_map_.lower_bound(timestamp);
+  return skip_given_timestamp
+             ? std::upper_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                                timestamp, CompareDecodeTimestampToKeyframe)
+             : std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                                timestamp, CompareKeyframeToDecodeTimestamp);
 }
 
 SourceBufferRangeByDts::KeyframeMap::const_iterator
 SourceBufferRangeByDts::GetFirstKeyframeAtOrBefore(
     DecodeTimestamp timestamp) const {
-  auto result = keyframe_map_.lower_bound(timestamp);
+  auto result = std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                                 timestamp, CompareKeyframeToDecodeTimestamp);
   // lower_bound() returns the first element >= |timestamp|, so we want the
   // previous element if it did not return the element exactly equal to
   // |timestamp|.
@@ -644,7 +666,9 @@ bool SourceBufferRangeByDts::TruncateAt(
 
   // Remove keyframes from |starting_point| onward.
   KeyframeMap::const_iterator starting_point_keyframe =
-      keyframe_map_.lower_bound((*starting_point)->GetDecodeTimestamp());
+      std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                       (*starting_point)->GetDecodeTimestamp(),
+                       CompareKeyframeToDecodeTimestamp);
   keyframe_map_.erase(starting_point_keyframe, keyframe_map_.end());
 
   // Remove everything from |starting_point| onward.
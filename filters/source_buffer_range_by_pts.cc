@@ -8,12 +8,25 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "base/logging.h"
 #include "media/base/timestamp_constants.h"
 
 namespace media {
 
+// Comparison operators for std::upper_bound() and std::lower_bound().
+static bool CompareTimeDeltaToKeyframe(
+    const base::TimeDelta& timestamp,
+    const std::pair<base::TimeDelta, int>& keyframe) {
+  return timestamp < keyframe.first;
+}
+static bool CompareKeyframeToTimeDelta(
+    const std::pair<base::TimeDelta, int>& keyframe,
+    const base::TimeDelta& timestamp) {
+  return keyframe.first < timestamp;
+}
+
 SourceBufferRangeByPts::SourceBufferRangeByPts(
     GapPolicy gap_policy,
     const BufferQueue& new_buffers,
@@ -128,11 +141,11 @@ void SourceBufferRangeByPts::AppendBuffersToEnd(
 
     buffers_.push_back(*itr);
     UpdateEndTime(*itr);
-    size_in_bytes_ += (*itr)->data_size();
+    ChargeBuffer(**itr);
 
     if ((*itr)->is_key_frame()) {
-      keyframe_map_.insert(std::make_pair(
-          (*itr)->timestamp(), buffers_.size() - 1 + keyframe_map_index_base_));
+      AddKeyframe((*itr)->timestamp(),
+                  buffers_.size() - 1 + keyframe_map_index_base_);
     }
   }
 
@@ -286,11 +299,10 @@ size_t SourceBufferRangeByPts::DeleteGOPFromFront(
   int buffers_deleted = 0;
   size_t total_bytes_deleted = 0;
 
-  KeyframeMap::const_iterator front = keyframe_map_.begin();
-  DCHECK(front != keyframe_map_.end());
+  DCHECK(!keyframe_map_.empty());
 
   // Delete the keyframe at the start of |keyframe_map_|.
-  keyframe_map_.erase(front);
+  keyframe_map_.pop_front();
 
   // Now we need to delete all the buffers that depend on the keyframe we've
   // just deleted.
@@ -301,10 +313,7 @@ size_t SourceBufferRangeByPts::DeleteGOPFromFront(
   // Delete buffers from the beginning of the buffered range up until (but not
   // including) the next keyframe.
   for (int i = 0; i < end_index; i++) {
-    size_t bytes_deleted = buffers_.front()->data_size();
-    DCHECK_GE(size_in_bytes_, bytes_deleted);
-    size_in_bytes_ -= bytes_deleted;
-    total_bytes_deleted += bytes_deleted;
+    total_bytes_deleted += ReleaseBuffer(*buffers_.front());
     deleted_buffers->push_back(buffers_.front());
     buffers_.pop_front();
     ++buffers_deleted;
@@ -351,10 +360,7 @@ size_t SourceBufferRangeByPts::DeleteGOPFromBack(BufferQueue* deleted_buffers) {
 
   size_t total_bytes_deleted = 0;
   while (buffers_.size() != goal_size) {
-    size_t bytes_deleted = buffers_.back()->data_size();
-    DCHECK_GE(size_in_bytes_, bytes_deleted);
-    size_in_bytes_ -= bytes_deleted;
-    total_bytes_deleted += bytes_deleted;
+    total_bytes_deleted += ReleaseBuffer(*buffers_.back());
     // We're removing buffers from the back, so push each removed buffer to the
     // front of |deleted_buffers| so that |deleted_buffers| are in nondecreasing
     // order.
@@ -376,6 +382,7 @@ size_t SourceBufferRangeByPts::GetRemovalGOP(
   DVLOG(4) << ToStringForDebugging();
 
   size_t bytes_removed = 0;
+  std::map<const SegmentBuffer*, int> released_slice_counts;
 
   auto gop_itr = GetFirstKeyframeAt(start_timestamp, false);
   if (gop_itr == keyframe_map_.end())
@@ -402,7 +409,7 @@ size_t SourceBufferRangeByPts::GetRemovalGOP(
     BufferQueue::const_iterator next_gop_start =
         buffers_.begin() + next_gop_index;
     for (; buffer_itr != next_gop_start; ++buffer_itr) {
-      gop_size += (*buffer_itr)->data_size();
+      gop_size += GetReleasableSize(**buffer_itr, &released_slice_counts);
     }
 
     bytes_removed += gop_size;
@@ -713,14 +720,31 @@ SourceBufferRangeByPts::GetBufferItrAt(base::TimeDelta timestamp,
   return buffers_.begin() + GetBufferIndexAt(timestamp, skip_given_timestamp);
 }
 
+void SourceBufferRangeByPts::AddKeyframe(base::TimeDelta timestamp, int index) {
+  // Keyframes usually arrive in order, so this is usually an append.
+  if (keyframe_map_.empty() || keyframe_map_.back().first < timestamp) {
+    keyframe_map_.emplace_back(timestamp, index);
+    return;
+  }
+
+  KeyframeMap::const_iterator itr =
+      std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(), timestamp,
+                       CompareKeyframeToTimeDelta);
+  if (itr->first != timestamp)
+    keyframe_map_.insert(itr, std::make_pair(timestamp, index));
+}
+
 SourceBufferRangeByPts::KeyframeMap::const_iterator
 SourceBufferRangeByPts::GetFirstKeyframeAt(base::TimeDelta timestamp,
                                            bool skip_given_timestamp) const {
   DVLOG(1) << __func__;
   DVLOG(4) << ToStringForDebugging();
 
-  return skip_given_timestamp ? keyframe_map_.upper_bound(timestamp)
-                              : keyframe_map_.lower_bound(timestamp);
+  return skip_given_timestamp
+             ? std::upper_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                                timestamp, CompareTimeDeltaToKeyframe)
+             : std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                                timestamp, CompareKeyframeToTimeDelta);
 }
 
 SourceBufferRangeByPts::KeyframeMap::const_iterator
@@ -729,7 +753,8 @@ SourceBufferRangeByPts::GetFirstKeyframeAtOrBefore(
   DVLOG(1) << __func__;
   DVLOG(4) << ToStringForDebugging();
 
-  auto result = keyframe_map_.lower_bound(timestamp);
+  auto result = std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                                 timestamp, CompareKeyframeToTimeDelta);
   // lower_bound() returns the first element >= |timestamp|, so we want the
   // previous element if it did not return the element exactly equal to
   // |timestamp|.
@@ -770,7 +795,9 @@ bool SourceBufferRangeByPts::TruncateAt(const size_t starting_point,
 
   // Remove keyframes from |starting_point| onward.
   KeyframeMap::const_iterator starting_point_keyframe =
-      keyframe_map_.lower_bound((*starting_point_iter)->timestamp());
+      std::lower_bound(keyframe_map_.begin(), keyframe_map_.end(),
+                       (*starting_point_iter)->timestamp(),
+                       CompareKeyframeToTimeDelta);
   keyframe_map_.erase(starting_point_keyframe, keyframe_map_.end());
 
   // Remove everything from |starting_point| onward.
@@ -6,9 +6,10 @@
 #define MEDIA_FILTERS_SOURCE_BUFFER_RANGE_BY_PTS_H_
 
 #include <stddef.h>
-#include <map>
 #include <memory>
+#include <utility>
 
+#include "base/containers/circular_deque.h"
 #include "media/filters/source_buffer_range.h"
 
 namespace media {
@@ -193,7 +194,10 @@ class MEDIA_EXPORT SourceBufferRangeByPts : public SourceBufferRange {
                          BufferQueue* buffers) const;
 
  private:
-  typedef std::map<base::TimeDelta, int> KeyframeMap;
+  // Keyframes are appended in order and removed from either end. Keeping them
+  // sorted by timestamp in a deque makes lookups a binary search, while
+  // removing the first GOP during garbage collection stays O(1).
+  typedef base::circular_deque<std::pair<base::TimeDelta, int>> KeyframeMap;
 
   // Helper method for Appending |range| to the end of this range.  If |range|'s
   // first buffer time is before the time of the last buffer in this range,
@@ -216,6 +220,10 @@ class MEDIA_EXPORT SourceBufferRangeByPts : public SourceBufferRange {
   BufferQueue::const_iterator GetBufferItrAt(base::TimeDelta timestamp,
                                              bool skip_given_timestamp) const;
 
+  // Adds the keyframe at |timestamp| to |keyframe_map_| with position |index|,
+  // unless |keyframe_map_| already has a keyframe at |timestamp|.
+  void AddKeyframe(base::TimeDelta timestamp, int index);
+
   // Returns an iterator in |keyframe_map_| pointing to the next keyframe after
   // |timestamp|. If |skip_given_timestamp| is true, this returns the first
   // keyframe with a timestamp strictly greater than |timestamp|.
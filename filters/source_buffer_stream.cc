@@ -5,14 +5,20 @@
 #include "media/filters/source_buffer_stream.h"
 
 #include <algorithm>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/logging.h"
+#include "base/metrics/field_trial_params.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/task_scheduler/task_scheduler.h"
 #include "base/trace_event/trace_event.h"
 #include "media/base/demuxer_memory_limit.h"
 #include "media/base/media_switches.h"
@@ -46,6 +52,27 @@ const int kMaxAudioSpliceLogs = 20;
 // work or other side-effects.
 const int kMaxStrangeSameTimestampsLogs = 20;
 
+// With kIncrementalSourceBufferGC, garbage collection starts once the buffered
+// data exceeds this many quarters of the effective memory limit.
+const size_t kProactiveGarbageCollectionQuarters = 3;
+
+// Time each proactive garbage collection may spend freeing data, unless set by
+// the "budget_ms" parameter of kIncrementalSourceBufferGC.
+const int kDefaultGarbageCollectionBudgetMs = 1;
+
+base::TimeDelta GetGarbageCollectionBudget() {
+  return base::TimeDelta::FromMilliseconds(
+      std::max(0, base::GetFieldTrialParamByFeatureAsInt(
+                      kIncrementalSourceBufferGC, "budget_ms",
+                      kDefaultGarbageCollectionBudgetMs)));
+}
+
+void RecordGarbageCollectionTime(base::TimeDelta elapsed) {
+  UMA_HISTOGRAM_CUSTOM_COUNTS("Media.MSE.GarbageCollectionTimeUs",
+                              elapsed.InMicroseconds(), 1,
+                              base::Time::kMicrosecondsPerSecond, 50);
+}
+
 // Helper method that returns true if |ranges| is sorted in increasing order,
 // false otherwise.
 bool IsRangeListSorted(
@@ -198,7 +225,10 @@ SourceBufferStream<RangeClass>::SourceBufferStream(
       highest_output_buffer_timestamp_(kNoDecodeTimestamp()),
       max_interbuffer_distance_(
           base::TimeDelta::FromMilliseconds(kMinimumInterbufferDistanceInMs)),
-      memory_limit_(GetDemuxerStreamAudioMemoryLimit()) {
+      memory_limit_(GetDemuxerStreamAudioMemoryLimit()),
+      incremental_garbage_collection_(
+          base::FeatureList::IsEnabled(kIncrementalSourceBufferGC)),
+      garbage_collection_budget_(GetGarbageCollectionBudget()) {
   DCHECK(audio_config.IsValidConfig());
   audio_configs_.push_back(audio_config);
 }
@@ -214,7 +244,10 @@ SourceBufferStream<RangeClass>::SourceBufferStream(
       highest_output_buffer_timestamp_(kNoDecodeTimestamp()),
       max_interbuffer_distance_(
           base::TimeDelta::FromMilliseconds(kMinimumInterbufferDistanceInMs)),
-      memory_limit_(GetDemuxerStreamVideoMemoryLimit()) {
+      memory_limit_(GetDemuxerStreamVideoMemoryLimit()),
+      incremental_garbage_collection_(
+          base::FeatureList::IsEnabled(kIncrementalSourceBufferGC)),
+      garbage_collection_budget_(GetGarbageCollectionBudget()) {
   DCHECK(video_config.IsValidConfig());
   video_configs_.push_back(video_config);
 }
@@ -231,7 +264,10 @@ SourceBufferStream<RangeClass>::SourceBufferStream(
       highest_output_buffer_timestamp_(kNoDecodeTimestamp()),
       max_interbuffer_distance_(
           base::TimeDelta::FromMilliseconds(kMinimumInterbufferDistanceInMs)),
-      memory_limit_(GetDemuxerStreamAudioMemoryLimit()) {}
+      memory_limit_(GetDemuxerStreamAudioMemoryLimit()),
+      incremental_garbage_collection_(
+          base::FeatureList::IsEnabled(kIncrementalSourceBufferGC)),
+      garbage_collection_budget_(GetGarbageCollectionBudget()) {}
 
 template <typename RangeClass>
 SourceBufferStream<RangeClass>::~SourceBufferStream() = default;
@@ -892,8 +928,17 @@ bool SourceBufferStream<RangeClass>::GarbageCollectIfNeeded(
   }
 
   // Return if we're under or at the memory limit.
-  if (ranges_size + newDataSize <= effective_memory_limit)
+  if (ranges_size + newDataSize <= effective_memory_limit) {
+    if (incremental_garbage_collection_) {
+      GarbageCollectProactively(media_time, ranges_size + newDataSize,
+                                effective_memory_limit);
+    }
     return true;
+  }
+
+  // Freeing enough data for the append can't be spread over several calls,
+  // since the append fails if this returns false.
+  const base::TimeTicks start_time = base::TimeTicks::Now();
 
   size_t bytes_over_hard_memory_limit = 0;
   if (ranges_size + newDataSize > memory_limit_)
@@ -1032,9 +1077,76 @@ bool SourceBufferStream<RangeClass>::GarbageCollectIfNeeded(
            << " bytes_over_hard_memory_limit=" << bytes_over_hard_memory_limit
            << " ranges_=" << RangesToString<RangeClass>(ranges_);
 
+  ReleaseEvictedBuffers();
+  RecordGarbageCollectionTime(base::TimeTicks::Now() - start_time);
+
   return bytes_freed >= bytes_over_hard_memory_limit;
 }
 
+template <typename RangeClass>
+void SourceBufferStream<RangeClass>::GarbageCollectProactively(
+    DecodeTimestamp media_time,
+    size_t buffered_size,
+    size_t effective_memory_limit) {
+  const size_t proactive_memory_limit =
+      effective_memory_limit / 4 * kProactiveGarbageCollectionQuarters;
+  if (buffered_size <= proactive_memory_limit)
+    return;
+
+  // Appends behind the playback position, e.g. to fill in a gap, would have
+  // their data freed right away. Leave those to the regular algorithm.
+  if (highest_buffered_end_time_in_append_sequence_ != kNoDecodeTimestamp() &&
+      media_time > highest_buffered_end_time_in_append_sequence_) {
+    return;
+  }
+
+  const base::TimeTicks start_time = base::TimeTicks::Now();
+  size_t bytes_freed = FreeBuffersWithinDeadline(
+      buffered_size - proactive_memory_limit, media_time,
+      start_time + garbage_collection_budget_);
+  DVLOG(3) << __func__ << " " << GetStreamTypeName() << ": Removed "
+           << bytes_freed << " bytes from the front. ranges_="
+           << RangesToString<RangeClass>(ranges_);
+  if (bytes_freed == 0)
+    return;
+
+  ReleaseEvictedBuffers();
+  RecordGarbageCollectionTime(base::TimeTicks::Now() - start_time);
+}
+
+template <typename RangeClass>
+size_t SourceBufferStream<RangeClass>::FreeBuffersWithinDeadline(
+    size_t total_bytes_to_free,
+    DecodeTimestamp media_time,
+    base::TimeTicks deadline) {
+  size_t bytes_freed = 0;
+  do {
+    // FreeBuffers() stops after the first GOP which frees at least a byte.
+    size_t gop_bytes = FreeBuffers(1, media_time, false);
+    if (gop_bytes == 0)
+      break;
+    bytes_freed += gop_bytes;
+  } while (bytes_freed < total_bytes_to_free &&
+           base::TimeTicks::Now() < deadline);
+  return bytes_freed;
+}
+
+template <typename RangeClass>
+void SourceBufferStream<RangeClass>::ReleaseEvictedBuffers() {
+  if (evicted_buffers_.empty())
+    return;
+
+  // Releasing the last reference frees each buffer's data, which adds up for
+  // large evictions. The buffers are thread-safe refcounted, and nothing else
+  // refers to them through this stream anymore.
+  if (base::TaskScheduler::GetInstance()) {
+    base::PostTaskWithTraits(
+        FROM_HERE, {base::TaskPriority::BACKGROUND},
+        base::BindOnce([](BufferQueue) {}, std::move(evicted_buffers_)));
+  }
+  evicted_buffers_.clear();
+}
+
 template <typename RangeClass>
 size_t SourceBufferStream<RangeClass>::FreeBuffersAfterLastAppended(
     size_t total_bytes_to_free,
@@ -1169,6 +1281,12 @@ size_t SourceBufferStream<RangeClass>::FreeBuffers(size_t total_bytes_to_free,
       range_for_next_append_ = ranges_.end();
     } else {
       bytes_freed += bytes_deleted;
+      // Freed buffers are kept for ReleaseEvictedBuffers() instead of being
+      // destroyed GOP by GOP.
+      if (incremental_garbage_collection_) {
+        std::move(buffers.begin(), buffers.end(),
+                  std::back_inserter(evicted_buffers_));
+      }
     }
 
     if (current_range->size_in_bytes() == 0) {
@@ -22,6 +22,7 @@
 #include "base/macros.h"
 #include "base/memory/memory_pressure_listener.h"
 #include "base/memory/ref_counted.h"
+#include "base/time/time.h"
 #include "media/base/audio_decoder_config.h"
 #include "media/base/media_export.h"
 #include "media/base/media_log.h"
@@ -100,6 +101,10 @@ class MEDIA_EXPORT SourceBufferStream {
 
   // Frees up space if the SourceBufferStream is taking up too much memory.
   // |media_time| is current playback position.
+  // When kIncrementalSourceBufferGC is enabled, also frees data before
+  // |media_time| once the stream is above a fraction of its memory limit, a
+  // GOP at a time until |garbage_collection_budget_| is spent, so that the
+  // limit is rarely reached and each call does a bounded amount of work.
   bool GarbageCollectIfNeeded(DecodeTimestamp media_time,
                               size_t newDataSize);
 
@@ -209,6 +214,23 @@ class MEDIA_EXPORT SourceBufferStream {
   size_t FreeBuffersAfterLastAppended(size_t total_bytes_to_free,
                                       DecodeTimestamp media_time);
 
+  // Frees data before |media_time| until |buffered_size|, the bytes buffered
+  // including the upcoming append, is back under three quarters of
+  // |effective_memory_limit| or |garbage_collection_budget_| is spent.
+  void GarbageCollectProactively(DecodeTimestamp media_time,
+                                 size_t buffered_size,
+                                 size_t effective_memory_limit);
+
+  // Like FreeBuffers() from the front, but frees a GOP at a time and stops
+  // after the GOP which crosses |deadline|.
+  size_t FreeBuffersWithinDeadline(size_t total_bytes_to_free,
+                                   DecodeTimestamp media_time,
+                                   base::TimeTicks deadline);
+
+  // Drops the references to buffers collected by FreeBuffers(), on a
+  // background task if a TaskScheduler is available.
+  void ReleaseEvictedBuffers();
+
   // Gets the removal range to secure |byte_to_free| from
   // [|start_timestamp|, |end_timestamp|).
   // Returns the size of buffers to secure if future
@@ -554,6 +576,17 @@ class MEDIA_EXPORT SourceBufferStream {
   // The maximum amount of data in bytes the stream will keep in memory.
   size_t memory_limit_;
 
+  // Whether kIncrementalSourceBufferGC is enabled, and the time
+  // GarbageCollectIfNeeded() may then spend freeing data before the memory
+  // limit is reached, set by the feature's "budget_ms" parameter. At least one
+  // GOP is freed per call regardless. Both are read on construction.
+  const bool incremental_garbage_collection_;
+  const base::TimeDelta garbage_collection_budget_;
+
+  // Buffers freed by garbage collection with kIncrementalSourceBufferGC
+  // enabled, waiting for ReleaseEvictedBuffers().
+  BufferQueue evicted_buffers_;
+
   // Indicates that a kConfigChanged status has been reported by GetNextBuffer()
   // and GetCurrentXXXDecoderConfig() must be called to update the current
   // config. GetNextBuffer() must not be called again until
@@ -0,0 +1,186 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/test/scoped_feature_list.h"
+#include "base/time/time.h"
+#include "media/base/media_log.h"
+#include "media/base/media_switches.h"
+#include "media/base/stream_parser_buffer.h"
+#include "media/base/test_helpers.h"
+#include "media/filters/source_buffer_range_by_dts.h"
+#include "media/filters/source_buffer_range_by_pts.h"
+#include "media/filters/source_buffer_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+// A long live session: two hours of 2 second segments of 30 fps video, each
+// segment being one GOP.
+static const int kFramesPerSecond = 30;
+static const int kSegmentDurationSeconds = 2;
+static const int kFramesPerSegment = kFramesPerSecond * kSegmentDurationSeconds;
+static const int kNumSegments = 2 * 60 * 60 / kSegmentDurationSeconds;
+static const int kFrameSize = 64;
+
+static const int kNumSeeks = 10000;
+static const int kNumRemovals = 500;
+
+// Memory limit for the garbage collection benchmark, holding ten minutes of
+// media.
+static const size_t kGarbageCollectionMemoryLimit =
+    10 * 60 * kFramesPerSecond * kFrameSize;
+
+class SourceBufferStreamPerfTest : public testing::Test {
+ public:
+  SourceBufferStreamPerfTest()
+      : frame_duration_(base::TimeDelta::FromSeconds(1) / kFramesPerSecond),
+        segment_duration_(
+            base::TimeDelta::FromSeconds(kSegmentDurationSeconds)) {
+    for (int i = 0; i < kFrameSize; ++i)
+      frame_data_[i] = i;
+  }
+
+  // Returns the frames of segment |index|.
+  StreamParser::BufferQueue CreateSegment(int index) const {
+    StreamParser::BufferQueue buffers;
+    for (int i = 0; i < kFramesPerSegment; ++i) {
+      scoped_refptr<StreamParserBuffer> buffer = StreamParserBuffer::CopyFrom(
+          frame_data_, kFrameSize, i == 0, DemuxerStream::VIDEO, 0);
+      const base::TimeDelta timestamp =
+          segment_duration_ * index + frame_duration_ * i;
+      buffer->set_timestamp(timestamp);
+      buffer->SetDecodeTimestamp(
+          DecodeTimestamp::FromPresentationTime(timestamp));
+      buffer->set_duration(frame_duration_);
+      buffers.push_back(buffer);
+    }
+    return buffers;
+  }
+
+  template <typename RangeClass>
+  void AppendSegment(SourceBufferStream<RangeClass>* stream, int index) {
+    const base::TimeDelta start = segment_duration_ * index;
+    stream->OnStartOfCodedFrameGroup(
+        DecodeTimestamp::FromPresentationTime(start), start);
+    ASSERT_TRUE(stream->Append(CreateSegment(index)));
+  }
+
+  // Appends every segment to a new stream and reports the time per segment,
+  // then seeks to and removes segments throughout the stream.
+  template <typename RangeClass>
+  void RunAppendSeekRemoveBenchmark(const std::string& trace) {
+    SourceBufferStream<RangeClass> stream(TestVideoConfig::Normal(),
+                                          &media_log_);
+    stream.set_memory_limit(kNumSegments * kFramesPerSegment * kFrameSize);
+
+    base::TimeDelta append_time;
+    for (int i = 0; i < kNumSegments; ++i) {
+      // Exclude creating the buffers, which a demuxer would do.
+      const StreamParser::BufferQueue buffers = CreateSegment(i);
+      const base::TimeDelta start = segment_duration_ * i;
+      const base::TimeTicks append_start = base::TimeTicks::Now();
+      stream.OnStartOfCodedFrameGroup(
+          DecodeTimestamp::FromPresentationTime(start), start);
+      ASSERT_TRUE(stream.Append(buffers));
+      append_time += base::TimeTicks::Now() - append_start;
+    }
+    ASSERT_EQ(1u, stream.GetBufferedTime().size());
+    perf_test::PrintResult("source_buffer_stream_append", "", trace,
+                           append_time.InMicrosecondsF() / kNumSegments, "us",
+                           true);
+
+    const base::TimeDelta duration = stream.GetBufferedDuration();
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kNumSeeks; ++i) {
+      // Visit the whole stream in a cache-unfriendly order.
+      stream.Seek(duration * ((i * 7919) % kNumSeeks) / kNumSeeks);
+    }
+    perf_test::PrintResult(
+        "source_buffer_stream_seek", "", trace,
+        (base::TimeTicks::Now() - start).InMicrosecondsF() / kNumSeeks, "us",
+        true);
+
+    // Remove segments spread over the stream, each splitting a range.
+    start = base::TimeTicks::Now();
+    for (int i = 0; i < kNumRemovals; ++i) {
+      const int index = (i * 7919) % kNumSegments;
+      stream.Remove(segment_duration_ * index,
+                    segment_duration_ * index + frame_duration_ * 10,
+                    duration);
+    }
+    perf_test::PrintResult(
+        "source_buffer_stream_remove", "", trace,
+        (base::TimeTicks::Now() - start).InMicrosecondsF() / kNumRemovals,
+        "us", true);
+  }
+
+  // Plays a live session with a sliding window of buffered media, collecting
+  // garbage before every append like SourceBuffer does, and reports the
+  // average and the longest time spent collecting garbage per segment.
+  template <typename RangeClass>
+  void RunGarbageCollectionBenchmark(const std::string& trace) {
+    SourceBufferStream<RangeClass> stream(TestVideoConfig::Normal(),
+                                          &media_log_);
+    stream.set_memory_limit(kGarbageCollectionMemoryLimit);
+
+    base::TimeDelta gc_time;
+    base::TimeDelta max_gc_time;
+    for (int i = 0; i < kNumSegments; ++i) {
+      // Playback trails the live edge by one segment.
+      const DecodeTimestamp media_time = DecodeTimestamp::FromPresentationTime(
+          segment_duration_ * std::max(i - 1, 0));
+      const base::TimeTicks gc_start = base::TimeTicks::Now();
+      ASSERT_TRUE(stream.GarbageCollectIfNeeded(
+          media_time, kFramesPerSegment * kFrameSize));
+      const base::TimeDelta elapsed = base::TimeTicks::Now() - gc_start;
+      gc_time += elapsed;
+      max_gc_time = std::max(max_gc_time, elapsed);
+      AppendSegment(&stream, i);
+    }
+    EXPECT_LE(stream.GetBufferedSize(), kGarbageCollectionMemoryLimit);
+    perf_test::PrintResult("source_buffer_stream_gc", "", trace,
+                           gc_time.InMicrosecondsF() / kNumSegments, "us",
+                           true);
+    perf_test::PrintResult("source_buffer_stream_gc_max", "", trace,
+                           max_gc_time.InMicrosecondsF(), "us", true);
+  }
+
+ protected:
+  const base::TimeDelta frame_duration_;
+  const base::TimeDelta segment_duration_;
+  uint8_t frame_data_[kFrameSize];
+  MediaLog media_log_;
+};
+
+TEST_F(SourceBufferStreamPerfTest, AppendSeekRemoveByPts) {
+  RunAppendSeekRemoveBenchmark<SourceBufferRangeByPts>("by_pts");
+}
+
+TEST_F(SourceBufferStreamPerfTest, AppendSeekRemoveByDts) {
+  RunAppendSeekRemoveBenchmark<SourceBufferRangeByDts>("by_dts");
+}
+
+TEST_F(SourceBufferStreamPerfTest, GarbageCollectionByPts) {
+  RunGarbageCollectionBenchmark<SourceBufferRangeByPts>("by_pts");
+}
+
+TEST_F(SourceBufferStreamPerfTest, GarbageCollectionByDts) {
+  RunGarbageCollectionBenchmark<SourceBufferRangeByDts>("by_dts");
+}
+
+TEST_F(SourceBufferStreamPerfTest, IncrementalGarbageCollectionByPts) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeature(kIncrementalSourceBufferGC);
+  RunGarbageCollectionBenchmark<SourceBufferRangeByPts>("by_pts_incremental");
+}
+
+}  // namespace media
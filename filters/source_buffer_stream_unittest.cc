@@ -23,6 +23,7 @@
 #include "media/base/media_switches.h"
 #include "media/base/media_util.h"
 #include "media/base/mock_media_log.h"
+#include "media/base/segment_buffer.h"
 #include "media/base/test_helpers.h"
 #include "media/base/text_track_config.h"
 #include "media/base/timestamp_constants.h"
@@ -594,6 +595,27 @@ class SourceBufferStreamTest : public testing::TestWithParam<BufferingApi> {
       EXPECT_EQ(expect_success, STREAM_OP(Append(queue)));
   }
 
+  // Appends |number_of_buffers| keyframes starting at |starting_position|,
+  // whose data are consecutive slices of |segment| rather than copies.
+  void AppendSegmentSlices(int starting_position,
+                           int number_of_buffers,
+                           const scoped_refptr<SegmentBuffer>& segment) {
+    BufferQueue queue;
+    for (int i = 0; i < number_of_buffers; i++) {
+      scoped_refptr<StreamParserBuffer> buffer =
+          StreamParserBuffer::FromSegment(segment,
+                                          segment->data() + i * kDataSize,
+                                          kDataSize, true, GetStreamType(), 0);
+      base::TimeDelta timestamp = frame_duration_ * (starting_position + i);
+      buffer->SetDecodeTimestamp(
+          DecodeTimestamp::FromPresentationTime(timestamp));
+      buffer->set_timestamp(timestamp);
+      buffer->set_duration(frame_duration_);
+      queue.push_back(buffer);
+    }
+    EXPECT_TRUE(STREAM_OP(Append(queue)));
+  }
+
   void UpdateLastBufferDuration(DecodeTimestamp current_dts,
                                 BufferQueue* buffers) {
     if (buffers->empty() || buffers->back()->duration() > base::TimeDelta())
@@ -2684,6 +2706,42 @@ TEST_P(SourceBufferStreamTest, GarbageCollection_DeleteFrontGOPsAtATime) {
   CheckExpectedBuffers(5, 9, &kDataA);
 }
 
+TEST_P(SourceBufferStreamTest,
+       GarbageCollection_RepeatedDeleteFrontThenSeekAndRemove) {
+  // Set memory limit to 20 buffers.
+  SetMemoryLimit(20);
+
+  // Append 20 buffers at positions 0 through 19.
+  NewCodedFrameGroupAppend(0, 20, &kDataA);
+
+  // Keep playback 15 buffers ahead of the front while appending 5 buffers at a
+  // time, so that each GC deletes the first GOP of the range.
+  for (int i = 20; i < 60; i += 5) {
+    Seek(i - 5);
+    EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(i - 5, 5));
+    AppendBuffers(i, 5, &kDataA);
+  }
+  CheckExpectedRanges("{ [40,59) }");
+
+  // Keyframes left after the front deletions are still found by seeks.
+  Seek(45);
+  CheckExpectedBuffers(45, 59, &kDataA);
+  Seek(40);
+  CheckExpectedBuffers(40, 44, &kDataA);
+
+  // Removing a GOP from the middle splits the range at its keyframes.
+  Remove(45 * frame_duration(), 50 * frame_duration(), 60 * frame_duration());
+  CheckExpectedRanges("{ [40,44) [50,59) }");
+  Seek(50);
+  CheckExpectedBuffers(50, 59, &kDataA);
+
+  // GC can still delete the front of the stream after the removal.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(55, 10));
+  CheckExpectedRanges("{ [50,59) }");
+  Seek(50);
+  CheckExpectedBuffers(50, 59, &kDataA);
+}
+
 TEST_P(SourceBufferStreamTest, GarbageCollection_DeleteBack) {
   // Set memory limit to 5 buffers.
   SetMemoryLimit(5);
@@ -3283,6 +3341,41 @@ TEST_P(SourceBufferStreamTest, GarbageCollection_Performance) {
   }
 }
 
+TEST_P(SourceBufferStreamTest, GarbageCollection_FreesWholeSegments) {
+  SetStreamInfo(kDefaultFramesPerSecond, kDefaultFramesPerSecond);
+  SetMemoryLimit(20);
+
+  // Buffers 0 through 9 are slices of |segment_a| and 10 through 19 of
+  // |segment_b|. Each segment has 15 buffers worth of data written to it, of
+  // which the stream counts all, and room for 5 more, which it doesn't count.
+  std::vector<uint8_t> data(15 * kDataSize);
+  scoped_refptr<SegmentBuffer> segment_a =
+      base::MakeRefCounted<SegmentBuffer>(20 * kDataSize);
+  segment_a->Write(0, data.data(), data.size());
+  scoped_refptr<SegmentBuffer> segment_b =
+      base::MakeRefCounted<SegmentBuffer>(20 * kDataSize);
+  segment_b->Write(0, data.data(), data.size());
+  STREAM_OP(OnStartOfCodedFrameGroup(DecodeTimestamp(), base::TimeDelta()));
+  AppendSegmentSlices(0, 10, segment_a);
+  AppendSegmentSlices(10, 10, segment_b);
+  CheckExpectedRanges("{ [0,19) }");
+  EXPECT_EQ(30u * kDataSize, STREAM_OP(GetBufferedSize()));
+
+  // Removing only some of |segment_a|'s slices frees no memory.
+  Remove(base::TimeDelta(), 5 * frame_duration_, 20 * frame_duration_);
+  CheckExpectedRanges("{ [5,19) }");
+  EXPECT_EQ(30u * kDataSize, STREAM_OP(GetBufferedSize()));
+
+  // GC has to evict all of the remaining slices of |segment_a| to get under the
+  // limit, after which nothing but this test refers to it.
+  Seek(15);
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(15, 0));
+  CheckExpectedRanges("{ [10,19) }");
+  EXPECT_EQ(15u * kDataSize, STREAM_OP(GetBufferedSize()));
+  EXPECT_TRUE(segment_a->HasOneRef());
+  EXPECT_FALSE(segment_b->HasOneRef());
+}
+
 TEST_P(SourceBufferStreamTest, GarbageCollection_MediaTimeAfterLastAppendTime) {
   // Set memory limit to 10 buffers.
   SetMemoryLimit(10);
@@ -5314,6 +5407,58 @@ TEST_P(SourceBufferStreamTest, InstantGarbageCollectionUnderMemoryPressure) {
   CheckExpectedRangesByTimestamp("{ [9,16) }");
 }
 
+TEST_P(SourceBufferStreamTest, IncrementalGarbageCollection) {
+  // Without any budget, data is freed one GOP per call.
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeatureWithParameters(
+      kIncrementalSourceBufferGC, {{"budget_ms", "0"}});
+  STREAM_RESET(video_config_);
+  SetMemoryLimit(40);
+  NewCodedFrameGroupAppend(0, 40, &kDataA);
+  Seek(35);
+
+  // The stream is within its memory limit but above three quarters of it, so
+  // data before the playback position is freed.
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(35, 0));
+  CheckExpectedRanges("{ [5,39) }");
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(35, 0));
+  CheckExpectedRanges("{ [10,39) }");
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(35, 0));
+  CheckExpectedRanges("{ [10,39) }");
+  CheckExpectedBuffers(35, 39, &kDataA);
+}
+
+TEST_P(SourceBufferStreamTest, IncrementalGarbageCollection_Budget) {
+  // With enough budget, a single call frees as much as needed.
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeatureWithParameters(
+      kIncrementalSourceBufferGC, {{"budget_ms", "10000"}});
+  STREAM_RESET(video_config_);
+  SetMemoryLimit(40);
+  NewCodedFrameGroupAppend(0, 30, &kDataA);
+  Seek(25);
+
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(25, 10));
+  CheckExpectedRanges("{ [10,29) }");
+  CheckExpectedBuffers(25, 29, &kDataA);
+}
+
+TEST_P(SourceBufferStreamTest, IncrementalGarbageCollection_OverMemoryLimit) {
+  // Making room for an append which would exceed the memory limit isn't
+  // bounded by the budget.
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeatureWithParameters(
+      kIncrementalSourceBufferGC, {{"budget_ms", "0"}});
+  STREAM_RESET(video_config_);
+  SetMemoryLimit(20);
+  NewCodedFrameGroupAppend(0, 20, &kDataA);
+  Seek(15);
+
+  EXPECT_TRUE(GarbageCollectWithPlaybackAtBuffer(15, 10));
+  CheckExpectedRanges("{ [10,19) }");
+  CheckExpectedBuffers(15, 19, &kDataA);
+}
+
 TEST_P(SourceBufferStreamTest, GCFromFrontThenExplicitRemoveFromMiddleToEnd) {
   // Attempts to exercise SBRByPts::GetBufferIndexAt() after its
   // |keyframe_map_index_base_| has been increased, and when there is a GOP
@@ -14,7 +14,6 @@
 #include <algorithm>
 
 #include "base/bind.h"
-#include "base/containers/circular_deque.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/numerics/safe_conversions.h"
@@ -328,6 +327,8 @@ void Vp9Parser::Context::UpdateRefSlot(
   ref_slots_[ref_type] = ref_slot;
 }
 
+constexpr size_t Vp9Parser::kMaxFramesInSuperframe;
+
 Vp9Parser::Vp9Parser(bool parsing_compressed_header)
     : parsing_compressed_header_(parsing_compressed_header) {
   Reset();
@@ -339,13 +340,13 @@ void Vp9Parser::SetStream(const uint8_t* stream, off_t stream_size) {
   DCHECK(stream);
   stream_ = stream;
   bytes_left_ = stream_size;
-  frames_.clear();
+  num_frames_ = next_frame_index_ = 0;
 }
 
 void Vp9Parser::Reset() {
   stream_ = nullptr;
   bytes_left_ = 0;
-  frames_.clear();
+  num_frames_ = next_frame_index_ = 0;
   curr_frame_info_.Reset();
 
   context_.Reset();
@@ -451,21 +452,19 @@ Vp9Parser::Result Vp9Parser::ParseNextFrame(Vp9FrameHeader* fhdr) {
     frame_info = curr_frame_info_;
     curr_frame_info_.Reset();
   } else {
-    if (frames_.empty()) {
+    if (next_frame_index_ == num_frames_) {
       // No frames to be decoded, if there is no more stream, request more.
       if (!stream_)
         return kEOStream;
 
       // New stream to be parsed, parse it and fill frames_.
-      frames_ = ParseSuperframe();
-      if (frames_.empty()) {
+      if (!ParseSuperframe()) {
         DVLOG(1) << "Failed parsing superframes";
         return kInvalidStream;
       }
     }
 
-    frame_info = frames_.front();
-    frames_.pop_front();
+    frame_info = frames_[next_frame_index_++];
 
     if (ParseUncompressedHeader(frame_info, fhdr, &result))
       return result;
@@ -497,22 +496,25 @@ Vp9Parser::ContextRefreshCallback Vp9Parser::GetContextRefreshCb(
 }
 
 // Annex B Superframes
-base::circular_deque<Vp9Parser::FrameInfo> Vp9Parser::ParseSuperframe() {
+bool Vp9Parser::ParseSuperframe() {
   const uint8_t* stream = stream_;
   off_t bytes_left = bytes_left_;
 
   // Make sure we don't parse stream_ more than once.
   stream_ = nullptr;
   bytes_left_ = 0;
+  num_frames_ = next_frame_index_ = 0;
 
   if (bytes_left < 1)
-    return base::circular_deque<FrameInfo>();
+    return false;
 
   // If this is a superframe, the last byte in the stream will contain the
   // superframe marker. If not, the whole buffer contains a single frame.
   uint8_t marker = *(stream + bytes_left - 1);
   if ((marker & 0xe0) != 0xc0) {
-    return {FrameInfo(stream, bytes_left)};
+    frames_[0] = FrameInfo(stream, bytes_left);
+    num_frames_ = 1;
+    return true;
   }
 
   DVLOG(1) << "Parsing a superframe";
@@ -521,22 +523,23 @@ base::circular_deque<Vp9Parser::FrameInfo> Vp9Parser::ParseSuperframe() {
   // index, which stores information about sizes of each frame in it.
   // Calculate its size and set index_ptr to the beginning of it.
   size_t num_frames = (marker & 0x7) + 1;
+  static_assert(kMaxFramesInSuperframe == 0x7 + 1,
+                "|frames_| must fit any superframe");
   size_t mag = ((marker >> 3) & 0x3) + 1;
   off_t index_size = 2 + mag * num_frames;
 
   if (bytes_left < index_size)
-    return base::circular_deque<FrameInfo>();
+    return false;
 
   const uint8_t* index_ptr = stream + bytes_left - index_size;
   if (marker != *index_ptr)
-    return base::circular_deque<FrameInfo>();
+    return false;
 
   ++index_ptr;
   bytes_left -= index_size;
 
   // Parse frame information contained in the index and add a pointer to and
-  // size of each frame to frames.
-  base::circular_deque<FrameInfo> frames;
+  // size of each frame to frames_.
   for (size_t i = 0; i < num_frames; ++i) {
     uint32_t size = 0;
     for (size_t j = 0; j < mag; ++j) {
@@ -547,17 +550,18 @@ base::circular_deque<Vp9Parser::FrameInfo> Vp9Parser::ParseSuperframe() {
     if (!base::IsValueInRangeForNumericType<off_t>(size) ||
         static_cast<off_t>(size) > bytes_left) {
       DVLOG(1) << "Not enough data in the buffer for frame " << i;
-      return base::circular_deque<FrameInfo>();
+      return false;
     }
 
-    frames.push_back(FrameInfo(stream, size));
+    frames_[i] = FrameInfo(stream, size);
     stream += size;
     bytes_left -= size;
 
     DVLOG(1) << "Frame " << i << ", size: " << size;
   }
 
-  return frames;
+  num_frames_ = num_frames;
+  return true;
 }
 
 // 8.6.1 Dequantization functions
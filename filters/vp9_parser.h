@@ -19,7 +19,6 @@
 #include <memory>
 
 #include "base/callback.h"
-#include "base/containers/circular_deque.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
 #include "media/base/media_export.h"
@@ -370,7 +369,7 @@ class MEDIA_EXPORT Vp9Parser {
 
   // Parse the next frame in the current stream buffer, filling |fhdr| with
   // the parsed frame header and updating current segmentation and loop filter
-  // state.
+  // state. Parsing does not allocate.
   // Return kOk if a frame has successfully been parsed,
   //        kEOStream if there is no more data in the current stream buffer,
   //        kAwaitingRefresh if this frame awaiting frame context update, or
@@ -403,7 +402,12 @@ class MEDIA_EXPORT Vp9Parser {
     off_t size = 0;
   };
 
-  base::circular_deque<FrameInfo> ParseSuperframe();
+  // A superframe index holds the sizes of at most 8 frames.
+  static constexpr size_t kMaxFramesInSuperframe = 8;
+
+  // Split the current stream buffer into |frames_|. Return false if the
+  // superframe index is invalid.
+  bool ParseSuperframe();
 
   // Returns true and populates |result| with the parsing result if parsing of
   // current frame is finished (possibly unsuccessfully). |fhdr| will only be
@@ -432,8 +436,11 @@ class MEDIA_EXPORT Vp9Parser {
 
   const bool parsing_compressed_header_;
 
-  // FrameInfo for the remaining frames in the current superframe to be parsed.
-  base::circular_deque<FrameInfo> frames_;
+  // FrameInfo for the frames in the current superframe. Those from
+  // |next_frame_index_| to |num_frames_| remain to be parsed.
+  FrameInfo frames_[kMaxFramesInSuperframe];
+  size_t num_frames_;
+  size_t next_frame_index_;
 
   Context context_;
 
@@ -0,0 +1,73 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/time/time.h"
+#include "media/base/decoder_buffer.h"
+#include "media/base/test_data_util.h"
+#include "media/filters/ivf_parser.h"
+#include "media/filters/vp9_parser.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 500;
+
+// test-25fps.vp9 has no frames awaiting a context update from the decoder, so
+// it can be parsed with and without the compressed header.
+class Vp9ParserPerfTest : public testing::Test {
+ public:
+  Vp9ParserPerfTest() : stream_(ReadTestDataFile("test-25fps.vp9")) {
+    IvfParser ivf_parser;
+    IvfFileHeader ivf_file_header;
+    EXPECT_TRUE(ivf_parser.Initialize(stream_->data(), stream_->data_size(),
+                                      &ivf_file_header));
+    IvfFrameHeader ivf_frame_header;
+    const uint8_t* payload;
+    while (ivf_parser.ParseNextFrame(&ivf_frame_header, &payload))
+      frames_.emplace_back(payload, ivf_frame_header.frame_size);
+  }
+
+  // Parses every frame of the stream kBenchmarkIterations times and reports
+  // the time per frame.
+  void RunBenchmark(const std::string& trace, bool parsing_compressed_header) {
+    int num_parsed_frames = 0;
+    Vp9FrameHeader fhdr;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      Vp9Parser parser(parsing_compressed_header);
+      for (const auto& frame : frames_) {
+        parser.SetStream(frame.first, frame.second);
+        while (parser.ParseNextFrame(&fhdr) == Vp9Parser::kOk)
+          ++num_parsed_frames;
+      }
+    }
+    double total_time_microseconds =
+        (base::TimeTicks::Now() - start).InMicrosecondsF();
+    ASSERT_EQ(269 * kBenchmarkIterations, num_parsed_frames);
+    perf_test::PrintResult("vp9_parser", "", trace,
+                           total_time_microseconds / num_parsed_frames, "us",
+                           true);
+  }
+
+ protected:
+  scoped_refptr<DecoderBuffer> stream_;
+  std::vector<std::pair<const uint8_t*, size_t>> frames_;
+};
+
+TEST_F(Vp9ParserPerfTest, ParseWithCompressedHeader) {
+  RunBenchmark("with_compressed_header", true);
+}
+
+TEST_F(Vp9ParserPerfTest, ParseWithoutCompressedHeader) {
+  RunBenchmark("without_compressed_header", false);
+}
+
+}  // namespace media
@@ -264,6 +264,59 @@ TEST_F(Vp9ParserTest, AwaitingContextUpdate) {
   EXPECT_EQ(9u, fhdr.header_size_in_bytes);
 }
 
+// Without the compressed header, the parser returns the same uncompressed
+// header fields.
+TEST_F(Vp9ParserTest, ParsingWithoutCompressedHeaderMatchesFullParsing) {
+  Initialize("bear-vp9.ivf", true);
+
+  IvfParser ivf_parser;
+  IvfFileHeader ivf_file_header;
+  ASSERT_TRUE(ivf_parser.Initialize(stream_->data(), stream_->length(),
+                                    &ivf_file_header));
+  Vp9Parser parser(false);
+
+  int num_parsed_frames = 0;
+  Vp9FrameHeader fhdr;
+  while (ParseNextFrame(&fhdr) == Vp9Parser::kOk) {
+    Vp9FrameContext frame_context;
+    ReadContext(&frame_context);
+    ReadContext(&frame_context);
+    if (ReadShouldContextUpdate()) {
+      ReadContext(&frame_context);
+      GetContextRefreshCb(fhdr).Run(frame_context);
+    }
+
+    Vp9FrameHeader uncompressed_fhdr;
+    memset(&uncompressed_fhdr, 0xab, sizeof(uncompressed_fhdr));
+    Vp9Parser::Result res;
+    while ((res = parser.ParseNextFrame(&uncompressed_fhdr)) ==
+           Vp9Parser::kEOStream) {
+      IvfFrameHeader ivf_frame_header;
+      const uint8_t* ivf_payload;
+      ASSERT_TRUE(ivf_parser.ParseNextFrame(&ivf_frame_header, &ivf_payload));
+      parser.SetStream(ivf_payload, ivf_frame_header.frame_size);
+    }
+    ASSERT_EQ(Vp9Parser::kOk, res);
+
+    EXPECT_EQ(fhdr.frame_type, uncompressed_fhdr.frame_type);
+    EXPECT_EQ(fhdr.show_frame, uncompressed_fhdr.show_frame);
+    EXPECT_EQ(fhdr.frame_width, uncompressed_fhdr.frame_width);
+    EXPECT_EQ(fhdr.frame_height, uncompressed_fhdr.frame_height);
+    EXPECT_EQ(fhdr.refresh_frame_flags, uncompressed_fhdr.refresh_frame_flags);
+    EXPECT_EQ(fhdr.quant_params.base_q_idx,
+              uncompressed_fhdr.quant_params.base_q_idx);
+    EXPECT_EQ(fhdr.data, uncompressed_fhdr.data);
+    EXPECT_EQ(fhdr.frame_size, uncompressed_fhdr.frame_size);
+    EXPECT_EQ(fhdr.header_size_in_bytes,
+              uncompressed_fhdr.header_size_in_bytes);
+    EXPECT_EQ(fhdr.uncompressed_header_size,
+              uncompressed_fhdr.uncompressed_header_size);
+    ++num_parsed_frames;
+  }
+
+  EXPECT_EQ(82, num_parsed_frames);
+}
+
 TEST_P(Vp9ParserTest, VerifyFirstFrame) {
   Initialize(GetParam().file_name, false);
   Vp9FrameHeader fhdr;
@@ -4,19 +4,38 @@
 
 #include "media/filters/wsola_internals.h"
 
+#include <stdint.h>
+
 #include <algorithm>
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "base/logging.h"
+#include "base/no_destructor.h"
 #include "base/numerics/math_constants.h"
 #include "build/build_config.h"
 #include "media/base/audio_bus.h"
 
 #if defined(ARCH_CPU_X86_FAMILY)
 #define USE_SIMD 1
-#include <xmmintrin.h>
+#include <emmintrin.h>
+
+// NaCl does not allow intrinsics beyond SSE2 to be selected at run time.
+#if !defined(OS_NACL)
+#include <immintrin.h>
+
+#include "base/cpu.h"
+
+#if defined(COMPILER_GCC) || defined(__clang__)
+#define AVX2_FUNCTION __attribute__((target("avx2,fma")))
+#else
+#define AVX2_FUNCTION
+#endif
+#define USE_AVX2 1
+#endif
 #elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
 #define USE_SIMD 1
 #include <arm_neon.h>
@@ -43,6 +62,122 @@ float MultiChannelSimilarityMeasure(const float* dot_prod_a_b,
   return similarity_measure;
 }
 
+// Dot product of |len| elements of |a| and |b|; neither needs to be aligned.
+static float DotProduct_C(const float* a, const float* b, int len) {
+  float sum = 0.0f;
+  for (int n = 0; n < len; ++n)
+    sum += a[n] * b[n];
+  return sum;
+}
+
+// The SIMD versions keep two independent accumulators so consecutive
+// multiply-adds don't wait on each other, which roughly doubles throughput
+// over a single accumulator on current cores.
+#if defined(ARCH_CPU_X86_FAMILY)
+static float DotProduct_SSE(const float* a, const float* b, int len) {
+  __m128 m_sum0 = _mm_setzero_ps();
+  __m128 m_sum1 = _mm_setzero_ps();
+  int n = 0;
+  for (; n + 8 <= len; n += 8) {
+    m_sum0 = _mm_add_ps(
+        m_sum0, _mm_mul_ps(_mm_loadu_ps(a + n), _mm_loadu_ps(b + n)));
+    m_sum1 = _mm_add_ps(
+        m_sum1, _mm_mul_ps(_mm_loadu_ps(a + n + 4), _mm_loadu_ps(b + n + 4)));
+  }
+  if (n + 4 <= len) {
+    m_sum0 = _mm_add_ps(
+        m_sum0, _mm_mul_ps(_mm_loadu_ps(a + n), _mm_loadu_ps(b + n)));
+    n += 4;
+  }
+  m_sum0 = _mm_add_ps(m_sum0, m_sum1);
+
+  // Reduce to a single float. Sadly, SSE1,2 doesn't have a horizontal sum
+  // function, so we have to condense manually.
+  m_sum0 = _mm_add_ps(_mm_movehl_ps(m_sum0, m_sum0), m_sum0);
+  float sum;
+  _mm_store_ss(&sum, _mm_add_ss(m_sum0, _mm_shuffle_ps(m_sum0, m_sum0, 1)));
+
+  // C version is required to handle remainder of frames (% 4 != 0).
+  return sum + DotProduct_C(a + n, b + n, len - n);
+}
+
+#if defined(USE_AVX2)
+// DotProduct_AVX2() also uses FMA3, which may be unavailable even with AVX2.
+static bool CpuSupportsAVX2() {
+  static const bool supports_avx2 = [] {
+    base::CPU cpu;
+    return cpu.has_avx2() && cpu.has_fma3();
+  }();
+  return supports_avx2;
+}
+
+AVX2_FUNCTION static float DotProduct_AVX2(const float* a,
+                                           const float* b,
+                                           int len) {
+  __m256 m_sum0 = _mm256_setzero_ps();
+  __m256 m_sum1 = _mm256_setzero_ps();
+  int n = 0;
+  for (; n + 16 <= len; n += 16) {
+    m_sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + n), _mm256_loadu_ps(b + n),
+                             m_sum0);
+    m_sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + n + 8),
+                             _mm256_loadu_ps(b + n + 8), m_sum1);
+  }
+  if (n + 8 <= len) {
+    m_sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + n), _mm256_loadu_ps(b + n),
+                             m_sum0);
+    n += 8;
+  }
+  m_sum0 = _mm256_add_ps(m_sum0, m_sum1);
+  __m128 m_sum = _mm_add_ps(_mm256_castps256_ps128(m_sum0),
+                            _mm256_extractf128_ps(m_sum0, 1));
+  if (n + 4 <= len) {
+    m_sum = _mm_fmadd_ps(_mm_loadu_ps(a + n), _mm_loadu_ps(b + n), m_sum);
+    n += 4;
+  }
+  m_sum = _mm_add_ps(_mm_movehl_ps(m_sum, m_sum), m_sum);
+  const float sum =
+      _mm_cvtss_f32(_mm_add_ss(m_sum, _mm_shuffle_ps(m_sum, m_sum, 1)));
+  return sum + DotProduct_C(a + n, b + n, len - n);
+}
+#endif  // defined(USE_AVX2)
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+static float DotProduct_NEON(const float* a, const float* b, int len) {
+  float32x4_t m_sum0 = vmovq_n_f32(0);
+  float32x4_t m_sum1 = vmovq_n_f32(0);
+  int n = 0;
+  for (; n + 8 <= len; n += 8) {
+    m_sum0 = vmlaq_f32(m_sum0, vld1q_f32(a + n), vld1q_f32(b + n));
+    m_sum1 = vmlaq_f32(m_sum1, vld1q_f32(a + n + 4), vld1q_f32(b + n + 4));
+  }
+  if (n + 4 <= len) {
+    m_sum0 = vmlaq_f32(m_sum0, vld1q_f32(a + n), vld1q_f32(b + n));
+    n += 4;
+  }
+  m_sum0 = vaddq_f32(m_sum0, m_sum1);
+
+  // Reduce to a single float.
+  float32x2_t m_half = vadd_f32(vget_high_f32(m_sum0), vget_low_f32(m_sum0));
+  const float sum = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
+  return sum + DotProduct_C(a + n, b + n, len - n);
+}
+#endif
+
+// SIMD optimized variants can provide a massive speedup to this operation.
+static float DotProduct(const float* a, const float* b, int len) {
+#if defined(USE_AVX2)
+  if (CpuSupportsAVX2())
+    return DotProduct_AVX2(a, b, len);
+#endif
+#if defined(ARCH_CPU_X86_FAMILY)
+  return DotProduct_SSE(a, b, len);
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+  return DotProduct_NEON(a, b, len);
+#else
+  return DotProduct_C(a, b, len);
+#endif
+}
+
 void MultiChannelDotProduct(const AudioBus* a,
                             int frame_offset_a,
                             const AudioBus* b,
@@ -55,55 +190,9 @@ void MultiChannelDotProduct(const AudioBus* a,
   DCHECK_LE(frame_offset_a + num_frames, a->frames());
   DCHECK_LE(frame_offset_b + num_frames, b->frames());
 
-// SIMD optimized variants can provide a massive speedup to this operation.
-#if defined(USE_SIMD)
-  const int rem = num_frames % 4;
-  const int last_index = num_frames - rem;
-  const int channels = a->channels();
-  for (int ch = 0; ch < channels; ++ch) {
-    const float* a_src = a->channel(ch) + frame_offset_a;
-    const float* b_src = b->channel(ch) + frame_offset_b;
-
-#if defined(ARCH_CPU_X86_FAMILY)
-    // First sum all components.
-    __m128 m_sum = _mm_setzero_ps();
-    for (int s = 0; s < last_index; s += 4) {
-      m_sum = _mm_add_ps(
-          m_sum, _mm_mul_ps(_mm_loadu_ps(a_src + s), _mm_loadu_ps(b_src + s)));
-    }
-
-    // Reduce to a single float for this channel. Sadly, SSE1,2 doesn't have a
-    // horizontal sum function, so we have to condense manually.
-    m_sum = _mm_add_ps(_mm_movehl_ps(m_sum, m_sum), m_sum);
-    _mm_store_ss(dot_product + ch,
-                 _mm_add_ss(m_sum, _mm_shuffle_ps(m_sum, m_sum, 1)));
-#elif defined(ARCH_CPU_ARM_FAMILY)
-    // First sum all components.
-    float32x4_t m_sum = vmovq_n_f32(0);
-    for (int s = 0; s < last_index; s += 4)
-      m_sum = vmlaq_f32(m_sum, vld1q_f32(a_src + s), vld1q_f32(b_src + s));
-
-    // Reduce to a single float for this channel.
-    float32x2_t m_half = vadd_f32(vget_high_f32(m_sum), vget_low_f32(m_sum));
-    dot_product[ch] = vget_lane_f32(vpadd_f32(m_half, m_half), 0);
-#endif
-  }
-
-  if (!rem)
-    return;
-  num_frames = rem;
-  frame_offset_a += last_index;
-  frame_offset_b += last_index;
-#else
-  memset(dot_product, 0, sizeof(*dot_product) * a->channels());
-#endif  // defined(USE_SIMD)
-
-  // C version is required to handle remainder of frames (% 4 != 0)
-  for (int k = 0; k < a->channels(); ++k) {
-    const float* ch_a = a->channel(k) + frame_offset_a;
-    const float* ch_b = b->channel(k) + frame_offset_b;
-    for (int n = 0; n < num_frames; ++n)
-      dot_product[k] += *ch_a++ * *ch_b++;
+  for (int ch = 0; ch < a->channels(); ++ch) {
+    dot_product[ch] = DotProduct(a->channel(ch) + frame_offset_a,
+                                 b->channel(ch) + frame_offset_b, num_frames);
   }
 }
 
@@ -116,16 +205,47 @@ void MultiChannelMovingBlockEnergies(const AudioBus* input,
   for (int k = 0; k < input->channels(); ++k) {
     const float* input_channel = input->channel(k);
 
-    energy[k] = 0;
-
     // First block of channel |k|.
-    for (int m = 0; m < frames_per_block; ++m) {
-      energy[k] += input_channel[m] * input_channel[m];
-    }
+    energy[k] = DotProduct(input_channel, input_channel, frames_per_block);
 
+    // Each following block adds the energy of the frame sliding in and drops
+    // that of the frame sliding out. The SIMD versions compute four of these
+    // differences at once and turn them into running sums with a prefix sum
+    // across the vector lanes.
     const float* slide_out = input_channel;
     const float* slide_in = input_channel + frames_per_block;
-    for (int n = 1; n < num_blocks; ++n, ++slide_in, ++slide_out) {
+    int n = 1;
+#if defined(USE_SIMD)
+    float block_energies[4];
+    for (; n + 4 <= num_blocks; n += 4, slide_in += 4, slide_out += 4) {
+#if defined(ARCH_CPU_X86_FAMILY)
+      const __m128 m_in = _mm_loadu_ps(slide_in);
+      const __m128 m_out = _mm_loadu_ps(slide_out);
+      __m128 m_diff =
+          _mm_sub_ps(_mm_mul_ps(m_in, m_in), _mm_mul_ps(m_out, m_out));
+      m_diff = _mm_add_ps(m_diff, _mm_castsi128_ps(_mm_slli_si128(
+                                      _mm_castps_si128(m_diff), 4)));
+      m_diff = _mm_add_ps(m_diff, _mm_castsi128_ps(_mm_slli_si128(
+                                      _mm_castps_si128(m_diff), 8)));
+      _mm_storeu_ps(block_energies,
+                    _mm_add_ps(m_diff, _mm_set1_ps(energy[k + (n - 1) *
+                                                                channels])));
+#elif defined(ARCH_CPU_ARM_FAMILY)
+      const float32x4_t m_in = vld1q_f32(slide_in);
+      const float32x4_t m_out = vld1q_f32(slide_out);
+      const float32x4_t m_zero = vmovq_n_f32(0);
+      float32x4_t m_diff = vmlsq_f32(vmulq_f32(m_in, m_in), m_out, m_out);
+      m_diff = vaddq_f32(m_diff, vextq_f32(m_zero, m_diff, 3));
+      m_diff = vaddq_f32(m_diff, vextq_f32(m_zero, m_diff, 2));
+      vst1q_f32(block_energies,
+                vaddq_f32(m_diff, vdupq_n_f32(energy[k + (n - 1) * channels])));
+#endif
+      for (int i = 0; i < 4; ++i)
+        energy[k + (n + i) * channels] = block_energies[i];
+    }
+#endif  // defined(USE_SIMD)
+
+    for (; n < num_blocks; ++n, ++slide_in, ++slide_out) {
       energy[k + n * channels] = energy[k + (n - 1) * channels] - *slide_out *
           *slide_out + *slide_in * *slide_in;
     }
@@ -266,6 +386,269 @@ int FullSearch(int low_limit,
   return optimal_index;
 }
 
+// The largest FFT MultiChannelCrossCorrelation() runs, enough for the search
+// blocks of AudioRendererAlgorithm at limits::kMaxSampleRate.
+constexpr int kMaxFFTSize = 1 << 15;
+
+// Cost of the FFT-based search per frame and stage of its FFTs, relative to a
+// multiply-add of the decimated search, as measured with
+// wsola_internals_perftest.
+constexpr int64_t kFFTSearchCostFactor = 16;
+
+// Twiddle factors of every FFT stage up to kMaxFFTSize, stored contiguously
+// per stage so that the butterflies of a stage read them sequentially: the
+// stage combining blocks of |half_length| uses exp(-2 * pi * i * n / (2 *
+// |half_length|)) for n in [0, |half_length|), at index |half_length| - 1 + n.
+struct FFTTables {
+  FFTTables() : cos_table(kMaxFFTSize - 1), sin_table(kMaxFFTSize - 1) {
+    for (int half_length = 1; half_length < kMaxFFTSize; half_length <<= 1) {
+      for (int n = 0; n < half_length; ++n) {
+        const double angle = -base::kPiDouble * n / half_length;
+        cos_table[half_length - 1 + n] = std::cos(angle);
+        sin_table[half_length - 1 + n] = std::sin(angle);
+      }
+    }
+  }
+
+  std::vector<float> cos_table;
+  std::vector<float> sin_table;
+};
+
+static const FFTTables& GetFFTTables() {
+  static const base::NoDestructor<FFTTables> tables;
+  return *tables;
+}
+
+// In-place radix-2 FFTs of the complex sequence |real|, |imag|, whose size
+// must be a power of two of at most kMaxFFTSize. ForwardFFT() takes its input
+// in natural order and leaves the spectrum in bit-reversed order, which
+// InverseFFT() takes back to natural order, so neither needs a bit-reversal
+// permutation. The inverse transform is unscaled.
+static void ForwardFFT(std::vector<float>* real, std::vector<float>* imag) {
+  const int size = static_cast<int>(real->size());
+  DCHECK_EQ(size & (size - 1), 0);
+  DCHECK_EQ(real->size(), imag->size());
+  DCHECK_LE(size, kMaxFFTSize);
+  const FFTTables& tables = GetFFTTables();
+  float* re = real->data();
+  float* im = imag->data();
+
+  // Decimation in frequency: a' = a + b, b' = (a - b) * w.
+  for (int half_length = size / 2; half_length >= 1; half_length >>= 1) {
+    const float* w_re = &tables.cos_table[half_length - 1];
+    const float* w_im = &tables.sin_table[half_length - 1];
+    for (int start = 0; start < size; start += 2 * half_length) {
+      float* a_re = re + start;
+      float* a_im = im + start;
+      float* b_re = a_re + half_length;
+      float* b_im = a_im + half_length;
+      int i = 0;
+#if defined(USE_SIMD)
+      for (; i + 4 <= half_length; i += 4) {
+#if defined(ARCH_CPU_X86_FAMILY)
+        const __m128 m_a_re = _mm_loadu_ps(a_re + i);
+        const __m128 m_a_im = _mm_loadu_ps(a_im + i);
+        const __m128 m_b_re = _mm_loadu_ps(b_re + i);
+        const __m128 m_b_im = _mm_loadu_ps(b_im + i);
+        const __m128 m_w_re = _mm_loadu_ps(w_re + i);
+        const __m128 m_w_im = _mm_loadu_ps(w_im + i);
+        const __m128 m_d_re = _mm_sub_ps(m_a_re, m_b_re);
+        const __m128 m_d_im = _mm_sub_ps(m_a_im, m_b_im);
+        _mm_storeu_ps(a_re + i, _mm_add_ps(m_a_re, m_b_re));
+        _mm_storeu_ps(a_im + i, _mm_add_ps(m_a_im, m_b_im));
+        _mm_storeu_ps(b_re + i, _mm_sub_ps(_mm_mul_ps(m_d_re, m_w_re),
+                                           _mm_mul_ps(m_d_im, m_w_im)));
+        _mm_storeu_ps(b_im + i, _mm_add_ps(_mm_mul_ps(m_d_re, m_w_im),
+                                           _mm_mul_ps(m_d_im, m_w_re)));
+#elif defined(ARCH_CPU_ARM_FAMILY)
+        const float32x4_t m_a_re = vld1q_f32(a_re + i);
+        const float32x4_t m_a_im = vld1q_f32(a_im + i);
+        const float32x4_t m_b_re = vld1q_f32(b_re + i);
+        const float32x4_t m_b_im = vld1q_f32(b_im + i);
+        const float32x4_t m_w_re = vld1q_f32(w_re + i);
+        const float32x4_t m_w_im = vld1q_f32(w_im + i);
+        const float32x4_t m_d_re = vsubq_f32(m_a_re, m_b_re);
+        const float32x4_t m_d_im = vsubq_f32(m_a_im, m_b_im);
+        vst1q_f32(a_re + i, vaddq_f32(m_a_re, m_b_re));
+        vst1q_f32(a_im + i, vaddq_f32(m_a_im, m_b_im));
+        vst1q_f32(b_re + i,
+                  vmlsq_f32(vmulq_f32(m_d_re, m_w_re), m_d_im, m_w_im));
+        vst1q_f32(b_im + i,
+                  vmlaq_f32(vmulq_f32(m_d_re, m_w_im), m_d_im, m_w_re));
+#endif
+      }
+#endif  // defined(USE_SIMD)
+      for (; i < half_length; ++i) {
+        const float d_re = a_re[i] - b_re[i];
+        const float d_im = a_im[i] - b_im[i];
+        a_re[i] += b_re[i];
+        a_im[i] += b_im[i];
+        b_re[i] = d_re * w_re[i] - d_im * w_im[i];
+        b_im[i] = d_re * w_im[i] + d_im * w_re[i];
+      }
+    }
+  }
+}
+
+static void InverseFFT(std::vector<float>* real, std::vector<float>* imag) {
+  const int size = static_cast<int>(real->size());
+  DCHECK_EQ(size & (size - 1), 0);
+  DCHECK_EQ(real->size(), imag->size());
+  DCHECK_LE(size, kMaxFFTSize);
+  const FFTTables& tables = GetFFTTables();
+  float* re = real->data();
+  float* im = imag->data();
+
+  // Decimation in time with the conjugate twiddle factors: t = b * conj(w),
+  // a' = a + t, b' = a - t.
+  for (int half_length = 1; half_length < size; half_length <<= 1) {
+    const float* w_re = &tables.cos_table[half_length - 1];
+    const float* w_im = &tables.sin_table[half_length - 1];
+    for (int start = 0; start < size; start += 2 * half_length) {
+      float* a_re = re + start;
+      float* a_im = im + start;
+      float* b_re = a_re + half_length;
+      float* b_im = a_im + half_length;
+      int i = 0;
+#if defined(USE_SIMD)
+      for (; i + 4 <= half_length; i += 4) {
+#if defined(ARCH_CPU_X86_FAMILY)
+        const __m128 m_a_re = _mm_loadu_ps(a_re + i);
+        const __m128 m_a_im = _mm_loadu_ps(a_im + i);
+        const __m128 m_b_re = _mm_loadu_ps(b_re + i);
+        const __m128 m_b_im = _mm_loadu_ps(b_im + i);
+        const __m128 m_w_re = _mm_loadu_ps(w_re + i);
+        const __m128 m_w_im = _mm_loadu_ps(w_im + i);
+        const __m128 m_t_re = _mm_add_ps(_mm_mul_ps(m_b_re, m_w_re),
+                                         _mm_mul_ps(m_b_im, m_w_im));
+        const __m128 m_t_im = _mm_sub_ps(_mm_mul_ps(m_b_im, m_w_re),
+                                         _mm_mul_ps(m_b_re, m_w_im));
+        _mm_storeu_ps(a_re + i, _mm_add_ps(m_a_re, m_t_re));
+        _mm_storeu_ps(a_im + i, _mm_add_ps(m_a_im, m_t_im));
+        _mm_storeu_ps(b_re + i, _mm_sub_ps(m_a_re, m_t_re));
+        _mm_storeu_ps(b_im + i, _mm_sub_ps(m_a_im, m_t_im));
+#elif defined(ARCH_CPU_ARM_FAMILY)
+        const float32x4_t m_a_re = vld1q_f32(a_re + i);
+        const float32x4_t m_a_im = vld1q_f32(a_im + i);
+        const float32x4_t m_b_re = vld1q_f32(b_re + i);
+        const float32x4_t m_b_im = vld1q_f32(b_im + i);
+        const float32x4_t m_w_re = vld1q_f32(w_re + i);
+        const float32x4_t m_w_im = vld1q_f32(w_im + i);
+        const float32x4_t m_t_re =
+            vmlaq_f32(vmulq_f32(m_b_re, m_w_re), m_b_im, m_w_im);
+        const float32x4_t m_t_im =
+            vmlsq_f32(vmulq_f32(m_b_im, m_w_re), m_b_re, m_w_im);
+        vst1q_f32(a_re + i, vaddq_f32(m_a_re, m_t_re));
+        vst1q_f32(a_im + i, vaddq_f32(m_a_im, m_t_im));
+        vst1q_f32(b_re + i, vsubq_f32(m_a_re, m_t_re));
+        vst1q_f32(b_im + i, vsubq_f32(m_a_im, m_t_im));
+#endif
+      }
+#endif  // defined(USE_SIMD)
+      for (; i < half_length; ++i) {
+        const float t_re = b_re[i] * w_re[i] + b_im[i] * w_im[i];
+        const float t_im = b_im[i] * w_re[i] - b_re[i] * w_im[i];
+        b_re[i] = a_re[i] - t_re;
+        b_im[i] = a_im[i] - t_im;
+        a_re[i] += t_re;
+        a_im[i] += t_im;
+      }
+    }
+  }
+}
+
+void MultiChannelCrossCorrelation(const AudioBus* target_block,
+                                  const AudioBus* search_block,
+                                  float* correlation) {
+  DCHECK_EQ(target_block->channels(), search_block->channels());
+  const int channels = search_block->channels();
+  const int target_size = target_block->frames();
+  const int search_size = search_block->frames();
+  const int num_candidate_blocks = search_size - (target_size - 1);
+  DCHECK_GT(num_candidate_blocks, 0);
+
+  // The correlation is circular, but with |target_block| zero padded to at
+  // least |search_size| frames none of the candidate lags wrap around.
+  int fft_size = 1;
+  while (fft_size < search_size)
+    fft_size <<= 1;
+  DCHECK_LE(fft_size, kMaxFFTSize);
+
+  std::vector<float> real(fft_size);
+  std::vector<float> imag(fft_size);
+  for (int k = 0; k < channels; ++k) {
+    // Transform both real signals at once as search + i * target.
+    std::copy(search_block->channel(k), search_block->channel(k) + search_size,
+              real.begin());
+    std::fill(real.begin() + search_size, real.end(), 0.0f);
+    std::copy(target_block->channel(k), target_block->channel(k) + target_size,
+              imag.begin());
+    std::fill(imag.begin() + target_size, imag.end(), 0.0f);
+    ForwardFFT(&real, &imag);
+
+    // Separate the two spectra using their conjugate symmetry, then form
+    // conj(Target) * Search, whose inverse transform is the correlation.
+    // Bins m and fft_size - m are processed together since each needs the
+    // other's original value. In bit-reversed order, positions 0 and 1 hold
+    // bins 0 and fft_size / 2, which are their own mirrors, and the mirrors of
+    // the bins in positions [block, 2 * block) are in the same range, in
+    // reverse order.
+    for (int block = 0; block < fft_size; block = std::max(1, block * 2)) {
+      const int end = std::max(1, block * 2);
+      for (int pos = block, mirror = end - 1; pos <= mirror; ++pos, --mirror) {
+        const float z_re = real[pos];
+        const float z_im = imag[pos];
+        const float mirror_re = real[mirror];
+        const float mirror_im = imag[mirror];
+
+        // S[m] = (Z[m] + conj(Z[-m])) / 2 and T[m] = (Z[m] - conj(Z[-m])) /
+        // 2i. The product at -m is the conjugate of the one at m.
+        const float s_re = 0.5f * (z_re + mirror_re);
+        const float s_im = 0.5f * (z_im - mirror_im);
+        const float t_re = 0.5f * (z_im + mirror_im);
+        const float t_im = 0.5f * (z_re - mirror_re);
+        const float p_re = t_re * s_re - t_im * s_im;
+        const float p_im = t_re * s_im + t_im * s_re;
+        real[pos] = p_re;
+        imag[pos] = p_im;
+        real[mirror] = p_re;
+        imag[mirror] = -p_im;
+      }
+    }
+    InverseFFT(&real, &imag);
+
+    const float scale = 1.0f / fft_size;
+    for (int n = 0; n < num_candidate_blocks; ++n)
+      correlation[k + n * channels] = real[n] * scale;
+  }
+}
+
+int CorrelationSearch(Interval exclude_interval,
+                      int channels,
+                      int num_candidate_blocks,
+                      const float* correlation,
+                      const float* energy_target_block,
+                      const float* energy_candidate_blocks) {
+  float best_similarity = std::numeric_limits<float>::min();
+  int optimal_index = 0;
+
+  for (int n = 0; n < num_candidate_blocks; ++n) {
+    if (InInterval(n, exclude_interval))
+      continue;
+
+    float similarity = MultiChannelSimilarityMeasure(
+        &correlation[n * channels], energy_target_block,
+        &energy_candidate_blocks[n * channels], channels);
+
+    if (similarity > best_similarity) {
+      best_similarity = similarity;
+      optimal_index = n;
+    }
+  }
+
+  return optimal_index;
+}
+
 int OptimalIndex(const AudioBus* search_block,
                  const AudioBus* target_block,
                  Interval exclude_interval) {
@@ -294,6 +677,29 @@ int OptimalIndex(const AudioBus* search_block,
   MultiChannelDotProduct(target_block, 0, target_block, 0,
                          target_size, energy_target_block.get());
 
+  // The decimated search costs about a dot product of the target per
+  // decimated candidate, while the FFT costs O(n log n) in the search block
+  // size only, so the FFT wins for large blocks and search regions.
+  int fft_size = 1;
+  int fft_stages = 0;
+  for (; fft_size < search_block->frames(); fft_size <<= 1)
+    ++fft_stages;
+  const int64_t decimated_search_cost =
+      static_cast<int64_t>(num_candidate_blocks / kSearchDecimation +
+                           2 * kSearchDecimation + 1) *
+      target_size;
+  const int64_t fft_search_cost =
+      kFFTSearchCostFactor * static_cast<int64_t>(fft_size) * fft_stages;
+  if (fft_size <= kMaxFFTSize && fft_search_cost < decimated_search_cost) {
+    std::unique_ptr<float[]> correlation(
+        new float[channels * num_candidate_blocks]);
+    MultiChannelCrossCorrelation(target_block, search_block,
+                                 correlation.get());
+    return CorrelationSearch(exclude_interval, channels, num_candidate_blocks,
+                             correlation.get(), energy_target_block.get(),
+                             energy_candidate_blocks.get());
+  }
+
   int optimal_index = DecimatedSearch(kSearchDecimation,
                                       exclude_interval, target_block,
                                       search_block, energy_target_block.get(),
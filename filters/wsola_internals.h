@@ -69,9 +69,34 @@ MEDIA_EXPORT int FullSearch(int low_limit,
                             const float* energy_target_block,
                             const float* energy_candidate_blocks);
 
+// Cross-correlation of |target_block| with every candidate block of
+// |search_block|, i.e. MultiChannelDotProduct() of |target_block| against each
+// of the |search_block->frames()| - (|target_block->frames()| - 1) candidates,
+// computed with an FFT. Like the energies of MultiChannelMovingBlockEnergies(),
+// channels are interleaved in |correlation|. |search_block| may have at most
+// 32768 frames.
+MEDIA_EXPORT void MultiChannelCrossCorrelation(const AudioBus* target_block,
+                                               const AudioBus* search_block,
+                                               float* correlation);
+
+// Search all |num_candidate_blocks| candidates for the one most similar to the
+// target block, given their |correlation| with the target as computed by
+// MultiChannelCrossCorrelation(). Unlike the decimated search, this never
+// misses the best match between decimated samples. The FFT cost grows with the
+// search region only, not with the block length, so OptimalIndex() uses this
+// for large blocks and search regions; see wsola_internals_perftest.cc.
+MEDIA_EXPORT int CorrelationSearch(Interval exclude_interval,
+                                   int channels,
+                                   int num_candidate_blocks,
+                                   const float* correlation,
+                                   const float* energy_target_block,
+                                   const float* energy_candidate_blocks);
+
 // Find the index of the block, within |search_block|, that is most similar
 // to |target_block|. Obviously, the returned index is w.r.t. |search_block|.
-// |exclude_interval| is an interval that is excluded from the search.
+// |exclude_interval| is an interval that is excluded from the search. Uses
+// whichever of the decimated and the FFT-based search is cheaper for the sizes
+// of the blocks.
 MEDIA_EXPORT int OptimalIndex(const AudioBus* search_block,
                               const AudioBus* target_block,
                               Interval exclude_interval);
@@ -0,0 +1,120 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "media/base/audio_bus.h"
+#include "media/filters/wsola_internals.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 200;
+
+// Block sizes used by AudioRendererAlgorithm; see audio_renderer_algorithm.cc.
+static const int kOlaWindowSizeMs = 20;
+static const int kWsolaSearchIntervalMs = 30;
+
+class WsolaInternalsPerfTest : public testing::TestWithParam<int> {
+ public:
+  WsolaInternalsPerfTest()
+      : sample_rate_(GetParam()),
+        target_frames_(sample_rate_ * kOlaWindowSizeMs / 1000),
+        num_candidate_blocks_(sample_rate_ * kWsolaSearchIntervalMs / 1000),
+        target_(AudioBus::Create(kChannels, target_frames_)),
+        search_(AudioBus::Create(kChannels,
+                                 num_candidate_blocks_ + target_frames_ - 1)),
+        energy_target_(new float[kChannels]),
+        energy_candidates_(new float[kChannels * num_candidate_blocks_]),
+        correlation_(new float[kChannels * num_candidate_blocks_]) {
+    for (int k = 0; k < kChannels; ++k) {
+      for (int n = 0; n < search_->frames(); ++n)
+        search_->channel(k)[n] = std::sin(0.01f * n + k);
+    }
+    search_->CopyPartialFramesTo(num_candidate_blocks_ / 3, target_frames_, 0,
+                                 target_.get());
+    internal::MultiChannelDotProduct(target_.get(), 0, target_.get(), 0,
+                                     target_frames_, energy_target_.get());
+    internal::MultiChannelMovingBlockEnergies(search_.get(), target_frames_,
+                                              energy_candidates_.get());
+  }
+
+  // Runs |fn| kBenchmarkIterations times and reports the time per run.
+  template <typename Fn>
+  void RunBenchmark(const std::string& name, Fn fn) {
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i)
+      fn();
+    double total_time_milliseconds =
+        (base::TimeTicks::Now() - start).InMillisecondsF();
+    perf_test::PrintResult(name, "", base::IntToString(sample_rate_) + "hz",
+                           total_time_milliseconds / kBenchmarkIterations,
+                           "ms", true);
+  }
+
+ protected:
+  static const int kChannels = 2;
+
+  const int sample_rate_;
+  const int target_frames_;
+  const int num_candidate_blocks_;
+  std::unique_ptr<AudioBus> target_;
+  std::unique_ptr<AudioBus> search_;
+  std::unique_ptr<float[]> energy_target_;
+  std::unique_ptr<float[]> energy_candidates_;
+  std::unique_ptr<float[]> correlation_;
+};
+
+TEST_P(WsolaInternalsPerfTest, MovingBlockEnergies) {
+  RunBenchmark("wsola_moving_block_energies", [this]() {
+    internal::MultiChannelMovingBlockEnergies(search_.get(), target_frames_,
+                                              energy_candidates_.get());
+  });
+}
+
+// The decimated search followed by a local full search, as run by
+// OptimalIndex() for short blocks.
+TEST_P(WsolaInternalsPerfTest, DecimatedSearch) {
+  const internal::Interval kNoExclusion(-100, -10);
+  RunBenchmark("wsola_decimated_search", [this, kNoExclusion]() {
+    int index = internal::DecimatedSearch(
+        5, kNoExclusion, target_.get(), search_.get(), energy_target_.get(),
+        energy_candidates_.get());
+    internal::FullSearch(std::max(0, index - 5),
+                         std::min(num_candidate_blocks_ - 1, index + 5),
+                         kNoExclusion, target_.get(), search_.get(),
+                         energy_target_.get(), energy_candidates_.get());
+  });
+}
+
+// The exhaustive FFT-based search run by OptimalIndex() for long blocks.
+TEST_P(WsolaInternalsPerfTest, CorrelationSearch) {
+  const internal::Interval kNoExclusion(-100, -10);
+  RunBenchmark("wsola_correlation_search", [this, kNoExclusion]() {
+    internal::MultiChannelCrossCorrelation(target_.get(), search_.get(),
+                                           correlation_.get());
+    internal::CorrelationSearch(kNoExclusion, kChannels,
+                                num_candidate_blocks_, correlation_.get(),
+                                energy_target_.get(), energy_candidates_.get());
+  });
+}
+
+TEST_P(WsolaInternalsPerfTest, OptimalIndex) {
+  const internal::Interval kNoExclusion(-100, -10);
+  RunBenchmark("wsola_optimal_index", [this, kNoExclusion]() {
+    internal::OptimalIndex(search_.get(), target_.get(), kNoExclusion);
+  });
+}
+
+INSTANTIATE_TEST_CASE_P(,
+                        WsolaInternalsPerfTest,
+                        testing::Values(44100, 48000, 96000, 192000, 384000));
+
+}  // namespace media
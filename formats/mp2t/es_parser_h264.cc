@@ -183,7 +183,9 @@ EsParserH264::EsParserH264(const NewVideoConfigCB& new_video_config_cb,
     : es_adapter_(new_video_config_cb, emit_buffer_cb),
       h264_parser_(new H264Parser()),
       current_access_unit_pos_(0),
-      next_access_unit_pos_(0)
+      next_access_unit_pos_(0),
+      config_pps_id_(-1),
+      parameter_sets_changed_(true)
 #if BUILDFLAG(ENABLE_HLS_SAMPLE_AES)
       ,
       use_hls_sample_aes_(false),
@@ -201,6 +203,8 @@ EsParserH264::EsParserH264(const NewVideoConfigCB& new_video_config_cb,
       h264_parser_(new H264Parser()),
       current_access_unit_pos_(0),
       next_access_unit_pos_(0),
+      config_pps_id_(-1),
+      parameter_sets_changed_(true),
       use_hls_sample_aes_(use_hls_sample_aes),
       get_decrypt_config_cb_(get_decrypt_config_cb) {
   DCHECK_EQ(!!get_decrypt_config_cb_, use_hls_sample_aes_);
@@ -229,6 +233,8 @@ void EsParserH264::ResetInternal() {
   h264_parser_.reset(new H264Parser());
   current_access_unit_pos_ = 0;
   next_access_unit_pos_ = 0;
+  config_pps_id_ = -1;
+  parameter_sets_changed_ = true;
   last_video_decoder_config_ = VideoDecoderConfig();
   es_adapter_.Reset();
 }
@@ -330,6 +336,8 @@ bool EsParserH264::ParseFromEsQueue() {
         int sps_id;
         if (h264_parser_->ParseSPS(&sps_id) != H264Parser::kOk)
           return false;
+        if (h264_parser_->last_parameter_set_changed())
+          parameter_sets_changed_ = true;
         break;
       }
       case H264NALU::kPPS: {
@@ -340,6 +348,8 @@ bool EsParserH264::ParseFromEsQueue() {
           // since it is possible to have a PPS before SPS in the stream.
           if (last_video_decoder_config_.IsValidConfig())
             return false;
+        } else if (h264_parser_->last_parameter_set_changed()) {
+          parameter_sets_changed_ = true;
         }
         break;
       }
@@ -415,7 +425,7 @@ bool EsParserH264::EmitFrame(int64_t access_unit_pos,
     // to process this kind of frame accordingly.
     if (last_video_decoder_config_.IsValidConfig())
       return false;
-  } else {
+  } else if (pps_id != config_pps_id_ || parameter_sets_changed_) {
     const H264SPS* sps = h264_parser_->GetSPS(pps->seq_parameter_set_id);
     if (!sps)
       return false;
@@ -429,6 +439,8 @@ bool EsParserH264::EmitFrame(int64_t access_unit_pos,
     }
 #endif
     RCHECK(UpdateVideoDecoderConfig(sps, scheme));
+    config_pps_id_ = pps_id;
+    parameter_sets_changed_ = false;
   }
 
   // Emit a frame.
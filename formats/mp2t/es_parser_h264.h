@@ -88,6 +88,12 @@ class MEDIA_EXPORT EsParserH264 : public EsParser {
   std::unique_ptr<H264Parser> h264_parser_;
   int64_t current_access_unit_pos_;
   int64_t next_access_unit_pos_;
+
+  // Id of the PPS |last_video_decoder_config_| was last checked against, and
+  // whether any SPS or PPS changed since. The config is only rebuilt when the
+  // parameter sets change, rather than on every access unit.
+  int config_pps_id_;
+  bool parameter_sets_changed_;
 #if BUILDFLAG(ENABLE_HLS_SAMPLE_AES)
   bool use_hls_sample_aes_;
   // Callback to obtain the current decrypt_config.
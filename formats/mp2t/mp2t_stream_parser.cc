@@ -289,9 +289,12 @@ bool Mp2tStreamParser::Parse(const uint8_t* buf, int size) {
   ts_byte_queue_.Push(buf, size);
 
   while (true) {
+    // Enough for TsPacket::Sync() to check four packets in a row. Only TS
+    // packets spanning two appends need to be copied.
     const uint8_t* ts_buffer;
     int ts_buffer_size;
-    ts_byte_queue_.Peek(&ts_buffer, &ts_buffer_size);
+    ts_byte_queue_.PeekAtLeast(4 * TsPacket::kPacketSize, &ts_buffer,
+                               &ts_buffer_size);
     if (ts_buffer_size < TsPacket::kPacketSize)
       break;
 
@@ -534,10 +534,28 @@ bool WebMClusterParser::OnBlock(bool is_simple_block,
     // TODO(wolenetz/acolwell): Validate and use a common cross-parser TrackId
     // type with remapped bytestream track numbers and allow multiple tracks as
     // applicable. See https://crbug.com/341581.
-    buffer = StreamParserBuffer::CopyFrom(
-        data + data_offset, size - data_offset,
-        additional, additional_size,
-        is_keyframe, buffer_type, track_num);
+    //
+    // A slice keeps all of |segment_buffer_| alive, and its stream counts the
+    // whole segment towards its memory limit. Since the segment holds
+    // interleaved audio and video, only slice video frames, which make up
+    // most of it, so that the audio stream isn't charged for data it doesn't
+    // use. Audio frames are small enough that copying them costs little, and
+    // audio decoders would copy slices again to pad them. Block group data
+    // has been copied into |block_data_| already.
+    const uint8_t* frame_data = data + data_offset;
+    const int frame_size = size - data_offset;
+    if (segment_buffer_ && buffer_type == DemuxerStream::VIDEO &&
+        segment_buffer_->Contains(frame_data, frame_size)) {
+      buffer = StreamParserBuffer::FromSegment(segment_buffer_, frame_data,
+                                               frame_size, is_keyframe,
+                                               buffer_type, track_num);
+      if (additional)
+        buffer->CopySideDataFrom(additional, additional_size);
+    } else {
+      buffer = StreamParserBuffer::CopyFrom(frame_data, frame_size, additional,
+                                            additional_size, is_keyframe,
+                                            buffer_type, track_num);
+    }
 
     if (decrypt_config)
       buffer->set_decrypt_config(std::move(decrypt_config));
@@ -11,12 +11,14 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 
 #include "base/containers/circular_deque.h"
 #include "base/macros.h"
 #include "media/base/audio_decoder_config.h"
 #include "media/base/media_export.h"
 #include "media/base/media_log.h"
+#include "media/base/segment_buffer.h"
 #include "media/base/stream_parser.h"
 #include "media/base/stream_parser_buffer.h"
 #include "media/formats/webm/webm_parser.h"
@@ -171,6 +173,12 @@ class MEDIA_EXPORT WebMClusterParser : public WebMParserClient {
   // Returns the number of bytes parsed on success.
   int Parse(const uint8_t* buf, int size);
 
+  // Sets the buffer holding the data passed to subsequent Parse() calls, so
+  // that frames can refer to it instead of being copied. May be null.
+  void set_segment_buffer(scoped_refptr<SegmentBuffer> segment_buffer) {
+    segment_buffer_ = std::move(segment_buffer);
+  }
+
   base::TimeDelta cluster_start_time() const { return cluster_start_time_; }
 
   // Get the current ready buffers resulting from Parse().
@@ -279,6 +287,9 @@ class MEDIA_EXPORT WebMClusterParser : public WebMParserClient {
 
   WebMListParser parser_;
 
+  // See set_segment_buffer().
+  scoped_refptr<SegmentBuffer> segment_buffer_;
+
   int64_t last_block_timecode_ = -1;
   std::unique_ptr<uint8_t[]> block_data_;
   int block_data_size_ = -1;
@@ -488,6 +488,32 @@ TEST_F(WebMClusterParserTest, ParseClusterWithSingleCall) {
   ASSERT_TRUE(VerifyBuffers(parser_, kDefaultBlockInfo, block_count));
 }
 
+TEST_F(WebMClusterParserTest, VideoBuffersReferToSegmentBuffer) {
+  int block_count = arraysize(kDefaultBlockInfo);
+  std::unique_ptr<Cluster> cluster(
+      CreateCluster(0, kDefaultBlockInfo, block_count));
+  auto segment = base::MakeRefCounted<SegmentBuffer>(cluster->size());
+  segment->Write(0, cluster->data(), cluster->size());
+  parser_->set_segment_buffer(segment);
+
+  int result = parser_->Parse(segment->data(), segment->size());
+  EXPECT_EQ(cluster->size(), result);
+  ASSERT_TRUE(VerifyBuffers(parser_, kDefaultBlockInfo, block_count));
+
+  // Video frames are slices of |segment|, while audio frames are copies so
+  // that the audio stream doesn't keep the video data alive.
+  StreamParser::BufferQueueMap buffers;
+  parser_->GetBuffers(&buffers);
+  ASSERT_FALSE(buffers[kVideoTrackNum].empty());
+  for (const auto& buffer : buffers[kVideoTrackNum]) {
+    EXPECT_TRUE(segment->Contains(buffer->data(), buffer->data_size()));
+  }
+  ASSERT_FALSE(buffers[kAudioTrackNum].empty());
+  for (const auto& buffer : buffers[kAudioTrackNum]) {
+    EXPECT_FALSE(segment->Contains(buffer->data(), buffer->data_size()));
+  }
+}
+
 TEST_F(WebMClusterParserTest, ParseClusterWithMultipleCalls) {
   int block_count = arraysize(kDefaultBlockInfo);
   std::unique_ptr<Cluster> cluster(
@@ -80,44 +80,54 @@ bool WebMStreamParser::Parse(const uint8_t* buf, int size) {
 
   byte_queue_.Push(buf, size);
 
-  int result = 0;
-  int bytes_parsed = 0;
-  const uint8_t* cur = NULL;
-  int cur_size = 0;
-
-  byte_queue_.Peek(&cur, &cur_size);
-  while (cur_size > 0) {
-    State oldState = state_;
-    switch (state_) {
-      case kParsingHeaders:
-        result = ParseInfoAndTracks(cur, cur_size);
-        break;
-
-      case kParsingClusters:
-        result = ParseCluster(cur, cur_size);
-        break;
+  // Parse the queue a contiguous window at a time, widening the window only
+  // when an element doesn't fit, so that usually just the elements spanning
+  // two appends are copied.
+  int min_window_size = 0;
+  for (;;) {
+    int result = 0;
+    int bytes_parsed = 0;
+    const uint8_t* cur = NULL;
+    int cur_size = 0;
+
+    byte_queue_.PeekAtLeast(min_window_size, &cur, &cur_size);
+    while (cur_size > 0) {
+      State oldState = state_;
+      switch (state_) {
+        case kParsingHeaders:
+          result = ParseInfoAndTracks(cur, cur_size);
+          break;
+
+        case kParsingClusters:
+          result = ParseCluster(cur, cur_size);
+          break;
+
+        case kWaitingForInit:
+        case kError:
+          return false;
+      }
 
-      case kWaitingForInit:
-      case kError:
+      if (result < 0) {
+        ChangeState(kError);
         return false;
-    }
+      }
+
+      if (state_ == oldState && result == 0)
+        break;
 
-    if (result < 0) {
-      ChangeState(kError);
-      return false;
+      DCHECK_GE(result, 0);
+      cur += result;
+      cur_size -= result;
+      bytes_parsed += result;
     }
 
-    if (state_ == oldState && result == 0)
-      break;
+    byte_queue_.Pop(bytes_parsed);
 
-    DCHECK_GE(result, 0);
-    cur += result;
-    cur_size -= result;
-    bytes_parsed += result;
+    // Wait for more data if the window held all of the queue.
+    if (cur_size == byte_queue_.size())
+      return true;
+    min_window_size = 2 * cur_size;
   }
-
-  byte_queue_.Pop(bytes_parsed);
-  return true;
 }
 
 void WebMStreamParser::ChangeState(State new_state) {
@@ -263,6 +273,7 @@ int WebMStreamParser::ParseCluster(const uint8_t* data, int size) {
   if (!cluster_parser_)
     return -1;
 
+  cluster_parser_->set_segment_buffer(byte_queue_.segment());
   int bytes_parsed = cluster_parser_->Parse(data, size);
   if (bytes_parsed < 0)
     return bytes_parsed;
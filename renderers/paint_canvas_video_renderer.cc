@@ -5,10 +5,17 @@
 #include "media/renderers/paint_canvas_video_renderer.h"
 
 #include <GLES3/gl3.h>
+#include <algorithm>
+#include <atomic>
 #include <limits>
 
+#include "base/bind.h"
 #include "base/macros.h"
 #include "base/memory/ptr_util.h"
+#include "base/sys_info.h"
+#include "base/task_scheduler/post_task.h"
+#include "base/task_scheduler/task_scheduler.h"
+#include "base/trace_event/trace_event.h"
 #include "cc/paint/paint_canvas.h"
 #include "cc/paint/paint_flags.h"
 #include "cc/paint/paint_image.h"
@@ -27,6 +34,7 @@
 #include "third_party/skia/include/gpu/GrContext.h"
 #include "third_party/skia/include/gpu/gl/GrGLTypes.h"
 #include "ui/gfx/geometry/rect_f.h"
+#include "ui/gfx/geometry/size_conversions.h"
 #include "ui/gfx/skia_util.h"
 
 // Skia internal format depends on a platform. On Android it is ABGR, on others
@@ -65,6 +73,11 @@ namespace {
 // We delete the temporary resource if it is not used for 3 seconds.
 const int kTemporaryResourceDeletionDelay = 3;  // Seconds;
 
+// Limits on the downscaled images kept by PaintCanvasVideoRenderer.  Older
+// images are dropped once either limit is exceeded.
+constexpr size_t kMaxScaledImages = 8;
+constexpr size_t kMaxScaledImageBytes = 16 * 1024 * 1024;
+
 class SyncTokenClientImpl : public VideoFrame::SyncTokenClient {
  public:
   explicit SyncTokenClientImpl(gpu::gles2::GLES2Interface* gl) : gl_(gl) {}
@@ -306,17 +319,49 @@ void SynchronizeVideoFrameRead(scoped_refptr<VideoFrame> video_frame,
   }
 }
 
+// Scales the visible area of the I420 or YV12 |video_frame| to |dest_size|,
+// writing the Y, U and V planes to |dest_planes|.
+void ScaleVisiblePlanes(const VideoFrame* video_frame,
+                        const gfx::Size& dest_size,
+                        uint8_t* const dest_planes[3],
+                        const int dest_strides[3]) {
+  TRACE_EVENT0("media", "ScaleVisiblePlanes");
+  libyuv::I420Scale(video_frame->visible_data(VideoFrame::kYPlane),
+                    video_frame->stride(VideoFrame::kYPlane),
+                    video_frame->visible_data(VideoFrame::kUPlane),
+                    video_frame->stride(VideoFrame::kUPlane),
+                    video_frame->visible_data(VideoFrame::kVPlane),
+                    video_frame->stride(VideoFrame::kVPlane),
+                    video_frame->visible_rect().width(),
+                    video_frame->visible_rect().height(),
+                    dest_planes[VideoFrame::kYPlane],
+                    dest_strides[VideoFrame::kYPlane],
+                    dest_planes[VideoFrame::kUPlane],
+                    dest_strides[VideoFrame::kUPlane],
+                    dest_planes[VideoFrame::kVPlane],
+                    dest_strides[VideoFrame::kVPlane], dest_size.width(),
+                    dest_size.height(), libyuv::kFilterBox);
+}
+
 }  // anonymous namespace
 
 // Generates an RGB image from a VideoFrame. Convert YUV to RGB plain on GPU.
+// The image may be smaller than the frame's visible size, in which case the
+// frame is scaled down when the pixels are requested; only I420 and YV12 frames
+// can be scaled.
 class VideoImageGenerator : public cc::PaintImageGenerator {
  public:
   VideoImageGenerator(const scoped_refptr<VideoFrame>& frame)
+      : VideoImageGenerator(frame, frame->visible_rect().size()) {}
+  VideoImageGenerator(const scoped_refptr<VideoFrame>& frame,
+                      const gfx::Size& size)
       : cc::PaintImageGenerator(
-            SkImageInfo::MakeN32Premul(frame->visible_rect().width(),
-                                       frame->visible_rect().height())),
-        frame_(frame) {
+            SkImageInfo::MakeN32Premul(size.width(), size.height())),
+        frame_(frame),
+        size_(size) {
     DCHECK(!frame_->HasTextures());
+    DCHECK(!IsScaled() || frame_->format() == PIXEL_FORMAT_I420 ||
+           frame_->format() == PIXEL_FORMAT_YV12);
   }
   ~VideoImageGenerator() override = default;
 
@@ -331,8 +376,28 @@ class VideoImageGenerator : public cc::PaintImageGenerator {
     DCHECK_EQ(frame_index, 0u);
 
     // If skia couldn't do the YUV conversion on GPU, we will on CPU.
-    PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(frame_.get(), pixels,
-                                                           row_bytes);
+    if (!IsScaled()) {
+      PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+          frame_.get(), pixels, row_bytes);
+      return true;
+    }
+
+    // Scale before converting, so that only the pixels drawn are converted.
+    scoped_refptr<VideoFrame> scaled_frame =
+        VideoFrame::CreateFrame(PIXEL_FORMAT_I420, size_, gfx::Rect(size_),
+                                size_, frame_->timestamp());
+    if (!scaled_frame)
+      return false;
+    scaled_frame->set_color_space(frame_->ColorSpace());
+    uint8_t* const planes[3] = {scaled_frame->data(VideoFrame::kYPlane),
+                                scaled_frame->data(VideoFrame::kUPlane),
+                                scaled_frame->data(VideoFrame::kVPlane)};
+    const int strides[3] = {scaled_frame->stride(VideoFrame::kYPlane),
+                            scaled_frame->stride(VideoFrame::kUPlane),
+                            scaled_frame->stride(VideoFrame::kVPlane)};
+    ScaleVisiblePlanes(frame_.get(), size_, planes, strides);
+    PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+        scaled_frame.get(), pixels, row_bytes);
     return true;
   }
 
@@ -357,9 +422,7 @@ class VideoImageGenerator : public cc::PaintImageGenerator {
     for (int plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane;
          ++plane) {
       const gfx::Size size =
-          VideoFrame::PlaneSize(frame_->format(), plane,
-                                gfx::Size(frame_->visible_rect().width(),
-                                          frame_->visible_rect().height()));
+          VideoFrame::PlaneSize(frame_->format(), plane, size_);
       sizeInfo->fSizes[plane].set(size.width(), size.height());
       sizeInfo->fWidthBytes[plane] = size.width();
     }
@@ -379,13 +442,27 @@ class VideoImageGenerator : public cc::PaintImageGenerator {
     for (int plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane;
          ++plane) {
       const gfx::Size size =
-          VideoFrame::PlaneSize(frame_->format(), plane,
-                                gfx::Size(frame_->visible_rect().width(),
-                                          frame_->visible_rect().height()));
+          VideoFrame::PlaneSize(frame_->format(), plane, size_);
       if (size.width() != sizeInfo.fSizes[plane].width() ||
           size.height() != sizeInfo.fSizes[plane].height()) {
         return false;
       }
+    }
+
+    if (IsScaled()) {
+      // Scale straight into the supplied memory.
+      uint8_t* const out_planes[3] = {static_cast<uint8_t*>(planes[0]),
+                                      static_cast<uint8_t*>(planes[1]),
+                                      static_cast<uint8_t*>(planes[2])};
+      const int out_strides[3] = {static_cast<int>(sizeInfo.fWidthBytes[0]),
+                                  static_cast<int>(sizeInfo.fWidthBytes[1]),
+                                  static_cast<int>(sizeInfo.fWidthBytes[2])};
+      ScaleVisiblePlanes(frame_.get(), size_, out_planes, out_strides);
+      return true;
+    }
+
+    for (int plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane;
+         ++plane) {
 
       size_t offset;
       const int y_shift =
@@ -424,7 +501,11 @@ class VideoImageGenerator : public cc::PaintImageGenerator {
   }
 
  private:
+  bool IsScaled() const { return size_ != frame_->visible_rect().size(); }
+
   scoped_refptr<VideoFrame> frame_;
+  // Size of the generated image.
+  const gfx::Size size_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(VideoImageGenerator);
 };
@@ -435,6 +516,7 @@ PaintCanvasVideoRenderer::PaintCanvasVideoRenderer()
           base::TimeDelta::FromSeconds(kTemporaryResourceDeletionDelay),
           this,
           &PaintCanvasVideoRenderer::ResetCache),
+      scaled_images_(kMaxScaledImages),
       renderer_stable_id_(cc::PaintImage::GetNextId()) {}
 
 PaintCanvasVideoRenderer::~PaintCanvasVideoRenderer() {
@@ -470,9 +552,24 @@ void PaintCanvasVideoRenderer::Paint(
     return;
   }
 
+  gfx::SizeF rotated_dest_size = dest_rect.size();
+  if (video_rotation == VIDEO_ROTATION_90 ||
+      video_rotation == VIDEO_ROTATION_270) {
+    rotated_dest_size =
+        gfx::SizeF(rotated_dest_size.height(), rotated_dest_size.width());
+  }
+
+  // Software frames drawn smaller than their visible size get an image of the
+  // drawn size, which scales the frame before converting it.
   gpu::gles2::GLES2Interface* gl = context_3d.gl;
-  if (!UpdateLastImage(video_frame, context_3d))
-    return;
+  cc::PaintImage image;
+  if (!video_frame->HasTextures())
+    image = GetScaledImage(video_frame, gfx::ToRoundedSize(rotated_dest_size));
+  if (!image) {
+    if (!UpdateLastImage(video_frame, context_3d))
+      return;
+    image = last_image_;
+  }
 
   cc::PaintFlags video_flags;
   video_flags.setAlpha(flags.getAlpha());
@@ -481,7 +578,7 @@ void PaintCanvasVideoRenderer::Paint(
 
   const bool need_rotation = video_rotation != VIDEO_ROTATION_0;
   const bool need_scaling =
-      dest_rect.size() != gfx::SizeF(last_image_.width(), last_image_.height());
+      dest_rect.size() != gfx::SizeF(image.width(), image.height());
   const bool need_translation = !dest_rect.origin().IsOrigin();
   bool need_transform = need_rotation || need_scaling || need_translation;
   if (need_transform) {
@@ -505,17 +602,11 @@ void PaintCanvasVideoRenderer::Paint(
     }
     canvas->rotate(angle);
 
-    gfx::SizeF rotated_dest_size = dest_rect.size();
-    if (video_rotation == VIDEO_ROTATION_90 ||
-        video_rotation == VIDEO_ROTATION_270) {
-      rotated_dest_size =
-          gfx::SizeF(rotated_dest_size.height(), rotated_dest_size.width());
-    }
     canvas->scale(
-        SkFloatToScalar(rotated_dest_size.width() / last_image_.width()),
-        SkFloatToScalar(rotated_dest_size.height() / last_image_.height()));
-    canvas->translate(-SkFloatToScalar(last_image_.width() * 0.5f),
-                      -SkFloatToScalar(last_image_.height() * 0.5f));
+        SkFloatToScalar(rotated_dest_size.width() / image.width()),
+        SkFloatToScalar(rotated_dest_size.height() / image.height()));
+    canvas->translate(-SkFloatToScalar(image.width() * 0.5f),
+                      -SkFloatToScalar(image.height() * 0.5f));
   }
 
   // This is a workaround for crbug.com/524717. A texture backed image is not
@@ -524,14 +615,12 @@ void PaintCanvasVideoRenderer::Paint(
   // sw image into the SkPicture. The long term solution is for Skia to provide
   // a SkPicture filter that makes a picture safe for multiple CPU raster
   // threads. (skbug.com/4321).
-  cc::PaintImage image = last_image_;
   if (canvas->imageInfo().colorType() == kUnknown_SkColorType) {
     sk_sp<SkImage> non_texture_image =
-        last_image_.GetSkImage()->makeNonTextureImage();
-    image =
-        cc::PaintImageBuilder::WithProperties(last_image_)
-            .set_image(std::move(non_texture_image), last_image_.content_id())
-            .TakePaintImage();
+        image.GetSkImage()->makeNonTextureImage();
+    image = cc::PaintImageBuilder::WithProperties(image)
+                .set_image(std::move(non_texture_image), image.content_id())
+                .TakePaintImage();
   }
   canvas->drawImage(image, 0, 0, &video_flags);
 
@@ -741,131 +830,219 @@ void TextureSubImageUsingIntermediate(unsigned target,
   gl->DeleteTextures(1, &temp_texture);
 }
 
-}  // anonymous namespace
-
-// static
-void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
-    const VideoFrame* video_frame,
-    void* rgb_pixels,
-    size_t row_bytes) {
-  if (!video_frame->IsMappable()) {
-    NOTREACHED() << "Cannot extract pixels from non-CPU frame formats.";
-    return;
-  }
+// Converting more than this many bytes of RGB output is split into stripes
+// which are converted in parallel; smaller frames are converted serially.
+constexpr size_t kBytesPerConvertTarget = 1024 * 1024;
+
+// Returns the address of |row| of the visible area of |plane|.  |row| must be
+// even so that it lands on a chroma row for vertically subsampled planes.
+const uint8_t* VisibleRowData(const VideoFrame* video_frame,
+                              size_t plane,
+                              int row) {
+  return video_frame->visible_data(plane) +
+         video_frame->stride(plane) *
+             VideoFrame::Rows(plane, video_frame->format(), row);
+}
 
-  // TODO(hubbe): This should really default to the rec709 colorspace.
-  // https://crbug.com/828599
-  SkYUVColorSpace color_space = kRec601_SkYUVColorSpace;
-  video_frame->ColorSpace().ToSkYUVColorSpace(&color_space);
+// Converts |rows| rows of the visible area of |video_frame|, starting at
+// |first_row|, to |rgb_pixels|, which points at the RGB row for |first_row|.
+// Only handles the formats libyuv can convert directly.
+void ConvertVideoFrameRowsToRGBPixels(const VideoFrame* video_frame,
+                                      SkYUVColorSpace color_space,
+                                      int first_row,
+                                      int rows,
+                                      uint8_t* rgb_pixels,
+                                      size_t row_bytes) {
+  DCHECK_EQ(0, first_row % 2);
+  const int width = video_frame->visible_rect().width();
+  const uint8_t* y_plane =
+      VisibleRowData(video_frame, VideoFrame::kYPlane, first_row);
+  const int y_stride = video_frame->stride(VideoFrame::kYPlane);
 
   switch (video_frame->format()) {
     case PIXEL_FORMAT_YV12:
-    case PIXEL_FORMAT_I420:
+    case PIXEL_FORMAT_I420: {
+      const uint8_t* u_plane =
+          VisibleRowData(video_frame, VideoFrame::kUPlane, first_row);
+      const uint8_t* v_plane =
+          VisibleRowData(video_frame, VideoFrame::kVPlane, first_row);
+      const int u_stride = video_frame->stride(VideoFrame::kUPlane);
+      const int v_stride = video_frame->stride(VideoFrame::kVPlane);
       switch (color_space) {
         case kJPEG_SkYUVColorSpace:
-          LIBYUV_J420_TO_ARGB(video_frame->visible_data(VideoFrame::kYPlane),
-                              video_frame->stride(VideoFrame::kYPlane),
-                              video_frame->visible_data(VideoFrame::kUPlane),
-                              video_frame->stride(VideoFrame::kUPlane),
-                              video_frame->visible_data(VideoFrame::kVPlane),
-                              video_frame->stride(VideoFrame::kVPlane),
-                              static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                              video_frame->visible_rect().width(),
-                              video_frame->visible_rect().height());
+          LIBYUV_J420_TO_ARGB(y_plane, y_stride, u_plane, u_stride, v_plane,
+                              v_stride, rgb_pixels, row_bytes, width, rows);
           break;
         case kRec709_SkYUVColorSpace:
-          LIBYUV_H420_TO_ARGB(video_frame->visible_data(VideoFrame::kYPlane),
-                              video_frame->stride(VideoFrame::kYPlane),
-                              video_frame->visible_data(VideoFrame::kUPlane),
-                              video_frame->stride(VideoFrame::kUPlane),
-                              video_frame->visible_data(VideoFrame::kVPlane),
-                              video_frame->stride(VideoFrame::kVPlane),
-                              static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                              video_frame->visible_rect().width(),
-                              video_frame->visible_rect().height());
+          LIBYUV_H420_TO_ARGB(y_plane, y_stride, u_plane, u_stride, v_plane,
+                              v_stride, rgb_pixels, row_bytes, width, rows);
           break;
         case kRec601_SkYUVColorSpace:
-          LIBYUV_I420_TO_ARGB(video_frame->visible_data(VideoFrame::kYPlane),
-                              video_frame->stride(VideoFrame::kYPlane),
-                              video_frame->visible_data(VideoFrame::kUPlane),
-                              video_frame->stride(VideoFrame::kUPlane),
-                              video_frame->visible_data(VideoFrame::kVPlane),
-                              video_frame->stride(VideoFrame::kVPlane),
-                              static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                              video_frame->visible_rect().width(),
-                              video_frame->visible_rect().height());
+          LIBYUV_I420_TO_ARGB(y_plane, y_stride, u_plane, u_stride, v_plane,
+                              v_stride, rgb_pixels, row_bytes, width, rows);
           break;
       }
       break;
+    }
+
     case PIXEL_FORMAT_I422:
-      LIBYUV_I422_TO_ARGB(video_frame->visible_data(VideoFrame::kYPlane),
-                          video_frame->stride(VideoFrame::kYPlane),
-                          video_frame->visible_data(VideoFrame::kUPlane),
-                          video_frame->stride(VideoFrame::kUPlane),
-                          video_frame->visible_data(VideoFrame::kVPlane),
-                          video_frame->stride(VideoFrame::kVPlane),
-                          static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                          video_frame->visible_rect().width(),
-                          video_frame->visible_rect().height());
+      LIBYUV_I422_TO_ARGB(
+          y_plane, y_stride,
+          VisibleRowData(video_frame, VideoFrame::kUPlane, first_row),
+          video_frame->stride(VideoFrame::kUPlane),
+          VisibleRowData(video_frame, VideoFrame::kVPlane, first_row),
+          video_frame->stride(VideoFrame::kVPlane), rgb_pixels, row_bytes,
+          width, rows);
       break;
 
     case PIXEL_FORMAT_I420A:
       LIBYUV_I420ALPHA_TO_ARGB(
-          video_frame->visible_data(VideoFrame::kYPlane),
-          video_frame->stride(VideoFrame::kYPlane),
-          video_frame->visible_data(VideoFrame::kUPlane),
+          y_plane, y_stride,
+          VisibleRowData(video_frame, VideoFrame::kUPlane, first_row),
           video_frame->stride(VideoFrame::kUPlane),
-          video_frame->visible_data(VideoFrame::kVPlane),
+          VisibleRowData(video_frame, VideoFrame::kVPlane, first_row),
           video_frame->stride(VideoFrame::kVPlane),
-          video_frame->visible_data(VideoFrame::kAPlane),
-          video_frame->stride(VideoFrame::kAPlane),
-          static_cast<uint8_t*>(rgb_pixels), row_bytes,
-          video_frame->visible_rect().width(),
-          video_frame->visible_rect().height(),
+          VisibleRowData(video_frame, VideoFrame::kAPlane, first_row),
+          video_frame->stride(VideoFrame::kAPlane), rgb_pixels, row_bytes,
+          width, rows,
           1);  // 1 = enable RGB premultiplication by Alpha.
       break;
 
     case PIXEL_FORMAT_I444:
-      LIBYUV_I444_TO_ARGB(video_frame->visible_data(VideoFrame::kYPlane),
-                          video_frame->stride(VideoFrame::kYPlane),
-                          video_frame->visible_data(VideoFrame::kUPlane),
-                          video_frame->stride(VideoFrame::kUPlane),
-                          video_frame->visible_data(VideoFrame::kVPlane),
-                          video_frame->stride(VideoFrame::kVPlane),
-                          static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                          video_frame->visible_rect().width(),
-                          video_frame->visible_rect().height());
+      LIBYUV_I444_TO_ARGB(
+          y_plane, y_stride,
+          VisibleRowData(video_frame, VideoFrame::kUPlane, first_row),
+          video_frame->stride(VideoFrame::kUPlane),
+          VisibleRowData(video_frame, VideoFrame::kVPlane, first_row),
+          video_frame->stride(VideoFrame::kVPlane), rgb_pixels, row_bytes,
+          width, rows);
       break;
 
-    case PIXEL_FORMAT_YUV420P10:
+    case PIXEL_FORMAT_YUV420P10: {
+      const uint16_t* y_plane16 = reinterpret_cast<const uint16_t*>(y_plane);
+      const uint16_t* u_plane16 = reinterpret_cast<const uint16_t*>(
+          VisibleRowData(video_frame, VideoFrame::kUPlane, first_row));
+      const uint16_t* v_plane16 = reinterpret_cast<const uint16_t*>(
+          VisibleRowData(video_frame, VideoFrame::kVPlane, first_row));
+      const int u_stride = video_frame->stride(VideoFrame::kUPlane) / 2;
+      const int v_stride = video_frame->stride(VideoFrame::kVPlane) / 2;
       if (color_space == kRec709_SkYUVColorSpace) {
-        LIBYUV_H010_TO_ARGB(reinterpret_cast<const uint16_t*>(
-                                video_frame->visible_data(VideoFrame::kYPlane)),
-                            video_frame->stride(VideoFrame::kYPlane) / 2,
-                            reinterpret_cast<const uint16_t*>(
-                                video_frame->visible_data(VideoFrame::kUPlane)),
-                            video_frame->stride(VideoFrame::kUPlane) / 2,
-                            reinterpret_cast<const uint16_t*>(
-                                video_frame->visible_data(VideoFrame::kVPlane)),
-                            video_frame->stride(VideoFrame::kVPlane) / 2,
-                            static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                            video_frame->visible_rect().width(),
-                            video_frame->visible_rect().height());
+        LIBYUV_H010_TO_ARGB(y_plane16, y_stride / 2, u_plane16, u_stride,
+                            v_plane16, v_stride, rgb_pixels, row_bytes, width,
+                            rows);
       } else {
-        LIBYUV_I010_TO_ARGB(reinterpret_cast<const uint16_t*>(
-                                video_frame->visible_data(VideoFrame::kYPlane)),
-                            video_frame->stride(VideoFrame::kYPlane) / 2,
-                            reinterpret_cast<const uint16_t*>(
-                                video_frame->visible_data(VideoFrame::kUPlane)),
-                            video_frame->stride(VideoFrame::kUPlane) / 2,
-                            reinterpret_cast<const uint16_t*>(
-                                video_frame->visible_data(VideoFrame::kVPlane)),
-                            video_frame->stride(VideoFrame::kVPlane) / 2,
-                            static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                            video_frame->visible_rect().width(),
-                            video_frame->visible_rect().height());
+        LIBYUV_I010_TO_ARGB(y_plane16, y_stride / 2, u_plane16, u_stride,
+                            v_plane16, v_stride, rgb_pixels, row_bytes, width,
+                            rows);
       }
       break;
+    }
+
+    case PIXEL_FORMAT_NV12:
+      LIBYUV_NV12_TO_ARGB(
+          y_plane, y_stride,
+          VisibleRowData(video_frame, VideoFrame::kUVPlane, first_row),
+          video_frame->stride(VideoFrame::kUVPlane), rgb_pixels, row_bytes,
+          width, rows);
+      break;
+
+    default:
+      NOTREACHED();
+  }
+}
+
+// Shared by every thread working on the stripes of one frame.  Stripes are
+// claimed in order through |next_stripe_|, so the calling thread converts
+// whatever the workers have not picked up yet.  Whichever thread completes the
+// last stripe runs |done_cb_|; late worker tasks find no stripes left and only
+// touch this object, which they keep alive.
+class StripedConversion
+    : public base::RefCountedThreadSafe<StripedConversion> {
+ public:
+  StripedConversion(const VideoFrame* video_frame,
+                    SkYUVColorSpace color_space,
+                    uint8_t* rgb_pixels,
+                    size_t row_bytes,
+                    int rows_per_stripe,
+                    base::OnceClosure done_cb)
+      : video_frame_(video_frame),
+        color_space_(color_space),
+        rgb_pixels_(rgb_pixels),
+        row_bytes_(row_bytes),
+        rows_per_stripe_(rows_per_stripe),
+        stripes_((video_frame->visible_rect().height() + rows_per_stripe - 1) /
+                 rows_per_stripe),
+        done_cb_(std::move(done_cb)) {}
+
+  // Converts stripes until none are left to claim.
+  static void ConvertStripes(scoped_refptr<StripedConversion> conversion) {
+    while (conversion->ConvertNextStripe()) {
+    }
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<StripedConversion>;
+  ~StripedConversion() = default;
+
+  bool ConvertNextStripe() {
+    const int stripe = next_stripe_.fetch_add(1);
+    if (stripe >= stripes_)
+      return false;
+
+    TRACE_EVENT0("media", "StripedConversion::ConvertNextStripe");
+    const int first_row = stripe * rows_per_stripe_;
+    const int rows =
+        std::min(rows_per_stripe_,
+                 video_frame_->visible_rect().height() - first_row);
+    ConvertVideoFrameRowsToRGBPixels(video_frame_, color_space_, first_row,
+                                     rows, rgb_pixels_ + first_row * row_bytes_,
+                                     row_bytes_);
+    // Only the thread completing the last stripe gets here with the count at
+    // |stripes_|, so |done_cb_| is run exactly once.
+    if (completed_stripes_.fetch_add(1) + 1 == stripes_)
+      std::move(done_cb_).Run();
+    return true;
+  }
+
+  // Only dereferenced while converting a stripe, i.e. before |done_cb_| runs.
+  const VideoFrame* const video_frame_;
+  const SkYUVColorSpace color_space_;
+  uint8_t* const rgb_pixels_;
+  const size_t row_bytes_;
+  const int rows_per_stripe_;
+  const int stripes_;
+
+  std::atomic<int> next_stripe_{0};
+  std::atomic<int> completed_stripes_{0};
+  base::OnceClosure done_cb_;
+
+  DISALLOW_COPY_AND_ASSIGN(StripedConversion);
+};
+
+// Converts |video_frame| into |rgb_pixels|.  Without |done_cb| the conversion
+// happens on the calling thread before this returns.  With it, large frames are
+// split into stripes converted on the task scheduler's workers as well as the
+// calling thread, and |done_cb| runs on whichever thread finishes last.
+void ConvertVideoFrameToRGBPixelsInternal(const VideoFrame* video_frame,
+                                          void* rgb_pixels,
+                                          size_t row_bytes,
+                                          base::OnceClosure done_cb) {
+  if (!video_frame->IsMappable()) {
+    NOTREACHED() << "Cannot extract pixels from non-CPU frame formats.";
+    if (done_cb)
+      std::move(done_cb).Run();
+    return;
+  }
+
+  switch (video_frame->format()) {
+    case PIXEL_FORMAT_YV12:
+    case PIXEL_FORMAT_I420:
+    case PIXEL_FORMAT_I422:
+    case PIXEL_FORMAT_I420A:
+    case PIXEL_FORMAT_I444:
+    case PIXEL_FORMAT_YUV420P10:
+    case PIXEL_FORMAT_NV12:
+      break;
 
     case PIXEL_FORMAT_YUV420P9:
     case PIXEL_FORMAT_YUV422P9:
@@ -877,9 +1054,18 @@ void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
     case PIXEL_FORMAT_YUV444P12: {
       scoped_refptr<VideoFrame> temporary_frame =
           DownShiftHighbitVideoFrame(video_frame);
-      ConvertVideoFrameToRGBPixels(temporary_frame.get(), rgb_pixels,
-                                   row_bytes);
-      break;
+      VideoFrame* temporary_frame_ptr = temporary_frame.get();
+      // Keep |temporary_frame| alive until the stripes are done.
+      if (done_cb) {
+        done_cb = base::BindOnce(
+            [](scoped_refptr<VideoFrame>, base::OnceClosure done_cb) {
+              std::move(done_cb).Run();
+            },
+            std::move(temporary_frame), std::move(done_cb));
+      }
+      ConvertVideoFrameToRGBPixelsInternal(temporary_frame_ptr, rgb_pixels,
+                                           row_bytes, std::move(done_cb));
+      return;
     }
 
     case PIXEL_FORMAT_Y16:
@@ -887,17 +1073,9 @@ void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
       // and always use GL_RGBA.
       FlipAndConvertY16(video_frame, static_cast<uint8_t*>(rgb_pixels), GL_RGBA,
                         GL_UNSIGNED_BYTE, false /*flip_y*/, row_bytes);
-      break;
-
-    case PIXEL_FORMAT_NV12:
-      LIBYUV_NV12_TO_ARGB(video_frame->visible_data(VideoFrame::kYPlane),
-                          video_frame->stride(VideoFrame::kYPlane),
-                          video_frame->visible_data(VideoFrame::kUVPlane),
-                          video_frame->stride(VideoFrame::kUVPlane),
-                          static_cast<uint8_t*>(rgb_pixels), row_bytes,
-                          video_frame->visible_rect().width(),
-                          video_frame->visible_rect().height());
-      break;
+      if (done_cb)
+        std::move(done_cb).Run();
+      return;
 
     case PIXEL_FORMAT_NV21:
     case PIXEL_FORMAT_UYVY:
@@ -911,7 +1089,66 @@ void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
     case PIXEL_FORMAT_UNKNOWN:
       NOTREACHED() << "Only YUV formats and Y16 are supported, got: "
                    << media::VideoPixelFormatToString(video_frame->format());
+      if (done_cb)
+        std::move(done_cb).Run();
+      return;
+  }
+
+  // TODO(hubbe): This should really default to the rec709 colorspace.
+  // https://crbug.com/828599
+  SkYUVColorSpace color_space = kRec601_SkYUVColorSpace;
+  video_frame->ColorSpace().ToSkYUVColorSpace(&color_space);
+
+  // Split the frame into stripes of an even number of rows, so that every
+  // stripe starts on a chroma row.  Without a task scheduler (e.g. in some
+  // tests) or for small frames there is only one stripe.
+  const int height = video_frame->visible_rect().height();
+  const size_t rgb_row_bytes = video_frame->visible_rect().width() * 4;
+  const int rows_per_stripe =
+      std::max<size_t>((kBytesPerConvertTarget / rgb_row_bytes) & ~1, 2);
+  const int num_workers = std::min(
+      (height + rows_per_stripe - 1) / rows_per_stripe - 1,
+      base::SysInfo::NumberOfProcessors() - 1);
+  if (!done_cb || num_workers <= 0 || !base::TaskScheduler::GetInstance()) {
+    ConvertVideoFrameRowsToRGBPixels(video_frame, color_space, 0, height,
+                                     static_cast<uint8_t*>(rgb_pixels),
+                                     row_bytes);
+    if (done_cb)
+      std::move(done_cb).Run();
+    return;
   }
+
+  auto conversion = base::MakeRefCounted<StripedConversion>(
+      video_frame, color_space, static_cast<uint8_t*>(rgb_pixels), row_bytes,
+      rows_per_stripe, std::move(done_cb));
+  for (int i = 0; i < num_workers; ++i) {
+    base::PostTaskWithTraits(
+        FROM_HERE, {base::TaskPriority::USER_BLOCKING},
+        base::BindOnce(&StripedConversion::ConvertStripes, conversion));
+  }
+  StripedConversion::ConvertStripes(std::move(conversion));
+}
+
+}  // anonymous namespace
+
+// static
+void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+    const VideoFrame* video_frame,
+    void* rgb_pixels,
+    size_t row_bytes) {
+  ConvertVideoFrameToRGBPixelsInternal(video_frame, rgb_pixels, row_bytes,
+                                       base::OnceClosure());
+}
+
+// static
+void PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsAsync(
+    const VideoFrame* video_frame,
+    void* rgb_pixels,
+    size_t row_bytes,
+    base::OnceClosure done_cb) {
+  DCHECK(done_cb);
+  ConvertVideoFrameToRGBPixelsInternal(video_frame, rgb_pixels, row_bytes,
+                                       std::move(done_cb));
 }
 
 // static
@@ -1212,6 +1449,79 @@ void PaintCanvasVideoRenderer::ResetCache() {
   // Clear cached values.
   last_image_ = cc::PaintImage();
   last_id_.reset();
+  scaled_images_.Clear();
+  scaled_image_bytes_ = 0;
+}
+
+bool PaintCanvasVideoRenderer::ScaledImageKey::operator<(
+    const ScaledImageKey& other) const {
+  if (frame_id != other.frame_id)
+    return frame_id < other.frame_id;
+  if (size.width() != other.size.width())
+    return size.width() < other.size.width();
+  if (size.height() != other.size.height())
+    return size.height() < other.size.height();
+  return color_space < other.color_space;
+}
+
+cc::PaintImage PaintCanvasVideoRenderer::GetScaledImage(
+    const scoped_refptr<VideoFrame>& video_frame,
+    const gfx::Size& size) {
+  const gfx::Size visible_size = video_frame->visible_rect().size();
+  if ((video_frame->format() != PIXEL_FORMAT_I420 &&
+       video_frame->format() != PIXEL_FORMAT_YV12) ||
+      !video_frame->IsMappable() || size.IsEmpty() || size == visible_size ||
+      size.width() > visible_size.width() ||
+      size.height() > visible_size.height()) {
+    return cc::PaintImage();
+  }
+
+  const ScaledImageKey key = {video_frame->unique_id(), size,
+                              video_frame->ColorSpace()};
+  auto it = scaled_images_.Get(key);
+  if (it != scaled_images_.end()) {
+    last_image_deleting_timer_.Reset();
+    return it->second;
+  }
+
+  cc::PaintImage image =
+      cc::PaintImageBuilder::WithDefault()
+          .set_id(renderer_stable_id_)
+          .set_animation_type(cc::PaintImage::AnimationType::VIDEO)
+          .set_completion_state(cc::PaintImage::CompletionState::DONE)
+          .set_paint_image_generator(
+              sk_make_sp<VideoImageGenerator>(video_frame, size))
+          .TakePaintImage();
+
+  // Images of other frames won't be painted again once a new frame is, so drop
+  // them rather than letting playback fill the cache with single-use entries.
+  for (auto it = scaled_images_.begin(); it != scaled_images_.end();) {
+    if (it->first.frame_id == key.frame_id) {
+      ++it;
+      continue;
+    }
+    scaled_image_bytes_ -= it->first.size.GetArea() * 4;
+    it = scaled_images_.Erase(it);
+  }
+
+  // MRUCache evicts the oldest entry itself when full; keep the byte count in
+  // sync with it before putting the new image in.
+  const size_t bytes = size.GetArea() * 4;
+  if (scaled_images_.size() == scaled_images_.max_size()) {
+    auto oldest = scaled_images_.rbegin();
+    scaled_image_bytes_ -= oldest->first.size.GetArea() * 4;
+    scaled_images_.Erase(oldest);
+  }
+  while (!scaled_images_.empty() &&
+         scaled_image_bytes_ + bytes > kMaxScaledImageBytes) {
+    auto oldest = scaled_images_.rbegin();
+    scaled_image_bytes_ -= oldest->first.size.GetArea() * 4;
+    scaled_images_.Erase(oldest);
+  }
+  scaled_images_.Put(key, image);
+  scaled_image_bytes_ += bytes;
+  last_image_deleting_timer_.Reset();
+  return image;
 }
 
 bool PaintCanvasVideoRenderer::UpdateLastImage(
@@ -1219,7 +1529,10 @@ bool PaintCanvasVideoRenderer::UpdateLastImage(
     const Context3D& context_3d) {
   if (!last_image_ || video_frame->unique_id() != last_id_ ||
       !last_image_.GetSkImage()->getBackendTexture(true).isValid()) {
-    ResetCache();
+    // Only drop |last_image_|; |scaled_images_| may hold other sizes of this
+    // frame and prunes images of older frames by itself.
+    last_image_ = cc::PaintImage();
+    last_id_.reset();
 
     auto paint_image_builder =
         cc::PaintImageBuilder::WithDefault()
@@ -1277,4 +1590,12 @@ SkISize PaintCanvasVideoRenderer::LastImageDimensionsForTesting() {
   return last_image_dimensions_for_testing_;
 }
 
+size_t PaintCanvasVideoRenderer::ScaledImageCountForTesting() const {
+  return scaled_images_.size();
+}
+
+size_t PaintCanvasVideoRenderer::ScaledImageBytesForTesting() const {
+  return scaled_image_bytes_;
+}
+
 }  // namespace media
@@ -8,6 +8,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
 #include "base/macros.h"
 #include "base/memory/ref_counted.h"
 #include "base/optional.h"
@@ -66,11 +68,23 @@ class MEDIA_EXPORT PaintCanvasVideoRenderer {
 
   // Convert the contents of |video_frame| to raw RGB pixels. |rgb_pixels|
   // should point into a buffer large enough to hold as many 32 bit RGBA pixels
-  // as are in the visible_rect() area of the frame.
+  // as are in the visible_rect() area of the frame.  The conversion happens on
+  // the calling thread.
   static void ConvertVideoFrameToRGBPixels(const media::VideoFrame* video_frame,
                                            void* rgb_pixels,
                                            size_t row_bytes);
 
+  // Like ConvertVideoFrameToRGBPixels(), but large frames are split into
+  // stripes which are converted on the task scheduler's workers as well as the
+  // calling thread.  Never blocks: |done_cb| is run on whichever thread
+  // finishes the last stripe, possibly before this returns.  |video_frame| and
+  // |rgb_pixels| must stay valid until then.
+  static void ConvertVideoFrameToRGBPixelsAsync(
+      const media::VideoFrame* video_frame,
+      void* rgb_pixels,
+      size_t row_bytes,
+      base::OnceClosure done_cb);
+
   // Copy the visible rect size contents of texture of |video_frame| to
   // texture |texture|. |level|, |internal_format|, |type| specify target
   // texture |texture|. The format of |video_frame| must be
@@ -172,6 +186,8 @@ class MEDIA_EXPORT PaintCanvasVideoRenderer {
 
   // Used for unit test.
   SkISize LastImageDimensionsForTesting();
+  size_t ScaledImageCountForTesting() const;
+  size_t ScaledImageBytesForTesting() const;
 
  private:
   // Update the cache holding the most-recently-painted frame. Returns false
@@ -181,13 +197,38 @@ class MEDIA_EXPORT PaintCanvasVideoRenderer {
 
   void CorrectLastImageDimensions(const SkIRect& visible_rect);
 
+  // Returns a lazily generated image of the software |video_frame| scaled to
+  // |size|, using or filling |scaled_images_|.  The frame is scaled and then
+  // converted only when the image's pixels are requested.  Returns an empty
+  // image if |video_frame| can't be scaled this way, or if |size| isn't smaller
+  // than its visible size, in which case converting first is cheaper.
+  cc::PaintImage GetScaledImage(const scoped_refptr<VideoFrame>& video_frame,
+                                const gfx::Size& size);
+
   // Last image used to draw to the canvas.
   cc::PaintImage last_image_;
 
   // VideoFrame::unique_id() of the videoframe used to generate |last_image_|.
   base::Optional<int> last_id_;
 
-  // If |last_image_| is not used for a while, it's deleted to save memory.
+  // Identifies an entry of |scaled_images_|.  The color space is part of the
+  // key since it can be changed on a frame after it has been painted.
+  struct ScaledImageKey {
+    int frame_id;
+    gfx::Size size;
+    gfx::ColorSpace color_space;
+
+    bool operator<(const ScaledImageKey& other) const;
+  };
+
+  // Downscaled images of the most recently painted frame, e.g. of a paused
+  // video drawn to several thumbnails, and their total decoded size in bytes.
+  // Reusing an image lets decoded pixels cached for it be reused too.
+  base::MRUCache<ScaledImageKey, cc::PaintImage> scaled_images_;
+  size_t scaled_image_bytes_ = 0;
+
+  // If |last_image_| and |scaled_images_| are not used for a while, they are
+  // deleted to save memory.
   base::DelayTimer last_image_deleting_timer_;
   // Stable paint image id to provide to draw image calls.
   cc::PaintImage::Id renderer_stable_id_;
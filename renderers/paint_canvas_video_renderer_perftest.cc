@@ -0,0 +1,105 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/time/time.h"
+#include "media/base/video_frame.h"
+#include "media/renderers/paint_canvas_video_renderer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 50;
+
+struct ConvertPerfTestParams {
+  const char* name;
+  int width;
+  int height;
+  VideoPixelFormat format;
+};
+
+class PaintCanvasVideoRendererPerfTest
+    : public testing::TestWithParam<ConvertPerfTestParams> {
+ public:
+  PaintCanvasVideoRendererPerfTest()
+      : size_(GetParam().width, GetParam().height),
+        frame_(VideoFrame::CreateFrame(GetParam().format,
+                                       size_,
+                                       gfx::Rect(size_),
+                                       size_,
+                                       base::TimeDelta())),
+        row_bytes_(size_.width() * 4),
+        rgb_pixels_(row_bytes_ * size_.height()) {
+    // Keep 10-bit samples within range.
+    const uint8_t mask = GetParam().format == PIXEL_FORMAT_I420 ? 0xff : 0x03;
+    for (size_t plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane;
+         ++plane) {
+      uint8_t* data = frame_->data(plane);
+      const int plane_bytes = frame_->stride(plane) * frame_->rows(plane);
+      for (int i = 0; i < plane_bytes; ++i)
+        data[i] = (i * 13 + plane * 47) & mask;
+    }
+  }
+
+  // Converts |frame_| kBenchmarkIterations times and reports the time per
+  // frame.  |striped| conversions are waited for before the next one starts.
+  void RunBenchmark(const std::string& mode, bool striped) {
+    base::WaitableEvent done(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                             base::WaitableEvent::InitialState::NOT_SIGNALED);
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      if (striped) {
+        PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsAsync(
+            frame_.get(), rgb_pixels_.data(), row_bytes_,
+            base::BindOnce(&base::WaitableEvent::Signal,
+                           base::Unretained(&done)));
+        done.Wait();
+      } else {
+        PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+            frame_.get(), rgb_pixels_.data(), row_bytes_);
+      }
+    }
+    double total_time_milliseconds =
+        (base::TimeTicks::Now() - start).InMillisecondsF();
+    perf_test::PrintResult("convert_video_frame_to_rgb", "",
+                           std::string(GetParam().name) + "_" + mode,
+                           total_time_milliseconds / kBenchmarkIterations,
+                           "ms", true);
+  }
+
+ protected:
+  const gfx::Size size_;
+  const scoped_refptr<VideoFrame> frame_;
+  const size_t row_bytes_;
+  std::vector<uint8_t> rgb_pixels_;
+};
+
+TEST_P(PaintCanvasVideoRendererPerfTest, Serial) {
+  RunBenchmark("serial", false);
+}
+
+TEST_P(PaintCanvasVideoRendererPerfTest, Striped) {
+  base::test::ScopedTaskEnvironment task_environment;
+  RunBenchmark("striped", true);
+}
+
+static const ConvertPerfTestParams kConvertPerfTestParams[] = {
+    {"1080p_8bit", 1920, 1080, PIXEL_FORMAT_I420},
+    {"1080p_10bit", 1920, 1080, PIXEL_FORMAT_YUV420P10},
+    {"4k_8bit", 3840, 2160, PIXEL_FORMAT_I420},
+    {"4k_10bit", 3840, 2160, PIXEL_FORMAT_YUV420P10},
+};
+
+INSTANTIATE_TEST_CASE_P(,
+                        PaintCanvasVideoRendererPerfTest,
+                        testing::ValuesIn(kConvertPerfTestParams));
+
+}  // namespace media
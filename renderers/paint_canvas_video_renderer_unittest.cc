@@ -4,10 +4,14 @@
 
 #include <GLES3/gl3.h>
 #include <stdint.h>
+#include <vector>
 
+#include "base/bind.h"
 #include "base/macros.h"
 #include "base/memory/aligned_memory.h"
 #include "base/message_loop/message_loop.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/scoped_task_environment.h"
 #include "cc/paint/paint_flags.h"
 #include "cc/paint/skia_paint_canvas.h"
 #include "gpu/GLES2/gl2extchromium.h"
@@ -325,6 +329,90 @@ TEST_F(PaintCanvasVideoRendererTest, Smaller) {
   EXPECT_EQ(SK_ColorBLUE, bitmap()->getColor(0, 0));
 }
 
+TEST_F(PaintCanvasVideoRendererTest, ScaledImageCache) {
+  // |larger_frame| is drawn downscaled, so it gets an image of the drawn size
+  // which is cached for the frame.
+  Paint(larger_frame(), target_canvas(), kBlue);
+  EXPECT_EQ(SK_ColorBLUE, bitmap()->getColor(0, 0));
+  EXPECT_EQ(1u, renderer_.ScaledImageCountForTesting());
+
+  // The cached image is used as long as the frame's id doesn't change.
+  Paint(larger_frame(), target_canvas(), kNone);
+  EXPECT_EQ(SK_ColorBLUE, bitmap()->getColor(0, 0));
+  EXPECT_EQ(1u, renderer_.ScaledImageCountForTesting());
+
+  renderer_.ResetCache();
+  EXPECT_EQ(0u, renderer_.ScaledImageCountForTesting());
+}
+
+TEST_F(PaintCanvasVideoRendererTest, ScaledImageCacheSeveralSizes) {
+  const gfx::RectF kThumbnailRect(kWidth / 2, kHeight / 2);
+  PaintRotated(larger_frame(), target_canvas(), kThumbnailRect, kBlue,
+               SkBlendMode::kSrcOver, VIDEO_ROTATION_0);
+  Paint(larger_frame(), target_canvas(), kNone);
+  EXPECT_EQ(2u, renderer_.ScaledImageCountForTesting());
+  EXPECT_EQ(static_cast<size_t>(kThumbnailRect.size().GetArea() +
+                                kNaturalRect.size().GetArea()) *
+                4,
+            renderer_.ScaledImageBytesForTesting());
+
+  // Painting the frame at its own size goes through |last_image_|, which must
+  // leave the downscaled images alone.
+  PaintRotated(larger_frame(), target_canvas(),
+               gfx::RectF(larger_frame()->visible_rect()), kNone,
+               SkBlendMode::kSrcOver, VIDEO_ROTATION_0);
+  EXPECT_EQ(2u, renderer_.ScaledImageCountForTesting());
+
+  // Both sizes are still served from the cache.
+  PaintRotated(larger_frame(), target_canvas(), kThumbnailRect, kNone,
+               SkBlendMode::kSrcOver, VIDEO_ROTATION_0);
+  EXPECT_EQ(SK_ColorBLUE, bitmap()->getColor(0, 0));
+  Paint(larger_frame(), target_canvas(), kNone);
+  EXPECT_EQ(SK_ColorBLUE, bitmap()->getColor(kWidth - 1, kHeight - 1));
+  EXPECT_EQ(2u, renderer_.ScaledImageCountForTesting());
+}
+
+TEST_F(PaintCanvasVideoRendererTest, ScaledImageCacheDropsOlderFrames) {
+  Paint(larger_frame(), target_canvas(), kBlue);
+  EXPECT_EQ(1u, renderer_.ScaledImageCountForTesting());
+
+  // A new frame, as during playback, replaces the images of the previous one.
+  scoped_refptr<VideoFrame> next_frame =
+      VideoFrame::CreateBlackFrame(larger_frame()->coded_size());
+  Paint(next_frame, target_canvas(), kRed);
+  EXPECT_EQ(SK_ColorRED, bitmap()->getColor(0, 0));
+  EXPECT_EQ(1u, renderer_.ScaledImageCountForTesting());
+  EXPECT_EQ(static_cast<size_t>(kWidth * kHeight * 4),
+            renderer_.ScaledImageBytesForTesting());
+}
+
+TEST_F(PaintCanvasVideoRendererTest, ScaledImageCacheLimits) {
+  // At most 8 images are kept.
+  for (int i = 1; i <= 10; ++i) {
+    PaintRotated(larger_frame(), target_canvas(), gfx::RectF(i * 8, i * 8),
+                 kNone, SkBlendMode::kSrcOver, VIDEO_ROTATION_0);
+  }
+  EXPECT_EQ(8u, renderer_.ScaledImageCountForTesting());
+
+  // A 2048x2048 frame scaled to just below its size takes almost all of the
+  // 16MB budget, so each such image evicts everything else.
+  const int kSide = 2048;
+  const size_t kMaxBytes = 16 * 1024 * 1024;
+  scoped_refptr<VideoFrame> huge_frame =
+      VideoFrame::CreateBlackFrame(gfx::Size(kSide, kSide));
+  PaintRotated(huge_frame, target_canvas(), gfx::RectF(kSide / 2, kSide / 2),
+               kNone, SkBlendMode::kSrcOver, VIDEO_ROTATION_0);
+  EXPECT_EQ(1u, renderer_.ScaledImageCountForTesting());
+  for (int side = kSide - 1; side > kSide - 3; --side) {
+    PaintRotated(huge_frame, target_canvas(), gfx::RectF(side, side), kNone,
+                 SkBlendMode::kSrcOver, VIDEO_ROTATION_0);
+    EXPECT_EQ(1u, renderer_.ScaledImageCountForTesting());
+    EXPECT_EQ(static_cast<size_t>(side * side * 4),
+              renderer_.ScaledImageBytesForTesting());
+    EXPECT_LE(renderer_.ScaledImageBytesForTesting(), kMaxBytes);
+  }
+}
+
 TEST_F(PaintCanvasVideoRendererTest, NoTimestamp) {
   VideoFrame* video_frame = natural_frame().get();
   video_frame->set_timestamp(media::kNoTimestamp);
@@ -781,4 +869,42 @@ TEST_F(PaintCanvasVideoRendererTest, TexSubImage2D_Y16_R32F) {
       2 /*xoffset*/, 1 /*yoffset*/, false /*flip_y*/, true);
 }
 
+// Frames large enough to be converted in parallel stripes must produce the
+// same pixels as a serial conversion.
+TEST(PaintCanvasVideoRendererConvertTest, StripedMatchesSerial) {
+  const gfx::Size kCodedSize(1920, 1088);
+  // An odd visible height leaves a short final stripe.
+  const gfx::Rect kVisibleRect(2, 4, 1900, 1077);
+  const size_t kRowBytes = kVisibleRect.width() * 4;
+
+  for (const auto format : {PIXEL_FORMAT_I420, PIXEL_FORMAT_YUV420P10}) {
+    scoped_refptr<VideoFrame> frame = VideoFrame::CreateFrame(
+        format, kCodedSize, kVisibleRect, kVisibleRect.size(),
+        base::TimeDelta());
+    // Keep 10-bit samples within range.
+    const uint8_t mask = format == PIXEL_FORMAT_I420 ? 0xff : 0x03;
+    for (size_t plane = VideoFrame::kYPlane; plane <= VideoFrame::kVPlane;
+         ++plane) {
+      uint8_t* data = frame->data(plane);
+      const int plane_bytes = frame->stride(plane) * frame->rows(plane);
+      for (int i = 0; i < plane_bytes; ++i)
+        data[i] = (i * 7 + plane * 31) & mask;
+    }
+
+    std::vector<uint8_t> serial(kRowBytes * kVisibleRect.height());
+    PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixels(
+        frame.get(), serial.data(), kRowBytes);
+
+    base::test::ScopedTaskEnvironment task_environment;
+    std::vector<uint8_t> striped(serial.size());
+    base::WaitableEvent done(base::WaitableEvent::ResetPolicy::MANUAL,
+                             base::WaitableEvent::InitialState::NOT_SIGNALED);
+    PaintCanvasVideoRenderer::ConvertVideoFrameToRGBPixelsAsync(
+        frame.get(), striped.data(), kRowBytes,
+        base::BindOnce(&base::WaitableEvent::Signal, base::Unretained(&done)));
+    done.Wait();
+    EXPECT_EQ(serial, striped) << VideoPixelFormatToString(format);
+  }
+}
+
 }  // namespace media
@@ -3,15 +3,39 @@
 // found in the LICENSE file.
 
 #include "media/video/h264_bit_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bits.h"
 #include "base/logging.h"
+#include "base/sys_byteorder.h"
 
 namespace media {
 
+namespace {
+
+const int kRegWidthInBits = sizeof(uint64_t) * 8;
+
+// Returns true if any of the bytes in |word| is 0x03, the value of emulation
+// prevention bytes.
+bool HasEmulationPreventionByteValue(uint64_t word) {
+  const uint64_t zero_if_03 = word ^ UINT64_C(0x0303030303030303);
+  return ((zero_if_03 - UINT64_C(0x0101010101010101)) & ~zero_if_03 &
+          UINT64_C(0x8080808080808080)) != 0;
+}
+
+}  // namespace
+
+constexpr size_t H264BitReader::kNumEmulationPreventionBytePositions;
+
 H264BitReader::H264BitReader()
     : data_(NULL),
       bytes_left_(0),
-      curr_byte_(0),
-      num_remaining_bits_in_curr_byte_(0),
+      reg_(0),
+      num_bits_in_reg_(0),
+      num_bits_loaded_(0),
       prev_two_bytes_(0),
       emulation_prevention_bytes_(0) {}
 
@@ -25,7 +49,9 @@ bool H264BitReader::Initialize(const uint8_t* data, off_t size) {
 
   data_ = data;
   bytes_left_ = size;
-  num_remaining_bits_in_curr_byte_ = 0;
+  reg_ = 0;
+  num_bits_in_reg_ = 0;
+  num_bits_loaded_ = 0;
   // Initially set to 0xffff to accept all initial two-byte sequences.
   prev_two_bytes_ = 0xffff;
   emulation_prevention_bytes_ = 0;
@@ -33,79 +59,191 @@ bool H264BitReader::Initialize(const uint8_t* data, off_t size) {
   return true;
 }
 
-bool H264BitReader::UpdateCurrByte() {
-  if (bytes_left_ < 1)
-    return false;
+void H264BitReader::Refill() {
+  while (num_bits_in_reg_ <= kRegWidthInBits - 8 && bytes_left_ > 0) {
+    // Load as many whole bytes as fit at once, unless one of them might be an
+    // emulation prevention byte.
+    if (bytes_left_ >= static_cast<off_t>(sizeof(uint64_t))) {
+      uint64_t word;
+      memcpy(&word, data_, sizeof(word));
+      word = base::NetToHost64(word);
+      if (!HasEmulationPreventionByteValue(word)) {
+        const int num_bytes = (kRegWidthInBits - num_bits_in_reg_) / 8;
+        const uint64_t bytes = word >> (kRegWidthInBits - 8 * num_bytes);
+        reg_ |= bytes << (kRegWidthInBits - num_bits_in_reg_ - 8 * num_bytes);
+        num_bits_in_reg_ += 8 * num_bytes;
+        num_bits_loaded_ += 8 * num_bytes;
+        data_ += num_bytes;
+        bytes_left_ -= num_bytes;
+        prev_two_bytes_ = num_bytes > 1
+                              ? bytes & 0xffff
+                              : ((prev_two_bytes_ & 0xff) << 8) | bytes;
+        continue;
+      }
+    }
 
-  // Emulation prevention three-byte detection.
-  // If a sequence of 0x000003 is found, skip (ignore) the last byte (0x03).
-  if (*data_ == 0x03 && (prev_two_bytes_ & 0xffff) == 0) {
-    // Detected 0x000003, skip last byte.
-    ++data_;
-    --bytes_left_;
-    ++emulation_prevention_bytes_;
-    // Need another full three bytes before we can detect the sequence again.
-    prev_two_bytes_ = 0xffff;
+    // Emulation prevention three-byte detection.
+    // If a sequence of 0x000003 is found, skip (ignore) the last byte (0x03).
+    if (*data_ == 0x03 && (prev_two_bytes_ & 0xffff) == 0) {
+      // Detected 0x000003, skip last byte.
+      ++data_;
+      --bytes_left_;
+      emulation_prevention_byte_positions_
+          [emulation_prevention_bytes_ % kNumEmulationPreventionBytePositions] =
+              num_bits_loaded_;
+      ++emulation_prevention_bytes_;
+      // Need another full three bytes before we can detect the sequence again.
+      prev_two_bytes_ = 0xffff;
+      continue;
+    }
 
-    if (bytes_left_ < 1)
-      return false;
+    const uint8_t byte = *data_++;
+    --bytes_left_;
+    reg_ |= static_cast<uint64_t>(byte)
+            << (kRegWidthInBits - 8 - num_bits_in_reg_);
+    num_bits_in_reg_ += 8;
+    num_bits_loaded_ += 8;
+    prev_two_bytes_ = ((prev_two_bytes_ & 0xff) << 8) | byte;
   }
+}
 
-  // Load a new byte and advance pointers.
-  curr_byte_ = *data_++ & 0xff;
-  --bytes_left_;
-  num_remaining_bits_in_curr_byte_ = 8;
-
-  prev_two_bytes_ = ((prev_two_bytes_ & 0xff) << 8) | curr_byte_;
-
-  return true;
+size_t H264BitReader::NumEmulationPreventionBytesAfter(off_t num_bits) const {
+  const size_t num_positions = std::min(emulation_prevention_bytes_,
+                                        kNumEmulationPreventionBytePositions);
+  size_t count = 0;
+  for (size_t i = 0; i < num_positions; ++i) {
+    if (emulation_prevention_byte_positions_[i] >= num_bits)
+      ++count;
+  }
+  return count;
 }
 
 // Read |num_bits| (1 to 31 inclusive) from the stream and return them
 // in |out|, with first bit in the stream as MSB in |out| at position
 // (|num_bits| - 1).
 bool H264BitReader::ReadBits(int num_bits, int* out) {
-  int bits_left = num_bits;
-  *out = 0;
   DCHECK(num_bits <= 31);
 
-  while (num_remaining_bits_in_curr_byte_ < bits_left) {
-    // Take all that's left in current byte, shift to make space for the rest.
-    *out |= (curr_byte_ << (bits_left - num_remaining_bits_in_curr_byte_));
-    bits_left -= num_remaining_bits_in_curr_byte_;
+  if (num_bits_in_reg_ < num_bits) {
+    Refill();
+    if (num_bits_in_reg_ < num_bits)
+      return false;
+  }
+
+  if (num_bits == 0) {
+    *out = 0;
+    return true;
+  }
 
-    if (!UpdateCurrByte())
+  *out = static_cast<int>(reg_ >> (kRegWidthInBits - num_bits));
+  reg_ <<= num_bits;
+  num_bits_in_reg_ -= num_bits;
+  return true;
+}
+
+bool H264BitReader::ReadUE(int* out) {
+  if (num_bits_in_reg_ < 32)
+    Refill();
+
+  // A code with n leading zero bits is 2n + 1 bits long, and its value is
+  // the code read as a binary number, minus one. Codes of up to 30 leading
+  // zero bits fit in an int.
+  const int leading_zero_bits =
+      reg_ ? base::bits::CountLeadingZeroBits(reg_) : kRegWidthInBits;
+  const int code_bits = 2 * leading_zero_bits + 1;
+  if (leading_zero_bits <= 30 && code_bits <= num_bits_in_reg_) {
+    *out = static_cast<int>((reg_ >> (kRegWidthInBits - code_bits)) - 1);
+    reg_ <<= code_bits;
+    num_bits_in_reg_ -= code_bits;
+    return true;
+  }
+
+  // The code is cut short by the end of the stream, or too large; read it
+  // bit by bit to consume it the same way in any case.
+  int num_bits = -1;
+  int bit;
+  do {
+    if (!ReadBits(1, &bit))
+      return false;
+    num_bits++;
+  } while (bit == 0);
+
+  if (num_bits > 31)
+    return false;
+
+  // Special case for |num_bits| == 31 to avoid integer overflow. The only
+  // valid representation as an int is 2^31 - 1, so the remaining bits must
+  // be 0 or else the number is too large.
+  *out = (1u << num_bits) - 1u;
+
+  int rest;
+  if (num_bits == 31) {
+    if (!ReadBits(num_bits, &rest))
+      return false;
+    return rest == 0;
+  }
+
+  if (num_bits > 0) {
+    if (!ReadBits(num_bits, &rest))
       return false;
+    *out += rest;
   }
 
-  *out |= (curr_byte_ >> (num_remaining_bits_in_curr_byte_ - bits_left));
-  *out &= ((1u << num_bits) - 1u);
-  num_remaining_bits_in_curr_byte_ -= bits_left;
+  return true;
+}
+
+bool H264BitReader::ReadSE(int* out) {
+  int ue;
+
+  // See Chapter 9 in the spec.
+  if (!ReadUE(&ue))
+    return false;
+
+  if (ue % 2 == 0)
+    *out = -(ue / 2);
+  else
+    *out = ue / 2 + 1;
 
   return true;
 }
 
 off_t H264BitReader::NumBitsLeft() {
-  return (num_remaining_bits_in_curr_byte_ + bytes_left_ * 8);
+  // Count emulation prevention bytes ahead of the bits read so far, as if
+  // they hadn't been skipped yet. A skipped byte is behind once the first bit
+  // after it has been read.
+  return num_bits_in_reg_ + bytes_left_ * 8 +
+         NumEmulationPreventionBytesAfter(NumBitsRead()) * 8;
 }
 
 bool H264BitReader::HasMoreRBSPData() {
-  // Make sure we have more bits, if we are at 0 bits in current byte and
-  // updating current byte fails, we don't have more data anyway.
-  if (num_remaining_bits_in_curr_byte_ == 0 && !UpdateCurrByte())
-    return false;
+  // Make sure we have more bits, if we are at 0 bits in |reg_| and refilling
+  // it fails, we don't have more data anyway.
+  if (num_bits_in_reg_ == 0) {
+    Refill();
+    if (num_bits_in_reg_ == 0)
+      return false;
+  }
 
-  // If there is no more RBSP data, then |curr_byte_| contains the stop bit and
-  // zero padding. Check to see if there is other data instead.
+  // If there is no more RBSP data, then the current byte contains the stop
+  // bit and zero padding. Check to see if there is other data instead.
   // (We don't actually check for the stop bit itself, instead treating the
   // invalid case of all trailing zeros identically).
-  if ((curr_byte_ & ((1 << (num_remaining_bits_in_curr_byte_ - 1)) - 1)) != 0)
+  const int bits_in_curr_byte =
+      num_bits_in_reg_ % 8 ? num_bits_in_reg_ % 8 : 8;
+  const uint64_t bits_after_next_bit =
+      ((UINT64_C(1) << (bits_in_curr_byte - 1)) - 1)
+      << (kRegWidthInBits - bits_in_curr_byte);
+  if ((reg_ & bits_after_next_bit) != 0)
     return true;
 
   // While the spec disallows it (7.4.1: "The last byte of the NAL unit shall
   // not be equal to 0x00"), some streams have trailing null bytes anyway. We
   // don't handle emulation prevention sequences because HasMoreRBSPData() is
   // not used when parsing slices (where cabac_zero_word elements are legal).
+  if ((reg_ << bits_in_curr_byte) != 0 ||
+      NumEmulationPreventionBytesAfter(NumBitsRead() + bits_in_curr_byte) > 0) {
+    return true;
+  }
   for (off_t i = 0; i < bytes_left_; i++) {
     if (data_[i] != 0)
       return true;
@@ -116,7 +254,8 @@ bool H264BitReader::HasMoreRBSPData() {
 }
 
 size_t H264BitReader::NumEmulationPreventionBytesRead() {
-  return emulation_prevention_bytes_;
+  return emulation_prevention_bytes_ -
+         NumEmulationPreventionBytesAfter(NumBitsRead());
 }
 
 }  // namespace media
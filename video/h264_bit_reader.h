@@ -20,6 +20,9 @@ namespace media {
 // This is not a generic bit reader class, as it takes into account
 // H.264 stream-specific constraints, such as skipping emulation-prevention
 // bytes and stop bits. See spec for more details.
+//
+// Bits are read from a 64-bit cache, which is refilled several bytes at a
+// time; emulation prevention bytes are dropped as the cache is refilled.
 class MEDIA_EXPORT H264BitReader {
  public:
   H264BitReader();
@@ -34,11 +37,17 @@ class MEDIA_EXPORT H264BitReader {
 
   // Read |num_bits| next bits from stream and return in |*out|, first bit
   // from the stream starting at |num_bits| position in |*out|.
-  // |num_bits| may be 1-32, inclusive.
+  // |num_bits| may be 1-31, inclusive.
   // Return false if the given number of bits cannot be read (not enough
   // bits in the stream), true otherwise.
   bool ReadBits(int num_bits, int* out);
 
+  // Read one unsigned/signed Exp-Golomb code (see 9.1 in the spec) from the
+  // stream and return it in |*out|. Return false if the stream ends within
+  // the code, or if its value does not fit in an int.
+  bool ReadUE(int* out);
+  bool ReadSE(int* out);
+
   // Return the number of bits left in the stream.
   off_t NumBitsLeft();
 
@@ -49,30 +58,52 @@ class MEDIA_EXPORT H264BitReader {
   size_t NumEmulationPreventionBytesRead();
 
  private:
-  // Advance to the next byte, loading it into curr_byte_.
-  // Return false on end of stream.
-  bool UpdateCurrByte();
+  // Number of recently skipped emulation prevention bytes whose position is
+  // remembered. Only those next to bits still in |reg_| are needed; there are
+  // at most 5 of them, since |reg_| holds 8 bytes and each emulation
+  // prevention byte follows two zero bytes.
+  static constexpr size_t kNumEmulationPreventionBytePositions = 8;
+
+  // Load bytes into |reg_| until it holds more than 56 bits or the stream
+  // ends, skipping emulation prevention bytes.
+  void Refill();
 
-  // Pointer to the next unread (not in curr_byte_) byte in the stream.
+  // Return the number of skipped emulation prevention bytes which come after
+  // the first |num_bits| bits of the RBSP.
+  size_t NumEmulationPreventionBytesAfter(off_t num_bits) const;
+
+  // Return the number of bits read since Initialize().
+  off_t NumBitsRead() const { return num_bits_loaded_ - num_bits_in_reg_; }
+
+  // Pointer to the next byte in the stream not yet loaded into |reg_|.
   const uint8_t* data_;
 
-  // Bytes left in the stream (without the curr_byte_).
+  // Bytes left in the stream (without those loaded into |reg_|).
   off_t bytes_left_;
 
-  // Contents of the current byte; first unread bit starting at position
-  // 8 - num_remaining_bits_in_curr_byte_ from MSB.
-  int curr_byte_;
+  // Bits loaded from the stream but not read yet, first unread bit as MSB.
+  // Bits beyond |num_bits_in_reg_| are zero.
+  uint64_t reg_;
+  int num_bits_in_reg_;
 
-  // Number of bits remaining in curr_byte_
-  int num_remaining_bits_in_curr_byte_;
+  // Number of bits loaded into |reg_| since Initialize(), not counting
+  // emulation prevention bytes.
+  off_t num_bits_loaded_;
 
   // Used in emulation prevention three byte detection (see spec).
   // Initially set to 0xffff to accept all initial two-byte sequences.
   int prev_two_bytes_;
 
-  // Number of emulation preventation bytes (0x000003) we met.
+  // Number of emulation preventation bytes (0x000003) skipped, including
+  // those behind bits still in |reg_|.
   size_t emulation_prevention_bytes_;
 
+  // Value of |num_bits_loaded_| when each of the last skipped emulation
+  // prevention bytes was met, indexed by their count modulo
+  // kNumEmulationPreventionBytePositions.
+  off_t emulation_prevention_byte_positions_
+      [kNumEmulationPreventionBytePositions];
+
   DISALLOW_COPY_AND_ASSIGN(H264BitReader);
 };
 
@@ -0,0 +1,139 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/time/time.h"
+#include "media/video/h264_bit_reader.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 20;
+
+// Number of Exp-Golomb codes in the test stream.
+static const int kNumCodes = 1024 * 1024;
+
+// Decodes an Exp-Golomb code one bit at a time, the way H264Parser used to.
+static bool ReadUEBitByBit(H264BitReader* reader, int* val) {
+  int num_bits = -1;
+  int bit;
+  do {
+    if (!reader->ReadBits(1, &bit))
+      return false;
+    num_bits++;
+  } while (!bit);
+
+  if (num_bits > 30)
+    return false;
+
+  *val = (1 << num_bits) - 1;
+  if (num_bits > 0) {
+    int rest;
+    if (!reader->ReadBits(num_bits, &rest))
+      return false;
+    *val += rest;
+  }
+  return true;
+}
+
+class H264BitReaderPerfTest : public testing::Test {
+ public:
+  H264BitReaderPerfTest() {
+    // Mostly small values, as in slice headers and macroblock layers, with
+    // emulation prevention bytes inserted the way an encoder would.
+    uint32_t state = 1;
+    std::vector<bool> bits;
+    for (int i = 0; i < kNumCodes; ++i) {
+      state = state * 1103515245 + 12345;
+      const uint32_t value = (state >> 16) % ((state & 0x7) ? 8 : 4096);
+      const uint32_t code = value + 1;
+      int code_bits = 0;
+      while (code >> code_bits)
+        ++code_bits;
+      bits.insert(bits.end(), code_bits - 1, false);
+      for (int bit = code_bits - 1; bit >= 0; --bit)
+        bits.push_back((code >> bit) & 1);
+    }
+    bits.push_back(true);
+
+    int zeroes = 0;
+    for (size_t i = 0; i < bits.size(); i += 8) {
+      uint8_t value = 0;
+      for (size_t bit = i; bit < i + 8; ++bit)
+        value = (value << 1) | (bit < bits.size() && bits[bit]);
+      if (zeroes >= 2 && value <= 0x03) {
+        stream_.push_back(0x03);
+        zeroes = 0;
+      }
+      stream_.push_back(value);
+      zeroes = value ? 0 : zeroes + 1;
+    }
+  }
+
+  // Runs |read| on a fresh reader kBenchmarkIterations times and reports the
+  // time per stream.
+  template <typename ReadFunction>
+  void RunBenchmark(const std::string& trace, ReadFunction read) {
+    int64_t sum = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i) {
+      H264BitReader reader;
+      ASSERT_TRUE(reader.Initialize(stream_.data(), stream_.size()));
+      sum += read(&reader);
+    }
+    double total_time_milliseconds =
+        (base::TimeTicks::Now() - start).InMillisecondsF();
+    EXPECT_GT(sum, 0);
+    perf_test::PrintResult("h264_bit_reader", "", trace,
+                           total_time_milliseconds / kBenchmarkIterations,
+                           "ms", true);
+  }
+
+ protected:
+  std::vector<uint8_t> stream_;
+};
+
+TEST_F(H264BitReaderPerfTest, ReadUE) {
+  RunBenchmark("read_ue", [](H264BitReader* reader) {
+    int64_t sum = 0;
+    int value;
+    for (int i = 0; i < kNumCodes; ++i) {
+      EXPECT_TRUE(reader->ReadUE(&value));
+      sum += value;
+    }
+    return sum;
+  });
+}
+
+TEST_F(H264BitReaderPerfTest, ReadUEBitByBit) {
+  RunBenchmark("read_ue_bit_by_bit", [](H264BitReader* reader) {
+    int64_t sum = 0;
+    int value;
+    for (int i = 0; i < kNumCodes; ++i) {
+      EXPECT_TRUE(ReadUEBitByBit(reader, &value));
+      sum += value;
+    }
+    return sum;
+  });
+}
+
+TEST_F(H264BitReaderPerfTest, ReadBits) {
+  RunBenchmark("read_bits", [](H264BitReader* reader) {
+    int64_t sum = 0;
+    int value;
+    for (int num_bits = 1; reader->ReadBits(num_bits, &value);
+         num_bits = num_bits % 16 + 1) {
+      sum += value;
+    }
+    return sum;
+  });
+}
+
+}  // namespace media
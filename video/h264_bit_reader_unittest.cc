@@ -3,6 +3,11 @@
 // found in the LICENSE file.
 
 #include "media/video/h264_bit_reader.h"
+
+#include <stdint.h>
+
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace media {
@@ -70,4 +75,146 @@ TEST(H264BitReaderTest, StopBitOccupyFullByte) {
   EXPECT_FALSE(reader.HasMoreRBSPData());
 }
 
+TEST(H264BitReaderTest, ReadExpGolombCodes) {
+  H264BitReader reader;
+  // ue(v) codes for 0, 1, 2, 3, 7, 254 followed by se(v) codes for 1, -1, 2,
+  // -2, then a stop bit: 1 010 011 00100 0001000 000000011111111 010 011
+  // 00100 00101 1.
+  const unsigned char rbsp[] = {0xa6, 0x41, 0x00, 0x3f, 0xd3, 0x21, 0x60};
+  int value = 0;
+
+  EXPECT_TRUE(reader.Initialize(rbsp, sizeof(rbsp)));
+  const int kExpectedUE[] = {0, 1, 2, 3, 7, 254};
+  for (int expected : kExpectedUE) {
+    EXPECT_TRUE(reader.ReadUE(&value));
+    EXPECT_EQ(expected, value);
+  }
+  const int kExpectedSE[] = {1, -1, 2, -2};
+  for (int expected : kExpectedSE) {
+    EXPECT_TRUE(reader.ReadSE(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_EQ(reader.NumBitsLeft(), 6);
+  EXPECT_FALSE(reader.HasMoreRBSPData());
+}
+
+TEST(H264BitReaderTest, ReadLongExpGolombCodes) {
+  H264BitReader reader;
+  // 2^31 - 2, the largest value that fits in an int, is 30 zero bits followed
+  // by 31 one bits. 2^31 - 1 needs 31 leading zero bits and is rejected. The
+  // runs of zero bytes are escaped.
+  const unsigned char stream[] = {0x00, 0x00, 0x03, 0x00, 0x03, 0xff, 0xff,
+                                  0xff, 0xf8, 0x00, 0x00, 0x03, 0x00, 0x0f,
+                                  0xff, 0xff, 0xff, 0xf0};
+  int value = 0;
+
+  EXPECT_TRUE(reader.Initialize(stream, sizeof(stream)));
+  EXPECT_TRUE(reader.ReadUE(&value));
+  EXPECT_EQ(0x7ffffffe, value);
+  EXPECT_FALSE(reader.ReadUE(&value));
+}
+
+TEST(H264BitReaderTest, ReadExpGolombCodePastEndOfStream) {
+  H264BitReader reader;
+  // Five leading zero bits need five more bits after the marker bit.
+  const unsigned char rbsp[] = {0x01};
+  int value = 0;
+
+  EXPECT_TRUE(reader.Initialize(rbsp, sizeof(rbsp)));
+  EXPECT_TRUE(reader.ReadBits(2, &value));
+  EXPECT_FALSE(reader.ReadUE(&value));
+}
+
+TEST(H264BitReaderTest, SkipEmulationPreventionBytes) {
+  H264BitReader reader;
+  const unsigned char stream[] = {0x00, 0x00, 0x03, 0x01, 0x00,
+                                  0x00, 0x03, 0x00, 0xff, 0x80};
+  int value = 0;
+
+  EXPECT_TRUE(reader.Initialize(stream, sizeof(stream)));
+  EXPECT_EQ(reader.NumBitsLeft(), 80);
+  EXPECT_EQ(reader.NumEmulationPreventionBytesRead(), 0u);
+
+  EXPECT_TRUE(reader.ReadBits(16, &value));
+  EXPECT_EQ(value, 0);
+  EXPECT_EQ(reader.NumEmulationPreventionBytesRead(), 0u);
+
+  // The next byte comes after the first emulation prevention byte.
+  EXPECT_TRUE(reader.ReadBits(8, &value));
+  EXPECT_EQ(value, 0x01);
+  EXPECT_EQ(reader.NumEmulationPreventionBytesRead(), 1u);
+  EXPECT_EQ(reader.NumBitsLeft(), 48);
+
+  EXPECT_TRUE(reader.ReadBits(24, &value));
+  EXPECT_EQ(value, 0);
+  EXPECT_EQ(reader.NumEmulationPreventionBytesRead(), 2u);
+  EXPECT_EQ(reader.NumBitsLeft(), 16);
+  EXPECT_TRUE(reader.HasMoreRBSPData());
+
+  EXPECT_TRUE(reader.ReadBits(8, &value));
+  EXPECT_EQ(value, 0xff);
+  EXPECT_FALSE(reader.HasMoreRBSPData());
+}
+
+// Compares reads from a stream with emulation prevention bytes against the
+// RBSP they escape.
+TEST(H264BitReaderTest, MatchesUnescapedStream) {
+  // Build an RBSP with many runs of zero bytes, and escape it.
+  std::vector<uint8_t> rbsp;
+  uint32_t seed = 1;
+  for (int i = 0; i < 4096; ++i) {
+    seed = seed * 1103515245 + 12345;
+    const uint8_t byte = seed >> 24;
+    rbsp.push_back(byte < 0x80 ? 0 : byte < 0xa0 ? byte & 3 : byte);
+  }
+  rbsp.back() = 0x80;
+
+  std::vector<uint8_t> stream;
+  int zero_count = 0;
+  for (uint8_t byte : rbsp) {
+    if (zero_count >= 2 && byte <= 0x03) {
+      stream.push_back(0x03);
+      zero_count = 0;
+    }
+    stream.push_back(byte);
+    zero_count = byte == 0 ? zero_count + 1 : 0;
+  }
+
+  H264BitReader reader;
+  EXPECT_TRUE(reader.Initialize(stream.data(), stream.size()));
+  off_t bit_offset = 0;
+  int read_index = 0;
+  while (bit_offset + 64 < static_cast<off_t>(rbsp.size() * 8)) {
+    int value = 0;
+    int expected = 0;
+    if (read_index++ % 3 == 0) {
+      // Decode the expected Exp-Golomb code one bit at a time.
+      int leading_zeros = 0;
+      while (!(rbsp[(bit_offset + leading_zeros) / 8] &
+               (0x80 >> ((bit_offset + leading_zeros) % 8)))) {
+        ++leading_zeros;
+      }
+      if (leading_zeros > 30)
+        break;
+      bit_offset += leading_zeros + 1;
+      int suffix = 0;
+      for (int i = 0; i < leading_zeros; ++i, ++bit_offset) {
+        suffix = (suffix << 1) |
+                 ((rbsp[bit_offset / 8] >> (7 - bit_offset % 8)) & 1);
+      }
+      expected = (1 << leading_zeros) - 1 + suffix;
+      ASSERT_TRUE(reader.ReadUE(&value));
+    } else {
+      const int num_bits = 1 + read_index % 31;
+      for (int i = 0; i < num_bits; ++i, ++bit_offset) {
+        expected = (expected << 1) |
+                   ((rbsp[bit_offset / 8] >> (7 - bit_offset % 8)) & 1);
+      }
+      ASSERT_TRUE(reader.ReadBits(num_bits, &value));
+    }
+    ASSERT_EQ(expected, value) << "at bit " << bit_offset;
+    ASSERT_TRUE(reader.HasMoreRBSPData());
+  }
+}
+
 }  // namespace media
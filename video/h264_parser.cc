@@ -4,19 +4,94 @@
 
 #include "media/video/h264_parser.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <limits>
 #include <memory>
 
+#include "base/bits.h"
 #include "base/logging.h"
 #include "base/macros.h"
 #include "base/numerics/safe_math.h"
+#include "build/build_config.h"
 #include "media/base/subsample_entry.h"
 #include "ui/gfx/geometry/rect.h"
 #include "ui/gfx/geometry/size.h"
 
+// NaCl does not allow intrinsics.
+#if defined(ARCH_CPU_X86_FAMILY) && !defined(OS_NACL)
+#include <emmintrin.h>
+#define VECTORIZED_START_CODE_SEARCH
+#elif defined(ARCH_CPU_ARM_FAMILY) && defined(USE_NEON)
+#include <arm_neon.h>
+#define VECTORIZED_START_CODE_SEARCH
+#endif
+
 namespace media {
 
 namespace {
+
+#if defined(VECTORIZED_START_CODE_SEARCH)
+// Number of candidate start code positions tested at once.
+constexpr off_t kStartCodeSearchStride = 16;
+#endif
+
+// Returns the offset of the first three-byte start code in |data|, or
+// |data_size| if there is none.
+off_t FindThreeByteStartCode(const uint8_t* data, off_t data_size) {
+  off_t pos = 0;
+
+#if defined(VECTORIZED_START_CODE_SEARCH)
+  // Compare kStartCodeSearchStride positions against "\0\0\1" at once; each
+  // position needs two bytes after it to be tested.
+  for (; pos + kStartCodeSearchStride + 2 <= data_size;
+       pos += kStartCodeSearchStride) {
+#if defined(ARCH_CPU_X86_FAMILY)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i byte0 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    const __m128i byte1 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1));
+    const __m128i byte2 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 2));
+    const __m128i matches = _mm_and_si128(
+        _mm_and_si128(_mm_cmpeq_epi8(byte0, zero), _mm_cmpeq_epi8(byte1, zero)),
+        _mm_cmpeq_epi8(byte2, _mm_set1_epi8(1)));
+    const uint32_t mask = _mm_movemask_epi8(matches);
+    if (mask)
+      return pos + base::bits::CountTrailingZeroBits(mask);
+#elif defined(ARCH_CPU_ARM_FAMILY)
+    const uint8x16_t matches = vandq_u8(
+        vandq_u8(vceqq_u8(vld1q_u8(data + pos), vdupq_n_u8(0)),
+                 vceqq_u8(vld1q_u8(data + pos + 1), vdupq_n_u8(0))),
+        vceqq_u8(vld1q_u8(data + pos + 2), vdupq_n_u8(1)));
+    const uint8x8_t any_match =
+        vorr_u8(vget_low_u8(matches), vget_high_u8(matches));
+    if (vget_lane_u64(vreinterpret_u64_u8(any_match), 0)) {
+      while (data[pos] || data[pos + 1] || data[pos + 2] != 1)
+        ++pos;
+      return pos;
+    }
+#endif
+  }
+#endif  // defined(VECTORIZED_START_CODE_SEARCH)
+
+  // Search the remaining positions. The start code is "\0\0\1", ones are more
+  // unusual than zeroes, so let's search for it first.
+  while (data_size - pos >= 3) {
+    const uint8_t* one = reinterpret_cast<const uint8_t*>(
+        memchr(data + pos + 2, 1, data_size - pos - 2));
+    if (!one)
+      break;
+    pos = one - data - 2;
+    if (data[pos] == 0x00 && data[pos + 1] == 0x00)
+      return pos;
+    ++pos;
+  }
+  return data_size;
+}
+
 // Converts [|start|, |end|) range with |encrypted_ranges| into a vector of
 // SubsampleEntry. |encrypted_ranges| must be with in the range defined by
 // |start| and |end|.
@@ -298,7 +373,13 @@ static const int kTableSarHeight[] = {0,  1,  11, 11, 11, 33, 11, 11, 11,
 static_assert(arraysize(kTableSarWidth) == arraysize(kTableSarHeight),
               "sar tables must have the same size");
 
-H264Parser::H264Parser() {
+template <typename ParameterSet>
+H264Parser::StoredParameterSet<ParameterSet>::StoredParameterSet() = default;
+
+template <typename ParameterSet>
+H264Parser::StoredParameterSet<ParameterSet>::~StoredParameterSet() = default;
+
+H264Parser::H264Parser() : last_parameter_set_changed_(false) {
   Reset();
 }
 
@@ -341,27 +422,55 @@ void H264Parser::SetEncryptedStream(
 }
 
 const H264PPS* H264Parser::GetPPS(int pps_id) const {
-  auto it = active_PPSes_.find(pps_id);
-  if (it == active_PPSes_.end()) {
+  if (pps_id < 0 || pps_id >= kMaxPPSCount ||
+      !active_PPSes_[pps_id].parameter_set) {
     DVLOG(1) << "Requested a nonexistent PPS id " << pps_id;
     return nullptr;
   }
 
-  return it->second.get();
+  return active_PPSes_[pps_id].parameter_set.get();
 }
 
 const H264SPS* H264Parser::GetSPS(int sps_id) const {
-  auto it = active_SPSes_.find(sps_id);
-  if (it == active_SPSes_.end()) {
+  if (sps_id < 0 || sps_id >= kMaxSPSCount ||
+      !active_SPSes_[sps_id].parameter_set) {
     DVLOG(1) << "Requested a nonexistent SPS id " << sps_id;
     return nullptr;
   }
 
-  return it->second.get();
+  return active_SPSes_[sps_id].parameter_set.get();
+}
+
+template <typename ParameterSet>
+bool H264Parser::IsRepeatOf(
+    const StoredParameterSet<ParameterSet>& stored) const {
+  DCHECK_EQ(previous_nalu_range_.size(), 1u);
+  const uint8_t* nalu_start = previous_nalu_range_.start(0);
+  const size_t nalu_size = previous_nalu_range_.end(0) - nalu_start;
+  return stored.parameter_set && stored.nalu_data.size() == nalu_size &&
+         memcmp(stored.nalu_data.data(), nalu_start, nalu_size) == 0;
+}
+
+template <typename ParameterSet>
+void H264Parser::Store(std::unique_ptr<ParameterSet> parameter_set,
+                       StoredParameterSet<ParameterSet>* stored) {
+  DCHECK_EQ(previous_nalu_range_.size(), 1u);
+  stored->parameter_set = std::move(parameter_set);
+  stored->nalu_data.assign(previous_nalu_range_.start(0),
+                           previous_nalu_range_.end(0));
+  last_parameter_set_changed_ = true;
 }
 
-static inline bool IsStartCode(const uint8_t* data) {
-  return data[0] == 0x00 && data[1] == 0x00 && data[2] == 0x01;
+H264Parser::Result H264Parser::RewindToNALUPayload() {
+  DCHECK_EQ(previous_nalu_range_.size(), 1u);
+  const uint8_t* nalu_start = previous_nalu_range_.start(0);
+  if (!br_.Initialize(nalu_start, previous_nalu_range_.end(0) - nalu_start))
+    return kInvalidStream;
+
+  // Skip the NALU header.
+  int data;
+  READ_BITS_OR_RETURN(8, &data);
+  return kOk;
 }
 
 // static
@@ -370,49 +479,27 @@ bool H264Parser::FindStartCode(const uint8_t* data,
                                off_t* offset,
                                off_t* start_code_size) {
   DCHECK_GE(data_size, 0);
-  off_t bytes_left = data_size;
-
-  while (bytes_left >= 3) {
-    // The start code is "\0\0\1", ones are more unusual than zeroes, so let's
-    // search for it first.
-    const uint8_t* tmp =
-        reinterpret_cast<const uint8_t*>(memchr(data + 2, 1, bytes_left - 2));
-    if (!tmp) {
-      data += bytes_left - 2;
-      bytes_left = 2;
-      break;
-    }
-    tmp -= 2;
-    bytes_left -= tmp - data;
-    data = tmp;
-
-    if (IsStartCode(data)) {
-      // Found three-byte start code, set pointer at its beginning.
-      *offset = data_size - bytes_left;
-      *start_code_size = 3;
-
-      // If there is a zero byte before this start code,
-      // then it's actually a four-byte start code, so backtrack one byte.
-      if (*offset > 0 && *(data - 1) == 0x00) {
-        --(*offset);
-        ++(*start_code_size);
-      }
+  *offset = FindThreeByteStartCode(data, data_size);
+  if (*offset == data_size) {
+    // End of data: offset is pointing to the first byte that was not
+    // considered as a possible start of a start code.
+    // Note: there is no security issue when receiving a negative |data_size|
+    // since in this case |*offset| is 0 (valid offset).
+    *offset = std::max<off_t>(data_size - 2, 0);
+    *start_code_size = 0;
+    return false;
+  }
 
-      return true;
-    }
+  // Found three-byte start code, |*offset| points at its beginning.
+  *start_code_size = 3;
 
-    ++data;
-    --bytes_left;
+  // If there is a zero byte before this start code,
+  // then it's actually a four-byte start code, so backtrack one byte.
+  if (*offset > 0 && data[*offset - 1] == 0x00) {
+    --(*offset);
+    ++(*start_code_size);
   }
-
-  // End of data: offset is pointing to the first byte that was not considered
-  // as a possible start of a start code.
-  // Note: there is no security issue when receiving a negative |data_size|
-  // since in this case, |bytes_left| is equal to |data_size| and thus
-  // |*offset| is equal to 0 (valid offset).
-  *offset = data_size - bytes_left;
-  *start_code_size = 0;
-  return false;
+  return true;
 }
 
 bool H264Parser::LocateNALU(off_t* nalu_size, off_t* start_code_size) {
@@ -493,6 +580,49 @@ bool H264Parser::FindStartCodeInClearRanges(
   return true;
 }
 
+// static
+void H264Parser::FindNALUs(const uint8_t* data,
+                           off_t data_size,
+                           const Ranges<const uint8_t*>& encrypted_ranges,
+                           std::vector<NALUBoundary>* nalus) {
+  DCHECK(nalus);
+  off_t start_code_offset = 0;
+  off_t start_code_size = 0;
+  if (!FindStartCodeInClearRanges(data, data_size, encrypted_ranges,
+                                  &start_code_offset, &start_code_size)) {
+    return;
+  }
+
+  // Each search for the next start code ends the current NALU, so every byte
+  // is scanned once.
+  while (true) {
+    const off_t nalu_data_offset = start_code_offset + start_code_size;
+    if (nalu_data_offset >= data_size)
+      return;
+
+    NALUBoundary nalu;
+    nalu.start_code_offset = start_code_offset;
+    nalu.start_code_size = start_code_size;
+
+    off_t nalu_size_without_start_code = 0;
+    if (!FindStartCodeInClearRanges(
+            data + nalu_data_offset, data_size - nalu_data_offset,
+            encrypted_ranges, &nalu_size_without_start_code,
+            &start_code_size)) {
+      nalu.size_with_start_code = data_size - start_code_offset;
+      nalus->push_back(nalu);
+      return;
+    }
+    // Consecutive start codes enclose no NALU; skip the empty range.
+    if (nalu_size_without_start_code > 0) {
+      nalu.size_with_start_code =
+          nalu.start_code_size + nalu_size_without_start_code;
+      nalus->push_back(nalu);
+    }
+    start_code_offset = nalu_data_offset + nalu_size_without_start_code;
+  }
+}
+
 // static
 VideoCodecProfile H264Parser::ProfileIDCToVideoCodecProfile(int profile_idc) {
   switch (profile_idc) {
@@ -526,73 +656,35 @@ bool H264Parser::ParseNALUs(const uint8_t* stream,
                             size_t stream_size,
                             std::vector<H264NALU>* nalus) {
   DCHECK(nalus);
-  H264Parser parser;
-  parser.SetStream(stream, stream_size);
+  std::vector<NALUBoundary> boundaries;
+  FindNALUs(stream, stream_size, Ranges<const uint8_t*>(), &boundaries);
 
-  while (true) {
+  nalus->reserve(nalus->size() + boundaries.size());
+  for (const NALUBoundary& boundary : boundaries) {
     H264NALU nalu;
-    const H264Parser::Result result = parser.AdvanceToNextNALU(&nalu);
-    if (result == H264Parser::kOk) {
-      nalus->push_back(nalu);
-    } else if (result == media::H264Parser::kEOStream) {
-      return true;
-    } else {
-      DLOG(ERROR) << "Unexpected H264 parser result";
+    nalu.data = stream + boundary.start_code_offset + boundary.start_code_size;
+    nalu.size = boundary.size_with_start_code - boundary.start_code_size;
+    DCHECK_GT(nalu.size, 0);
+
+    // Read NALU header, checking the forbidden_zero_bit.
+    const uint8_t header = nalu.data[0];
+    if (header & 0x80) {
+      DLOG(ERROR) << "Invalid NALU header";
       return false;
     }
+    nalu.nal_ref_idc = (header >> 5) & 0x3;
+    nalu.nal_unit_type = header & 0x1f;
+    nalus->push_back(nalu);
   }
-  NOTREACHED();
-  return false;
+  return true;
 }
 
 H264Parser::Result H264Parser::ReadUE(int* val) {
-  int num_bits = -1;
-  int bit;
-  int rest;
-
-  // Count the number of contiguous zero bits.
-  do {
-    READ_BITS_OR_RETURN(1, &bit);
-    num_bits++;
-  } while (bit == 0);
-
-  if (num_bits > 31)
-    return kInvalidStream;
-
-  // Calculate exp-Golomb code value of size num_bits.
-  // Special case for |num_bits| == 31 to avoid integer overflow. The only
-  // valid representation as an int is 2^31 - 1, so the remaining bits must
-  // be 0 or else the number is too large.
-  *val = (1u << num_bits) - 1u;
-
-  if (num_bits == 31) {
-    READ_BITS_OR_RETURN(num_bits, &rest);
-    return (rest == 0) ? kOk : kInvalidStream;
-  }
-
-  if (num_bits > 0) {
-    READ_BITS_OR_RETURN(num_bits, &rest);
-    *val += rest;
-  }
-
-  return kOk;
+  return br_.ReadUE(val) ? kOk : kInvalidStream;
 }
 
 H264Parser::Result H264Parser::ReadSE(int* val) {
-  int ue;
-  Result res;
-
-  // See Chapter 9 in the spec.
-  res = ReadUE(&ue);
-  if (res != kOk)
-    return res;
-
-  if (ue % 2 == 0)
-    *val = -(ue / 2);
-  else
-    *val = ue / 2 + 1;
-
-  return kOk;
+  return br_.ReadSE(val) ? kOk : kInvalidStream;
 }
 
 H264Parser::Result H264Parser::AdvanceToNextNALU(H264NALU* nalu) {
@@ -1030,6 +1122,21 @@ H264Parser::Result H264Parser::ParseSPS(int* sps_id) {
 
   *sps_id = -1;
 
+  // Look up the SPS stored under the id, which follows the first three bytes,
+  // and skip parsing if this is a repeat of it.
+  int id;
+  READ_BITS_OR_RETURN(24, &data);
+  READ_UE_OR_RETURN(&id);
+  TRUE_OR_RETURN(id < kMaxSPSCount);
+  if (IsRepeatOf(active_SPSes_[id])) {
+    *sps_id = id;
+    last_parameter_set_changed_ = false;
+    return kOk;
+  }
+  res = RewindToNALUPayload();
+  if (res != kOk)
+    return res;
+
   std::unique_ptr<H264SPS> sps(new H264SPS());
 
   READ_BITS_OR_RETURN(8, &sps->profile_idc);
@@ -1137,9 +1244,16 @@ H264Parser::Result H264Parser::ParseSPS(int* sps_id) {
       return res;
   }
 
-  // If an SPS with the same id already exists, replace it.
+  // If an SPS with the same id already exists, replace it. PPSes referring to
+  // it may parse differently now, so repeats of them must be parsed again.
   *sps_id = sps->seq_parameter_set_id;
-  active_SPSes_[*sps_id] = std::move(sps);
+  Store(std::move(sps), &active_SPSes_[*sps_id]);
+  for (StoredParameterSet<H264PPS>& stored_pps : active_PPSes_) {
+    if (stored_pps.parameter_set &&
+        stored_pps.parameter_set->seq_parameter_set_id == *sps_id) {
+      stored_pps.nalu_data.clear();
+    }
+  }
 
   return kOk;
 }
@@ -1151,20 +1265,27 @@ H264Parser::Result H264Parser::ParsePPS(int* pps_id) {
 
   *pps_id = -1;
 
-  std::unique_ptr<H264PPS> pps(new H264PPS());
+  // Skip parsing if this is a repeat of the PPS stored under the same id.
+  int id;
+  READ_UE_OR_RETURN(&id);
+  TRUE_OR_RETURN(id < kMaxPPSCount);
+  if (IsRepeatOf(active_PPSes_[id])) {
+    *pps_id = id;
+    last_parameter_set_changed_ = false;
+    return kOk;
+  }
 
-  READ_UE_OR_RETURN(&pps->pic_parameter_set_id);
+  std::unique_ptr<H264PPS> pps(new H264PPS());
+  pps->pic_parameter_set_id = id;
   READ_UE_OR_RETURN(&pps->seq_parameter_set_id);
-  TRUE_OR_RETURN(pps->seq_parameter_set_id < 32);
+  TRUE_OR_RETURN(pps->seq_parameter_set_id < kMaxSPSCount);
 
-  if (active_SPSes_.find(pps->seq_parameter_set_id) == active_SPSes_.end()) {
+  sps = GetSPS(pps->seq_parameter_set_id);
+  if (!sps) {
     DVLOG(1) << "Invalid stream, no SPS id: " << pps->seq_parameter_set_id;
     return kInvalidStream;
   }
 
-  sps = GetSPS(pps->seq_parameter_set_id);
-  TRUE_OR_RETURN(sps);
-
   READ_BOOL_OR_RETURN(&pps->entropy_coding_mode_flag);
   READ_BOOL_OR_RETURN(&pps->bottom_field_pic_order_in_frame_present_flag);
 
@@ -1214,7 +1335,7 @@ H264Parser::Result H264Parser::ParsePPS(int* pps_id) {
 
   // If a PPS with the same id already exists, replace it.
   *pps_id = pps->pic_parameter_set_id;
-  active_PPSes_[*pps_id] = std::move(pps);
+  Store(std::move(pps), &active_PPSes_[*pps_id]);
 
   return kOk;
 }
@@ -11,7 +11,6 @@
 #include <stdint.h>
 #include <sys/types.h>
 
-#include <map>
 #include <memory>
 #include <vector>
 
@@ -395,6 +394,17 @@ class MEDIA_EXPORT H264Parser {
     kEOStream,           // end of stream
   };
 
+  // Location of a NALU within an Annex-B stream, as found by FindNALUs().
+  struct NALUBoundary {
+    // Offset from the start of the stream to the NALU's start code.
+    off_t start_code_offset;
+    // Either 3 or 4.
+    off_t start_code_size;
+    // Size of the NALU including its start code, i.e. up to the start code of
+    // the next NALU or the end of the stream.
+    off_t size_with_start_code;
+  };
+
   // Find offset from start of data to next NALU start code
   // and size of found start code (3 or 4 bytes).
   // If no start code is found, offset is pointing to the first unprocessed byte
@@ -420,6 +430,16 @@ class MEDIA_EXPORT H264Parser {
                                          off_t* offset,
                                          off_t* start_code_size);
 
+  // Finds every NALU in |data| in a single pass over it, skipping start codes
+  // that may appear inside of |encrypted_ranges|, and appends their locations
+  // to |nalus|. The NALUs are the same as repeated calls to
+  // AdvanceToNextNALU() would find, except that empty NALUs between
+  // consecutive start codes are skipped rather than ending the stream.
+  static void FindNALUs(const uint8_t* data,
+                        off_t data_size,
+                        const Ranges<const uint8_t*>& encrypted_ranges,
+                        std::vector<NALUBoundary>* nalus);
+
   static VideoCodecProfile ProfileIDCToVideoCodecProfile(int profile_idc);
 
   // Parses the input stream and returns all the NALUs through |nalus|. Returns
@@ -471,6 +491,16 @@ class MEDIA_EXPORT H264Parser {
   const H264SPS* GetSPS(int sps_id) const;
   const H264PPS* GetPPS(int pps_id) const;
 
+  // Returns true if the last successful ParseSPS()/ParsePPS() call replaced
+  // the SPS/PPS stored under its id, or stored the first one. In-band repeats
+  // of a byte-identical SPS/PPS, as sent before every IDR picture by
+  // broadcast and HLS streams, are not parsed again and are not changes, so
+  // callers can reconfigure only when this returns true. Pointers returned by
+  // GetSPS()/GetPPS() stay valid across repeats.
+  bool last_parameter_set_changed() const {
+    return last_parameter_set_changed_;
+  }
+
   // Slice headers and SEI messages are not used across NALUs by the parser
   // and can be discarded after current NALU, so the parser does not store
   // them, nor does it manage their memory.
@@ -491,6 +521,35 @@ class MEDIA_EXPORT H264Parser {
   std::vector<SubsampleEntry> GetCurrentSubsamples();
 
  private:
+  // Maximum number of SPSes and PPSes in a stream, see 7.4.2.1.1 and 7.4.2.2.
+  static constexpr int kMaxSPSCount = 32;
+  static constexpr int kMaxPPSCount = 256;
+
+  // An SPS or PPS stored for future reference, along with the NALU it was
+  // parsed from.
+  template <typename ParameterSet>
+  struct StoredParameterSet {
+    StoredParameterSet();
+    ~StoredParameterSet();
+
+    std::unique_ptr<ParameterSet> parameter_set;
+    // Empty if a repeat of the NALU has to be parsed again.
+    std::vector<uint8_t> nalu_data;
+  };
+
+  // Returns true if the current NALU is a byte-identical repeat of the one
+  // |stored| was parsed from.
+  template <typename ParameterSet>
+  bool IsRepeatOf(const StoredParameterSet<ParameterSet>& stored) const;
+
+  // Stores |parameter_set|, parsed from the current NALU, in |stored|.
+  template <typename ParameterSet>
+  void Store(std::unique_ptr<ParameterSet> parameter_set,
+             StoredParameterSet<ParameterSet>* stored);
+
+  // Moves |br_| back to the start of the current NALU's payload.
+  Result RewindToNALUPayload();
+
   // Move the stream pointer to the beginning of the next NALU,
   // i.e. pointing at the next start code.
   // Return true if a NALU has been found.
@@ -543,9 +602,12 @@ class MEDIA_EXPORT H264Parser {
 
   H264BitReader br_;
 
-  // PPSes and SPSes stored for future reference.
-  std::map<int, std::unique_ptr<H264SPS>> active_SPSes_;
-  std::map<int, std::unique_ptr<H264PPS>> active_PPSes_;
+  // PPSes and SPSes stored for future reference, indexed by id.
+  StoredParameterSet<H264SPS> active_SPSes_[kMaxSPSCount];
+  StoredParameterSet<H264PPS> active_PPSes_[kMaxPPSCount];
+
+  // See last_parameter_set_changed().
+  bool last_parameter_set_changed_;
 
   // Ranges of encrypted bytes in the buffer passed to
   // SetEncryptedStream().
@@ -0,0 +1,110 @@
+// Copyright 2018 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/time/time.h"
+#include "media/video/h264_parser.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_test.h"
+
+namespace media {
+
+static const int kBenchmarkIterations = 20;
+
+// Roughly one second of a 100 Mbps stream.
+static const size_t kStreamSize = 12 * 1024 * 1024;
+
+class H264ParserPerfTest : public testing::Test {
+ public:
+  H264ParserPerfTest() {
+    // Slices of pseudo-random payload, with emulation prevention bytes
+    // inserted the way an encoder would.
+    uint32_t state = 1;
+    auto next_random = [&state]() {
+      state = state * 1103515245 + 12345;
+      return state >> 16;
+    };
+    while (stream_.size() < kStreamSize) {
+      stream_.insert(stream_.end(), {0x00, 0x00, 0x00, 0x01, 0x65});
+      const size_t slice_size = 16 * 1024 + next_random() % (64 * 1024);
+      int zeroes = 0;
+      for (size_t i = 0; i < slice_size; ++i) {
+        // Skew towards zero bytes, which are common in real payloads.
+        const uint8_t value = next_random() % 4 ? next_random() & 0xff : 0;
+        if (zeroes >= 2 && value <= 0x03) {
+          stream_.push_back(0x03);
+          zeroes = 0;
+        }
+        stream_.push_back(value);
+        zeroes = value ? 0 : zeroes + 1;
+      }
+      // Slices don't end in a zero byte.
+      stream_.push_back(0x80);
+    }
+  }
+
+  // Runs |scan| kBenchmarkIterations times and reports the time per stream.
+  template <typename ScanFunction>
+  void RunBenchmark(const std::string& trace, ScanFunction scan) {
+    size_t nalus = 0;
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int i = 0; i < kBenchmarkIterations; ++i)
+      nalus = scan();
+    double total_time_milliseconds =
+        (base::TimeTicks::Now() - start).InMillisecondsF();
+    EXPECT_GT(nalus, 0u);
+    perf_test::PrintResult("h264_parser", "", trace,
+                           total_time_milliseconds / kBenchmarkIterations,
+                           "ms", true);
+  }
+
+ protected:
+  std::vector<uint8_t> stream_;
+};
+
+TEST_F(H264ParserPerfTest, FindStartCode) {
+  RunBenchmark("find_start_code", [this]() {
+    size_t nalus = 0;
+    const uint8_t* data = stream_.data();
+    off_t bytes_left = stream_.size();
+    off_t offset;
+    off_t start_code_size;
+    while (H264Parser::FindStartCode(data, bytes_left, &offset,
+                                     &start_code_size)) {
+      ++nalus;
+      data += offset + start_code_size;
+      bytes_left -= offset + start_code_size;
+    }
+    return nalus;
+  });
+}
+
+TEST_F(H264ParserPerfTest, FindNALUs) {
+  std::vector<H264Parser::NALUBoundary> nalus;
+  RunBenchmark("find_nalus", [this, &nalus]() {
+    nalus.clear();
+    H264Parser::FindNALUs(stream_.data(), stream_.size(),
+                          Ranges<const uint8_t*>(), &nalus);
+    return nalus.size();
+  });
+}
+
+TEST_F(H264ParserPerfTest, AdvanceToNextNALU) {
+  RunBenchmark("advance_to_next_nalu", [this]() {
+    size_t nalus = 0;
+    H264Parser parser;
+    parser.SetStream(stream_.data(), stream_.size());
+    H264NALU nalu;
+    while (parser.AdvanceToNextNALU(&nalu) == H264Parser::kOk)
+      ++nalus;
+    return nalus;
+  });
+}
+
+}  // namespace media
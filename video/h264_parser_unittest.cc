@@ -2,6 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <algorithm>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -169,6 +170,242 @@ TEST(H264ParserTest, ParseNALUsFromStreamFile) {
   ASSERT_EQ(num_nalus, nalus.size());
 }
 
+// Byte-by-byte reference for H264Parser::FindStartCode().
+bool FindStartCodeReference(const uint8_t* data,
+                            off_t data_size,
+                            off_t* offset,
+                            off_t* start_code_size) {
+  for (off_t i = 0; i + 3 <= data_size; ++i) {
+    if (data[i] == 0x00 && data[i + 1] == 0x00 && data[i + 2] == 0x01) {
+      *offset = i;
+      *start_code_size = 3;
+      if (i > 0 && data[i - 1] == 0x00) {
+        --(*offset);
+        ++(*start_code_size);
+      }
+      return true;
+    }
+  }
+  *offset = std::max<off_t>(data_size - 2, 0);
+  *start_code_size = 0;
+  return false;
+}
+
+// Checks start codes on each side of the boundaries between vectorized and
+// scalar search.
+TEST(H264ParserTest, FindStartCodeAtEveryPosition) {
+  const off_t kBufferSize = 70;
+  for (off_t size = 0; size <= kBufferSize; ++size) {
+    for (off_t pos = 0; pos < kBufferSize; ++pos) {
+      for (const bool four_byte : {false, true}) {
+        std::vector<uint8_t> buffer(kBufferSize, 0xab);
+        buffer[pos] = 0x00;
+        if (pos + 1 < kBufferSize)
+          buffer[pos + 1] = 0x00;
+        if (pos + 2 < kBufferSize)
+          buffer[pos + 2] = 0x01;
+        if (four_byte && pos > 0)
+          buffer[pos - 1] = 0x00;
+
+        off_t offset = -1;
+        off_t start_code_size = -1;
+        off_t expected_offset = -1;
+        off_t expected_start_code_size = -1;
+        EXPECT_EQ(FindStartCodeReference(buffer.data(), size,
+                                         &expected_offset,
+                                         &expected_start_code_size),
+                  H264Parser::FindStartCode(buffer.data(), size, &offset,
+                                            &start_code_size))
+            << "size=" << size << " pos=" << pos;
+        EXPECT_EQ(expected_offset, offset);
+        EXPECT_EQ(expected_start_code_size, start_code_size);
+      }
+    }
+  }
+}
+
+// Checks streams dense in zeroes and ones, where most candidates are partial
+// start codes.
+TEST(H264ParserTest, FindStartCodeInDenseStream) {
+  std::vector<uint8_t> buffer(4096);
+  uint32_t state = 1;
+  for (uint8_t& value : buffer) {
+    state = state * 1103515245 + 12345;
+    value = (state >> 16) % 3 ? 0x00 : 0x01;
+  }
+  for (off_t start = 0; start < static_cast<off_t>(buffer.size()); ++start) {
+    const off_t size = buffer.size() - start;
+    off_t offset = -1;
+    off_t start_code_size = -1;
+    off_t expected_offset = -1;
+    off_t expected_start_code_size = -1;
+    EXPECT_EQ(FindStartCodeReference(buffer.data() + start, size,
+                                     &expected_offset,
+                                     &expected_start_code_size),
+              H264Parser::FindStartCode(buffer.data() + start, size, &offset,
+                                        &start_code_size));
+    EXPECT_EQ(expected_offset, offset);
+    EXPECT_EQ(expected_start_code_size, start_code_size);
+  }
+}
+
+TEST(H264ParserTest, FindNALUsMatchesAdvanceToNextNALU) {
+  base::FilePath file_path = GetTestDataFilePath("test-25fps.h264");
+  base::MemoryMappedFile stream;
+  ASSERT_TRUE(stream.Initialize(file_path))
+      << "Couldn't open stream file: " << file_path.MaybeAsASCII();
+
+  std::vector<H264Parser::NALUBoundary> boundaries;
+  H264Parser::FindNALUs(stream.data(), stream.length(),
+                        Ranges<const uint8_t*>(), &boundaries);
+
+  H264Parser parser;
+  parser.SetStream(stream.data(), stream.length());
+  H264NALU nalu;
+  for (const H264Parser::NALUBoundary& boundary : boundaries) {
+    ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+    EXPECT_EQ(stream.data() + boundary.start_code_offset +
+                  boundary.start_code_size,
+              nalu.data);
+    EXPECT_EQ(boundary.size_with_start_code - boundary.start_code_size,
+              nalu.size);
+  }
+  EXPECT_EQ(H264Parser::kEOStream, parser.AdvanceToNextNALU(&nalu));
+}
+
+TEST(H264ParserTest, FindNALUsSkipsEncryptedStartCodes) {
+  const uint8_t kStream[] = {
+      // Leading garbage, then the first NALU.
+      0xff, 0x00, 0x00, 0x00, 0x01,  // start code.
+      0x65,                          // Nalu type = 5, IDR slice.
+      // Encrypted bytes, which look like a start code.
+      0x12, 0x00, 0x00, 0x01, 0x34,
+      // Second NALU, in the clear.
+      0x00, 0x00, 0x01,  // start code.
+      0x06,              // Nalu type = 6, SEI.
+      0xff, 0xfe,
+      // Start code without a NALU header, which ends the stream.
+      0x00, 0x00, 0x01,
+  };
+  Ranges<const uint8_t*> encrypted_ranges;
+  encrypted_ranges.Add(kStream + 6, kStream + 11);
+
+  std::vector<H264Parser::NALUBoundary> boundaries;
+  H264Parser::FindNALUs(kStream, base::size(kStream), encrypted_ranges,
+                        &boundaries);
+  ASSERT_EQ(2u, boundaries.size());
+  EXPECT_EQ(1, boundaries[0].start_code_offset);
+  EXPECT_EQ(4, boundaries[0].start_code_size);
+  EXPECT_EQ(10, boundaries[0].size_with_start_code);
+  EXPECT_EQ(11, boundaries[1].start_code_offset);
+  EXPECT_EQ(3, boundaries[1].start_code_size);
+  EXPECT_EQ(6, boundaries[1].size_with_start_code);
+
+  // Without the encrypted ranges the start code in the first NALU counts.
+  boundaries.clear();
+  H264Parser::FindNALUs(kStream, base::size(kStream), Ranges<const uint8_t*>(),
+                        &boundaries);
+  EXPECT_EQ(3u, boundaries.size());
+}
+
+TEST(H264ParserTest, ParseNALUsSkipsEmptyNALUs) {
+  const uint8_t kStream[] = {
+      0x00, 0x00, 0x01,        // start code, with nothing after it.
+      0x00, 0x00, 0x00, 0x01,  // start code.
+      0x67,                    // Nalu type = 7, SPS.
+      0x42, 0xc0,
+      0x00, 0x00, 0x01,  // start code, with nothing after it.
+      0x00, 0x00, 0x01,  // start code.
+      0x68,              // Nalu type = 8, PPS.
+      0xce,
+  };
+
+  std::vector<H264NALU> nalus;
+  ASSERT_TRUE(H264Parser::ParseNALUs(kStream, base::size(kStream), &nalus));
+  ASSERT_EQ(2u, nalus.size());
+  EXPECT_EQ(kStream + 7, nalus[0].data);
+  EXPECT_EQ(3, nalus[0].size);
+  EXPECT_EQ(H264NALU::kSPS, nalus[0].nal_unit_type);
+  EXPECT_EQ(kStream + 16, nalus[1].data);
+  EXPECT_EQ(2, nalus[1].size);
+  EXPECT_EQ(H264NALU::kPPS, nalus[1].nal_unit_type);
+}
+
+TEST(H264ParserTest, RepeatedParameterSetsAreNotChanges) {
+  base::FilePath file_path = GetTestDataFilePath("test-25fps.h264");
+  base::MemoryMappedFile stream;
+  ASSERT_TRUE(stream.Initialize(file_path))
+      << "Couldn't open stream file: " << file_path.MaybeAsASCII();
+
+  // Copy the first SPS and PPS out of the stream, start codes included.
+  std::vector<uint8_t> sps_nalu;
+  std::vector<uint8_t> pps_nalu;
+  std::vector<H264Parser::NALUBoundary> boundaries;
+  H264Parser::FindNALUs(stream.data(), stream.length(),
+                        Ranges<const uint8_t*>(), &boundaries);
+  for (const H264Parser::NALUBoundary& boundary : boundaries) {
+    const uint8_t* start = stream.data() + boundary.start_code_offset;
+    const uint8_t* end = start + boundary.size_with_start_code;
+    const int nal_unit_type = start[boundary.start_code_size] & 0x1f;
+    if (nal_unit_type == H264NALU::kSPS && sps_nalu.empty())
+      sps_nalu.assign(start, end);
+    if (nal_unit_type == H264NALU::kPPS && pps_nalu.empty())
+      pps_nalu.assign(start, end);
+  }
+  ASSERT_FALSE(sps_nalu.empty());
+  ASSERT_FALSE(pps_nalu.empty());
+
+  // The SPS again, with a trailing byte which the parser ignores, but which
+  // makes it differ from the first one.
+  std::vector<uint8_t> changed_sps_nalu = sps_nalu;
+  changed_sps_nalu.push_back(0xff);
+
+  std::vector<uint8_t> test_stream;
+  for (const auto* nalu : {&sps_nalu, &pps_nalu, &sps_nalu, &pps_nalu,
+                           &changed_sps_nalu, &pps_nalu}) {
+    test_stream.insert(test_stream.end(), nalu->begin(), nalu->end());
+  }
+
+  H264Parser parser;
+  parser.SetStream(test_stream.data(), test_stream.size());
+  H264NALU nalu;
+  int sps_id;
+  int pps_id;
+
+  ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSPS(&sps_id));
+  EXPECT_TRUE(parser.last_parameter_set_changed());
+  const H264SPS* sps = parser.GetSPS(sps_id);
+  ASSERT_TRUE(sps);
+  const base::Optional<gfx::Size> coded_size = sps->GetCodedSize();
+  ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePPS(&pps_id));
+  EXPECT_TRUE(parser.last_parameter_set_changed());
+  const H264PPS* pps = parser.GetPPS(pps_id);
+
+  // Repeats keep the stored sets.
+  ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSPS(&sps_id));
+  EXPECT_FALSE(parser.last_parameter_set_changed());
+  EXPECT_EQ(sps, parser.GetSPS(sps_id));
+  ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePPS(&pps_id));
+  EXPECT_FALSE(parser.last_parameter_set_changed());
+  EXPECT_EQ(pps, parser.GetPPS(pps_id));
+
+  // A different SPS replaces the stored one, and the PPS referring to it has
+  // to be parsed again.
+  ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSPS(&sps_id));
+  EXPECT_TRUE(parser.last_parameter_set_changed());
+  ASSERT_TRUE(parser.GetSPS(sps_id));
+  EXPECT_EQ(coded_size, parser.GetSPS(sps_id)->GetCodedSize());
+  ASSERT_EQ(H264Parser::kOk, parser.AdvanceToNextNALU(&nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePPS(&pps_id));
+  EXPECT_TRUE(parser.last_parameter_set_changed());
+  EXPECT_EQ(H264Parser::kEOStream, parser.AdvanceToNextNALU(&nalu));
+}
+
 // Verify that GetCurrentSubsamples works.
 TEST(H264ParserTest, GetCurrentSubsamplesNormal) {
   const uint8_t kStream[] = {